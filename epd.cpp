@@ -4,111 +4,521 @@
 #include "esp_log.h"
 #include "freertos/task.h"
 
+void Epd::_updateBegin(){
+  update();
+}
+
+void Epd::_updateFinish(){
+}
+
+void Epd::updateDirty(uint8_t full_update_percent){
+  if (!_dirty.enabled()) {
+    update();
+    return;
+  }
+  if (_dirty.count() == 0) return;
+
+  uint32_t full_area = (uint32_t)WIDTH * (uint32_t)HEIGHT;
+  if (_dirty.area() * 100 >= full_area * full_update_percent) {
+    if (debug_enabled) printf("updateDirty: %d%% of the display changed, full update\n", (int)(_dirty.area() * 100 / full_area));
+    update();
+  } else {
+    uint8_t count = _dirty.count();
+    for (uint8_t i = 0; i < count; i++) {
+      epd_rect_t r = _dirty.rect(i);
+      if (debug_enabled) printf("updateDirty: x:%d y:%d w:%d h:%d\n", r.x, r.y, r.w, r.h);
+      _updateDirtyRect(r.x, r.y, r.w, r.h);
+    }
+  }
+  _dirty.clear();
+}
+
+bool Epd::_spanFill(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color){
+  // Adafruit_GFX has its own rules for negative sizes, leave them to it
+  if (_span.buffer == nullptr || w <= 0 || h <= 0) return false;
+  // Clip in rotated coordinates
+  if (x < 0) { w += x; x = 0; }
+  if (y < 0) { h += y; y = 0; }
+  if (x + w > width()) w = width() - x;
+  if (y + h > height()) h = height() - y;
+  if (w <= 0 || h <= 0) return true;
+
+  // Same transformation as drawPixel, applied once to the rectangle
+  int32_t x0, y0, x1, y1;
+  switch (getRotation()) {
+    case 1:
+      x0 = _span.width - y - h;
+      x1 = _span.width - y - 1;
+      y0 = x;
+      y1 = x + w - 1;
+      break;
+    case 2:
+      x0 = _span.width - x - w;
+      x1 = _span.width - x - 1;
+      y0 = _span.height - y - h;
+      y1 = _span.height - y - 1;
+      break;
+    case 3:
+      x0 = y;
+      x1 = y + h - 1;
+      y0 = _span.height - x - w;
+      y1 = _span.height - x - 1;
+      break;
+    default:
+      x0 = x;
+      x1 = x + w - 1;
+      y0 = y;
+      y1 = y + h - 1;
+      break;
+  }
+  // Models with less visible pixels than buffer bits (Ex. 122 of 128) map part of a rotated display outside
+  if (x0 < 0) x0 = 0;
+  if (y0 < 0) y0 = 0;
+  if (x1 >= _span.stride * 8) x1 = _span.stride * 8 - 1;
+  if (y1 >= _span.height) y1 = _span.height - 1;
+  if (x0 > x1 || y0 > y1) return true;
+
+  bool set = _span.inverted ? (color == 0) : (color != 0);
+  if (_span.rotated) {
+    // The buffer is in rotated coordinates already, only the dirty region is in controller ones
+    uint16_t stride = (width() + 7) / 8;
+    if (w == 1) {
+      epd_span1_column(_span.buffer, stride, x, y, y + h - 1, set);
+    } else {
+      epd_span1_rect(_span.buffer, stride, x, y, x + w - 1, y + h - 1, set);
+    }
+  } else if (x0 == x1) {
+    epd_span1_column(_span.buffer, _span.stride, x0, y0, y1, set);
+  } else {
+    epd_span1_rect(_span.buffer, _span.stride, x0, y0, x1, y1, set);
+  }
+  _dirty.markRect(x0, y0, x1 - x0 + 1, y1 - y0 + 1);
+  return true;
+}
+
+void Epd::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color){
+  if (!_spanFill(x, y, w, h, color)) Adafruit_GFX::fillRect(x, y, w, h, color);
+}
+
+void Epd::writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color){
+  if (!_spanFill(x, y, w, h, color)) Adafruit_GFX::writeFillRect(x, y, w, h, color);
+}
+
+void Epd::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color){
+  if (!_spanFill(x, y, w, 1, color)) Adafruit_GFX::drawFastHLine(x, y, w, color);
+}
+
+void Epd::writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color){
+  if (!_spanFill(x, y, w, 1, color)) Adafruit_GFX::writeFastHLine(x, y, w, color);
+}
+
+void Epd::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color){
+  if (!_spanFill(x, y, 1, h, color)) Adafruit_GFX::drawFastVLine(x, y, h, color);
+}
+
+void Epd::writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color){
+  if (!_spanFill(x, y, 1, h, color)) Adafruit_GFX::writeFastVLine(x, y, h, color);
+}
+
 // display.print / println handling
-// TODO: Implement printf
 size_t Epd::write(uint8_t v){
-  Adafruit_GFX::write(v);
+  if (_useGlyphCache()) {
+    _writeGlyph(v);
+  } else {
+    Adafruit_GFX::write(v);
+  }
   return 1;
 }
-uint8_t Epd::_unicodeEasy(uint8_t c) {
-  if (c<191 && c>131 && c!=176) { // 176 is °W 
-    c+=64;
-  }
-  return c;
-}
-
-uint8_t Epd::_unicodePerChar(uint8_t c) {
-  // Cope with umlauten - Needs work
-     // TODO: Research a smarter way to do this
-     switch (c)
-     {
-       // German characters
-     case 164: // ä update to right adafruit GFX char
-       c = 228;
-       break;
-     case 182: // ö
-       c += 64;
-       break;
-     case 188: // ü -> used also in spanish cigüeña
-       c += 64;
-       break;
-     case 132: // Ä
-       c += 64;
-       break;
-     case 150: // Ö
-       c += 64;
-       break;
-     case 156: // Ü
-       c += 64;
-       break;
-     case 159: // ß
-       c += 64;
-       break;
-     // Spanish/French/North EU characters
-       case 166: // æ
-       c += 64;
-       break;
-       case 167: // ç
-       c += 64;
-       break;
-       case 168: // è
-       c += 64;
-       break;
-       case 169: // é
-       c += 64;
-       break;
-       case 170: // ê
-       c += 64;
-       break;
-       case 171: // ë
-       c += 64;
-       break;
-       }
-       return c;
+
+// Decoded characters of one print(). The checks of the glyph cache are done once per run
+void Epd::_writeRun(const uint8_t* chars, size_t count){
+  if (_useGlyphCache()) {
+    for (size_t i = 0; i < count; i++) _writeGlyph(chars[i]);
+  } else {
+    for (size_t i = 0; i < count; i++) Adafruit_GFX::write(chars[i]);
+  }
+}
+
+bool Epd::setGlyphCache(uint16_t glyphs, uint32_t bytes){
+  if (glyphs == 0) {
+    _glyphs.end();
+    return true;
+  }
+  return _glyphs.begin(glyphs, bytes);
+}
+
+bool Epd::_useGlyphCache(){
+  return _glyphs.enabled() && gfxFont != nullptr && _span.buffer != nullptr &&
+         textsize_x == 1 && textsize_y == 1;
+}
+
+// Same cursor and wrap handling as Adafruit_GFX::write() for custom fonts
+void Epd::_writeGlyph(uint8_t c){
+  if (c == '\n') {
+    cursor_x = 0;
+    cursor_y += (uint8_t)gfxFont->yAdvance;
+    return;
+  }
+  if (c == '\r' || c < gfxFont->first || c > gfxFont->last) return;
+
+  GFXglyph* glyph = gfxFont->glyph + (c - gfxFont->first);
+  if (glyph->width > 0 && glyph->height > 0) {
+    int16_t xo = (int8_t)glyph->xOffset;
+    if (wrap && (cursor_x + xo + glyph->width) > _width) {
+      cursor_x = 0;
+      cursor_y += (uint8_t)gfxFont->yAdvance;
+    }
+    // Glyphs cut by the edges go pixel by pixel
+    if (!_blitGlyph(cursor_x + xo, cursor_y + (int8_t)glyph->yOffset, glyph, c)) {
+      drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor, 1, 1);
+    }
+  }
+  cursor_x += (uint8_t)glyph->xAdvance;
+}
+
+bool Epd::_blitGlyph(int16_t x, int16_t y, const GFXglyph* glyph, uint8_t c){
+  int16_t w = glyph->width;
+  int16_t h = glyph->height;
+  if (x < 0 || y < 0 || x + w > width() || y + h > height()) return false;
+
+  // Glyph box in controller coordinates, same transformation as _spanFill
+  int32_t x0, y0;
+  switch (getRotation()) {
+    case 1:
+      x0 = _span.width - y - h;
+      y0 = x;
+      break;
+    case 2:
+      x0 = _span.width - x - w;
+      y0 = _span.height - y - h;
+      break;
+    case 3:
+      x0 = y;
+      y0 = _span.height - x - w;
+      break;
+    default:
+      x0 = x;
+      y0 = y;
+      break;
+  }
+  int32_t x1 = x0 + ((getRotation() & 1) ? h : w) - 1;
+  int32_t y1 = y0 + ((getRotation() & 1) ? w : h) - 1;
+  if (x0 < 0 || y0 < 0 || x1 >= _span.stride * 8 || y1 >= _span.height) return false;
+
+  // A rotated buffer takes the glyph as drawn
+  const epd_glyph_t* g = _glyphs.get(gfxFont, c, _span.rotated ? 0 : getRotation());
+  if (g == nullptr) return false;
+  uint16_t stride = _span.rotated ? (width() + 7) / 8 : _span.stride;
+  uint16_t bx = _span.rotated ? x : x0;
+  uint16_t by = _span.rotated ? y : y0;
+
+  bool set = _span.inverted ? (textcolor == 0) : (textcolor != 0);
+  uint8_t shift = bx & 7;
+  uint8_t* row = _span.buffer + (uint32_t)by * stride + (bx >> 3);
+  const uint8_t* src = g->bits;
+  // Bytes touched per row: the glyph row shifted right may spill into one more byte
+  uint8_t out = (shift + g->w + 7) / 8;
+  for (uint8_t j = 0; j < g->h; j++, row += stride, src += g->stride) {
+    uint8_t carry = 0;
+    for (uint8_t b = 0; b < out; b++) {
+      uint8_t bits = (b < g->stride) ? src[b] : 0;
+      uint8_t mask = carry | (bits >> shift);
+      carry = shift ? (uint8_t)(bits << (8 - shift)) : 0;
+      if (set) {
+        row[b] |= mask;
+      } else {
+        row[b] &= ~mask;
+      }
+    }
+  }
+  _dirty.markRect(x0, y0, x1 - x0 + 1, y1 - y0 + 1);
+  return true;
+}
+
+void Epd::print(const char* text, size_t len){
+  // Decoded in runs so the buffer stays on the stack
+  uint8_t chars[EPD_UTF8_RUN + 1];
+  while (len > 0) {
+    size_t n = (len < EPD_UTF8_RUN) ? len : EPD_UTF8_RUN;
+    _writeRun(chars, _utf8.decode(gfxFont, text, n, chars));
+    text += n;
+    len -= n;
+  }
+}
+
+void Epd::print(const char* text){
+  print(text, strlen(text));
 }
 
 void Epd::print(const std::string& text){
-   for(auto c : text) {
-     if (c==195 || c==194) continue; // Skip to next letter
-     c = _unicodeEasy(c);
-     write(uint8_t(c));
-   }
+  print(text.data(), text.size());
 }
 
 void Epd::print(const char c){
-     write(uint8_t(c));
+  write(uint8_t(c));
 }
 
 void Epd::println(const std::string& text){
-   for(auto c : text) {
-     if (c==195 || c==194) continue; // Skip to next letter
+  print(text.data(), text.size());
+  write(10); // newline
+}
 
-     // _unicodeEasy will just sum 64 and get the right character, should be faster and cover more chars
-     c = _unicodeEasy(c);
-     //c = _unicodePerChar(c); // _unicodePerChar has more control since they are only hand-picked chars
-     write(uint8_t(c));
-   }
-   write(10); // newline
+void Epd::_printOut(void* arg, const char* text, size_t len){
+  ((Epd*)arg)->print(text, len);
+}
+
+bool Epd::setTextBoundsCache(uint8_t entries){
+  if (entries == 0) {
+    _textCache.end();
+    return true;
+  }
+  return _textCache.begin(entries);
+}
+
+// How far right of the cursor charBounds() tests for wrap. Text without newlines
+int16_t Epd::_textReach(const uint8_t* chars, size_t count){
+  int32_t x = 0;
+  int32_t reach = 0;
+  for (size_t i = 0; i < count; i++) {
+    uint8_t c = chars[i];
+    if (c == '\r') continue;
+    if (gfxFont == nullptr) {
+      x += textsize_x * 6;
+      if (x > reach) reach = x;
+      continue;
+    }
+    if (c < gfxFont->first || c > gfxFont->last) continue;
+    GFXglyph* glyph = gfxFont->glyph + (c - gfxFont->first);
+    int32_t right = x + ((int8_t)glyph->xOffset + glyph->width) * textsize_x;
+    if (right > reach) reach = right;
+    x += glyph->xAdvance * textsize_x;
+  }
+  return (reach < INT16_MAX) ? reach : INT16_MAX;
+}
+
+// getTextBounds() of decoded characters, from _textCache when they were measured before
+void Epd::_measure(const uint8_t* chars, size_t count, int16_t x, int16_t y, int16_t* x1, int16_t* y1,
+                   uint16_t* w, uint16_t* h){
+  bool cacheable = _textCache.enabled() && memchr(chars, '\n', count) == nullptr;
+  epd_text_bounds_t bounds;
+  if (cacheable && _textCache.find(gfxFont, textsize_x, textsize_y, chars, count, &bounds) &&
+      (!wrap || x + bounds.reach <= _width)) {
+    *x1 = x + bounds.x1;
+    *y1 = y + bounds.y1;
+    *w = bounds.w;
+    *h = bounds.h;
+    return;
+  }
+
+  _measure_t m;
+  _measureBegin(m, nullptr, 0, x, y);
+  _measureChars(m, chars, count);
+  _measureResult(m, x1, y1, w, h);
+  if (cacheable) {
+    // Bounds move with the cursor as long as nothing wraps
+    bounds.reach = _textReach(chars, count);
+    if (!wrap || x + bounds.reach <= _width) {
+      bounds.x1 = *x1 - x;
+      bounds.y1 = *y1 - y;
+      bounds.w = *w;
+      bounds.h = *h;
+      _textCache.insert(gfxFont, textsize_x, textsize_y, chars, count, bounds);
+    }
+  }
+}
+
+void Epd::_measureBegin(_measure_t& m, uint8_t* keep, size_t capacity, int16_t x, int16_t y){
+  m.epd = this;
+  m.keep = keep;
+  m.kept = 0;
+  m.capacity = capacity;
+  m.overflow = false;
+  m.x0 = x;
+  m.y0 = y;
+  m.x = x;
+  m.y = y;
+  // Inverted so the first character sets it, like getTextBounds()
+  m.minx = 0x7FFF;
+  m.miny = 0x7FFF;
+  m.maxx = -1;
+  m.maxy = -1;
+}
+
+void Epd::_measureChars(_measure_t& m, const uint8_t* chars, size_t count){
+  for (size_t i = 0; i < count; i++) {
+    charBounds(chars[i], &m.x, &m.y, &m.minx, &m.miny, &m.maxx, &m.maxy);
+  }
+}
+
+// Keeps the decoded text while it fits, to measure it with _measure(). Longer text is measured as it comes
+void Epd::_measureOut(void* arg, const char* text, size_t len){
+  _measure_t* m = (_measure_t*)arg;
+  uint8_t chars[EPD_FORMAT_CHUNK + 1];
+  size_t count = m->utf8.decode(m->epd->gfxFont, text, len, chars);
+  if (!m->overflow) {
+    if (m->kept + count <= m->capacity) {
+      memcpy(m->keep + m->kept, chars, count);
+      m->kept += count;
+      return;
+    }
+    m->overflow = true;
+    m->epd->_measureChars(*m, m->keep, m->kept);
+  }
+  m->epd->_measureChars(*m, chars, count);
+}
+
+void Epd::_measureEnd(_measure_t& m, int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h){
+  if (m.overflow) {
+    _measureResult(m, x1, y1, w, h);
+  } else {
+    _measure(m.keep, m.kept, m.x0, m.y0, x1, y1, w, h);
+  }
+}
+
+// Same result as getTextBounds() from the box of the characters measured
+void Epd::_measureResult(const _measure_t& m, int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h){
+  *x1 = m.x0;
+  *y1 = m.y0;
+  *w = *h = 0;
+  if (m.maxx >= m.minx) {
+    *x1 = m.minx;
+    *w = m.maxx - m.minx + 1;
+  }
+  if (m.maxy >= m.miny) {
+    *y1 = m.miny;
+    *h = m.maxy - m.miny + 1;
+  }
+}
+
+void Epd::_vmeasure(_measure_t& m, int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h, const char* format,
+                    va_list args){
+  epd_vformat(_measureOut, &m, format, args);
+  _measureEnd(m, x1, y1, w, h);
+}
+
+void Epd::layoutLabels(epd_label_t* labels, size_t count){
+  // Measured without wrap, like drawLabels() prints them
+  const GFXfont* font = gfxFont;
+  bool wrapped = wrap;
+  wrap = false;
+  uint8_t keep[EPD_TEXT_KEEP];
+  for (size_t i = 0; i < count; i++) {
+    epd_label_t& label = labels[i];
+    gfxFont = (GFXfont*)label.font;
+    _measure_t m;
+    _measureBegin(m, keep, sizeof(keep), 0, 0);
+    for (size_t len = strlen(label.text), done = 0; done < len; done += EPD_FORMAT_CHUNK) {
+      _measureOut(&m, label.text + done, (len - done < EPD_FORMAT_CHUNK) ? len - done : EPD_FORMAT_CHUNK);
+    }
+    int16_t x1, y1;
+    _measureEnd(m, &x1, &y1, &label.text_w, &label.text_h);
+
+    switch (label.align & EPD_ALIGN_HORIZONTAL) {
+      case EPD_ALIGN_CENTER:
+        label.cursor_x = label.x + ((int16_t)label.w - (int16_t)label.text_w) / 2 - x1;
+        break;
+      case EPD_ALIGN_RIGHT:
+        label.cursor_x = label.x + (int16_t)label.w - (int16_t)label.text_w - x1;
+        break;
+      default:
+        label.cursor_x = label.x - x1;
+        break;
+    }
+    switch (label.align & EPD_ALIGN_VERTICAL) {
+      case EPD_ALIGN_MIDDLE:
+        label.cursor_y = label.y + ((int16_t)label.h - (int16_t)label.text_h) / 2 - y1;
+        break;
+      case EPD_ALIGN_BOTTOM:
+        label.cursor_y = label.y + (int16_t)label.h - (int16_t)label.text_h - y1;
+        break;
+      default:
+        label.cursor_y = label.y - y1;
+        break;
+    }
+  }
+  // Assigned directly: setFont() moves the cursor when it changes between the classic font and a GFXfont
+  gfxFont = (GFXfont*)font;
+  wrap = wrapped;
+}
+
+void Epd::drawLabels(const epd_label_t* labels, size_t count){
+  const GFXfont* font = gfxFont;
+  bool wrapped = wrap;
+  uint16_t color = textcolor;
+  uint16_t bgcolor = textbgcolor;
+  wrap = false;
+  for (size_t i = 0; i < count; i++) {
+    const epd_label_t& label = labels[i];
+    gfxFont = (GFXfont*)label.font;
+    textcolor = textbgcolor = label.color;
+    cursor_x = label.cursor_x;
+    cursor_y = label.cursor_y;
+    print(label.text);
+  }
+  gfxFont = (GFXfont*)font;
+  wrap = wrapped;
+  textcolor = color;
+  textbgcolor = bgcolor;
+}
+
+void Epd::drawParagraph(EpdParagraph& paragraph, uint16_t color, uint16_t bgcolor){
+  fillRect(paragraph.x(), paragraph.y(), paragraph.width(), paragraph.height(), bgcolor);
+  drawParagraph(paragraph, color);
+}
+
+void Epd::drawParagraph(EpdParagraph& paragraph, uint16_t color){
+  uint16_t lines = paragraph.layout(textsize_x, textsize_y);
+  int16_t top = paragraph.y();
+  switch (paragraph.align() & EPD_ALIGN_VERTICAL) {
+    case EPD_ALIGN_MIDDLE: top += ((int16_t)paragraph.height() - paragraph.textHeight()) / 2; break;
+    case EPD_ALIGN_BOTTOM: top += (int16_t)paragraph.height() - paragraph.textHeight(); break;
+  }
+  const GFXfont* font = gfxFont;
+  bool wrapped = wrap;
+  uint16_t textColor = textcolor;
+  uint16_t bgcolor = textbgcolor;
+  gfxFont = (GFXfont*)paragraph.font();
+  wrap = false;
+  textcolor = textbgcolor = color;
+  for (uint16_t i = 0; i < lines; i++) {
+    const epd_paragraph_line_t& line = paragraph.lines()[i];
+    int16_t x = paragraph.x();
+    switch (paragraph.align() & EPD_ALIGN_HORIZONTAL) {
+      case EPD_ALIGN_CENTER: x += ((int16_t)paragraph.width() - line.width) / 2; break;
+      case EPD_ALIGN_RIGHT: x += (int16_t)paragraph.width() - line.width; break;
+    }
+    cursor_x = x;
+    cursor_y = top + paragraph.ascent() + i * paragraph.lineHeight();
+    _writeRun(paragraph.chars() + line.start, line.len);
+    if (line.ellipsis) _writeRun((const uint8_t*)"...", 3);
+  }
+  gfxFont = (GFXfont*)font;
+  wrap = wrapped;
+  textcolor = textColor;
+  textbgcolor = bgcolor;
 }
 
 /**
  * @brief Similar to printf
- * Note that buffer needs to end with null character
+ * Formatted in chunks straight to print(): no length limit and no heap
  * @param format 
  * @param ... va_list
  */
 void Epd::printerf(const char *format, ...) {
     va_list args;
     va_start(args, format);
-    char max_buffer[1024];
-    int size = vsnprintf(max_buffer, sizeof max_buffer, format, args);
+    epd_vformat(_printOut, this, format, args);
     va_end(args);
+}
 
-    if (size < sizeof(max_buffer)) {
-        print(std::string(max_buffer));
-    } else {
-      ESP_LOGE("Epd::printerf", "max_buffer out of range. Increase max_buffer!");
-    }
+void Epd::getTextBoundsf(int16_t x, int16_t y, int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h, const char* format, ...) {
+    uint8_t keep[EPD_TEXT_KEEP];
+    _measure_t m;
+    _measureBegin(m, keep, sizeof(keep), x, y);
+    va_list args;
+    va_start(args, format);
+    _vmeasure(m, x1, y1, w, h, format, args);
+    va_end(args);
 }
 
 void Epd::newline() {
@@ -116,27 +526,22 @@ void Epd::newline() {
 }
 
 void Epd::draw_centered_text(const GFXfont *font, int16_t x, int16_t y, uint16_t w, uint16_t h, const char* format, ...) {
-    // Handle printf arguments
+    setFont(font);
+    // Measured while it is formatted. Text that fits in keep is printed from there, longer text is formatted again
+    uint8_t keep[EPD_TEXT_KEEP];
+    _measure_t m;
+    _measureBegin(m, keep, sizeof(keep), x, y);
     va_list args;
     va_start(args, format);
-    char max_buffer[1024];
-    int size = vsnprintf(max_buffer, sizeof max_buffer, format, args);
-    va_end(args);
-    string text = "";
-    if (size < sizeof(max_buffer)) {
-      text = std::string(max_buffer);
-      
-    } else {
-      ESP_LOGE("draw_centered_text", "max_buffer out of range. Increase max_buffer!");
-    }
-    // Draw external boundary where text needs to be centered in the middle
-    setFont(font);
+    va_list again;
+    va_copy(again, args);
     int16_t text_x = 0;
     int16_t text_y = 0;
     uint16_t text_w = 0;
     uint16_t text_h = 0;
+    _vmeasure(m, &text_x, &text_y, &text_w, &text_h, format, args);
+    va_end(args);
 
-    getTextBounds(text.c_str(), x, y, &text_x, &text_y, &text_w, &text_h);
     // Calculate the middle position
     
     int16_t ty = (h/2)+y+(text_h/2);
@@ -157,5 +562,10 @@ void Epd::draw_centered_text(const GFXfont *font, int16_t x, int16_t y, uint16_t
     }
 
     setCursor(text_x, ty);
-    print(text);
+    if (m.overflow) {
+      epd_vformat(_printOut, this, format, again);
+    } else {
+      _writeRun(keep, m.kept);
+    }
+    va_end(again);
 }
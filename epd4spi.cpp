@@ -3,20 +3,10 @@
 #include <string.h>
 #include "freertos/task.h"
 #include "esp_log.h"
+#include "esp_heap_caps.h"
+#include <esp_timer.h>
 
-#ifdef CONFIG_IDF_TARGET_ESP32
-    #define EPD_HOST    HSPI_HOST
-    #define DMA_CHAN    2
-#elif defined CONFIG_IDF_TARGET_ESP32S2
-    #define EPD_HOST    SPI2_HOST
-    #define DMA_CHAN    EPD_HOST
-#elif defined CONFIG_IDF_TARGET_ESP32S3
-    #define EPD_HOST    SPI2_HOST
-    #define DMA_CHAN    SPI_DMA_CH_AUTO
-#elif defined CONFIG_IDF_TARGET_ESP32C3
-    #define EPD_HOST    SPI3_HOST
-    #define DMA_CHAN    SPI_DMA_CH_AUTO
-#endif
+static const char* TAG = "Epd4Spi";
 
 /** DISPLAYS REF:
 __________
@@ -26,365 +16,428 @@ __________
 -----------
 */
 
+Epd4Spi::Epd4Spi(): _config(EPD4SPI_CONFIG_DEFAULT())
+{
+}
+
+Epd4Spi::Epd4Spi(const epd4spi_config_t& config): _config(config)
+{
+}
+
+Epd4Spi::~Epd4Spi()
+{
+    if (spi != nullptr) {
+        deselect();
+        spi_bus_remove_device(spi);
+        epd_spi_bus_release(_config.host);
+    }
+    if (_busy_events != nullptr) {
+        for (uint8_t p = 0; p < 4; p++) {
+            if (_config.busy[p] >= 0) gpio_isr_handler_remove((gpio_num_t)_config.busy[p]);
+        }
+        vEventGroupDelete(_busy_events);
+    }
+    for (int b = 0; b < EPD4SPI_CHUNK_BUFFERS; b++) {
+        if (_chunk[b] != nullptr) heap_caps_free(_chunk[b]);
+    }
+}
+
 void Epd4Spi::init(uint8_t frequency=4,bool debug=false){
     debug_enabled = debug;
+    if (spi != nullptr) {
+        deselect();
+        spi_bus_remove_device(spi);
+        epd_spi_bus_release(_config.host);
+        spi = nullptr;
+    }
     printf("PIN SETUP:\nSPI_M1_CS:%d <- all set as output GPIOs\nSPI_S1_CS:%d\nSPI_M2_CS:%d\nSPI_S2_CS:%d\n",
-    CONFIG_EINK_SPI_M1_CS,CONFIG_EINK_SPI_S1_CS,CONFIG_EINK_SPI_M2_CS,CONFIG_EINK_SPI_S2_CS);
+    _config.cs[0], _config.cs[1], _config.cs[2], _config.cs[3]);
     // Initialize GPIOs direction & initial states. Check that all are set
     // Setting 16 as output resets the ESP32 in TinyPICO (Don't use tinyPICO for this)
-    gpio_set_direction((gpio_num_t)CONFIG_EINK_SPI_M1_CS, GPIO_MODE_OUTPUT);
-    gpio_set_direction((gpio_num_t)CONFIG_EINK_SPI_S1_CS, GPIO_MODE_OUTPUT);
-    gpio_set_direction((gpio_num_t)CONFIG_EINK_SPI_M2_CS, GPIO_MODE_OUTPUT);
-    gpio_set_direction((gpio_num_t)CONFIG_EINK_SPI_S2_CS, GPIO_MODE_OUTPUT);
+    for (uint8_t p = 0; p < 4; p++) {
+        if (_config.cs[p] >= 0) gpio_set_direction((gpio_num_t)_config.cs[p], GPIO_MODE_OUTPUT);
+    }
 
     printf("\nSPI_M1_BUSY:%d <- all set as input,pullup GPIOs\nSPI_S1_BUSY:%d\nSPI_M2_BUSY:%d\nSPI_S2_BUSY:%d\n",
-    CONFIG_EINK_SPI_M1_BUSY,CONFIG_EINK_SPI_S1_BUSY,CONFIG_EINK_SPI_M2_BUSY,CONFIG_EINK_SPI_S2_BUSY);
-    gpio_set_pull_mode((gpio_num_t)CONFIG_EINK_SPI_M1_BUSY, GPIO_PULLUP_ONLY);
-    gpio_set_pull_mode((gpio_num_t)CONFIG_EINK_SPI_S1_BUSY, GPIO_PULLUP_ONLY);
-    gpio_set_pull_mode((gpio_num_t)CONFIG_EINK_SPI_M2_BUSY, GPIO_PULLUP_ONLY);
-    gpio_set_pull_mode((gpio_num_t)CONFIG_EINK_SPI_S2_BUSY, GPIO_PULLUP_ONLY);
-
-    gpio_set_direction((gpio_num_t)CONFIG_EINK_SPI_M1_BUSY, GPIO_MODE_INPUT);
-    gpio_set_direction((gpio_num_t)CONFIG_EINK_SPI_S1_BUSY, GPIO_MODE_INPUT);
-    gpio_set_direction((gpio_num_t)CONFIG_EINK_SPI_M2_BUSY, GPIO_MODE_INPUT);
-    gpio_set_direction((gpio_num_t)CONFIG_EINK_SPI_S2_BUSY, GPIO_MODE_INPUT);
+    _config.busy[0], _config.busy[1], _config.busy[2], _config.busy[3]);
+    for (uint8_t p = 0; p < 4; p++) {
+        if (_config.busy[p] < 0) continue;
+        gpio_set_pull_mode((gpio_num_t)_config.busy[p], GPIO_PULLUP_ONLY);
+        gpio_set_direction((gpio_num_t)_config.busy[p], GPIO_MODE_INPUT);
+    }
 
     printf("\nM1S1_DC:%d <- all set as output GPIOs\nM2S2_DC:%d\nM1S1_RST:%d\nM2S2_RST:%d\n",
-    CONFIG_EINK_M1S1_DC,CONFIG_EINK_M2S2_DC,CONFIG_EINK_M1S1_RST,CONFIG_EINK_M2S2_RST);
-    
-    gpio_set_direction((gpio_num_t)CONFIG_EINK_M1S1_DC, GPIO_MODE_OUTPUT);
-    gpio_set_direction((gpio_num_t)CONFIG_EINK_M2S2_DC, GPIO_MODE_OUTPUT);
-    gpio_set_direction((gpio_num_t)CONFIG_EINK_M1S1_RST, GPIO_MODE_OUTPUT);
-    gpio_set_direction((gpio_num_t)CONFIG_EINK_M2S2_RST, GPIO_MODE_OUTPUT);
+    _config.dc[0], _config.dc[1], _config.rst[0], _config.rst[1]);
+    for (uint8_t i = 0; i < 2; i++) {
+        if (_config.dc[i] >= 0) gpio_set_direction((gpio_num_t)_config.dc[i], GPIO_MODE_OUTPUT);
+        if (_config.rst[i] >= 0) gpio_set_direction((gpio_num_t)_config.rst[i], GPIO_MODE_OUTPUT);
+    }
 
     // Chip select starts HIGH since only on LOW transmits
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_S2_CS, 1);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_S1_CS, 1);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_M2_CS, 1);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_S2_CS, 1);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_CLK, 0);
+    _cs(EPD4SPI_ALL, 1);
+    gpio_set_level((gpio_num_t)_config.clk, 0);
     
     esp_err_t ret;
-    // MISO not used, only Master to Slave
-    spi_bus_config_t buscfg={
-        .mosi_io_num=CONFIG_EINK_SPI_MOSI,
-        .miso_io_num = -1,
-        .sclk_io_num=CONFIG_EINK_SPI_CLK,
-        .quadwp_io_num=-1,
-        .quadhd_io_num=-1,
-        .max_transfer_sz=4094
-    };
-    // max_transfer_sz   4Kb is the defaut SPI transfer size if 0
     // debug: 50000  0.5 Mhz so we can sniff the SPI commands with a Slave
-    uint16_t multiplier = 1000;
+    uint32_t clock_hz = (_config.clock_hz) ? _config.clock_hz : uint32_t(frequency)*1000000;
     if (debug_enabled) {
-        frequency = 50;
-        multiplier = 1;
+        clock_hz = 50000;
     }
     // Config Frequency and SS GPIO
     spi_device_interface_config_t devcfg={
         .mode=0,  //SPI mode 0
-        .clock_speed_hz=frequency*multiplier*1000,  // DEBUG: 50000 - No debug usually 4 Mhz
+        .clock_speed_hz=(int)clock_hz,  // DEBUG: 50000 - No debug usually 4 Mhz
         .input_delay_ns=0,
         .flags = (SPI_DEVICE_HALFDUPLEX | SPI_DEVICE_3WIRE),
         .queue_size=5
     };
     // Note: .spics_io_num=-1 is disabled since there are 4 Chip selects
 
-    ret=spi_bus_initialize(EPD_HOST, &buscfg, DMA_CHAN);
+    // Initialize the SPI bus, or share it. MISO not used, only Master to Slave
+    ret=epd_spi_bus_acquire(_config.host, _config.mosi, -1, _config.clk, EPD4SPI_MAX_TRANSFER);
     ESP_ERROR_CHECK(ret);
 
     // Attach the EPD to the SPI bus
-    ret=spi_bus_add_device(EPD_HOST, &devcfg, &spi);
+    ret=spi_bus_add_device(_config.host, &devcfg, &spi);
     ESP_ERROR_CHECK(ret);
-    
+
+    _busyInit();
+
     if (debug_enabled) {
       printf("EpdSpi::init() Debug enabled. SPI master at frequency:%d  MOSI:%d CLK:%d\n",
-      frequency*multiplier*1000, CONFIG_EINK_SPI_MOSI, CONFIG_EINK_SPI_CLK);
+      (int)clock_hz, _config.mosi, _config.clk);
         }
     }
 
-/* This ones will redirect it to M1 */
-void Epd4Spi::cmd(const uint8_t cmd) {
-    cmdM1(cmd);
-}
-void Epd4Spi::data(const uint8_t data) {
-    dataM1(data);
+void Epd4Spi::_cs(uint8_t panels, uint32_t level)
+{
+    for (uint8_t p = 0; p < 4; p++) {
+        if ((panels & (1 << p)) && _config.cs[p] >= 0) gpio_set_level((gpio_num_t)_config.cs[p], level);
+    }
 }
 
-/* M1 */
-void Epd4Spi::cmdM1(const uint8_t cmd)
+// The chip selects are GPIOs, so the SPI driver does not know when they are low. The bus is kept
+// for this device until _csHigh(): bytes to other devices on the host would reach the panels too
+void Epd4Spi::_csLow(uint8_t panels)
 {
-    if (debug_enabled) {
-        printf("M1C %x\n",cmd);
-    }
+    spi_device_acquire_bus(spi, portMAX_DELAY);
+    _cs(panels, 0);
+}
 
-    esp_err_t ret;
-    spi_transaction_t t;
-    memset(&t, 0, sizeof(t));       //Zero out the transaction
-    t.length=8;                     //Command is 8 bits
-    t.tx_buffer=&cmd;               //The data is the cmd itself 
-
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_M1_CS, 0);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_M1S1_DC, 0);
-    ret=spi_device_polling_transmit(spi, &t);
-
-    assert(ret==ESP_OK);            //Should have had no issues.
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_M1_CS, 1);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_M1S1_DC, 1); 
+void Epd4Spi::_csHigh(uint8_t panels)
+{
+    _cs(panels, 1);
+    spi_device_release_bus(spi);
 }
 
-void Epd4Spi::dataM1(uint8_t data)
+// M1 & S1 share one DC line, M2 & S2 the other
+void Epd4Spi::_dc(uint8_t panels, uint32_t level)
 {
-    if (debug_enabled) {
-      printf("D %x\n",data);
-    }
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_M1_CS, 0);
-    esp_err_t ret;
-    spi_transaction_t t;
-    memset(&t, 0, sizeof(t));       //Zero out the transaction
-    t.length=8;                     //Command is 8 bits
-    t.tx_buffer=&data;              //The data is the cmd itself
-    ret=spi_device_polling_transmit(spi, &t);
-    assert(ret==ESP_OK);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_M1_CS, 1);
+    if ((panels & (EPD4SPI_M1 | EPD4SPI_S1)) && _config.dc[0] >= 0) gpio_set_level((gpio_num_t)_config.dc[0], level);
+    if ((panels & (EPD4SPI_M2 | EPD4SPI_S2)) && _config.dc[1] >= 0) gpio_set_level((gpio_num_t)_config.dc[1], level);
 }
 
-/* S1 */
-void Epd4Spi::cmdS1(const uint8_t cmd)
+/* Send data to the SPI. Uses spi_device_polling_transmit, which waits until the
+ * transfer is complete.
+ *
+ * Since data transactions are usually small, they are handled in polling
+ * mode for higher speed. The overhead of interrupt transactions is more than
+ * just waiting for the transaction to complete.
+ */
+void Epd4Spi::_transmit(const uint8_t *data, uint32_t len)
 {
-    if (debug_enabled) {
-        printf("S1C %x\n",cmd);
+    // Polling transactions can't start while queued ones are pending
+    if (_chunk_inflight) _chunkDrain();
+    while (len > 0) {
+        uint32_t n = (len > EPD4SPI_MAX_TRANSFER) ? EPD4SPI_MAX_TRANSFER : len;
+        spi_transaction_t t;
+        memset(&t, 0, sizeof(t));       //Zero out the transaction
+        t.length=n*8;                   //Len is in bytes, transaction length is in bits.
+        if (n <= 4) {
+            t.flags=SPI_TRANS_USE_TXDATA;
+            memcpy(t.tx_data, data, n);
+        } else {
+            t.tx_buffer=data;
+        }
+        esp_err_t ret=spi_device_polling_transmit(spi, &t);
+        assert(ret==ESP_OK);            //Should have had no issues.
+        data += n;
+        len -= n;
     }
+}
 
-    esp_err_t ret;
-    spi_transaction_t t;
-    memset(&t, 0, sizeof(t));       //Zero out the transaction
-    t.length=8;                     //Command is 8 bits
-    t.tx_buffer=&cmd;               //The data is the cmd itself 
-
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_S1_CS, 0);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_M1S1_DC, 0);
-    ret=spi_device_polling_transmit(spi, &t);
-
-    assert(ret==ESP_OK);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_S1_CS, 1);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_M1S1_DC, 1);
+void Epd4Spi::cmd(uint8_t panels, uint8_t cmd)
+{
+    cmdData(panels, cmd, nullptr, 0);
 }
 
-void Epd4Spi::dataS1(uint8_t data)
+void Epd4Spi::cmdData(uint8_t panels, uint8_t cmd, const uint8_t *data, uint32_t len)
 {
     if (debug_enabled) {
-      printf("D %x\n",data);
+        printf("C %x to panels %x D len:%d\n", cmd, panels, (int)len);
     }
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_S1_CS, 0);
-    esp_err_t ret;
-    spi_transaction_t t;
-    memset(&t, 0, sizeof(t));       //Zero out the transaction
-    t.length=8;                     //Command is 8 bits
-    t.tx_buffer=&data;              //The data is the cmd itself
-    ret=spi_device_polling_transmit(spi, &t);
-    assert(ret==ESP_OK);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_S1_CS, 1);
+    _csLow(panels);
+    _dc(panels, 0);
+    _transmit(&cmd, 1);
+    _dc(panels, 1);
+    _transmit(data, len);
+    _csHigh(panels);
 }
 
-/* M2 */
-void Epd4Spi::cmdM2(const uint8_t cmd)
+void Epd4Spi::data(uint8_t panels, const uint8_t *data, uint32_t len)
 {
-    if (debug_enabled) {
-        printf("M2C %x\n",cmd);
+    if (len==0) return;
+    _csLow(panels);
+    _transmit(data, len);
+    _csHigh(panels);
+}
+
+void Epd4Spi::fill(uint8_t panels, uint8_t value, uint32_t count)
+{
+    uint8_t chunk[64];
+    memset(chunk, value, sizeof(chunk));
+    _csLow(panels);
+    while (count > 0) {
+        uint32_t n = (count > sizeof(chunk)) ? sizeof(chunk) : count;
+        _transmit(chunk, n);
+        count -= n;
     }
+    _csHigh(panels);
+}
 
-    esp_err_t ret;
-    spi_transaction_t t;
-    memset(&t, 0, sizeof(t));       //Zero out the transaction
-    t.length=8;                     //Command is 8 bits
-    t.tx_buffer=&cmd;               //The data is the cmd itself 
+void Epd4Spi::select(uint8_t panels)
+{
+    deselect();
+    _selected = panels;
+    _csLow(panels);
+}
 
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_M2_CS, 0);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_M2S2_DC, 0);
-    ret=spi_device_polling_transmit(spi, &t);
+void Epd4Spi::dataSelected(const uint8_t *data, uint32_t len)
+{
+    _transmit(data, len);
+}
 
-    assert(ret==ESP_OK);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_M2_CS, 1);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_M2S2_DC, 1);
+void Epd4Spi::deselect()
+{
+    _chunkDrain();
+    if (_selected == 0) return;
+    _csHigh(_selected);
+    _selected = 0;
 }
 
-void Epd4Spi::dataM2(uint8_t data)
+void Epd4Spi::dataRows(const uint8_t *rows, uint16_t y, uint16_t count, bool invert)
 {
-    if (debug_enabled) {
-      printf("D %x\n",data);
+    static const uint8_t left[] = {EPD4SPI_S2, EPD4SPI_M1};
+    static const uint8_t right[] = {EPD4SPI_M2, EPD4SPI_S1};
+    // Rows are gathered in DMA capable DRAM: the buffer may be in PSRAM and a few rows per transaction is faster.
+    // Without that memory every row goes from the stack, waiting for each transfer
+    uint8_t row[EPD4SPI_ROW_BYTES - EPD4SPI_LEFT_BYTES];
+    bool queued = _chunkInit();
+    uint32_t size = queued ? EPD4SPI_CHUNK_BYTES : sizeof(row);
+    uint32_t end = uint32_t(y) + count;
+    for (uint8_t half = 0; half < 2; half++) {
+        uint32_t first = half ? EPD4SPI_HALF_ROWS : 0;
+        uint32_t last = first + EPD4SPI_HALF_ROWS;
+        if (first < y) first = y;
+        if (last > end) last = end;
+        for (uint8_t side = 0; side < 2 && first < last; side++) {
+            uint16_t offset = side ? EPD4SPI_LEFT_BYTES : 0;
+            uint16_t len = side ? EPD4SPI_ROW_BYTES - EPD4SPI_LEFT_BYTES : EPD4SPI_LEFT_BYTES;
+            select(side ? right[half] : left[half]);
+            uint8_t* chunk = row;
+            uint32_t used = 0;
+            for (uint32_t r = first; r < last; r++) {
+                // Waits only when all the buffers are on the wire
+                if (used == 0 && queued) chunk = _chunkBuffer();
+                const uint8_t* src = rows + (r - y) * EPD4SPI_ROW_BYTES + offset;
+                if (invert) {
+                    for (uint16_t b = 0; b < len; b++) chunk[used + b] = ~src[b];
+                } else {
+                    memcpy(chunk + used, src, len);
+                }
+                used += len;
+                if (used + len > size || r + 1 == last) {
+                    if (queued) {
+                        _chunkQueue(used);
+                    } else {
+                        _transmit(chunk, used);
+                    }
+                    used = 0;
+                }
+            }
+            // The chip select goes up once the last chunk is sent
+            deselect();
+        }
     }
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_M2_CS, 0);
-    esp_err_t ret;
-    spi_transaction_t t;
-    memset(&t, 0, sizeof(t));       //Zero out the transaction
-    t.length=8;                     //Command is 8 bits
-    t.tx_buffer=&data;
-    ret=spi_device_polling_transmit(spi, &t);
-    assert(ret==ESP_OK);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_M2_CS, 1);
 }
 
-/* S2 */
-void Epd4Spi::cmdS2(const uint8_t cmd)
+bool Epd4Spi::_chunkInit()
 {
-    if (debug_enabled) {
-        printf("S2C %x\n",cmd);
+    if (_chunk[EPD4SPI_CHUNK_BUFFERS - 1] != nullptr) return true;
+    for (int b = 0; b < EPD4SPI_CHUNK_BUFFERS; b++) {
+        if (_chunk[b] == nullptr) _chunk[b] = (uint8_t*)heap_caps_malloc(EPD4SPI_CHUNK_BYTES, MALLOC_CAP_DMA);
+        if (_chunk[b] == nullptr) {
+            ESP_LOGW(TAG, "Not enough DMA memory for %d bytes chunks: rows are sent one by one", EPD4SPI_CHUNK_BYTES);
+            return false;
+        }
     }
+    return true;
+}
 
-    esp_err_t ret;
-    spi_transaction_t t;
-    memset(&t, 0, sizeof(t));       //Zero out the transaction
-    t.length=8;                     //Command is 8 bits
-    t.tx_buffer=&cmd;               //The data is the cmd itself 
-
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_S2_CS, 0);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_M2S2_DC, 0);
-    ret=spi_device_polling_transmit(spi, &t);
+// Next free chunk. If all of them are on the wire it blocks until the oldest transaction is done
+uint8_t* Epd4Spi::_chunkBuffer()
+{
+    if (_chunk_inflight == EPD4SPI_CHUNK_BUFFERS) {
+        spi_transaction_t *r;
+        esp_err_t ret = spi_device_get_trans_result(spi, &r, portMAX_DELAY);
+        assert(ret==ESP_OK);
+        _chunk_inflight--;
+    }
+    return _chunk[_chunk_head];
+}
 
+void Epd4Spi::_chunkQueue(uint32_t len)
+{
+    spi_transaction_t *t = &_chunk_trans[_chunk_head];
+    memset(t, 0, sizeof(*t));
+    t->length = len*8;
+    t->tx_buffer = _chunk[_chunk_head];
+    esp_err_t ret = spi_device_queue_trans(spi, t, portMAX_DELAY);
     assert(ret==ESP_OK);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_S2_CS, 1);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_M2S2_DC, 1);
+    _chunk_head = (_chunk_head + 1) % EPD4SPI_CHUNK_BUFFERS;
+    _chunk_inflight++;
 }
 
-void Epd4Spi::dataS2(uint8_t data)
+void Epd4Spi::_chunkDrain()
 {
-    if (debug_enabled) {
-      printf("D %x\n",data);
+    while (_chunk_inflight > 0) {
+        spi_transaction_t *r;
+        esp_err_t ret = spi_device_get_trans_result(spi, &r, portMAX_DELAY);
+        assert(ret==ESP_OK);
+        _chunk_inflight--;
     }
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_S2_CS, 0);
-    esp_err_t ret;
-    spi_transaction_t t;
-    memset(&t, 0, sizeof(t));       //Zero out the transaction
-    t.length=8;                     //Command is 8 bits
-    t.tx_buffer=&data;
-    ret=spi_device_polling_transmit(spi, &t);
-    assert(ret==ESP_OK);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_S2_CS, 1);
 }
 
-// Send a command to all 4 displays
-void Epd4Spi::cmdM1S1M2S2(uint8_t cmd) {
-    if (debug_enabled) {
-        printf("All4 C %x\n",cmd);
+// BUSY edges wake up the task blocked in waitBusy()
+void Epd4Spi::_busyInit()
+{
+    if (_busy_events != nullptr) return;
+    // The ISR service is shared: ESP_ERR_INVALID_STATE means it was already installed
+    esp_err_t ret = gpio_install_isr_service(0);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "gpio_install_isr_service failed: %d. waitBusy will poll", ret);
+        return;
+    }
+    _busy_events = xEventGroupCreate();
+    for (uint8_t p = 0; p < 4; p++) {
+        if (_config.busy[p] < 0) continue;
+        _busy_isr[p].io = this;
+        _busy_isr[p].bit = 1 << p;
+        gpio_set_intr_type((gpio_num_t)_config.busy[p], GPIO_INTR_DISABLE);
+        ESP_ERROR_CHECK(gpio_isr_handler_add((gpio_num_t)_config.busy[p], Epd4Spi::_busyIsr, &_busy_isr[p]));
     }
-
-    esp_err_t ret;
-    spi_transaction_t t;
-    memset(&t, 0, sizeof(t));       //Zero out the transaction
-    t.length=8;                     //Command is 8 bits
-    t.tx_buffer=&cmd;               //The data is the cmd itself 
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_M1_CS, 0);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_S1_CS, 0);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_M2_CS, 0);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_S2_CS, 0);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_M2S2_DC, 0);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_M1S1_DC, 0);
-    ret=spi_device_polling_transmit(spi, &t);
-
-    assert(ret==ESP_OK);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_M1_CS, 1);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_S1_CS, 1);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_M2_CS, 1);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_S2_CS, 1);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_M2S2_DC, 1);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_M1S1_DC, 1);
 }
 
-// Send data to the 4 displays
-void Epd4Spi::dataM1S1M2S2(uint8_t data)
+void IRAM_ATTR Epd4Spi::_busyIsr(void *arg)
 {
-    /* if (debug_enabled) {
-      printf("D %x\n",data);
-    } */
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_M1_CS, 0);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_S1_CS, 0);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_M2_CS, 0);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_S2_CS, 0);
-    esp_err_t ret;
-    spi_transaction_t t;
-    memset(&t, 0, sizeof(t));       //Zero out the transaction
-    t.length=8;                     //Command is 8 bits
-    t.tx_buffer=&data;
-    ret=spi_device_polling_transmit(spi, &t);
-    assert(ret==ESP_OK);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_M1_CS, 1);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_S1_CS, 1);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_M2_CS, 1);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_S2_CS, 1);
+    _busy_isr_t* busy = (_busy_isr_t*) arg;
+    BaseType_t woken = pdFALSE;
+    xEventGroupSetBitsFromISR(busy->io->_busy_events, busy->bit, &woken);
+    if (woken == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
 }
 
-void Epd4Spi::data(const uint8_t *data, int len)
+// Panels that are still busy (BUSY LOW). Panels without BUSY line are always ready
+uint8_t Epd4Spi::_busyPending(uint8_t panels)
 {
-    dataM1(data, len);
+    uint8_t pending = 0;
+    for (uint8_t p = 0; p < 4; p++) {
+        if ((panels & (1 << p)) && _config.busy[p] >= 0 && gpio_get_level((gpio_num_t)_config.busy[p]) == 0) pending |= 1 << p;
+    }
+    return pending;
 }
 
-/* Send data to the SPI. Uses spi_device_polling_transmit, which waits until the
- * transfer is complete.
- *
- * Since data transactions are usually small, they are handled in polling
- * mode for higher speed. The overhead of interrupt transactions is more than
- * just waiting for the transaction to complete.
+/**
+ * @brief Wait until the BUSY GPIOs of all panels are HIGH
+ *        The panels refresh at the same time, so the wait takes as long as the slowest one
+ *        instead of adding them up.
  */
-void Epd4Spi::dataM1(const uint8_t *data, int len)
+bool Epd4Spi::waitBusy(uint8_t panels, uint32_t timeout_ms, const char* message)
 {
-    if (len==0) return;
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_M1_CS, 0);
-    esp_err_t ret;
-    spi_transaction_t t;
-    memset(&t, 0, sizeof(t));       //Zero out the transaction
-    t.length=len*8;                 //Len is in bytes, transaction length is in bits.
-    t.tx_buffer=data;               //Data
-    ret=spi_device_polling_transmit(spi, &t);  //Transmit!
-    assert(ret==ESP_OK);            //Should have had no issues.
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_M1_CS, 1);
+    uint8_t pending = _busyPending(panels);
+    if (pending == 0) return true;
+
+    int64_t time_since_boot = esp_timer_get_time();
+    if (_busy_events != nullptr) {
+        xEventGroupClearBits(_busy_events, EPD4SPI_ALL); // Discard edges from a previous wait
+        for (uint8_t p = 0; p < 4; p++) {
+            if (!(pending & (1 << p))) continue;
+            gpio_set_intr_type((gpio_num_t)_config.busy[p], GPIO_INTR_POSEDGE);
+            gpio_intr_enable((gpio_num_t)_config.busy[p]);
+        }
+        // Lines might have been released before their interrupt was armed
+        pending = _busyPending(pending);
+        if (pending) {
+            xEventGroupWaitBits(_busy_events, pending, pdTRUE, pdTRUE, pdMS_TO_TICKS(timeout_ms));
+        }
+        for (uint8_t p = 0; p < 4; p++) {
+            if (!(panels & (1 << p)) || _config.busy[p] < 0) continue;
+            gpio_intr_disable((gpio_num_t)_config.busy[p]);
+            gpio_set_intr_type((gpio_num_t)_config.busy[p], GPIO_INTR_DISABLE);
+        }
+        pending = _busyPending(panels);
+    } else {
+        while ((pending = _busyPending(panels)) != 0) {
+            vTaskDelay(1);
+            if (esp_timer_get_time()-time_since_boot > (int64_t)timeout_ms*1000) break;
+        }
+    }
+
+    if (debug_enabled) {
+        ESP_LOGI(TAG, "waitBusy for %s %s after %lld ms", message, (pending) ? "timeout" : "released",
+                 (esp_timer_get_time()-time_since_boot)/1000);
+    }
+    return pending == 0;
 }
-void Epd4Spi::dataM2(const uint8_t *data, int len)
-{
-    if (len==0) return;
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_M2_CS, 0);
-    esp_err_t ret;
-    spi_transaction_t t;
-    memset(&t, 0, sizeof(t));
-    t.length=len*8;
-    t.tx_buffer=data;
-    ret=spi_device_polling_transmit(spi, &t);
-    assert(ret==ESP_OK);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_M2_CS, 1);
+
+/* This ones will redirect it to M1 */
+void Epd4Spi::cmd(const uint8_t cmd) {
+    cmdM1(cmd);
 }
-void Epd4Spi::dataS1(const uint8_t *data, int len)
-{
-    if (len==0) return;
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_S1_CS, 0);
-    esp_err_t ret;
-    spi_transaction_t t;
-    memset(&t, 0, sizeof(t));
-    t.length=len*8;
-    t.tx_buffer=data;
-    ret=spi_device_polling_transmit(spi, &t);
-    assert(ret==ESP_OK);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_S1_CS, 1);
+void Epd4Spi::data(const uint8_t data) {
+    dataM1(data);
 }
-void Epd4Spi::dataS2(const uint8_t *data, int len)
+void Epd4Spi::data(const uint8_t *data, int len)
 {
-    if (len==0) return;
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_S2_CS, 0);
-    esp_err_t ret;
-    spi_transaction_t t;
-    memset(&t, 0, sizeof(t));
-    t.length=len*8;
-    t.tx_buffer=data;
-    ret=spi_device_polling_transmit(spi, &t);
-    assert(ret==ESP_OK);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_S2_CS, 1);
+    dataM1(data, len);
 }
 
+/* One panel or the 4 of them */
+void Epd4Spi::cmdM1(const uint8_t cmd) { this->cmd(EPD4SPI_M1, cmd); }
+void Epd4Spi::cmdS1(const uint8_t cmd) { this->cmd(EPD4SPI_S1, cmd); }
+void Epd4Spi::cmdM2(const uint8_t cmd) { this->cmd(EPD4SPI_M2, cmd); }
+void Epd4Spi::cmdS2(const uint8_t cmd) { this->cmd(EPD4SPI_S2, cmd); }
+void Epd4Spi::cmdM1S1M2S2(uint8_t cmd) { this->cmd(EPD4SPI_ALL, cmd); }
+
+void Epd4Spi::dataM1(uint8_t data) { this->data(EPD4SPI_M1, &data, 1); }
+void Epd4Spi::dataS1(uint8_t data) { this->data(EPD4SPI_S1, &data, 1); }
+void Epd4Spi::dataM2(uint8_t data) { this->data(EPD4SPI_M2, &data, 1); }
+void Epd4Spi::dataS2(uint8_t data) { this->data(EPD4SPI_S2, &data, 1); }
+void Epd4Spi::dataM1S1M2S2(uint8_t data) { this->data(EPD4SPI_ALL, &data, 1); }
+
+void Epd4Spi::dataM1(const uint8_t *data, int len) { this->data(EPD4SPI_M1, data, len); }
+void Epd4Spi::dataS1(const uint8_t *data, int len) { this->data(EPD4SPI_S1, data, len); }
+void Epd4Spi::dataM2(const uint8_t *data, int len) { this->data(EPD4SPI_M2, data, len); }
+void Epd4Spi::dataS2(const uint8_t *data, int len) { this->data(EPD4SPI_S2, data, len); }
+
 void Epd4Spi::reset(uint8_t millis=20) {
-    gpio_set_level((gpio_num_t)CONFIG_EINK_M1S1_RST, 0);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_M2S2_RST, 0);
+    for (uint8_t i = 0; i < 2; i++) {
+        if (_config.rst[i] >= 0) gpio_set_level((gpio_num_t)_config.rst[i], 0);
+    }
     vTaskDelay(millis / portTICK_PERIOD_MS);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_M1S1_RST, 1);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_M2S2_RST, 1);
+    for (uint8_t i = 0; i < 2; i++) {
+        if (_config.rst[i] >= 0) gpio_set_level((gpio_num_t)_config.rst[i], 1);
+    }
     vTaskDelay(millis / portTICK_PERIOD_MS);
 }
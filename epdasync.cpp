@@ -0,0 +1,122 @@
+#include "epdasync.h"
+#include "esp_log.h"
+
+static const char* TAG = "EpdAsync";
+
+#define EPD_ASYNC_START (1 << 0)
+#define EPD_ASYNC_IDLE  (1 << 1)
+#define EPD_ASYNC_SENT  (1 << 2)
+// The callback returned: the task is waiting for the next start
+#define EPD_ASYNC_CB    (1 << 3)
+
+EpdAsync::~EpdAsync()
+{
+  _asyncStop();
+  if (_async_events != nullptr) {
+    vEventGroupDelete(_async_events);
+  }
+}
+
+void EpdAsync::_asyncStop()
+{
+  if (_async_task == nullptr) return;
+  // The callback runs once IDLE is set and may start another update
+  do {
+    waitForUpdate();
+    xEventGroupWaitBits(_async_events, EPD_ASYNC_CB, pdFALSE, pdTRUE, portMAX_DELAY);
+  } while (isUpdating());
+  vTaskDelete(_async_task);
+  _async_task = nullptr;
+}
+
+bool EpdAsync::_asyncInit()
+{
+  if (_async_task != nullptr) return true;
+
+  if (_async_events == nullptr) {
+    _async_events = xEventGroupCreate();
+    if (_async_events == nullptr) return false;
+    xEventGroupSetBits(_async_events, EPD_ASYNC_IDLE | EPD_ASYNC_SENT | EPD_ASYNC_CB);
+  }
+  if (xTaskCreate(_asyncTask, "epd_update", EPD_ASYNC_TASK_STACK, this, EPD_ASYNC_TASK_PRIORITY, &_async_task) != pdPASS) {
+    _async_task = nullptr;
+    ESP_LOGE(TAG, "Could not create the update task");
+    return false;
+  }
+  return true;
+}
+
+void EpdAsync::_asyncTask(void* arg)
+{
+  EpdAsync* epd = static_cast<EpdAsync*>(arg);
+  for (;;) {
+    xEventGroupWaitBits(epd->_async_events, EPD_ASYNC_START, pdTRUE, pdTRUE, portMAX_DELAY);
+    epd->_updateAsyncWork();
+
+    epd_update_cb_t cb = epd->_async_cb;
+    void* cb_arg = epd->_async_cb_arg;
+    epd->_async_cb = nullptr;
+    xEventGroupSetBits(epd->_async_events, EPD_ASYNC_IDLE);
+    if (cb != nullptr) {
+      cb(cb_arg);
+    }
+    // Unless the callback started the next update
+    if (xEventGroupGetBits(epd->_async_events) & EPD_ASYNC_IDLE) {
+      xEventGroupSetBits(epd->_async_events, EPD_ASYNC_CB);
+    }
+  }
+}
+
+void EpdAsync::_updateAsyncWork()
+{
+  if (_async_transfer) {
+    _updateBegin();
+    xEventGroupSetBits(_async_events, EPD_ASYNC_SENT);
+  }
+  _updateFinish();
+}
+
+bool EpdAsync::updateAsync(epd_update_cb_t cb, void* arg)
+{
+  waitForUpdate();
+  if (!_asyncInit()) {
+    _updateSwap();
+    _updateBegin();
+    _updateFinish();
+    if (cb != nullptr) cb(arg);
+    return false;
+  }
+
+  xEventGroupClearBits(_async_events, EPD_ASYNC_IDLE | EPD_ASYNC_SENT | EPD_ASYNC_CB);
+  _async_cb = cb;
+  _async_cb_arg = arg;
+  _async_transfer = _updateSwap();
+  if (!_async_transfer) {
+    _updateBegin();
+    xEventGroupSetBits(_async_events, EPD_ASYNC_SENT);
+  }
+  xEventGroupSetBits(_async_events, EPD_ASYNC_START);
+  return true;
+}
+
+bool EpdAsync::waitForUpdate(uint32_t timeout_ms)
+{
+  if (_async_events == nullptr) return true;
+  TickType_t ticks = (timeout_ms == portMAX_DELAY) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+  EventBits_t bits = xEventGroupWaitBits(_async_events, EPD_ASYNC_IDLE, pdFALSE, pdTRUE, ticks);
+  return (bits & EPD_ASYNC_IDLE) != 0;
+}
+
+bool EpdAsync::waitForTransfer(uint32_t timeout_ms)
+{
+  if (_async_events == nullptr) return true;
+  TickType_t ticks = (timeout_ms == portMAX_DELAY) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+  EventBits_t bits = xEventGroupWaitBits(_async_events, EPD_ASYNC_SENT, pdFALSE, pdTRUE, ticks);
+  return (bits & EPD_ASYNC_SENT) != 0;
+}
+
+bool EpdAsync::isUpdating()
+{
+  if (_async_events == nullptr) return false;
+  return (xEventGroupGetBits(_async_events) & EPD_ASYNC_IDLE) == 0;
+}
@@ -0,0 +1,212 @@
+#include "epdbench.h"
+#include <stdio.h>
+#include <inttypes.h>
+#include <string.h>
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include <Fonts/FreeSans9pt7b.h>
+#include <Fonts/FreeMonoBold12pt7b.h>
+
+static const char* BENCH_TEXT = "The quick brown fox jumps over the lazy dog 0123456789";
+
+static void _printResult(const epd_bench_result_t* r, void* arg)
+{
+  (void)arg;
+  double ops_s = (r->time_us > 0) ? (double)r->ops * 1000000 / r->time_us : 0;
+  printf("%-14s %-24s %8" PRIu32 " ops %10.2f ms %12.0f ops/s %7" PRIu32 " trans %9" PRIu32 " bytes %8" PRIu32 " heap\n",
+         r->model, r->test, r->ops, r->time_us / 1000.0, ops_s, r->transactions, r->bytes, r->heap_peak);
+}
+
+EpdBench::EpdBench(const char* model, uint16_t white, uint16_t black):
+  _model(model), _white(white), _black(black)
+{
+  setReport(_printResult, nullptr);
+}
+
+void EpdBench::setIoStats(epd_bench_io_cb_t cb, void* arg)
+{
+  _io_stats = cb;
+  _io_arg = arg;
+}
+
+void EpdBench::spiStats(epd_spi_stats_t* stats, void* io)
+{
+  *stats = ((EpdSpi*)io)->getStats();
+}
+
+void EpdBench::setReport(epd_bench_report_cb_t cb, void* arg)
+{
+  _report = cb;
+  _report_arg = arg;
+}
+
+void EpdBench::_run(Adafruit_GFX& gfx, void* display, uint8_t tests, _update_cb_t update, _print_cb_t print)
+{
+  // Same pseudo random primitives on every run and model
+  _seed = 1;
+  if (tests & EPD_BENCH_FILL)       _fill(gfx);
+  if (tests & EPD_BENCH_PIXEL)      _pixel(gfx);
+  if (tests & EPD_BENCH_PRIMITIVES) _primitives(gfx);
+  if (tests & EPD_BENCH_TEXT)       _text(gfx, display, print);
+  if (tests & EPD_BENCH_UPDATE)     _update(gfx, display, update);
+  gfx.setRotation(0);
+  gfx.setFont(nullptr);
+}
+
+void EpdBench::_begin(const char* test)
+{
+  memset(&_result, 0, sizeof(_result));
+  _result.model = _model;
+  _result.test = test;
+  memset(&_io_start, 0, sizeof(_io_start));
+  if (_io_stats != nullptr) _io_stats(&_io_start, _io_arg);
+  _sampleHeap();
+  _result.time_us = esp_timer_get_time();
+}
+
+void EpdBench::_end(uint32_t ops)
+{
+  _result.time_us = esp_timer_get_time() - _result.time_us;
+  _result.ops = ops;
+  _sampleHeap();
+  if (_io_stats != nullptr) {
+    epd_spi_stats_t io;
+    _io_stats(&io, _io_arg);
+    _result.transactions = io.transactions - _io_start.transactions;
+    _result.bytes = io.bytes - _io_start.bytes;
+  }
+  if (_report != nullptr) _report(&_result, _report_arg);
+}
+
+// Sampled when a test starts and ends: memory that update() allocates and frees is not seen
+void EpdBench::_sampleHeap()
+{
+  multi_heap_info_t info;
+  heap_caps_get_info(&info, MALLOC_CAP_8BIT);
+  if (info.total_allocated_bytes > _result.heap_peak) {
+    _result.heap_peak = info.total_allocated_bytes;
+  }
+}
+
+uint16_t EpdBench::_random(uint16_t max)
+{
+  _seed = _seed * 1103515245 + 12345;
+  return (_seed >> 16) % max;
+}
+
+void EpdBench::_fill(Adafruit_GFX& gfx)
+{
+  _begin("fillScreen");
+  for (int i = 0; i < EPD_BENCH_LOOPS; i++) {
+    gfx.fillScreen((i & 1) ? _black : _white);
+  }
+  _end(EPD_BENCH_LOOPS);
+  gfx.fillScreen(_white);
+}
+
+void EpdBench::_pixel(Adafruit_GFX& gfx)
+{
+  static const char* names[] = {"drawPixel rot0", "drawPixel rot1", "drawPixel rot2", "drawPixel rot3"};
+  for (uint8_t r = 0; r < 4; r++) {
+    gfx.setRotation(r);
+    int16_t w = gfx.width();
+    int16_t h = gfx.height();
+    _begin(names[r]);
+    for (int16_t y = 0; y < h; y++) {
+      for (int16_t x = 0; x < w; x++) {
+        gfx.drawPixel(x, y, ((x ^ y) & 1) ? _black : _white);
+      }
+    }
+    _end((uint32_t)w * h);
+  }
+  gfx.setRotation(0);
+  gfx.fillScreen(_white);
+}
+
+void EpdBench::_primitives(Adafruit_GFX& gfx)
+{
+  const uint32_t count = 64 * EPD_BENCH_LOOPS;
+  int16_t w = gfx.width();
+  int16_t h = gfx.height();
+  int16_t r_max = ((w < h) ? w : h) / 4;
+
+  _begin("drawLine");
+  for (uint32_t i = 0; i < count; i++) {
+    gfx.drawLine(_random(w), _random(h), _random(w), _random(h), _black);
+  }
+  _end(count);
+
+  _begin("drawRect");
+  for (uint32_t i = 0; i < count; i++) {
+    gfx.drawRect(_random(w / 2), _random(h / 2), _random(w / 2) + 1, _random(h / 2) + 1, _black);
+  }
+  _end(count);
+
+  _begin("fillRect");
+  for (uint32_t i = 0; i < count; i++) {
+    gfx.fillRect(_random(w / 2), _random(h / 2), _random(w / 4) + 1, _random(h / 4) + 1, (i & 1) ? _black : _white);
+  }
+  _end(count);
+
+  _begin("drawCircle");
+  for (uint32_t i = 0; i < count; i++) {
+    gfx.drawCircle(_random(w), _random(h), _random(r_max) + 1, _black);
+  }
+  _end(count);
+
+  _begin("fillCircle");
+  for (uint32_t i = 0; i < count; i++) {
+    gfx.fillCircle(_random(w), _random(h), _random(r_max) + 1, (i & 1) ? _black : _white);
+  }
+  _end(count);
+  gfx.fillScreen(_white);
+}
+
+void EpdBench::_text(Adafruit_GFX& gfx, void* display, _print_cb_t print)
+{
+  static const struct {
+    const char* test;
+    const GFXfont* font;
+  } fonts[] = {
+    {"text default", nullptr},
+    {"text FreeSans9pt7b", &FreeSans9pt7b},
+    {"text FreeMonoBold12pt7b", &FreeMonoBold12pt7b}
+  };
+  const uint32_t len = strlen(BENCH_TEXT);
+  gfx.setTextColor(_black);
+  for (auto& f : fonts) {
+    gfx.setFont(f.font);
+    uint32_t chars = 0;
+    _begin(f.test);
+    for (int i = 0; i < EPD_BENCH_LOOPS; i++) {
+      gfx.setCursor(0, (f.font != nullptr) ? f.font->yAdvance : 0);
+      // One screen of text per loop
+      while (gfx.getCursorY() < gfx.height()) {
+        print(display, BENCH_TEXT);
+        print(display, "\n");
+        chars += len + 1;
+      }
+    }
+    _end(chars);
+    gfx.fillScreen(_white);
+  }
+  gfx.setFont(nullptr);
+}
+
+void EpdBench::_update(Adafruit_GFX& gfx, void* display, _update_cb_t update)
+{
+  gfx.drawRect(0, 0, gfx.width(), gfx.height(), _black);
+  gfx.fillCircle(gfx.width() / 2, gfx.height() / 2, gfx.height() / 4, _black);
+
+  _begin("update");
+  update(display);
+  _end(1);
+
+  if (_update_window == nullptr) return;
+  int16_t w = gfx.width() / 2;
+  int16_t h = gfx.height() / 2;
+  gfx.fillRect(w / 2, h / 2, w, h, _white);
+  _begin("updateWindow");
+  _update_window(display, w / 2, h / 2, w, h);
+  _end(1);
+}
@@ -0,0 +1,111 @@
+#include "epddirty.h"
+
+static inline uint16_t _min16(uint16_t a, uint16_t b) { return a < b ? a : b; }
+static inline uint16_t _max16(uint16_t a, uint16_t b) { return a > b ? a : b; }
+
+static inline uint32_t _area(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1) {
+  return (uint32_t)(x1 - x0 + 1) * (uint32_t)(y1 - y0 + 1);
+}
+
+void EpdDirtyRects::begin(uint16_t width, uint16_t height)
+{
+  _width = width;
+  _height = height;
+  clear();
+}
+
+void EpdDirtyRects::markAll()
+{
+  if (!enabled()) return;
+  _x0[0] = 0;
+  _y0[0] = 0;
+  _x1[0] = _width - 1;
+  _y1[0] = _height - 1;
+  _count = 1;
+  _last = 0;
+}
+
+epd_rect_t EpdDirtyRects::rect(uint8_t index)
+{
+  epd_rect_t r = {_x0[index], _y0[index],
+                  (uint16_t)(_x1[index] - _x0[index] + 1), (uint16_t)(_y1[index] - _y0[index] + 1)};
+  return r;
+}
+
+uint32_t EpdDirtyRects::area()
+{
+  uint32_t total = 0;
+  for (uint8_t i = 0; i < _count; i++) {
+    total += _area(_x0[i], _y0[i], _x1[i], _y1[i]);
+  }
+  return total;
+}
+
+void EpdDirtyRects::markRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+  if (!enabled() || w == 0 || h == 0 || x >= _width || y >= _height) return;
+  _add(x, y, _min16(x + w - 1, _width - 1), _min16(y + h - 1, _height - 1));
+}
+
+void EpdDirtyRects::_add(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
+{
+  if (x0 >= _width || y0 >= _height) return;
+  // Partial updates send whole bytes so there is no point in tracking single bits
+  x0 = x0 & 0xFFF8;
+  x1 = _min16(x1 | 0x0007, _width - 1);
+
+  uint8_t best = 0;
+  uint32_t best_growth = UINT32_MAX;
+  for (uint8_t i = 0; i < _count; i++) {
+    uint32_t merged = _area(_min16(_x0[i], x0), _min16(_y0[i], y0), _max16(_x1[i], x1), _max16(_y1[i], y1));
+    uint32_t growth = merged - _area(_x0[i], _y0[i], _x1[i], _y1[i]);
+    if (growth < best_growth) {
+      best_growth = growth;
+      best = i;
+    }
+  }
+
+  if (_count < EPD_DIRTY_MAX_RECTS && best_growth > EPD_DIRTY_MERGE_AREA) {
+    _x0[_count] = x0;
+    _y0[_count] = y0;
+    _x1[_count] = x1;
+    _y1[_count] = y1;
+    _last = _count++;
+    return;
+  }
+
+  _x0[best] = _min16(_x0[best], x0);
+  _y0[best] = _min16(_y0[best], y0);
+  _x1[best] = _max16(_x1[best], x1);
+  _y1[best] = _max16(_y1[best], y1);
+  _last = best;
+  _coalesce();
+}
+
+// Merges regions that touch each other after one of them grew
+void EpdDirtyRects::_coalesce()
+{
+  bool merged = true;
+  while (merged) {
+    merged = false;
+    for (uint8_t i = 0; i < _count && !merged; i++) {
+      for (uint8_t j = i + 1; j < _count; j++) {
+        if (_x0[j] > _x1[i] + 1 || _x0[i] > _x1[j] + 1 ||
+            _y0[j] > _y1[i] + 1 || _y0[i] > _y1[j] + 1) continue;
+        _x0[i] = _min16(_x0[i], _x0[j]);
+        _y0[i] = _min16(_y0[i], _y0[j]);
+        _x1[i] = _max16(_x1[i], _x1[j]);
+        _y1[i] = _max16(_y1[i], _y1[j]);
+        // Last region takes the free slot
+        _count--;
+        _x0[j] = _x0[_count];
+        _y0[j] = _y0[_count];
+        _x1[j] = _x1[_count];
+        _y1[j] = _y1[_count];
+        _last = i;
+        merged = true;
+        break;
+      }
+    }
+  }
+}
@@ -0,0 +1,219 @@
+#include "epdformat.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stddef.h>
+#include <ctype.h>
+#include "esp_log.h"
+
+static const char* TAG = "EpdFormat";
+
+namespace {
+
+// Collects the output and hands it over in chunks
+class Sink
+{
+  public:
+    Sink(epd_format_out_t out, void* arg): _out(out), _arg(arg) {}
+
+    void put(const char* text, size_t len) {
+      while (len > 0) {
+        size_t n = EPD_FORMAT_CHUNK - _used;
+        if (n > len) n = len;
+        memcpy(_buffer + _used, text, n);
+        _used += n;
+        text += n;
+        len -= n;
+        if (_used == EPD_FORMAT_CHUNK) flush();
+      }
+    }
+
+    void pad(int count, char c = ' ') {
+      for (; count > 0; count--) put(&c, 1);
+    }
+
+    size_t flush() {
+      if (_used > 0) _out(_arg, _buffer, _used);
+      _total += _used;
+      _used = 0;
+      return _total;
+    }
+
+  private:
+    epd_format_out_t _out;
+    void* _arg;
+    char _buffer[EPD_FORMAT_CHUNK];
+    size_t _used = 0;
+    size_t _total = 0;
+};
+
+enum length_t { LEN_NONE, LEN_HH, LEN_H, LEN_L, LEN_LL, LEN_J, LEN_Z, LEN_T, LEN_LONG_DOUBLE };
+
+}
+
+size_t epd_vformat(epd_format_out_t out, void* arg, const char* format, va_list args)
+{
+  Sink sink(out, arg);
+  const char* p = format;
+  while (*p) {
+    const char* literal = p;
+    while (*p && *p != '%') p++;
+    sink.put(literal, p - literal);
+    if (*p == 0) break;
+
+    p++;
+    if (*p == '%') {
+      sink.put("%", 1);
+      p++;
+      continue;
+    }
+    // Conversion rebuilt for snprintf with * resolved
+    char spec[24] = "%";
+    size_t s = 1;
+    bool left = false;
+    bool zero = false;
+    while (*p && strchr("-+ #0", *p)) {
+      if (*p == '-') left = true;
+      if (*p == '0') zero = true;
+      if (s < 6) spec[s++] = *p;
+      p++;
+    }
+    int width = -1;
+    if (*p == '*') {
+      width = va_arg(args, int);
+      if (width < 0) {
+        left = true;
+        if (s < 6) spec[s++] = '-';
+        width = -width;
+      }
+      p++;
+    } else if (*p >= '0' && *p <= '9') {
+      for (width = 0; *p >= '0' && *p <= '9'; p++) width = width * 10 + (*p - '0');
+    }
+    int precision = -1;
+    if (*p == '.') {
+      p++;
+      if (*p == '*') {
+        precision = va_arg(args, int);
+        p++;
+      } else {
+        for (precision = 0; *p >= '0' && *p <= '9'; p++) precision = precision * 10 + (*p - '0');
+      }
+    }
+    length_t length = LEN_NONE;
+    const char* modifier = p;
+    switch (*p) {
+      case 'h': length = (p[1] == 'h') ? LEN_HH : LEN_H; break;
+      case 'l': length = (p[1] == 'l') ? LEN_LL : LEN_L; break;
+      case 'j': length = LEN_J; break;
+      case 'z': length = LEN_Z; break;
+      case 't': length = LEN_T; break;
+      case 'L': length = LEN_LONG_DOUBLE; break;
+    }
+    p += (length == LEN_HH || length == LEN_LL) ? 2 : (length != LEN_NONE);
+    char conversion = *p;
+    if (conversion == 0) break;
+    p++;
+
+    if (conversion == 's') {
+      const char* text = va_arg(args, const char*);
+      if (text == nullptr) text = "(null)";
+      size_t len = 0;
+      while (text[len] && (precision < 0 || len < (size_t)precision)) len++;
+      if (!left) sink.pad(width - (int)len);
+      sink.put(text, len);
+      if (left) sink.pad(width - (int)len);
+      continue;
+    }
+    if (conversion == 'n') {
+      (void)va_arg(args, void*);
+      continue;
+    }
+
+    // The width is padded below, so only the value has to fit in EPD_FORMAT_CONVERSION
+    if (precision >= 0) s += snprintf(spec + s, sizeof(spec) - s, ".%d", precision);
+    if (s > sizeof(spec) - 4) s = sizeof(spec) - 4;
+    memcpy(spec + s, modifier, p - modifier);
+    spec[s + (p - modifier)] = 0;
+
+    char value[EPD_FORMAT_CONVERSION];
+    int len = -1;
+    switch (conversion) {
+      case 'd':
+      case 'i':
+        switch (length) {
+          case LEN_L:  len = snprintf(value, sizeof(value), spec, va_arg(args, long)); break;
+          case LEN_LL: len = snprintf(value, sizeof(value), spec, va_arg(args, long long)); break;
+          case LEN_J:  len = snprintf(value, sizeof(value), spec, va_arg(args, intmax_t)); break;
+          case LEN_Z:  len = snprintf(value, sizeof(value), spec, va_arg(args, size_t)); break;
+          case LEN_T:  len = snprintf(value, sizeof(value), spec, va_arg(args, ptrdiff_t)); break;
+          default:     len = snprintf(value, sizeof(value), spec, va_arg(args, int)); break;
+        }
+        break;
+      case 'u':
+      case 'o':
+      case 'x':
+      case 'X':
+        switch (length) {
+          case LEN_L:  len = snprintf(value, sizeof(value), spec, va_arg(args, unsigned long)); break;
+          case LEN_LL: len = snprintf(value, sizeof(value), spec, va_arg(args, unsigned long long)); break;
+          case LEN_J:  len = snprintf(value, sizeof(value), spec, va_arg(args, uintmax_t)); break;
+          case LEN_Z:  len = snprintf(value, sizeof(value), spec, va_arg(args, size_t)); break;
+          case LEN_T:  len = snprintf(value, sizeof(value), spec, va_arg(args, ptrdiff_t)); break;
+          default:     len = snprintf(value, sizeof(value), spec, va_arg(args, unsigned int)); break;
+        }
+        break;
+      case 'c':
+        len = snprintf(value, sizeof(value), spec, va_arg(args, int));
+        break;
+      case 'p':
+        len = snprintf(value, sizeof(value), spec, va_arg(args, void*));
+        break;
+      case 'f': case 'F': case 'e': case 'E':
+      case 'g': case 'G': case 'a': case 'A':
+        if (length == LEN_LONG_DOUBLE) {
+          len = snprintf(value, sizeof(value), spec, va_arg(args, long double));
+        } else {
+          len = snprintf(value, sizeof(value), spec, va_arg(args, double));
+        }
+        break;
+      default:
+        // Unknown conversion: printed as it is, like most libc do
+        sink.put(spec, strlen(spec));
+        continue;
+    }
+    if (len < 0) continue;
+    if (len >= (int)sizeof(value)) {
+      ESP_LOGW(TAG, "%s needs %d characters, cut to %d. Increase EPD_FORMAT_CONVERSION", spec, len, (int)sizeof(value) - 1);
+      len = sizeof(value) - 1;
+    }
+    // 0 pads after the sign and 0x. Ignored with a precision of an integer and for inf / nan
+    int prefix = 0;
+    if (zero && !left && strchr("diuoxXfFeEgGaA", conversion) && !(precision >= 0 && strchr("diuoxX", conversion))) {
+      if (value[0] == '-' || value[0] == '+' || value[0] == ' ') prefix++;
+      if (value[prefix] == '0' && (value[prefix + 1] == 'x' || value[prefix + 1] == 'X')) prefix += 2;
+      if (!isxdigit((unsigned char)value[prefix])) zero = false;
+    } else {
+      zero = false;
+    }
+    if (zero) {
+      sink.put(value, prefix);
+      sink.pad(width - len, '0');
+      sink.put(value + prefix, len - prefix);
+      continue;
+    }
+    if (!left) sink.pad(width - len);
+    sink.put(value, len);
+    if (left) sink.pad(width - len);
+  }
+  return sink.flush();
+}
+
+size_t epd_format(epd_format_out_t out, void* arg, const char* format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  size_t len = epd_vformat(out, arg, format, args);
+  va_end(args);
+  return len;
+}
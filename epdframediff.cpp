@@ -0,0 +1,216 @@
+#include "epdframediff.h"
+#include <string.h>
+#include <stdlib.h>
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+static const char* TAG = "EpdFrameDiff";
+
+EpdFrameDiff::~EpdFrameDiff()
+{
+  end();
+}
+
+bool EpdFrameDiff::begin(uint16_t row_bytes, uint16_t rows, epd_diff_mode_t mode, uint16_t band_rows)
+{
+  end();
+  if (row_bytes == 0 || rows == 0 || band_rows == 0) return false;
+
+  uint16_t band_count = (rows + band_rows - 1) / band_rows;
+  _changed = (epd_diff_band_t*)malloc(band_count * sizeof(epd_diff_band_t));
+  if (mode == EPD_DIFF_SHADOW) {
+    uint32_t size = (uint32_t)row_bytes * rows;
+    _shadow = (uint8_t*)heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+    if (_shadow == nullptr) {
+      _shadow = (uint8_t*)heap_caps_malloc(size, MALLOC_CAP_8BIT);
+    }
+  } else {
+    _hashes = (uint32_t*)malloc(band_count * sizeof(uint32_t));
+  }
+  if (_changed == nullptr || (_shadow == nullptr && _hashes == nullptr)) {
+    ESP_LOGE(TAG, "Not enough memory for the frame diff");
+    end();
+    return false;
+  }
+
+  _mode = mode;
+  _row_bytes = row_bytes;
+  _rows = rows;
+  _band_rows = band_rows;
+  _band_count = band_count;
+  _changed_count = 0;
+  _valid = false;
+  return true;
+}
+
+void EpdFrameDiff::end()
+{
+  free(_shadow);
+  free(_hashes);
+  free(_changed);
+  _shadow = nullptr;
+  _hashes = nullptr;
+  _changed = nullptr;
+  _row_bytes = 0;
+  _band_count = 0;
+  _changed_count = 0;
+}
+
+// FNV-1a over 32 bit words when the data is aligned
+uint32_t EpdFrameDiff::_hash(const uint8_t* data, uint32_t len)
+{
+  uint32_t h = 2166136261u;
+  uint32_t i = 0;
+  if (((uintptr_t)data & 3) == 0) {
+    const uint32_t* w = (const uint32_t*)data;
+    for (; i + 4 <= len; i += 4) {
+      h = (h ^ *w++) * 16777619u;
+    }
+  }
+  for (; i < len; i++) {
+    h = (h ^ data[i]) * 16777619u;
+  }
+  return h;
+}
+
+// First and last different byte of a row. Returns false if the row is equal
+bool EpdFrameDiff::_rowSpan(const uint8_t* a, const uint8_t* b, uint16_t& first, uint16_t& last)
+{
+  uint16_t start = 0;
+  uint16_t end = _row_bytes;
+
+  if ((((uintptr_t)a | (uintptr_t)b) & 3) == 0) {
+    const uint32_t* wa = (const uint32_t*)a;
+    const uint32_t* wb = (const uint32_t*)b;
+    uint16_t words = _row_bytes / 4;
+    uint16_t w = 0;
+    while (w < words && wa[w] == wb[w]) w++;
+    if (w == words && (_row_bytes & 3) == 0) return false;
+    start = w * 4;
+
+    if ((_row_bytes & 3) == 0) {
+      uint16_t we = words;
+      while (we > w && wa[we - 1] == wb[we - 1]) we--;
+      end = we * 4;
+    }
+  }
+
+  while (start < end && a[start] == b[start]) start++;
+  if (start == end) return false;
+  while (a[end - 1] == b[end - 1]) end--;
+  first = start;
+  last = end - 1;
+  return true;
+}
+
+uint16_t EpdFrameDiff::compare(const uint8_t* buffer)
+{
+  _changed_count = 0;
+  if (!enabled()) return 0;
+
+  for (uint16_t b = 0; b < _band_count; b++) {
+    uint16_t y0 = b * _band_rows;
+    uint16_t rows = (y0 + _band_rows > _rows) ? _rows - y0 : _band_rows;
+    const uint8_t* band = buffer + (uint32_t)y0 * _row_bytes;
+    epd_diff_band_t changed = {y0, rows, 0, _row_bytes};
+
+    if (!_valid) {
+      _changed[_changed_count++] = changed;
+      continue;
+    }
+
+    if (_mode == EPD_DIFF_HASH) {
+      if (_hash(band, (uint32_t)rows * _row_bytes) != _hashes[b]) {
+        _changed[_changed_count++] = changed;
+      }
+      continue;
+    }
+
+    const uint8_t* shadow = _shadow + (uint32_t)y0 * _row_bytes;
+    uint16_t y_first = UINT16_MAX, y_last = 0;
+    uint16_t x_first = UINT16_MAX, x_last = 0;
+    for (uint16_t y = 0; y < rows; y++) {
+      uint16_t first, last;
+      if (!_rowSpan(band + (uint32_t)y * _row_bytes, shadow + (uint32_t)y * _row_bytes, first, last)) continue;
+      if (y_first == UINT16_MAX) y_first = y;
+      y_last = y;
+      if (first < x_first) x_first = first;
+      if (last > x_last) x_last = last;
+    }
+    if (y_first == UINT16_MAX) continue;
+
+    changed.y = y0 + y_first;
+    changed.h = y_last - y_first + 1;
+    changed.xb = x_first;
+    changed.wb = x_last - x_first + 1;
+    _changed[_changed_count++] = changed;
+  }
+  return _changed_count;
+}
+
+bool EpdFrameDiff::changedArea(uint16_t& xb, uint16_t& y, uint16_t& wb, uint16_t& h)
+{
+  uint32_t x0 = UINT16_MAX, y0 = UINT16_MAX, x1 = 0, y1 = 0;
+  uint32_t ax1 = (uint32_t)xb + wb, ay1 = (uint32_t)y + h;
+
+  for (uint16_t i = 0; i < _changed_count; i++) {
+    const epd_diff_band_t& c = _changed[i];
+    // Intersection with the area
+    uint32_t cx0 = (c.xb > xb) ? c.xb : xb;
+    uint32_t cy0 = (c.y > y) ? c.y : y;
+    uint32_t cx1 = ((uint32_t)c.xb + c.wb < ax1) ? (uint32_t)c.xb + c.wb : ax1;
+    uint32_t cy1 = ((uint32_t)c.y + c.h < ay1) ? (uint32_t)c.y + c.h : ay1;
+    if (cx0 >= cx1 || cy0 >= cy1) continue;
+    if (cx0 < x0) x0 = cx0;
+    if (cy0 < y0) y0 = cy0;
+    if (cx1 > x1) x1 = cx1;
+    if (cy1 > y1) y1 = cy1;
+  }
+  if (x0 == UINT16_MAX) return false;
+
+  xb = x0;
+  y = y0;
+  wb = x1 - x0;
+  h = y1 - y0;
+  return true;
+}
+
+void EpdFrameDiff::commit(const uint8_t* buffer)
+{
+  if (!enabled()) return;
+  if (_mode == EPD_DIFF_SHADOW) {
+    memcpy(_shadow, buffer, (uint32_t)_row_bytes * _rows);
+  } else {
+    for (uint16_t b = 0; b < _band_count; b++) {
+      uint16_t y0 = b * _band_rows;
+      uint16_t rows = (y0 + _band_rows > _rows) ? _rows - y0 : _band_rows;
+      _hashes[b] = _hash(buffer + (uint32_t)y0 * _row_bytes, (uint32_t)rows * _row_bytes);
+    }
+  }
+  _valid = true;
+}
+
+void EpdFrameDiff::commitArea(const uint8_t* buffer, uint16_t xb, uint16_t y, uint16_t wb, uint16_t h)
+{
+  // Without a complete frame there is nothing to compare the rest of the display with
+  if (!enabled() || !_valid) return;
+  if (xb >= _row_bytes || y >= _rows) return;
+  if (xb + wb > _row_bytes) wb = _row_bytes - xb;
+  if (y + h > _rows) h = _rows - y;
+
+  if (_mode == EPD_DIFF_SHADOW) {
+    for (uint16_t row = y; row < y + h; row++) {
+      uint32_t offset = (uint32_t)row * _row_bytes + xb;
+      memcpy(_shadow + offset, buffer + offset, wb);
+    }
+    return;
+  }
+
+  if (xb != 0 || wb != _row_bytes) return;
+  for (uint16_t b = 0; b < _band_count; b++) {
+    uint16_t y0 = b * _band_rows;
+    uint16_t rows = (y0 + _band_rows > _rows) ? _rows - y0 : _band_rows;
+    if (y0 < y || y0 + rows > y + h) continue;
+    _hashes[b] = _hash(buffer + (uint32_t)y0 * _row_bytes, (uint32_t)rows * _row_bytes);
+  }
+}
@@ -0,0 +1,137 @@
+#include "epdglyphcache.h"
+#include <string.h>
+#include <stdlib.h>
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+static const char* TAG = "EpdGlyphCache";
+
+EpdGlyphCache::~EpdGlyphCache()
+{
+  end();
+}
+
+bool EpdGlyphCache::begin(uint16_t glyphs, uint32_t bytes)
+{
+  end();
+  if (glyphs == 0 || bytes == 0) return false;
+
+  _entries = (epd_glyph_t*)calloc(glyphs, sizeof(epd_glyph_t));
+  _pool = (uint8_t*)heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+  if (_entries == nullptr || _pool == nullptr) {
+    ESP_LOGE(TAG, "Not enough memory for %d glyphs and %d bytes", (int)glyphs, (int)bytes);
+    end();
+    return false;
+  }
+  _glyphs = glyphs;
+  _pool_size = bytes;
+  _pool_used = 0;
+  resetStats();
+  return true;
+}
+
+void EpdGlyphCache::end()
+{
+  free(_entries);
+  free(_pool);
+  _entries = nullptr;
+  _pool = nullptr;
+  _glyphs = 0;
+  _pool_size = 0;
+  _pool_used = 0;
+  _stats.bytes = 0;
+}
+
+void EpdGlyphCache::resetStats()
+{
+  uint32_t bytes = _stats.bytes;
+  memset(&_stats, 0, sizeof(_stats));
+  _stats.bytes = bytes;
+}
+
+void EpdGlyphCache::_flush()
+{
+  memset(_entries, 0, _glyphs * sizeof(epd_glyph_t));
+  _pool_used = 0;
+  _stats.bytes = 0;
+  _stats.flushes++;
+}
+
+const epd_glyph_t* EpdGlyphCache::get(const GFXfont* font, uint8_t c, uint8_t rotation)
+{
+  if (c < font->first || c > font->last) return nullptr;
+  // Characters of one font take consecutive entries, so they do not collide with each other.
+  // The font address and rotation only choose where the run starts
+  uint32_t key = ((uint32_t)(uintptr_t)font >> 2) * 2654435761u + rotation * 40503u;
+  epd_glyph_t* entry = &_entries[((key >> 16) + c) % _glyphs];
+  if (entry->font == font && entry->c == c && entry->rotation == rotation) {
+    _stats.hits++;
+    return entry;
+  }
+
+  _stats.misses++;
+  const GFXglyph* glyph = &font->glyph[c - font->first];
+  if (glyph->width == 0 || glyph->height == 0) return nullptr;
+  uint8_t w = (rotation & 1) ? glyph->height : glyph->width;
+  uint8_t h = (rotation & 1) ? glyph->width : glyph->height;
+  uint8_t stride = (w + 7) / 8;
+  uint32_t size = (uint32_t)stride * h;
+  if (size > _pool_size) return nullptr;
+
+  // The replaced glyph leaves its bitmap to the new one if it is big enough
+  if (entry->font == nullptr || (uint32_t)entry->stride * entry->h < size) {
+    if (_pool_used + size > _pool_size) _flush();
+    entry->bits = _pool + _pool_used;
+    _pool_used += size;
+    _stats.bytes = _pool_used;
+  }
+  entry->font = font;
+  entry->c = c;
+  entry->rotation = rotation;
+  entry->w = w;
+  entry->h = h;
+  entry->stride = stride;
+  _render(entry, font, glyph);
+  return entry;
+}
+
+// GFXfont bitmaps are packed: rows are not padded to a byte
+void EpdGlyphCache::_render(epd_glyph_t* entry, const GFXfont* font, const GFXglyph* glyph)
+{
+  const uint8_t* src = font->bitmap + glyph->bitmapOffset;
+  uint8_t gw = glyph->width;
+  uint8_t gh = glyph->height;
+  memset(entry->bits, 0, (uint32_t)entry->stride * entry->h);
+
+  uint8_t bits = 0;
+  uint8_t bit = 0;
+  for (uint8_t gy = 0; gy < gh; gy++) {
+    for (uint8_t gx = 0; gx < gw; gx++) {
+      if ((bit++ & 7) == 0) bits = *src++;
+      bool set = bits & 0x80;
+      bits <<= 1;
+      if (!set) continue;
+      // Same transformation as drawPixel, relative to the glyph box
+      uint8_t x, y;
+      switch (entry->rotation) {
+        case 1:
+          x = gh - 1 - gy;
+          y = gx;
+          break;
+        case 2:
+          x = gw - 1 - gx;
+          y = gh - 1 - gy;
+          break;
+        case 3:
+          x = gy;
+          y = gw - 1 - gx;
+          break;
+        default:
+          x = gx;
+          y = gy;
+          break;
+      }
+      entry->bits[y * entry->stride + (x >> 3)] |= 0x80 >> (x & 7);
+    }
+  }
+}
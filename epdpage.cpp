@@ -0,0 +1,51 @@
+#include "epdpage.h"
+#include <stdlib.h>
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+static const char* TAG = "EpdPage";
+
+EpdPage::~EpdPage()
+{
+  end();
+}
+
+bool EpdPage::begin(uint32_t bytes, uint16_t stride, uint16_t height)
+{
+  uint32_t rows = bytes / stride;
+  if (rows == 0) rows = 1;
+  if (rows > height) rows = height;
+  // The band in use is kept if there is no memory for the new one
+  uint8_t* data = (uint8_t*)heap_caps_malloc(rows * stride, MALLOC_CAP_8BIT);
+  if (data == nullptr) {
+    ESP_LOGE(TAG, "Not enough memory for a band of %d rows", (int)rows);
+    return false;
+  }
+  end();
+  _data = data;
+  _rows = rows;
+  _height = height;
+  // Nothing selected: every row is outside
+  _top = 0;
+  _count = 0;
+  return true;
+}
+
+void EpdPage::end()
+{
+  free(_data);
+  _data = nullptr;
+  _rows = 0;
+  _count = 0;
+}
+
+bool EpdPage::select(uint16_t y)
+{
+  if (y >= _height) {
+    _count = 0;
+    return false;
+  }
+  _top = y;
+  _count = (_height - y < _rows) ? _height - y : _rows;
+  return true;
+}
@@ -0,0 +1,226 @@
+#include "epdparagraph.h"
+#include "epdutf8.h"
+#include <stdlib.h>
+#include <string.h>
+#include "esp_log.h"
+
+static const char* TAG = "EpdParagraph";
+
+EpdParagraph::EpdParagraph(const GFXfont* font): _font(font)
+{
+}
+
+EpdParagraph::~EpdParagraph()
+{
+  free(_text);
+  free(_chars);
+  free(_lines);
+}
+
+bool EpdParagraph::setText(const char* text)
+{
+  size_t len = strlen(text);
+  if (len > UINT16_MAX) len = UINT16_MAX;
+  if (_text != nullptr && len == _text_len && memcmp(_text, text, len) == 0) return false;
+
+  // The text is kept to decode it again for another font
+  char* copy = (char*)realloc(_text, len + 1);
+  uint8_t* chars = (uint8_t*)realloc(_chars, len + 1);
+  if (copy != nullptr) _text = copy;
+  if (chars != nullptr) _chars = chars;
+  if (copy == nullptr || chars == nullptr) {
+    ESP_LOGE(TAG, "Not enough memory for %d bytes of text", (int)len);
+    _text_len = _len = 0;
+    _dirty = true;
+    return true;
+  }
+  memcpy(_text, text, len);
+  _text[len] = 0;
+  _text_len = len;
+  _decode();
+  return true;
+}
+
+void EpdParagraph::_decode()
+{
+  if (_text == nullptr) return;
+  EpdUtf8 utf8;
+  _len = utf8.decode(_font, _text, _text_len, _chars);
+  _dirty = true;
+}
+
+void EpdParagraph::setFont(const GFXfont* font)
+{
+  if (font == _font) return;
+  _font = font;
+  // Font maps can decode the text to other characters
+  _decode();
+  _dirty = true;
+}
+
+void EpdParagraph::setBox(int16_t x, int16_t y, uint16_t w, uint16_t h)
+{
+  // Only the size changes the lines
+  if (w != _w || h != _h) _dirty = true;
+  _x = x;
+  _y = y;
+  _w = w;
+  _h = h;
+}
+
+void EpdParagraph::setLineSpacing(uint8_t percent)
+{
+  if (percent == _spacing) return;
+  _spacing = percent;
+  _dirty = true;
+}
+
+void EpdParagraph::setEllipsis(bool ellipsis)
+{
+  if (ellipsis == _ellipsis) return;
+  _ellipsis = ellipsis;
+  _dirty = true;
+}
+
+int16_t EpdParagraph::textHeight()
+{
+  return _visible ? (_visible - 1) * _line_height + _ascent + _descent : 0;
+}
+
+// Same as the cursor advance of Adafruit_GFX::write()
+uint16_t EpdParagraph::_advance(uint8_t c)
+{
+  if (c == '\n' || c == '\r') return 0;
+  if (_font == nullptr) return 6 * _size_x;
+  if (c < _font->first || c > _font->last) return 0;
+  return _font->glyph[c - _font->first].xAdvance * _size_x;
+}
+
+bool EpdParagraph::_addLine(uint16_t start, uint16_t end, uint32_t width)
+{
+  if (_visible == _max_lines) return false;
+  if (_visible == _capacity) {
+    uint16_t capacity = _capacity ? _capacity * 2 : 8;
+    if (capacity > _max_lines) capacity = _max_lines;
+    epd_paragraph_line_t* lines = (epd_paragraph_line_t*)realloc(_lines, capacity * sizeof(epd_paragraph_line_t));
+    if (lines == nullptr) {
+      ESP_LOGE(TAG, "Not enough memory for %d lines", (int)capacity);
+      return false;
+    }
+    _lines = lines;
+    _capacity = capacity;
+  }
+  epd_paragraph_line_t& line = _lines[_visible++];
+  line.start = start;
+  line.len = end - start;
+  line.width = (width < UINT16_MAX) ? width : UINT16_MAX;
+  line.ellipsis = false;
+  return true;
+}
+
+// Shortens the line until "..." fits after it
+void EpdParagraph::_ellipsize(epd_paragraph_line_t& line)
+{
+  uint32_t dots = 3 * _advance('.');
+  uint32_t width = line.width;
+  uint16_t end = line.start + line.len;
+  while (end > line.start && (width + dots > _w || _chars[end - 1] == ' ')) {
+    end--;
+    width -= _advance(_chars[end]);
+  }
+  line.len = end - line.start;
+  line.width = width + dots;
+  line.ellipsis = true;
+}
+
+uint16_t EpdParagraph::layout(uint8_t size_x, uint8_t size_y)
+{
+  if (!_dirty && size_x == _size_x && size_y == _size_y) return _visible;
+  _dirty = false;
+  _size_x = size_x;
+  _size_y = size_y;
+  _visible = 0;
+
+  // Cursor y is the baseline of GFXfont text and the top of the classic font
+  if (_font != nullptr) {
+    _line_height = _font->yAdvance * size_y;
+    _ascent = 0;
+    _descent = 0;
+    for (uint16_t c = _font->first; c <= _font->last; c++) {
+      const GFXglyph* glyph = &_font->glyph[c - _font->first];
+      if (glyph->height == 0) continue;
+      if (-glyph->yOffset > _ascent) _ascent = -glyph->yOffset;
+      if (glyph->yOffset + glyph->height > _descent) _descent = glyph->yOffset + glyph->height;
+    }
+    _ascent *= size_y;
+    _descent *= size_y;
+  } else {
+    _line_height = 8 * size_y;
+    _ascent = 0;
+    _descent = 8 * size_y;
+  }
+  _line_height = _line_height * _spacing / 100;
+  if (_line_height < 1) _line_height = 1;
+  int32_t first = _ascent + _descent;
+  _max_lines = (_h >= first) ? 1 + (_h - first) / _line_height : 0;
+  if (_max_lines == 0 || _w == 0) return 0;
+
+  // Greedy: every line takes as many words as fit
+  bool cut = false;
+  uint16_t i = 0;
+  while (i < _len) {
+    uint16_t start = i;
+    uint32_t width = 0;
+    int32_t break_end = -1;
+    uint16_t break_next = 0;
+    uint32_t break_width = 0;
+    uint16_t end, next;
+    uint32_t line_width;
+    for (;;) {
+      if (i == _len || _chars[i] == '\n') {
+        end = i;
+        next = (i == _len) ? i : i + 1;
+        line_width = width;
+        break;
+      }
+      uint8_t c = _chars[i];
+      uint16_t advance = _advance(c);
+      if (c != ' ' && width + advance > _w && i > start) {
+        if (break_end >= 0) {
+          end = break_end;
+          next = break_next;
+          line_width = break_width;
+        } else {
+          // A word longer than the line
+          end = i;
+          next = i;
+          line_width = width;
+        }
+        while (next < _len && _chars[next] == ' ') next++;
+        break;
+      }
+      width += advance;
+      if (c == ' ') {
+        break_end = i;
+        break_next = i + 1;
+        break_width = width - advance;
+      } else if (c == '-') {
+        break_end = i + 1;
+        break_next = i + 1;
+        break_width = width;
+      }
+      i++;
+    }
+    while (end > start && _chars[end - 1] == ' ') {
+      end--;
+      line_width -= _advance(' ');
+    }
+    if (!_addLine(start, end, line_width)) {
+      cut = true;
+      break;
+    }
+    i = next;
+  }
+  if (cut && _ellipsis && _visible > 0) _ellipsize(_lines[_visible - 1]);
+  return _visible;
+}
@@ -0,0 +1,257 @@
+#include "epdscheduler.h"
+#include <stdio.h>
+#include <string.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char* TAG = "EpdScheduler";
+
+#define EPD_SCHED_KICK     (1 << 0)
+#define EPD_SCHED_IDLE     (1 << 1)
+// One bit per display: its queued updates sent their buffer
+#define EPD_SCHED_SENT(d)  (1 << (8 + (d)))
+#define EPD_SCHED_SENT_ALL (((1 << EPD_SCHEDULER_MAX_DISPLAYS) - 1) << 8)
+
+EpdScheduler::EpdScheduler(bool debug):
+  _debug(debug)
+{
+  memset(_displays, 0, sizeof(_displays));
+}
+
+EpdScheduler::~EpdScheduler()
+{
+  if (_task != nullptr) {
+    waitAll();
+    // _done() of the last update releases the mutex after setting IDLE: it is done with this object
+    // once the mutex can be taken. The scheduler task is deleted while it can't touch the mutex
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    vTaskDelete(_task);
+    xSemaphoreGive(_mutex);
+  }
+  if (_events != nullptr) {
+    vEventGroupDelete(_events);
+  }
+  if (_mutex != nullptr) {
+    vSemaphoreDelete(_mutex);
+  }
+}
+
+bool EpdScheduler::_init()
+{
+  if (_task != nullptr) return true;
+
+  if (_mutex == nullptr) {
+    _mutex = xSemaphoreCreateMutex();
+    if (_mutex == nullptr) return false;
+  }
+  if (_events == nullptr) {
+    _events = xEventGroupCreate();
+    if (_events == nullptr) return false;
+    xEventGroupSetBits(_events, EPD_SCHED_IDLE | EPD_SCHED_SENT_ALL);
+  }
+  if (xTaskCreate(_schedulerTask, "epd_scheduler", EPD_SCHEDULER_TASK_STACK, this, EPD_SCHEDULER_TASK_PRIORITY, &_task) != pdPASS) {
+    _task = nullptr;
+    ESP_LOGE(TAG, "Could not create the scheduler task");
+    return false;
+  }
+  return true;
+}
+
+int8_t EpdScheduler::_display(EpdAsync& epd, bool add)
+{
+  for (uint8_t i = 0; i < _display_count; i++) {
+    if (_displays[i].epd == &epd) return i;
+  }
+  if (!add || _display_count == EPD_SCHEDULER_MAX_DISPLAYS) return -1;
+  _display_t& d = _displays[_display_count];
+  d.scheduler = this;
+  d.epd = &epd;
+  return _display_count++;
+}
+
+bool EpdScheduler::_queuedFor(uint8_t display)
+{
+  for (uint8_t i = 0; i < _queued; i++) {
+    if (_queue[i].display == display) return true;
+  }
+  return false;
+}
+
+// Called with _mutex taken
+void EpdScheduler::_updateIdle()
+{
+  bool idle = (_queued == 0);
+  for (uint8_t i = 0; i < _display_count && idle; i++) {
+    if (_displays[i].active) idle = false;
+  }
+  if (idle) {
+    xEventGroupSetBits(_events, EPD_SCHED_IDLE);
+  } else {
+    xEventGroupClearBits(_events, EPD_SCHED_IDLE);
+  }
+}
+
+bool EpdScheduler::submit(EpdAsync& epd, epd_sched_cb_t cb, void* arg)
+{
+  if (!_init()) return false;
+
+  xSemaphoreTake(_mutex, portMAX_DELAY);
+  int8_t display = _display(epd, true);
+  if (display < 0) {
+    xSemaphoreGive(_mutex);
+    ESP_LOGE(TAG, "Only %d displays can be scheduled", EPD_SCHEDULER_MAX_DISPLAYS);
+    return false;
+  }
+  if (_queued == EPD_SCHEDULER_QUEUE) {
+    xSemaphoreGive(_mutex);
+    ESP_LOGE(TAG, "Queue full, update of display %d dropped", (int)display);
+    return false;
+  }
+  _job_t& job = _queue[_queued++];
+  job.display = display;
+  job.cb = cb;
+  job.arg = arg;
+  job.queued_us = esp_timer_get_time();
+  xEventGroupClearBits(_events, EPD_SCHED_IDLE | EPD_SCHED_SENT(display));
+  xEventGroupSetBits(_events, EPD_SCHED_KICK);
+  xSemaphoreGive(_mutex);
+  return true;
+}
+
+void EpdScheduler::_schedulerTask(void* arg)
+{
+  static_cast<EpdScheduler*>(arg)->_run();
+}
+
+void EpdScheduler::_run()
+{
+  for (;;) {
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    // Oldest update of a display that is not refreshing. The bus is free: the last transfer finished
+    uint8_t next = 0;
+    while (next < _queued && _displays[_queue[next].display].active) next++;
+    if (next == _queued) {
+      xSemaphoreGive(_mutex);
+      // Set by submit() and when a display finished
+      xEventGroupWaitBits(_events, EPD_SCHED_KICK, pdTRUE, pdTRUE, portMAX_DELAY);
+      continue;
+    }
+    uint8_t display = _queue[next].display;
+    _display_t& d = _displays[display];
+    d.job = _queue[next];
+    _queued--;
+    memmove(&_queue[next], &_queue[next + 1], (_queued - next) * sizeof(_job_t));
+    d.active = true;
+    d.sent_us = 0;
+    d.start_us = esp_timer_get_time();
+    xSemaphoreGive(_mutex);
+
+    d.epd->updateAsync(_done, &d);
+    d.epd->waitForTransfer();
+
+    xSemaphoreTake(_mutex, portMAX_DELAY);
+    // Zero if _done() already run (updateAsync() without task)
+    if (d.active) d.sent_us = esp_timer_get_time();
+    if (!_queuedFor(display)) xEventGroupSetBits(_events, EPD_SCHED_SENT(display));
+    xSemaphoreGive(_mutex);
+  }
+}
+
+void EpdScheduler::_done(void* arg)
+{
+  _display_t& d = *static_cast<_display_t*>(arg);
+  EpdScheduler* scheduler = d.scheduler;
+  int64_t now = esp_timer_get_time();
+
+  xSemaphoreTake(scheduler->_mutex, portMAX_DELAY);
+  int64_t sent = (d.sent_us != 0) ? d.sent_us : now;
+  epd_sched_report_t report;
+  report.epd = d.epd;
+  report.wait_ms = (d.start_us - d.job.queued_us) / 1000;
+  report.transfer_ms = (sent - d.start_us) / 1000;
+  report.refresh_ms = (now - sent) / 1000;
+  report.latency_ms = (now - d.job.queued_us) / 1000;
+  d.updates++;
+  d.sum_latency_ms += report.latency_ms;
+  if (report.latency_ms > d.max_latency_ms) d.max_latency_ms = report.latency_ms;
+  d.last = report;
+  epd_sched_cb_t cb = d.job.cb;
+  void* cb_arg = d.job.arg;
+  xSemaphoreGive(scheduler->_mutex);
+
+  if (scheduler->_debug) {
+    printf("EpdScheduler: display %d wait %d ms, transfer %d ms, refresh %d ms, latency %d ms\n",
+           (int)(&d - scheduler->_displays), (int)report.wait_ms, (int)report.transfer_ms,
+           (int)report.refresh_ms, (int)report.latency_ms);
+  }
+  if (cb != nullptr) {
+    cb(&report, cb_arg);
+  }
+
+  // IDLE last: waitAll() may return and the scheduler be deleted right after it
+  xSemaphoreTake(scheduler->_mutex, portMAX_DELAY);
+  d.active = false;
+  xEventGroupSetBits(scheduler->_events, EPD_SCHED_KICK);
+  scheduler->_updateIdle();
+  xSemaphoreGive(scheduler->_mutex);
+}
+
+bool EpdScheduler::waitForTransfer(EpdAsync& epd, uint32_t timeout_ms)
+{
+  if (_events == nullptr) return true;
+  xSemaphoreTake(_mutex, portMAX_DELAY);
+  int8_t display = _display(epd, false);
+  xSemaphoreGive(_mutex);
+  if (display < 0) return true;
+  TickType_t ticks = (timeout_ms == portMAX_DELAY) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+  EventBits_t bits = xEventGroupWaitBits(_events, EPD_SCHED_SENT(display), pdFALSE, pdTRUE, ticks);
+  return (bits & EPD_SCHED_SENT(display)) != 0;
+}
+
+bool EpdScheduler::waitAll(uint32_t timeout_ms)
+{
+  if (_events == nullptr) return true;
+  TickType_t ticks = (timeout_ms == portMAX_DELAY) ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+  EventBits_t bits = xEventGroupWaitBits(_events, EPD_SCHED_IDLE, pdFALSE, pdTRUE, ticks);
+  return (bits & EPD_SCHED_IDLE) != 0;
+}
+
+uint8_t EpdScheduler::pending()
+{
+  if (_mutex == nullptr) return 0;
+  xSemaphoreTake(_mutex, portMAX_DELAY);
+  uint8_t queued = _queued;
+  xSemaphoreGive(_mutex);
+  return queued;
+}
+
+epd_sched_stats_t EpdScheduler::stats(EpdAsync& epd)
+{
+  epd_sched_stats_t stats = {};
+  if (_mutex == nullptr) return stats;
+  xSemaphoreTake(_mutex, portMAX_DELAY);
+  int8_t display = _display(epd, false);
+  if (display >= 0) {
+    _display_t& d = _displays[display];
+    stats.updates = d.updates;
+    stats.max_latency_ms = d.max_latency_ms;
+    stats.avg_latency_ms = d.updates ? d.sum_latency_ms / d.updates : 0;
+    stats.last = d.last;
+  }
+  xSemaphoreGive(_mutex);
+  return stats;
+}
+
+void EpdScheduler::resetStats()
+{
+  if (_mutex == nullptr) return;
+  xSemaphoreTake(_mutex, portMAX_DELAY);
+  for (uint8_t i = 0; i < _display_count; i++) {
+    _display_t& d = _displays[i];
+    d.updates = 0;
+    d.max_latency_ms = 0;
+    d.sum_latency_ms = 0;
+    memset(&d.last, 0, sizeof(d.last));
+  }
+  xSemaphoreGive(_mutex);
+}
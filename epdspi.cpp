@@ -3,78 +3,89 @@
 #include <string.h>
 #include "freertos/task.h"
 #include "esp_log.h"
-#ifdef CONFIG_IDF_TARGET_ESP32
-    #define EPD_HOST    HSPI_HOST
-    #define DMA_CHAN    2
-#elif defined CONFIG_IDF_TARGET_ESP32S2
-    #define EPD_HOST    SPI2_HOST
-    #define DMA_CHAN    EPD_HOST
-#elif defined CONFIG_IDF_TARGET_ESP32S3
-    #define EPD_HOST    SPI2_HOST
-    #define DMA_CHAN    SPI_DMA_CH_AUTO
-#elif defined CONFIG_IDF_TARGET_ESP32C3
-    // chip only support spi dma channel auto-alloc
-    #define EPD_HOST    SPI2_HOST
-    #define DMA_CHAN    SPI_DMA_CH_AUTO
-#endif
+#include "esp_heap_caps.h"
+#include <esp_timer.h>
+EpdSpi::EpdSpi(): _config(EPD_SPI_CONFIG_DEFAULT())
+{
+}
+
+EpdSpi::EpdSpi(const epd_spi_config_t& config): _config(config)
+{
+}
+
+EpdSpi::~EpdSpi()
+{
+    if (spi != nullptr) {
+        if (_stream_inflight) dataStreamEnd();
+        spi_bus_remove_device(spi);
+        epd_spi_bus_release(_config.host);
+    }
+    if (_busy_sem != nullptr) {
+        gpio_isr_handler_remove((gpio_num_t)_config.busy);
+        vSemaphoreDelete(_busy_sem);
+    }
+    for (int b = 0; b < EPD_STREAM_BUFFERS; b++) {
+        if (_stream_buffer[b] != nullptr) heap_caps_free(_stream_buffer[b]);
+    }
+}
 
 void EpdSpi::init(uint8_t frequency=4,bool debug=false){
     debug_enabled = debug;
+    if (spi != nullptr) {
+        if (_stream_inflight) dataStreamEnd();
+        spi_bus_remove_device(spi);
+        epd_spi_bus_release(_config.host);
+        spi = nullptr;
+    }
 
     //Initialize GPIOs direction & initial states
-    gpio_set_direction((gpio_num_t)CONFIG_EINK_SPI_CS, GPIO_MODE_OUTPUT);
-    gpio_set_direction((gpio_num_t)CONFIG_EINK_DC, GPIO_MODE_OUTPUT);
-    gpio_set_direction((gpio_num_t)CONFIG_EINK_RST, GPIO_MODE_OUTPUT);
-    gpio_set_direction((gpio_num_t)CONFIG_EINK_BUSY, GPIO_MODE_INPUT);
-    gpio_set_pull_mode((gpio_num_t)CONFIG_EINK_BUSY, GPIO_PULLUP_ONLY);
-
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_CS, 1);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_DC, 1);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_RST, 1);
+    gpio_set_direction((gpio_num_t)_config.cs, GPIO_MODE_OUTPUT);
+    gpio_set_direction((gpio_num_t)_config.dc, GPIO_MODE_OUTPUT);
+    gpio_set_direction((gpio_num_t)_config.rst, GPIO_MODE_OUTPUT);
+    gpio_set_direction((gpio_num_t)_config.busy, GPIO_MODE_INPUT);
+    gpio_set_pull_mode((gpio_num_t)_config.busy, GPIO_PULLUP_ONLY);
+
+    gpio_set_level((gpio_num_t)_config.cs, 1);
+    gpio_set_level((gpio_num_t)_config.dc, 1);
+    gpio_set_level((gpio_num_t)_config.rst, 1);
     
     esp_err_t ret;
-    // MISO not used, only Master to Slave
-    spi_bus_config_t buscfg={
-        .mosi_io_num=CONFIG_EINK_SPI_MOSI,
-        .miso_io_num = -1,
-        .sclk_io_num=CONFIG_EINK_SPI_CLK,
-        .quadwp_io_num=-1,
-        .quadhd_io_num=-1,
-        .max_transfer_sz=4094
-    };
-    // max_transfer_sz   4Kb is the defaut SPI transfer size if 0
     // debug: 50000  0.5 Mhz so we can sniff the SPI commands with a Slave
-    uint16_t multiplier = 1000;
+    uint32_t clock_hz = (_config.clock_hz) ? _config.clock_hz : uint32_t(frequency)*1000000;
     if (debug_enabled) {
-        frequency = 50;
-        multiplier = 1;
+        clock_hz = 50000;
     }
     //Config Frequency and SS GPIO
     spi_device_interface_config_t devcfg={
         .mode=0,  //SPI mode 0
-        .clock_speed_hz=frequency*multiplier*1000,  // DEBUG: 50000 - No debug usually 4 Mhz
+        .clock_speed_hz=(int)clock_hz,  // DEBUG: 50000 - No debug usually 4 Mhz
         .input_delay_ns=0,
-        .spics_io_num=CONFIG_EINK_SPI_CS,
+        .spics_io_num=_config.cs,
         .flags = (SPI_DEVICE_HALFDUPLEX | SPI_DEVICE_3WIRE),
-        .queue_size=5
+        .queue_size=EPD_SPI_QUEUE_SIZE,
+        .pre_cb=EpdSpi::_preTransfer
     };
-    // DISABLED Callbacks pre_cb/post_cb. SPI does not seem to behave the same
-    // CS / DC GPIO states the usual way
+    // pre_cb only touches DC when the transaction carries an epd_spi_dc_t in user (cmdData)
+    // cmd() & data() still set the DC GPIO state the usual way
+    _dc_cmd = { (gpio_num_t)_config.dc, 0 };
+    _dc_data = { (gpio_num_t)_config.dc, 1 };
+    _busyInit();
 
-    //Initialize the SPI bus
-    ret=spi_bus_initialize(EPD_HOST, &buscfg, DMA_CHAN);
+    // Initialize the SPI bus, or share it with the displays already on it. MISO not used, only Master to Slave
+    // max_transfer_sz   4Kb is the defaut SPI transfer size if 0
+    ret=epd_spi_bus_acquire(_config.host, _config.mosi, -1, _config.clk, 4094);
     ESP_ERROR_CHECK(ret);
 
     //Attach the EPD to the SPI bus
-    ret=spi_bus_add_device(EPD_HOST, &devcfg, &spi);
+    ret=spi_bus_add_device(_config.host, &devcfg, &spi);
     ESP_ERROR_CHECK(ret);
     
     if (debug_enabled) {
-      ESP_LOGI("EpdSPI", "init() Debug enabled. SPI master at frequency:%d  MOSI:%d CLK:%d CS:%d DC:%d RST:%d BUSY:%d DMA_CH: %d\n",
-      frequency*multiplier*1000, CONFIG_EINK_SPI_MOSI, CONFIG_EINK_SPI_CLK, CONFIG_EINK_SPI_CS,
-      CONFIG_EINK_DC,CONFIG_EINK_RST,CONFIG_EINK_BUSY, DMA_CHAN);
+      ESP_LOGI("EpdSPI", "init() Debug enabled. SPI master at frequency:%d  MOSI:%d CLK:%d CS:%d DC:%d RST:%d BUSY:%d HOST: %d\n",
+      (int)clock_hz, _config.mosi, _config.clk, _config.cs,
+      _config.dc, _config.rst, _config.busy, (int)_config.host);
         } else {
-           ESP_LOGI(TAG, "started at frequency: %d000", frequency*multiplier);
+           ESP_LOGI(TAG, "started at frequency: %d", (int)clock_hz);
         }
     }
 
@@ -87,6 +98,8 @@ void EpdSpi::init(uint8_t frequency=4,bool debug=false){
  */
 void EpdSpi::cmd(const uint8_t cmd)
 {
+    // Polling transactions are not allowed while queued ones are pending
+    if (_stream_inflight) dataStreamEnd();
     if (debug_enabled) {
         ESP_LOGI(TAG, "C %x",cmd);
     } 
@@ -98,16 +111,71 @@ void EpdSpi::cmd(const uint8_t cmd)
     t.tx_buffer=&cmd;               //The data is the cmd itself 
     // No need to toogle CS when spics_io_num is defined in SPI config struct
     //gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_CS, 0);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_DC, 0);
+    gpio_set_level((gpio_num_t)_config.dc, 0);
     ret=spi_device_polling_transmit(spi, &t);
+    _countTrans(&t);
 
     assert(ret==ESP_OK);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_DC, 1);
+    gpio_set_level((gpio_num_t)_config.dc, 1);
     
 }
 
+// Called by the SPI driver right before a transaction starts
+void IRAM_ATTR EpdSpi::_preTransfer(spi_transaction_t *t)
+{
+    epd_spi_dc_t* dc = (epd_spi_dc_t*) t->user;
+    if (dc != nullptr) {
+        gpio_set_level(dc->pin, dc->level);
+    }
+}
+
+/**
+ * @brief Send a command and its payload. Both transactions are queued back to back
+ *        and DC is switched by the SPI driver in pre_cb, so there is no CPU round-trip
+ *        between command and data. Payloads up to 4 bytes travel inside the transaction.
+ */
+void EpdSpi::cmdData(const uint8_t cmd, const uint8_t *data, int len)
+{
+    if (_stream_inflight) dataStreamEnd();
+    if (debug_enabled) {
+        ESP_LOGI(TAG, "C %x D len:%d", cmd, len);
+    }
+    esp_err_t ret;
+    spi_transaction_t t[2];
+    spi_transaction_t* rt;
+    memset(t, 0, sizeof(t));
+    t[0].length=8;
+    t[0].flags=SPI_TRANS_USE_TXDATA;
+    t[0].tx_data[0]=cmd;
+    t[0].user=&_dc_cmd;
+    uint8_t n = 1;
+    if (len > 0) {
+        t[1].length=len*8;
+        t[1].user=&_dc_data;
+        if (len <= 4) {
+            t[1].flags=SPI_TRANS_USE_TXDATA;
+            memcpy(t[1].tx_data, data, len);
+        } else {
+            t[1].tx_buffer=data;
+        }
+        n = 2;
+    }
+    for (uint8_t i = 0; i < n; i++) {
+        ret=spi_device_queue_trans(spi, &t[i], portMAX_DELAY);
+        _countTrans(&t[i]);
+        assert(ret==ESP_OK);
+    }
+    for (uint8_t i = 0; i < n; i++) {
+        ret=spi_device_get_trans_result(spi, &rt, portMAX_DELAY);
+        assert(ret==ESP_OK);
+    }
+    // Leave DC high as cmd() does, data(uint8_t) does not touch it
+    if (n == 1) gpio_set_level(_dc_data.pin, _dc_data.level);
+}
+
 void EpdSpi::data(uint8_t data)
 {
+    if (_stream_inflight) dataStreamEnd();
     if (debug_enabled) {
       ESP_LOGI(TAG,"D %x",data);
     }
@@ -117,17 +185,20 @@ void EpdSpi::data(uint8_t data)
     t.length=8;                     //Command is 8 bits
     t.tx_buffer=&data;              //The data is the cmd itself
     ret=spi_device_polling_transmit(spi, &t);
+    _countTrans(&t);
     
     assert(ret==ESP_OK);
 }
 
 void EpdSpi::dataBuffer(uint8_t data)
 {
+    if (_stream_inflight) dataStreamEnd();
     spi_transaction_t t;
     memset(&t, 0, sizeof(t));       //Zero out the transaction
     t.length=8;                     //Command is 8 bits
     t.tx_buffer=&data;
     spi_device_polling_transmit(spi, &t);
+    _countTrans(&t);
 }
 
 /* Send data to the SPI. Uses spi_device_polling_transmit, which waits until the
@@ -140,6 +211,7 @@ void EpdSpi::dataBuffer(uint8_t data)
 void EpdSpi::data(const uint8_t *data, int len)
 {
   if (len==0) return; 
+  if (_stream_inflight) dataStreamEnd();
     if (debug_enabled && false) {
         ESP_LOGI(TAG,"D");
         for (int i = 0; i < len; i++)  {
@@ -153,13 +225,258 @@ void EpdSpi::data(const uint8_t *data, int len)
     t.length=len*8;                 //Len is in bytes, transaction length is in bits.
     t.tx_buffer=data;               //Data
     ret=spi_device_polling_transmit(spi, &t);  //Transmit!
+    _countTrans(&t);
     assert(ret==ESP_OK);            //Should have had no issues.
 }
 
+/**
+ * @brief Prepare the DMA row buffers for a queued data stream.
+ * Buffers are kept between updates and only reallocated when a longer row is requested.
+ * Send the command (Ex. 0x13) before starting to queue rows, DC stays HIGH while streaming.
+ *
+ * Usage:
+ *   IO.dataStreamBegin(rowBytes);
+ *   for every row: buf = IO.dataStreamBuffer(); fill buf; IO.dataStreamQueue(rowBytes);
+ *   IO.dataStreamEnd();
+ */
+void EpdSpi::dataStreamBegin(uint16_t max_len)
+{
+    if (_stream_inflight) dataStreamEnd();
+    if (max_len > _stream_buffer_size) {
+        for (int b = 0; b < EPD_STREAM_BUFFERS; b++) {
+            if (_stream_buffer[b] != nullptr) heap_caps_free(_stream_buffer[b]);
+            _stream_buffer[b] = (uint8_t*)heap_caps_malloc(max_len, MALLOC_CAP_DMA);
+            assert(_stream_buffer[b] != nullptr);
+        }
+        _stream_buffer_size = max_len;
+    }
+    _stream_head = 0;
+}
+
+/**
+ * @brief Returns the next free DMA row buffer. If all of them are on the wire
+ *        it blocks until the oldest transaction is done.
+ */
+uint8_t* EpdSpi::dataStreamBuffer()
+{
+    if (_stream_inflight == EPD_STREAM_BUFFERS) {
+        _streamCollect();
+    }
+    return _stream_buffer[_stream_head];
+}
+
+/**
+ * @brief Queue len bytes of the buffer returned by dataStreamBuffer() and return
+ *        without waiting, so the next row can be prepared meanwhile.
+ */
+void EpdSpi::dataStreamQueue(int len)
+{
+    if (len==0) return;
+    assert(len <= _stream_buffer_size);
+    spi_transaction_t* t = &_stream_trans[_stream_head];
+    memset(t, 0, sizeof(spi_transaction_t));
+    t->length=len*8;
+    t->tx_buffer=_stream_buffer[_stream_head];
+    esp_err_t ret=spi_device_queue_trans(spi, t, portMAX_DELAY);
+    _countTrans(t);
+    assert(ret==ESP_OK);
+    _stream_head = (_stream_head + 1) % EPD_STREAM_BUFFERS;
+    _stream_inflight++;
+}
+
+/**
+ * @brief Copy data into the next DMA row buffer and queue it
+ */
+void EpdSpi::dataStream(const uint8_t *data, int len)
+{
+    uint8_t* buf = dataStreamBuffer();
+    memcpy(buf, data, len);
+    dataStreamQueue(len);
+}
+
+// Wait until every queued row is sent
+void EpdSpi::dataStreamEnd()
+{
+    while (_stream_inflight) {
+        _streamCollect();
+    }
+}
+
+void EpdSpi::_streamCollect()
+{
+    spi_transaction_t* t;
+    esp_err_t ret=spi_device_get_trans_result(spi, &t, portMAX_DELAY);
+    assert(ret==ESP_OK);
+    _stream_inflight--;
+}
+
+/**
+ * @brief Run a command sequence built with the epdsequence.h macros.
+ *        Commands and payloads are queued without waiting, the queue is only drained
+ *        when the sequence needs to wait (BUSY, DELAY, RESET) or when it ends.
+ */
+void EpdSpi::sequence(const uint8_t *seq)
+{
+    if (_stream_inflight) dataStreamEnd();
+    int64_t startTime = esp_timer_get_time();
+    _seq_count = 0;
+    const uint8_t *p = seq;
+    while (*p != EPD_SEQ_OP_END) {
+        uint8_t op = *p++;
+        switch (op) {
+            case EPD_SEQ_OP_CMD:
+            case EPD_SEQ_OP_CMD_BYTES:
+            {
+                const uint8_t *cmd = p;
+                uint8_t len = p[1];
+                const uint8_t *data = p + 2;
+                p += 2 + len;
+                _seqQueue(cmd, 1, &_dc_cmd);
+                if (len == 0) break;
+                if (op == EPD_SEQ_OP_CMD) {
+                    _seqQueue(data, len, &_dc_data);
+                } else {
+                    for (uint8_t i = 0; i < len; i++) {
+                        _seqQueue(&data[i], 1, &_dc_data);
+                    }
+                }
+                break;
+            }
+            case EPD_SEQ_OP_DELAY:
+                _seqDrain();
+                vTaskDelay((p[0] | (p[1] << 8)) / portTICK_PERIOD_MS);
+                p += 2;
+                break;
+            case EPD_SEQ_OP_BUSY:
+                _seqDrain();
+                waitBusy(p[0], p[1] | (p[2] << 8), "sequence");
+                p += 3;
+                break;
+            case EPD_SEQ_OP_RESET:
+                _seqDrain();
+                reset(p[0]);
+                p += 1;
+                break;
+            default:
+                ESP_LOGE(TAG, "sequence: unknown opcode %x", op);
+                assert(false);
+        }
+    }
+    _seqDrain();
+    gpio_set_level(_dc_data.pin, _dc_data.level);
+
+    if (debug_enabled) {
+        ESP_LOGI(TAG, "sequence: %d transactions in %lld us", _seq_count, esp_timer_get_time() - startTime);
+    }
+}
+
+void EpdSpi::_seqQueue(const uint8_t *data, uint8_t len, epd_spi_dc_t *dc)
+{
+    esp_err_t ret;
+    if (_seq_inflight == EPD_SPI_QUEUE_SIZE) {
+        spi_transaction_t *rt;
+        ret=spi_device_get_trans_result(spi, &rt, portMAX_DELAY);
+        assert(ret==ESP_OK);
+        _seq_inflight--;
+    }
+    spi_transaction_t *t = &_seq_trans[_seq_head];
+    memset(t, 0, sizeof(spi_transaction_t));
+    t->length=len*8;
+    t->user=dc;
+    if (len <= 4) {
+        t->flags=SPI_TRANS_USE_TXDATA;
+        memcpy(t->tx_data, data, len);
+    } else {
+        t->tx_buffer=data;
+    }
+    ret=spi_device_queue_trans(spi, t, portMAX_DELAY);
+    _countTrans(t);
+    assert(ret==ESP_OK);
+    _seq_head = (_seq_head + 1) % EPD_SPI_QUEUE_SIZE;
+    _seq_inflight++;
+    _seq_count++;
+}
+
+void EpdSpi::_seqDrain()
+{
+    spi_transaction_t *rt;
+    while (_seq_inflight) {
+        esp_err_t ret=spi_device_get_trans_result(spi, &rt, portMAX_DELAY);
+        assert(ret==ESP_OK);
+        _seq_inflight--;
+    }
+}
+
+// BUSY edges wake up the task blocked in waitBusy()
+void EpdSpi::_busyInit()
+{
+    if (_busy_sem != nullptr || _config.busy < 0) return;
+    _busy_sem = xSemaphoreCreateBinary();
+    // The ISR service is shared: ESP_ERR_INVALID_STATE means it was already installed
+    esp_err_t ret = gpio_install_isr_service(0);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE(TAG, "gpio_install_isr_service failed: %d. waitBusy will poll", ret);
+        vSemaphoreDelete(_busy_sem);
+        _busy_sem = nullptr;
+        return;
+    }
+    gpio_set_intr_type((gpio_num_t)_config.busy, GPIO_INTR_DISABLE);
+    ESP_ERROR_CHECK(gpio_isr_handler_add((gpio_num_t)_config.busy, EpdSpi::_busyIsr, this));
+}
+
+void IRAM_ATTR EpdSpi::_busyIsr(void *arg)
+{
+    EpdSpi* io = (EpdSpi*) arg;
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(io->_busy_sem, &woken);
+    if (woken == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+/**
+ * @brief Wait until the BUSY GPIO reaches ready_level
+ *        Good display / Waveshare UC81xx controllers: ready when HIGH, SSD16xx: ready when LOW
+ *        The task sleeps on a semaphore given by the BUSY edge interrupt, so there is no polling
+ *        latency and the CPU can go idle (light sleep if power management is enabled) meanwhile.
+ */
+bool EpdSpi::waitBusy(uint8_t ready_level, uint32_t timeout_ms, const char* message)
+{
+    gpio_num_t busy = (gpio_num_t)_config.busy;
+    if (gpio_get_level(busy) == ready_level) return true;
+
+    int64_t time_since_boot = esp_timer_get_time();
+    bool ready = false;
+    if (_busy_sem != nullptr) {
+        xSemaphoreTake(_busy_sem, 0); // Discard an edge from a previous wait
+        gpio_set_intr_type(busy, (ready_level) ? GPIO_INTR_POSEDGE : GPIO_INTR_NEGEDGE);
+        gpio_intr_enable(busy);
+        // BUSY might have been released before the interrupt was armed
+        ready = gpio_get_level(busy) == ready_level;
+        if (!ready) {
+            ready = xSemaphoreTake(_busy_sem, pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
+        }
+        gpio_intr_disable(busy);
+        gpio_set_intr_type(busy, GPIO_INTR_DISABLE);
+        if (!ready) ready = gpio_get_level(busy) == ready_level;
+    } else {
+        while (!(ready = gpio_get_level(busy) == ready_level)) {
+            vTaskDelay(1);
+            if (esp_timer_get_time()-time_since_boot > (int64_t)timeout_ms*1000) break;
+        }
+    }
+
+    if (debug_enabled) {
+        ESP_LOGI(TAG, "waitBusy for %s %s after %lld ms", message, (ready) ? "released" : "timeout",
+                 (esp_timer_get_time()-time_since_boot)/1000);
+    }
+    return ready;
+}
+
 void EpdSpi::reset(uint8_t millis=20) {
-    gpio_set_level((gpio_num_t)CONFIG_EINK_RST, 0);
+    gpio_set_level((gpio_num_t)_config.rst, 0);
     vTaskDelay(millis / portTICK_PERIOD_MS);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_RST, 1);
+    gpio_set_level((gpio_num_t)_config.rst, 1);
     vTaskDelay(millis / portTICK_PERIOD_MS);
 }
 
@@ -170,6 +487,7 @@ void EpdSpi::reset(uint8_t millis=20) {
 void EpdSpi::dataVector(vector<uint8_t> _buffer)
 {
     if (_buffer.size()==0) return;
+    if (_stream_inflight) dataStreamEnd();
 
     if (debug_enabled) {
         ESP_LOGI(TAG,"D");
@@ -184,6 +502,7 @@ void EpdSpi::dataVector(vector<uint8_t> _buffer)
     t.length = _buffer.size()*8;
     t.tx_buffer = _buffer.data();
     ret=spi_device_polling_transmit(spi, &t);
+    _countTrans(&t);
 
     assert(ret==ESP_OK);
 }
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include "epdspibus.h"
+#include "esp_log.h"
+
+static const char* TAG = "EpdSpiBus";
+
+#define EPD_SPI_HOSTS 3
+
+typedef struct {
+    uint8_t users;
+    bool owned;         // Initialized here. A host initialized by the application is never freed
+    int mosi;
+    int miso;
+    int clk;
+    int max_transfer;
+} epd_spi_bus_t;
+
+static epd_spi_bus_t s_bus[EPD_SPI_HOSTS] = {};
+
+static spi_dma_chan_t _dmaChannel(spi_host_device_t host)
+{
+#if defined CONFIG_IDF_TARGET_ESP32
+    return (host == HSPI_HOST) ? 2 : 1;
+#elif defined CONFIG_IDF_TARGET_ESP32S2
+    return (spi_dma_chan_t)host;
+#else
+    // chip only support spi dma channel auto-alloc
+    return SPI_DMA_CH_AUTO;
+#endif
+}
+
+esp_err_t epd_spi_bus_acquire(spi_host_device_t host, int mosi, int miso, int clk, int max_transfer)
+{
+    if (host >= EPD_SPI_HOSTS) return ESP_ERR_INVALID_ARG;
+    epd_spi_bus_t& bus = s_bus[host];
+    if (bus.users == 0) {
+        spi_bus_config_t buscfg={
+            .mosi_io_num=mosi,
+            .miso_io_num=miso,
+            .sclk_io_num=clk,
+            .quadwp_io_num=-1,
+            .quadhd_io_num=-1,
+            .max_transfer_sz=max_transfer
+        };
+        esp_err_t ret = spi_bus_initialize(host, &buscfg, _dmaChannel(host));
+        if (ret == ESP_ERR_INVALID_STATE) {
+            // Its pins are not known: the application is trusted to use the same ones
+            ESP_LOGI(TAG, "SPI host %d was initialized by the application, sharing it", (int)host);
+            bus.owned = false;
+        } else if (ret != ESP_OK) {
+            return ret;
+        } else {
+            bus.owned = true;
+            bus.mosi = mosi;
+            bus.miso = miso;
+            bus.clk = clk;
+            bus.max_transfer = max_transfer;
+        }
+    } else if (bus.owned) {
+        if (mosi != bus.mosi || clk != bus.clk || (miso >= 0 && miso != bus.miso)) {
+            ESP_LOGE(TAG, "SPI host %d runs with MOSI:%d MISO:%d CLK:%d", (int)host, bus.mosi, bus.miso, bus.clk);
+            return ESP_ERR_INVALID_ARG;
+        }
+        if (max_transfer > bus.max_transfer) {
+            ESP_LOGE(TAG, "SPI host %d has transfers of %d bytes, %d needed", (int)host, bus.max_transfer, max_transfer);
+            return ESP_ERR_INVALID_SIZE;
+        }
+    }
+    bus.users++;
+    return ESP_OK;
+}
+
+void epd_spi_bus_release(spi_host_device_t host)
+{
+    if (host >= EPD_SPI_HOSTS || s_bus[host].users == 0) return;
+    epd_spi_bus_t& bus = s_bus[host];
+    if (--bus.users == 0 && bus.owned) {
+        spi_bus_free(host);
+        bus.owned = false;
+    }
+}
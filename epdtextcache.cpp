@@ -0,0 +1,77 @@
+#include "epdtextcache.h"
+#include <stdlib.h>
+#include "esp_log.h"
+
+static const char* TAG = "EpdTextCache";
+
+EpdTextCache::~EpdTextCache()
+{
+  end();
+}
+
+bool EpdTextCache::begin(uint8_t entries)
+{
+  end();
+  if (entries == 0) return false;
+  _entries = (entry_t*)calloc(entries, sizeof(entry_t));
+  if (_entries == nullptr) {
+    ESP_LOGE(TAG, "Not enough memory for %d entries", (int)entries);
+    return false;
+  }
+  _size = entries;
+  _clock = 0;
+  resetStats();
+  return true;
+}
+
+void EpdTextCache::end()
+{
+  free(_entries);
+  _entries = nullptr;
+  _size = 0;
+}
+
+uint32_t EpdTextCache::_hash(const uint8_t* text, size_t len)
+{
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < len; i++) {
+    hash = (hash ^ text[i]) * 16777619u;
+  }
+  return hash;
+}
+
+bool EpdTextCache::find(const GFXfont* font, uint8_t size_x, uint8_t size_y, const uint8_t* text, size_t len,
+                        epd_text_bounds_t* bounds)
+{
+  uint32_t hash = _hash(text, len);
+  for (uint8_t i = 0; i < _size; i++) {
+    entry_t& e = _entries[i];
+    if (e.used != 0 && e.hash == hash && e.len == len && e.font == font &&
+        e.size_x == size_x && e.size_y == size_y) {
+      e.used = ++_clock;
+      *bounds = e.bounds;
+      _stats.hits++;
+      return true;
+    }
+  }
+  _stats.misses++;
+  return false;
+}
+
+void EpdTextCache::insert(const GFXfont* font, uint8_t size_x, uint8_t size_y, const uint8_t* text, size_t len,
+                          const epd_text_bounds_t& bounds)
+{
+  if (len > UINT16_MAX) return;
+  // Free entry or the least recently used
+  entry_t* victim = &_entries[0];
+  for (uint8_t i = 0; i < _size && victim->used != 0; i++) {
+    if (_entries[i].used < victim->used) victim = &_entries[i];
+  }
+  victim->font = font;
+  victim->hash = _hash(text, len);
+  victim->len = len;
+  victim->size_x = size_x;
+  victim->size_y = size_y;
+  victim->bounds = bounds;
+  victim->used = ++_clock;
+}
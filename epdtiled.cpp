@@ -0,0 +1,200 @@
+#include "epdtiled.h"
+
+EpdTiled::EpdTiled(const epd_tile_t* tiles, uint8_t count):
+  Adafruit_GFX(_canvasWidth(tiles, count), _canvasHeight(tiles, count)),
+  Epd(_canvasWidth(tiles, count), _canvasHeight(tiles, count))
+{
+  if (count > EPD_TILED_MAX_TILES) {
+    ESP_LOGE(TAG, "%d tiles, only the first %d are used", (int)count, EPD_TILED_MAX_TILES);
+    count = EPD_TILED_MAX_TILES;
+  }
+  memcpy(_tiles, tiles, count * sizeof(epd_tile_t));
+  _count = count;
+  printf("EpdTiled() %d tiles in a %dx%d canvas\n", (int)_count, (int)WIDTH, (int)HEIGHT);
+  // Nothing is known about the panels yet
+  markAll();
+}
+
+EpdTiled::~EpdTiled()
+{
+  // _updateFinish() waits for the tiles
+  _asyncStop();
+}
+
+int16_t EpdTiled::_canvasWidth(const epd_tile_t* tiles, uint8_t count)
+{
+  int16_t w = 0;
+  for (uint8_t i = 0; i < count && i < EPD_TILED_MAX_TILES; i++) {
+    int16_t right = tiles[i].x + tiles[i].epd->width();
+    if (right > w) w = right;
+  }
+  return w;
+}
+
+int16_t EpdTiled::_canvasHeight(const epd_tile_t* tiles, uint8_t count)
+{
+  int16_t h = 0;
+  for (uint8_t i = 0; i < count && i < EPD_TILED_MAX_TILES; i++) {
+    int16_t bottom = tiles[i].y + tiles[i].epd->height();
+    if (bottom > h) h = bottom;
+  }
+  return h;
+}
+
+void EpdTiled::init(bool debug)
+{
+  debug_enabled = debug;
+  for (uint8_t i = 0; i < _count; i++) {
+    _tiles[i].epd->init(debug);
+  }
+}
+
+void EpdTiled::drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+  if ((x < 0) || (x >= width()) || (y < 0) || (y >= height())) return;
+  switch (getRotation())
+  {
+    case 1:
+      swap(x, y);
+      x = WIDTH - x - 1;
+      break;
+    case 2:
+      x = WIDTH - x - 1;
+      y = HEIGHT - y - 1;
+      break;
+    case 3:
+      swap(x, y);
+      y = HEIGHT - y - 1;
+      break;
+  }
+  for (uint8_t n = 0; n < _count; n++) {
+    uint8_t i = (_last + n) % _count;
+    epd_tile_t& tile = _tiles[i];
+    int16_t tx = x - tile.x;
+    int16_t ty = y - tile.y;
+    if (tx < 0 || ty < 0 || tx >= tile.epd->width() || ty >= tile.epd->height()) continue;
+    tile.epd->drawPixel(tx, ty, color);
+    _changed |= 1UL << i;
+    _last = i;
+    return;
+  }
+  // Between tiles: there is no panel there
+}
+
+void EpdTiled::fillScreen(uint16_t color)
+{
+  for (uint8_t i = 0; i < _count; i++) {
+    _tiles[i].epd->fillScreen(color);
+  }
+  markAll();
+}
+
+void EpdTiled::_fill(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+{
+  if (w <= 0 || h <= 0) return;
+  // Clip in rotated coordinates
+  if (x < 0) { w += x; x = 0; }
+  if (y < 0) { h += y; y = 0; }
+  if (x + w > width()) w = width() - x;
+  if (y + h > height()) h = height() - y;
+  if (w <= 0 || h <= 0) return;
+
+  // Same transformation as drawPixel, applied once to the rectangle
+  int16_t t;
+  switch (getRotation()) {
+    case 1:
+      t = x;
+      x = WIDTH - y - h;
+      y = t;
+      swap(w, h);
+      break;
+    case 2:
+      x = WIDTH - x - w;
+      y = HEIGHT - y - h;
+      break;
+    case 3:
+      t = y;
+      y = HEIGHT - x - w;
+      x = t;
+      swap(w, h);
+      break;
+  }
+
+  for (uint8_t i = 0; i < _count; i++) {
+    epd_tile_t& tile = _tiles[i];
+    int16_t tw = tile.epd->width();
+    int16_t th = tile.epd->height();
+    int16_t x0 = (x > tile.x) ? x : tile.x;
+    int16_t y0 = (y > tile.y) ? y : tile.y;
+    int16_t x1 = (x + w < tile.x + tw) ? x + w : tile.x + tw;
+    int16_t y1 = (y + h < tile.y + th) ? y + h : tile.y + th;
+    if (x0 >= x1 || y0 >= y1) continue;
+    if (x1 - x0 == tw && y1 - y0 == th) {
+      // The model clears its whole buffer faster
+      tile.epd->fillScreen(color);
+    } else {
+      tile.epd->fillRect(x0 - tile.x, y0 - tile.y, x1 - x0, y1 - y0, color);
+    }
+    _changed |= 1UL << i;
+  }
+}
+
+void EpdTiled::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color){
+  _fill(x, y, w, h, color);
+}
+
+void EpdTiled::writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color){
+  _fill(x, y, w, h, color);
+}
+
+void EpdTiled::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color){
+  _fill(x, y, w, 1, color);
+}
+
+void EpdTiled::writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color){
+  _fill(x, y, w, 1, color);
+}
+
+void EpdTiled::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color){
+  _fill(x, y, 1, h, color);
+}
+
+void EpdTiled::writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color){
+  _fill(x, y, 1, h, color);
+}
+
+void EpdTiled::update()
+{
+  _updateBegin();
+  _updateFinish();
+}
+
+// Every changed tile gets its buffer and starts to refresh before the next one is sent
+void EpdTiled::_updateBegin()
+{
+  _updating = _changed;
+  _changed = 0;
+  for (uint8_t i = 0; i < _count; i++) {
+    if (!(_updating & (1UL << i))) continue;
+    if (debug_enabled) printf("EpdTiled: update of tile %d\n", (int)i);
+    _tiles[i].epd->updateAsync();
+  }
+}
+
+void EpdTiled::_updateFinish()
+{
+  for (uint8_t i = 0; i < _count; i++) {
+    if (_updating & (1UL << i)) _tiles[i].epd->waitForUpdate();
+  }
+  _updating = 0;
+}
+
+void EpdTiled::updateDirty(uint8_t full_update_percent)
+{
+  for (uint8_t i = 0; i < _count; i++) {
+    if (!(_changed & (1UL << i))) continue;
+    if (debug_enabled) printf("EpdTiled: updateDirty of tile %d\n", (int)i);
+    _tiles[i].epd->updateDirty(full_update_percent);
+  }
+  _changed = 0;
+}
@@ -0,0 +1,117 @@
+#include "epdutf8.h"
+#include "esp_log.h"
+
+static const char* TAG = "EpdUtf8";
+
+#define UTF8_ACCEPT 0
+#define UTF8_REJECT 12
+
+// Copyright (c) 2008-2009 Bjoern Hoehrmann <bjoern@hoehrmann.de>
+// See http://bjoern.hoehrmann.de/utf-8/decoder/dfa/ for details (MIT license)
+static const uint8_t utf8d[] = {
+  // Byte to character class
+   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,
+   1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,9,
+   7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,
+   8,8,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,2,
+  10,3,3,3,3,3,3,3,3,3,3,3,3,4,3,3, 11,6,6,6,5,8,8,8,8,8,8,8,8,8,8,8,
+  // State and character class to next state
+   0,12,24,36,60,96,84,12,12,12,48,72, 12,12,12,12,12,12,12,12,12,12,12,12,
+  12, 0,12,12,12,12,12, 0,12, 0,12,12, 12,24,12,12,12,12,12,24,12,24,12,12,
+  12,12,12,12,12,12,12,24,12,12,12,12, 12,24,12,12,12,12,12,12,12,24,12,12,
+  12,12,12,12,12,12,12,36,12,36,12,12, 12,36,12,12,12,12,12,36,12,36,12,12,
+  12,36,12,12,12,12,12,12,12,12,12,12,
+};
+
+// U+0080..U+00FF in the classic font, that is code page 437. write() skips glyph 176 of it unless
+// cp437(true) was called, so the glyphs after it are one lower
+static const uint8_t s_cp437[128] = {
+  '?', '?', '?', '?', '?', '?', '?', '?', '?', '?', '?', '?', '?', '?', '?', '?',
+  '?', '?', '?', '?', '?', '?', '?', '?', '?', '?', '?', '?', '?', '?', '?', '?',
+  0xFE, 0xAD, 0x9B, 0x9C, '?', 0x9D, '?', '?', '?', '?', 0xA6, 0xAE, 0xAA, '?', '?', '?',
+  0xF7, 0xF0, 0xFC, '?', '?', 0xE5, '?', 0xF9, '?', '?', 0xA7, 0xAF, 0xAC, 0xAB, '?', 0xA8,
+  '?', '?', '?', '?', 0x8E, 0x8F, 0x92, 0x80, '?', 0x90, '?', '?', '?', '?', '?', '?',
+  '?', 0xA5, '?', '?', '?', '?', 0x99, '?', '?', '?', '?', '?', 0x9A, '?', '?', 0xE0,
+  0x85, 0xA0, 0x83, '?', 0x84, 0x86, 0x91, 0x87, 0x8A, 0x82, 0x88, 0x89, 0x8D, 0xA1, 0x8C, 0x8B,
+  '?', 0xA4, 0x95, 0xA2, 0x93, '?', 0x94, 0xF5, '?', 0x97, 0xA3, 0x96, 0x81, '?', '?', 0x98,
+};
+
+typedef struct {
+    const GFXfont* font;
+    const epd_glyph_map_t* map;
+    uint16_t size;
+} font_map_t;
+
+static font_map_t s_maps[EPD_UTF8_FONT_MAPS];
+static uint8_t s_map_count = 0;
+
+bool EpdUtf8::setFontMap(const GFXfont* font, const epd_glyph_map_t* map, uint16_t size)
+{
+  for (uint8_t i = 0; i < s_map_count; i++) {
+    if (s_maps[i].font == font) {
+      s_maps[i].map = map;
+      s_maps[i].size = size;
+      return true;
+    }
+  }
+  if (s_map_count == EPD_UTF8_FONT_MAPS) {
+    ESP_LOGE(TAG, "No room for another font map. Increase EPD_UTF8_FONT_MAPS");
+    return false;
+  }
+  s_maps[s_map_count++] = {font, map, size};
+  return true;
+}
+
+uint8_t EpdUtf8::_lookup(const GFXfont* font, uint32_t codepoint)
+{
+  for (uint8_t i = 0; i < s_map_count; i++) {
+    if (s_maps[i].font != font) continue;
+    // Binary search, the map is sorted
+    const epd_glyph_map_t* map = s_maps[i].map;
+    int32_t lo = 0;
+    int32_t hi = (int32_t)s_maps[i].size - 1;
+    while (lo <= hi) {
+      int32_t mid = (lo + hi) / 2;
+      if (map[mid].codepoint == codepoint) return map[mid].c;
+      if (map[mid].codepoint < codepoint) {
+        lo = mid + 1;
+      } else {
+        hi = mid - 1;
+      }
+    }
+    break;
+  }
+  if (codepoint > 0xFF) return EPD_UTF8_MISSING;
+  if (font == nullptr && codepoint >= 0x80) return s_cp437[codepoint - 0x80];
+  // Latin-1 is in place, write() skips the characters the font does not have
+  return codepoint;
+}
+
+size_t EpdUtf8::decode(const GFXfont* font, const char* text, size_t len, uint8_t* out)
+{
+  size_t count = 0;
+  for (size_t i = 0; i < len; i++) {
+    uint8_t byte = text[i];
+    // ASCII outside a sequence: most of the text
+    if (byte < 0x80 && _state == UTF8_ACCEPT) {
+      out[count++] = byte;
+      continue;
+    }
+    uint32_t type = utf8d[byte];
+    _codepoint = (_state != UTF8_ACCEPT) ? (byte & 0x3Fu) | (_codepoint << 6) : (0xFFu >> type) & byte;
+    uint32_t previous = _state;
+    _state = utf8d[256 + _state + type];
+    if (_state == UTF8_ACCEPT) {
+      out[count++] = (s_map_count == 0 && font != nullptr && _codepoint <= 0xFF) ? _codepoint : _lookup(font, _codepoint);
+    } else if (_state == UTF8_REJECT) {
+      out[count++] = EPD_UTF8_MISSING;
+      _state = UTF8_ACCEPT;
+      // The byte that broke a sequence can start the next one
+      if (previous != UTF8_ACCEPT) i--;
+    }
+  }
+  return count;
+}
@@ -0,0 +1,105 @@
+// Host build: Runs EpdBench for every model, or the ones given, and prints one line per test
+//   calepd_bench [--speed N] [--tests MASK] [--verbose] [model ...]
+//
+// Each model runs in its own process since the SPI bus is initialized once per program.
+// Simulated time runs at speed 1 by default so the timings are real host timings.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <vector>
+#include "models.h"
+#include "epd_sim.h"
+
+static FILE* s_results = stdout;
+
+static void sim_stats(epd_spi_stats_t* stats, void* arg) {
+  (void)arg;
+  epd_sim_stats_t sim;
+  epd_sim_get_stats(&sim);
+  stats->transactions = sim.transactions;
+  stats->bytes = (uint32_t)sim.bytes;
+}
+
+static void report(const epd_bench_result_t* r, void* arg) {
+  (void)arg;
+  double ops_s = (r->time_us > 0) ? (double)r->ops * 1000000 / r->time_us : 0;
+  fprintf(s_results, "%-16s %-24s %9u ops %10.2f ms %12.0f ops/s %7u trans %9u bytes %9u heap\n",
+          r->model, r->test, r->ops, r->time_us / 1000.0, ops_s, r->transactions, r->bytes, r->heap_peak);
+  fflush(s_results);
+}
+
+static int run_model(const host_model_t* model, uint8_t tests, bool verbose) {
+  fflush(stdout);
+  pid_t pid = fork();
+  if (pid < 0) {
+    perror("fork");
+    return 1;
+  }
+  if (pid == 0) {
+    // The models print their own STATS. Results go to the original stdout
+    s_results = fdopen(dup(STDOUT_FILENO), "w");
+    if (!verbose) {
+      int null_fd = open("/dev/null", O_WRONLY);
+      dup2(null_fd, STDOUT_FILENO);
+      close(null_fd);
+    }
+    HostDisplay* display = host_model_create(model);
+    display->init(false);
+    EpdBench bench(model->name, model->white);
+    bench.setIoStats(sim_stats, nullptr);
+    bench.setReport(report, nullptr);
+    display->bench(bench, tests);
+    fflush(stdout);
+    fflush(s_results);
+    _exit(0);
+  }
+  int status = 0;
+  waitpid(pid, &status, 0);
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    fprintf(stderr, "%s: benchmark failed (status %d)\n", model->name, status);
+    return 1;
+  }
+  return 0;
+}
+
+static void add_model(const host_model_t* model, void* arg) {
+  ((std::vector<const host_model_t*>*)arg)->push_back(model);
+}
+
+int main(int argc, char** argv) {
+  uint32_t speed = 1;
+  uint8_t tests = EPD_BENCH_ALL;
+  bool verbose = false;
+  std::vector<const host_model_t*> models;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+      speed = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--tests") == 0 && i + 1 < argc) {
+      tests = strtol(argv[++i], nullptr, 0);
+    } else if (strcmp(argv[i], "--verbose") == 0) {
+      verbose = true;
+    } else if (argv[i][0] == '-') {
+      printf("Usage: %s [--speed N] [--tests MASK] [--verbose] [model ...]\n", argv[0]);
+      return 1;
+    } else {
+      const host_model_t* model = host_model_find(argv[i]);
+      if (model == nullptr) {
+        printf("Model %s is not in the host build. Use calepd_trace --list\n", argv[i]);
+        return 1;
+      }
+      models.push_back(model);
+    }
+  }
+  if (models.empty()) host_model_each(add_model, &models);
+
+  epd_sim_set_speed(speed);
+  int failed = 0;
+  for (const host_model_t* model : models) {
+    failed += run_model(model, tests, verbose);
+  }
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,54 @@
+/* Host build: Control of the simulated hardware
+ *
+ * Time runs `speed` times faster than the wall clock so vTaskDelay and the BUSY line
+ * do not slow down traces and benchmarks. The BUSY pins go to the busy level when the
+ * controller receives a command with a busy time (see epd_sim_set_busy_time) and return
+ * to the ready level, firing the GPIO interrupt, when that time has passed.
+ *
+ * A trace records every SPI transaction and every output GPIO change (except DC and CS)
+ * without timestamps, so two runs of the same code produce the same file:
+ *
+ *   C 12          Command byte (DC low)
+ *   D 4 00ff00ff  Data transaction: length and bytes in hex
+ *   G 26 0        GPIO level change
+ */
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include "driver/gpio.h"
+
+typedef struct {
+    uint32_t transactions;
+    uint32_t commands;
+    uint64_t bytes;        // Command and data bytes
+    uint64_t wire_us;      // Time these bytes need on the bus at the configured clock
+    uint32_t busy_events;  // Commands that set BUSY
+} epd_sim_stats_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+// Simulated time runs this many times faster than real time. Default 10
+void epd_sim_set_speed(uint32_t speed);
+
+// BUSY pins and the level they report when the controller is ready. Default: CONFIG_EINK_BUSY, ready HIGH
+void epd_sim_clear_busy_pins(void);
+void epd_sim_add_busy_pin(gpio_num_t pin, uint8_t ready_level);
+// BUSY of the controller behind chip select cs: only commands sent to that device set it, with its own
+// timer, so several displays refresh at the same time. Pins not linked are set by every command
+void epd_sim_link_busy_pin(gpio_num_t pin, gpio_num_t cs);
+// Milliseconds (simulated) BUSY stays active after the command. Use 0 to remove it
+void epd_sim_set_busy_time(uint8_t cmd, uint32_t ms);
+// Transactions sent while any of this pins is LOW are commands. Default: CONFIG_EINK_DC, M1S1 and M2S2 DC
+void epd_sim_add_dc_pin(gpio_num_t pin);
+// Byte received on every SPI read. Default 0xFF (MISO floats HIGH)
+void epd_sim_set_miso(uint8_t value);
+
+void epd_sim_get_stats(epd_sim_stats_t* stats);
+void epd_sim_reset_stats(void);
+
+// Writes the trace to file (NULL stops tracing). The file is not closed by the simulator
+void epd_sim_trace(FILE* file);
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,6 @@
+// Host build: Memory placement attributes do nothing
+#pragma once
+#define DRAM_ATTR
+#define IRAM_ATTR
+#define EXT_RAM_ATTR
+#define RTC_DATA_ATTR
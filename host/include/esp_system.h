@@ -0,0 +1,15 @@
+// Host build
+#pragma once
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_idf_version.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+uint32_t esp_get_free_heap_size(void);
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,8 @@
+// Host build: There is no watchdog
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+static inline esp_err_t esp_task_wdt_init(uint32_t timeout, bool panic) { (void)timeout; (void)panic; return ESP_OK; }
+static inline esp_err_t esp_task_wdt_reset(void) { return ESP_OK; }
@@ -0,0 +1,11 @@
+// Host build: Simulated time since start in microseconds (see epd_sim_set_speed)
+#pragma once
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+int64_t esp_timer_get_time(void);
+#ifdef __cplusplus
+}
+#endif
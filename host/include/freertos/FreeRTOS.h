@@ -0,0 +1,31 @@
+// Host build: FreeRTOS API implemented with std::thread in host/sim/freertos_sim.cpp
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include "esp_system.h"
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE  1
+#define pdPASS  pdTRUE
+#define pdFAIL  pdFALSE
+
+// Same as the ESP-IDF default
+#define configTICK_RATE_HZ 100
+#define portTICK_PERIOD_MS (1000 / configTICK_RATE_HZ)
+#define portMAX_DELAY      ((TickType_t)0xffffffffUL)
+#define pdMS_TO_TICKS(ms)  ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+#define portYIELD_FROM_ISR(...) do { } while (0)
+#define tskNO_AFFINITY     0x7FFFFFFF
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+size_t xPortGetFreeHeapSize(void);
+#ifdef __cplusplus
+}
+#endif
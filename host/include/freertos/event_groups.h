@@ -0,0 +1,20 @@
+// Host build
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+typedef void *EventGroupHandle_t;
+typedef uint32_t EventBits_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+EventGroupHandle_t xEventGroupCreate(void);
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, const EventBits_t bits);
+BaseType_t xEventGroupSetBitsFromISR(EventGroupHandle_t group, const EventBits_t bits, BaseType_t *higher_priority_task_woken);
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, const EventBits_t bits);
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group);
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, const EventBits_t bits, const BaseType_t clear_on_exit, const BaseType_t wait_for_all, TickType_t ticks);
+void vEventGroupDelete(EventGroupHandle_t group);
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,18 @@
+// Host build
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+typedef void *QueueHandle_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks);
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void *item, BaseType_t *higher_priority_task_woken);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+void vQueueDelete(QueueHandle_t queue);
+#ifdef __cplusplus
+}
+#endif
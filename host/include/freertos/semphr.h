@@ -0,0 +1,19 @@
+// Host build
+#pragma once
+#include "freertos/FreeRTOS.h"
+
+typedef void *SemaphoreHandle_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t *higher_priority_task_woken);
+void vSemaphoreDelete(SemaphoreHandle_t semaphore);
+#ifdef __cplusplus
+}
+#endif
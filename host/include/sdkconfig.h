@@ -0,0 +1,66 @@
+// Host build: Same defaults as Kconfig.projbuild. Override them with -D in CMake if needed
+#pragma once
+#define CONFIG_IDF_TARGET_ESP32 1
+
+#ifndef CONFIG_EINK_SPI_MOSI
+#define CONFIG_EINK_SPI_MOSI 23
+#endif
+#ifndef CONFIG_EINK_SPI_CLK
+#define CONFIG_EINK_SPI_CLK 18
+#endif
+#ifndef CONFIG_EINK_SPI_CS
+#define CONFIG_EINK_SPI_CS 32
+#endif
+#ifndef CONFIG_EINK_DC
+#define CONFIG_EINK_DC 27
+#endif
+#ifndef CONFIG_EINK_RST
+#define CONFIG_EINK_RST 26
+#endif
+#ifndef CONFIG_EINK_BUSY
+#define CONFIG_EINK_BUSY 35
+#endif
+#ifndef CONFIG_EINK_SPI_CS2
+#define CONFIG_EINK_SPI_CS2 4
+#endif
+#ifndef CONFIG_EINK_SPI_MISO
+#define CONFIG_EINK_SPI_MISO 19
+#endif
+
+// Wave12I48 4 SPI
+#ifndef CONFIG_EINK_SPI_M1_CS
+#define CONFIG_EINK_SPI_M1_CS 23
+#endif
+#ifndef CONFIG_EINK_SPI_S1_CS
+#define CONFIG_EINK_SPI_S1_CS 22
+#endif
+#ifndef CONFIG_EINK_SPI_M2_CS
+#define CONFIG_EINK_SPI_M2_CS 16
+#endif
+#ifndef CONFIG_EINK_SPI_S2_CS
+#define CONFIG_EINK_SPI_S2_CS 19
+#endif
+#ifndef CONFIG_EINK_SPI_M1_BUSY
+#define CONFIG_EINK_SPI_M1_BUSY 32
+#endif
+#ifndef CONFIG_EINK_SPI_S1_BUSY
+#define CONFIG_EINK_SPI_S1_BUSY 26
+#endif
+#ifndef CONFIG_EINK_SPI_M2_BUSY
+#define CONFIG_EINK_SPI_M2_BUSY 18
+#endif
+#ifndef CONFIG_EINK_SPI_S2_BUSY
+#define CONFIG_EINK_SPI_S2_BUSY 4
+#endif
+#ifndef CONFIG_EINK_M1S1_DC
+#define CONFIG_EINK_M1S1_DC 25
+#endif
+#ifndef CONFIG_EINK_M2S2_DC
+#define CONFIG_EINK_M2S2_DC 17
+#endif
+#ifndef CONFIG_EINK_M1S1_RST
+#define CONFIG_EINK_M1S1_RST 33
+#endif
+#ifndef CONFIG_EINK_M2S2_RST
+#define CONFIG_EINK_M2S2_RST 5
+#endif
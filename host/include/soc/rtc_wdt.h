@@ -0,0 +1,3 @@
+// Host build: There is no watchdog
+#pragma once
+static inline void rtc_wdt_feed(void) {}
@@ -0,0 +1,37 @@
+// Host build: Model lookup
+#include <string.h>
+#include "models.h"
+#include "epd_sim.h"
+
+static const host_model_t* const s_lists[] = {
+  host_models_epd,
+  host_models_epd_grays,
+  host_models_gdew075T7Grays,
+  host_models_epd_color,
+  host_models_7color,
+  host_models_plasticlogic
+};
+
+void host_model_each(void (*fn)(const host_model_t* model, void* arg), void* arg) {
+  for (const host_model_t* list : s_lists) {
+    for (const host_model_t* m = list; m->name != nullptr; m++) {
+      fn(m, arg);
+    }
+  }
+}
+
+const host_model_t* host_model_find(const char* name) {
+  for (const host_model_t* list : s_lists) {
+    for (const host_model_t* m = list; m->name != nullptr; m++) {
+      if (strcasecmp(m->name, name) == 0) return m;
+    }
+  }
+  return nullptr;
+}
+
+HostDisplay* host_model_create(const host_model_t* model) {
+  epd_sim_clear_busy_pins();
+  epd_sim_add_busy_pin((gpio_num_t)CONFIG_EINK_BUSY, model->busy_ready_level);
+  if (model->sim_setup != nullptr) model->sim_setup();
+  return model->create();
+}
@@ -0,0 +1,83 @@
+/* Host build: Registry of the display models compiled for the host
+ *
+ * epd.h and epd7color.h share the include guard so each family is registered
+ * from its own translation unit (models_epd*.cpp, models_7color.cpp, models_plasticlogic.cpp).
+ * The Epd models are split further by the macros their headers define (EPD_WHITE,
+ * IS_COLOR_EPD, buffer sizes) so no translation unit redefines them
+ */
+#pragma once
+#include <stdint.h>
+#include <string>
+#include <type_traits>
+#include <Adafruit_GFX.h>
+#include <epdbench.h>
+
+class HostDisplay
+{
+  public:
+    virtual ~HostDisplay() {}
+    virtual Adafruit_GFX& gfx() = 0;
+    virtual void init(bool debug) = 0;
+    virtual void print(const std::string& text) = 0;
+    virtual void update() = 0;
+    virtual void bench(EpdBench& bench, uint8_t tests) = 0;
+};
+
+// Specialize for models that declare updateWindow() without implementing it
+template <class Model> struct HostNoUpdateWindow { static const bool value = false; };
+
+template <class Model, class IOClass> class HostDisplayModel : public HostDisplay
+{
+  public:
+    HostDisplayModel() : _epd(_io) {}
+    Adafruit_GFX& gfx() { return _epd; }
+    void init(bool debug) { _epd.init(debug); }
+    void print(const std::string& text) { _epd.print(text); }
+    void update() { _epd.update(); }
+    void bench(EpdBench& bench, uint8_t tests) {
+      _setUpdateWindow(bench, _epd, 0);
+      bench.run(_epd, tests);
+    }
+
+  private:
+    // Most models have updateWindow(x, y, w, h, using_rotation). The others run the benchmark without it
+    template <class M> static auto _setUpdateWindow(EpdBench& bench, M& epd, int)
+        -> typename std::enable_if<!HostNoUpdateWindow<M>::value, decltype(epd.updateWindow(0, 0, 1, 1, true), void())>::type {
+      bench.setUpdateWindow([](void* d, int16_t x, int16_t y, uint16_t w, uint16_t h) {
+        ((M*)d)->updateWindow(x, y, w, h, true);
+      });
+    }
+    template <class M> static void _setUpdateWindow(EpdBench&, M&, long) {}
+
+    IOClass _io;
+    Model _epd;
+};
+
+typedef struct {
+    const char* name;
+    // EPD_WHITE of the model family (Plasticlogic uses 2 bits per pixel)
+    uint16_t white;
+    // BUSY level when the controller is ready
+    uint8_t busy_ready_level;
+    HostDisplay* (*create)();
+    // Optional: Extra simulator setup (BUSY pins of multi panel displays)
+    void (*sim_setup)();
+} host_model_t;
+
+#define HOST_MODEL(name, model, io, ready_level, setup) \
+    { name, EPD_WHITE, ready_level, []() -> HostDisplay* { return new HostDisplayModel<model, io>(); }, setup }
+
+// Each list ends with an entry where name is NULL
+extern const host_model_t host_models_epd[];
+extern const host_model_t host_models_epd_grays[];
+extern const host_model_t host_models_gdew075T7Grays[];
+extern const host_model_t host_models_epd_color[];
+extern const host_model_t host_models_7color[];
+extern const host_model_t host_models_plasticlogic[];
+
+// Searches all lists. Returns NULL if the model is not compiled
+const host_model_t* host_model_find(const char* name);
+// Calls fn for every model
+void host_model_each(void (*fn)(const host_model_t* model, void* arg), void* arg);
+// Configures the simulated BUSY pins for the model and creates it
+HostDisplay* host_model_create(const host_model_t* model);
@@ -0,0 +1,14 @@
+// Host build: Models that extend Epd7Color
+#include "models.h"
+#include <epd7color.h>
+#include <epdspi.h>
+#include "color/gdey073d46.h"
+#include "color/wave4i7Color.h"
+#include "color/wave5i7Color.h"
+
+const host_model_t host_models_7color[] = {
+  HOST_MODEL("gdey073d46", gdey073d46, EpdSpi, 1, nullptr),
+  HOST_MODEL("Wave4i7Color", Wave4i7Color, EpdSpi, 1, nullptr),
+  HOST_MODEL("Wave5i7Color", Wave5i7Color, EpdSpi, 1, nullptr),
+  {nullptr, 0, 0, nullptr, nullptr}
+};
@@ -0,0 +1,51 @@
+// Host build: Models that extend Epd and use the colors of gdew_colors.h
+#include "models.h"
+#include "epd_sim.h"
+#include <epd.h>
+#include <epdspi.h>
+#include <epd4spi.h>
+#include "custom/custom042.h"
+#include "gdeh0213b73.h"
+#include "goodisplay/gdey075T7.h"
+#include "goodisplay/gdey0583T81.h"
+#include "gdew075HD.h"
+#include "gdew075T7.h"
+#include "gdew075T8.h"
+#include "gdew0583t7.h"
+#include "gdew042t2.h"
+#include "gdew027w3.h"
+#include "gdew0213i5f.h"
+#include "gdep015OC1.h"
+#include "gdeh0154d67.h"
+#include "heltec0151.h"
+#include "wave12i48.h"
+
+template <> struct HostNoUpdateWindow<Wave12I48> { static const bool value = true; };
+
+// The 4 panels have their own BUSY line
+static void wave12i48_setup() {
+  epd_sim_clear_busy_pins();
+  epd_sim_add_busy_pin((gpio_num_t)CONFIG_EINK_SPI_M1_BUSY, 1);
+  epd_sim_add_busy_pin((gpio_num_t)CONFIG_EINK_SPI_S1_BUSY, 1);
+  epd_sim_add_busy_pin((gpio_num_t)CONFIG_EINK_SPI_M2_BUSY, 1);
+  epd_sim_add_busy_pin((gpio_num_t)CONFIG_EINK_SPI_S2_BUSY, 1);
+}
+
+const host_model_t host_models_epd[] = {
+  HOST_MODEL("Custom042", Custom042, EpdSpi, 1, nullptr),
+  HOST_MODEL("Gdeh0213b73", Gdeh0213b73, EpdSpi, 0, nullptr),
+  HOST_MODEL("Gdey075T7", Gdey075T7, EpdSpi, 1, nullptr),
+  HOST_MODEL("Gdey0583T81", Gdey0583T81, EpdSpi, 1, nullptr),
+  HOST_MODEL("Gdew075HD", Gdew075HD, EpdSpi, 0, nullptr),
+  HOST_MODEL("Gdew075T7", Gdew075T7, EpdSpi, 1, nullptr),
+  HOST_MODEL("Gdew075T8", Gdew075T8, EpdSpi, 1, nullptr),
+  HOST_MODEL("Gdew0583T7", Gdew0583T7, EpdSpi, 1, nullptr),
+  HOST_MODEL("Gdew042t2", Gdew042t2, EpdSpi, 1, nullptr),
+  HOST_MODEL("Gdew027w3", Gdew027w3, EpdSpi, 1, nullptr),
+  HOST_MODEL("Gdew0213i5f", Gdew0213i5f, EpdSpi, 1, nullptr),
+  HOST_MODEL("Gdep015OC1", Gdep015OC1, EpdSpi, 0, nullptr),
+  HOST_MODEL("Gdeh0154d67", Gdeh0154d67, EpdSpi, 0, nullptr),
+  HOST_MODEL("Hel0151", Hel0151, EpdSpi, 0, nullptr),
+  HOST_MODEL("Wave12I48", Wave12I48, Epd4Spi, 1, wave12i48_setup),
+  {nullptr, 0, 0, nullptr, nullptr}
+};
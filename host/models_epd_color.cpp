@@ -0,0 +1,28 @@
+// Host build: 3 color models that extend Epd (IS_COLOR_EPD is true)
+#include "models.h"
+#include <epd.h>
+#include <epdspi.h>
+#include "color/gdew027c44.h"
+#include "color/gdeh0154z90.h"
+#include "color/gdew0583z21.h"
+#include "color/gdew0583z83.h"
+#include "color/gdew075z09.h"
+#include "color/gdew075c64.h"
+#include "color/gdeh042Z96.h"
+#include "color/gdeh042Z21.h"
+#include "color/gdeq042Z21.h"
+#include "color/dke/dke075z83.h"
+
+const host_model_t host_models_epd_color[] = {
+  HOST_MODEL("Gdew027c44", Gdew027c44, EpdSpi, 1, nullptr),
+  HOST_MODEL("Gdeh0154z90", Gdeh0154z90, EpdSpi, 0, nullptr),
+  HOST_MODEL("Gdew0583z21", Gdew0583z21, EpdSpi, 1, nullptr),
+  HOST_MODEL("Gdew0583z83", Gdew0583z83, EpdSpi, 1, nullptr),
+  HOST_MODEL("Gdew075z09", Gdew075z09, EpdSpi, 1, nullptr),
+  HOST_MODEL("Gdew075C64", Gdew075C64, EpdSpi, 1, nullptr),
+  HOST_MODEL("Gdeh042Z96", Gdeh042Z96, EpdSpi, 0, nullptr),
+  HOST_MODEL("Gdeh042Z21", Gdeh042Z21, EpdSpi, 1, nullptr),
+  HOST_MODEL("Gdeq042Z21", Gdeq042Z21, EpdSpi, 1, nullptr),
+  HOST_MODEL("Dke075Z83", Dke075Z83, EpdSpi, 1, nullptr),
+  {nullptr, 0, 0, nullptr, nullptr}
+};
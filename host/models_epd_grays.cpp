@@ -0,0 +1,28 @@
+// Host build: Models that extend Epd and use the 4 gray levels of gdew_4grays.h
+#include "models.h"
+#include <epd.h>
+#include <epdspi.h>
+#include "goodisplay/gdey0213b74.h"
+#include "goodisplay/gdey0154d67.h"
+#include "goodisplay/gdey029T94.h"
+#include "goodisplay/gdey027T91.h"
+#include "goodisplay/gdeq037T31.h"
+#include "dke/depg1020bn.h"
+#include "dke/depg750bn.h"
+#include "gdew042t2Grays.h"
+#include "gdem029E97.h"
+#include "small/gdew0102I3F.h"
+
+const host_model_t host_models_epd_grays[] = {
+  HOST_MODEL("Gdey0213b74", Gdey0213b74, EpdSpi, 0, nullptr),
+  HOST_MODEL("Gdey0154d67", Gdey0154d67, EpdSpi, 0, nullptr),
+  HOST_MODEL("Gdey029T94", Gdey029T94, EpdSpi, 0, nullptr),
+  HOST_MODEL("Gdey027T91", Gdey027T91, EpdSpi, 0, nullptr),
+  HOST_MODEL("Gdeq037T31", Gdeq037T31, EpdSpi, 0, nullptr),
+  HOST_MODEL("Depg1020bn", Depg1020bn, EpdSpi, 0, nullptr),
+  HOST_MODEL("Depg750bn", Depg750bn, EpdSpi, 1, nullptr),
+  HOST_MODEL("Gdew042t2Grays", Gdew042t2Grays, EpdSpi, 1, nullptr),
+  HOST_MODEL("Gdem029E97", Gdem029E97, EpdSpi, 0, nullptr),
+  HOST_MODEL("Gdew0102I3F", Gdew0102I3F, EpdSpi, 1, nullptr),
+  {nullptr, 0, 0, nullptr, nullptr}
+};
@@ -0,0 +1,10 @@
+// Host build: Gdew075T7Grays has its own GDEW075T7_BUFFER_SIZE and cannot share the translation unit of Gdew075T7
+#include "models.h"
+#include <epd.h>
+#include <epdspi.h>
+#include "gdew075T7Grays.h"
+
+const host_model_t host_models_gdew075T7Grays[] = {
+  HOST_MODEL("Gdew075T7Grays", Gdew075T7Grays, EpdSpi, 1, nullptr),
+  {nullptr, 0, 0, nullptr, nullptr}
+};
@@ -0,0 +1,13 @@
+// Host build: Plasticlogic models that use 2 chip selects
+#include "models.h"
+#include <epdspi2cs.h>
+#include "plasticlogic011.h"
+#include "plasticlogic014.h"
+#include "plasticlogic021.h"
+
+const host_model_t host_models_plasticlogic[] = {
+  HOST_MODEL("PlasticLogic011", PlasticLogic011, EpdSpi2Cs, 1, nullptr),
+  HOST_MODEL("PlasticLogic014", PlasticLogic014, EpdSpi2Cs, 1, nullptr),
+  HOST_MODEL("PlasticLogic021", PlasticLogic021, EpdSpi2Cs, 1, nullptr),
+  {nullptr, 0, 0, nullptr, nullptr}
+};
@@ -0,0 +1,153 @@
+// Host build: Timer, heap, statistics and trace
+#include <stdarg.h>
+#include <stdlib.h>
+#include <atomic>
+#if defined(__GLIBC__)
+  #include <malloc.h>
+#endif
+#include "sim.h"
+#include "epd_sim.h"
+#include "esp_timer.h"
+#include "esp_system.h"
+#include "esp_heap_caps.h"
+
+// Reported as free heap. Same order of magnitude as an ESP32 with PSRAM
+#define SIM_HEAP_SIZE (4 * 1024 * 1024)
+
+static const std::chrono::steady_clock::time_point s_start = std::chrono::steady_clock::now();
+static std::atomic<uint32_t> s_speed(10);
+
+static std::mutex s_stats_lock;
+static epd_sim_stats_t s_stats = {};
+static FILE* s_trace = nullptr;
+
+namespace sim {
+  // Never destroyed: detached tasks may still be waiting when the program exits
+  std::mutex& rtos_lock = *new std::mutex();
+  std::condition_variable& rtos_cv = *new std::condition_variable();
+
+  int64_t now_us() {
+    auto real = std::chrono::steady_clock::now() - s_start;
+    return std::chrono::duration_cast<std::chrono::microseconds>(real).count() * s_speed;
+  }
+
+  std::chrono::steady_clock::time_point deadline_us(int64_t sim_us) {
+    return std::chrono::steady_clock::now() + std::chrono::microseconds(sim_us / s_speed);
+  }
+
+  std::chrono::steady_clock::time_point deadline(TickType_t ticks) {
+    return deadline_us((int64_t)ticks * portTICK_PERIOD_MS * 1000);
+  }
+
+  void trace(const char* format, ...) {
+    std::lock_guard<std::mutex> guard(s_stats_lock);
+    if (s_trace == nullptr) return;
+    va_list args;
+    va_start(args, format);
+    vfprintf(s_trace, format, args);
+    va_end(args);
+  }
+
+  void trace_data(const uint8_t* data, size_t len) {
+    std::lock_guard<std::mutex> guard(s_stats_lock);
+    if (s_trace == nullptr) return;
+    fprintf(s_trace, "D %zu ", len);
+    for (size_t i = 0; i < len; i++) {
+      fprintf(s_trace, "%02x", data[i]);
+    }
+    fputc('\n', s_trace);
+  }
+
+  void count_transaction(bool command, size_t bytes, int clock_hz) {
+    std::lock_guard<std::mutex> guard(s_stats_lock);
+    s_stats.transactions++;
+    if (command) s_stats.commands++;
+    s_stats.bytes += bytes;
+    if (clock_hz > 0) {
+      s_stats.wire_us += (uint64_t)bytes * 8 * 1000000 / clock_hz;
+    }
+  }
+
+  void count_busy() {
+    std::lock_guard<std::mutex> guard(s_stats_lock);
+    s_stats.busy_events++;
+  }
+}
+
+void epd_sim_set_speed(uint32_t speed) {
+  s_speed = (speed == 0) ? 1 : speed;
+}
+
+void epd_sim_get_stats(epd_sim_stats_t* stats) {
+  std::lock_guard<std::mutex> guard(s_stats_lock);
+  *stats = s_stats;
+}
+
+void epd_sim_reset_stats(void) {
+  std::lock_guard<std::mutex> guard(s_stats_lock);
+  s_stats = {};
+}
+
+void epd_sim_trace(FILE* file) {
+  std::lock_guard<std::mutex> guard(s_stats_lock);
+  if (s_trace != nullptr) fflush(s_trace);
+  s_trace = file;
+}
+
+int64_t esp_timer_get_time(void) {
+  return sim::now_us();
+}
+
+void* heap_caps_malloc(size_t size, uint32_t caps) {
+  (void)caps;
+  return malloc(size);
+}
+
+void* heap_caps_calloc(size_t n, size_t size, uint32_t caps) {
+  (void)caps;
+  return calloc(n, size);
+}
+
+void heap_caps_free(void* ptr) {
+  free(ptr);
+}
+
+size_t heap_caps_get_free_size(uint32_t caps) {
+  (void)caps;
+  return SIM_HEAP_SIZE;
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t caps) {
+  (void)caps;
+  return SIM_HEAP_SIZE;
+}
+
+// Allocated bytes are the real ones of the process (glibc only), the free ones stay constant
+static size_t _allocated() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+  struct mallinfo2 mi = mallinfo2();
+  return mi.uordblks + mi.hblkhd;
+#elif defined(__GLIBC__)
+  struct mallinfo mi = mallinfo();
+  return (size_t)(unsigned)mi.uordblks + (size_t)(unsigned)mi.hblkhd;
+#else
+  return 0;
+#endif
+}
+
+void heap_caps_get_info(multi_heap_info_t* info, uint32_t caps) {
+  (void)caps;
+  *info = {};
+  info->total_allocated_bytes = _allocated();
+  info->total_free_bytes = SIM_HEAP_SIZE;
+  info->largest_free_block = SIM_HEAP_SIZE;
+  info->minimum_free_bytes = SIM_HEAP_SIZE;
+}
+
+uint32_t esp_get_free_heap_size(void) {
+  return SIM_HEAP_SIZE;
+}
+
+size_t xPortGetFreeHeapSize(void) {
+  return SIM_HEAP_SIZE;
+}
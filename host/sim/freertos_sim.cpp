@@ -0,0 +1,262 @@
+// Host build: FreeRTOS tasks, delays, semaphores, event groups and queues on top of std::thread
+#include <string.h>
+#include <deque>
+#include <string>
+#include <thread>
+#include <vector>
+#include "sim.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include "freertos/queue.h"
+
+struct SimTask {
+  std::string name;
+  bool deleted = false;
+  bool finished = false;
+};
+
+// Thrown inside a task to unwind it when it gets deleted
+struct SimTaskDeleted {};
+
+static thread_local SimTask* t_current = nullptr;
+
+struct SimSemaphore {
+  UBaseType_t count;
+  UBaseType_t max;
+};
+
+struct SimEventGroup {
+  EventBits_t bits = 0;
+};
+
+struct SimQueue {
+  UBaseType_t length;
+  UBaseType_t item_size;
+  std::deque<std::vector<uint8_t>> items;
+};
+
+namespace sim {
+  bool wait(std::unique_lock<std::mutex>& lock, TickType_t ticks, const std::function<bool()>& ready) {
+    auto until = (ticks == portMAX_DELAY) ? std::chrono::steady_clock::time_point::max() : deadline(ticks);
+    while (!ready()) {
+      if (t_current != nullptr && t_current->deleted) throw SimTaskDeleted();
+      if (ticks == portMAX_DELAY) {
+        rtos_cv.wait(lock);
+      } else if (rtos_cv.wait_until(lock, until) == std::cv_status::timeout) {
+        return ready();
+      }
+    }
+    return true;
+  }
+}
+
+// Tasks
+
+void vTaskDelay(const TickType_t ticks) {
+  std::unique_lock<std::mutex> lock(sim::rtos_lock);
+  if (ticks == 0) {
+    lock.unlock();
+    std::this_thread::yield();
+    return;
+  }
+  sim::wait(lock, ticks, [] { return false; });
+}
+
+TickType_t xTaskGetTickCount(void) {
+  return (TickType_t)(sim::now_us() / 1000 / portTICK_PERIOD_MS);
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack_depth, void* arg, UBaseType_t priority, TaskHandle_t* handle) {
+  (void)stack_depth;
+  (void)priority;
+  SimTask* task = new SimTask();
+  task->name = (name != nullptr) ? name : "";
+  std::thread thread([task, fn, arg] {
+    t_current = task;
+    try {
+      fn(arg);
+    } catch (const SimTaskDeleted&) {
+    }
+    {
+      std::lock_guard<std::mutex> guard(sim::rtos_lock);
+      task->finished = true;
+    }
+    sim::rtos_cv.notify_all();
+  });
+  thread.detach();
+  if (handle != nullptr) *handle = task;
+  return pdPASS;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack_depth, void* arg, UBaseType_t priority, TaskHandle_t* handle, BaseType_t core_id) {
+  (void)core_id;
+  return xTaskCreate(fn, name, stack_depth, arg, priority, handle);
+}
+
+void vTaskDelete(TaskHandle_t handle) {
+  SimTask* task = (handle == nullptr) ? t_current : (SimTask*)handle;
+  if (task == nullptr) return;
+  if (task == t_current) throw SimTaskDeleted();
+
+  std::unique_lock<std::mutex> lock(sim::rtos_lock);
+  task->deleted = true;
+  sim::rtos_cv.notify_all();
+  sim::rtos_cv.wait(lock, [task] { return task->finished; });
+  lock.unlock();
+  delete task;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+  return t_current;
+}
+
+// Semaphores
+
+static SemaphoreHandle_t _semaphoreCreate(UBaseType_t max, UBaseType_t initial) {
+  SimSemaphore* semaphore = new SimSemaphore();
+  semaphore->count = initial;
+  semaphore->max = max;
+  return semaphore;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+  return _semaphoreCreate(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+  return _semaphoreCreate(1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count) {
+  return _semaphoreCreate(max_count, initial_count);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t handle, TickType_t ticks) {
+  SimSemaphore* semaphore = (SimSemaphore*)handle;
+  std::unique_lock<std::mutex> lock(sim::rtos_lock);
+  if (!sim::wait(lock, ticks, [semaphore] { return semaphore->count > 0; })) return pdFALSE;
+  semaphore->count--;
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t handle) {
+  SimSemaphore* semaphore = (SimSemaphore*)handle;
+  {
+    std::lock_guard<std::mutex> guard(sim::rtos_lock);
+    if (semaphore->count >= semaphore->max) return pdFALSE;
+    semaphore->count++;
+  }
+  sim::rtos_cv.notify_all();
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t handle, BaseType_t* higher_priority_task_woken) {
+  if (higher_priority_task_woken != nullptr) *higher_priority_task_woken = pdFALSE;
+  return xSemaphoreGive(handle);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t handle) {
+  delete (SimSemaphore*)handle;
+}
+
+// Event groups
+
+EventGroupHandle_t xEventGroupCreate(void) {
+  return new SimEventGroup();
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t handle, const EventBits_t bits) {
+  SimEventGroup* group = (SimEventGroup*)handle;
+  EventBits_t result;
+  {
+    std::lock_guard<std::mutex> guard(sim::rtos_lock);
+    group->bits |= bits;
+    result = group->bits;
+  }
+  sim::rtos_cv.notify_all();
+  return result;
+}
+
+BaseType_t xEventGroupSetBitsFromISR(EventGroupHandle_t handle, const EventBits_t bits, BaseType_t* higher_priority_task_woken) {
+  if (higher_priority_task_woken != nullptr) *higher_priority_task_woken = pdFALSE;
+  xEventGroupSetBits(handle, bits);
+  return pdPASS;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t handle, const EventBits_t bits) {
+  SimEventGroup* group = (SimEventGroup*)handle;
+  std::lock_guard<std::mutex> guard(sim::rtos_lock);
+  EventBits_t previous = group->bits;
+  group->bits &= ~bits;
+  return previous;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t handle) {
+  SimEventGroup* group = (SimEventGroup*)handle;
+  std::lock_guard<std::mutex> guard(sim::rtos_lock);
+  return group->bits;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t handle, const EventBits_t bits, const BaseType_t clear_on_exit, const BaseType_t wait_for_all, TickType_t ticks) {
+  SimEventGroup* group = (SimEventGroup*)handle;
+  std::unique_lock<std::mutex> lock(sim::rtos_lock);
+  bool set = sim::wait(lock, ticks, [group, bits, wait_for_all] {
+    return wait_for_all ? (group->bits & bits) == bits : (group->bits & bits) != 0;
+  });
+  EventBits_t result = group->bits;
+  if (set && clear_on_exit) group->bits &= ~bits;
+  return result;
+}
+
+void vEventGroupDelete(EventGroupHandle_t handle) {
+  delete (SimEventGroup*)handle;
+}
+
+// Queues
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+  SimQueue* queue = new SimQueue();
+  queue->length = length;
+  queue->item_size = item_size;
+  return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t handle, const void* item, TickType_t ticks) {
+  SimQueue* queue = (SimQueue*)handle;
+  {
+    std::unique_lock<std::mutex> lock(sim::rtos_lock);
+    if (!sim::wait(lock, ticks, [queue] { return queue->items.size() < queue->length; })) return pdFALSE;
+    const uint8_t* bytes = (const uint8_t*)item;
+    queue->items.emplace_back(bytes, bytes + queue->item_size);
+  }
+  sim::rtos_cv.notify_all();
+  return pdTRUE;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t handle, const void* item, BaseType_t* higher_priority_task_woken) {
+  if (higher_priority_task_woken != nullptr) *higher_priority_task_woken = pdFALSE;
+  return xQueueSend(handle, item, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t handle, void* item, TickType_t ticks) {
+  SimQueue* queue = (SimQueue*)handle;
+  {
+    std::unique_lock<std::mutex> lock(sim::rtos_lock);
+    if (!sim::wait(lock, ticks, [queue] { return !queue->items.empty(); })) return pdFALSE;
+    memcpy(item, queue->items.front().data(), queue->item_size);
+    queue->items.pop_front();
+  }
+  sim::rtos_cv.notify_all();
+  return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t handle) {
+  SimQueue* queue = (SimQueue*)handle;
+  std::lock_guard<std::mutex> guard(sim::rtos_lock);
+  return queue->items.size();
+}
+
+void vQueueDelete(QueueHandle_t handle) {
+  delete (SimQueue*)handle;
+}
@@ -0,0 +1,294 @@
+// Host build: GPIO levels, interrupts and the BUSY line of the controller
+#include <thread>
+#include <vector>
+#include "sim.h"
+#include "epd_sim.h"
+#include "driver/gpio.h"
+
+struct SimPin {
+  uint8_t level = 1;  // Inputs float HIGH like with the pull-ups
+  bool output = false;
+  bool dc = false;
+  bool cs = false;
+  bool busy = false;
+  uint8_t ready_level = 1;
+  int link_cs = -1;     // Set only by commands to this chip select, with its own timer
+  int64_t until = 0;
+  gpio_int_type_t intr_type = GPIO_INTR_DISABLE;
+  bool intr_enabled = false;
+  gpio_isr_t isr = nullptr;
+  void* isr_arg = nullptr;
+};
+
+struct SimIsrCall {
+  gpio_isr_t isr;
+  void* arg;
+};
+
+// Protects the pins and the BUSY timer. Never held while calling an ISR.
+// Not destroyed at exit since the BUSY thread is still waiting on them
+static std::mutex& s_lock = *new std::mutex();
+static std::condition_variable& s_busy_cv = *new std::condition_variable();
+static SimPin s_pins[GPIO_NUM_MAX];
+static uint32_t s_busy_ms[256];
+static int64_t s_busy_until = 0;  // Pins that are not linked to a chip select
+static bool s_busy_thread = false;
+
+static bool _configure() {
+  s_pins[CONFIG_EINK_BUSY].busy = true;
+  s_pins[CONFIG_EINK_DC].dc = true;
+  s_pins[CONFIG_EINK_M1S1_DC].dc = true;
+  s_pins[CONFIG_EINK_M2S2_DC].dc = true;
+  // Refresh, master activation and power commands of the UC81xx and SSD16xx families
+  s_busy_ms[0x12] = 300;
+  s_busy_ms[0x20] = 300;
+  s_busy_ms[0x17] = 300;
+  s_busy_ms[0x04] = 20;
+  s_busy_ms[0x02] = 20;
+  return true;
+}
+static bool s_configured = _configure();
+
+static bool _valid(gpio_num_t pin) {
+  return pin >= 0 && pin < GPIO_NUM_MAX;
+}
+
+static bool _edgeFires(gpio_int_type_t type, uint8_t from, uint8_t to) {
+  switch (type) {
+    case GPIO_INTR_POSEDGE: return from == 0 && to == 1;
+    case GPIO_INTR_NEGEDGE: return from == 1 && to == 0;
+    case GPIO_INTR_ANYEDGE: return from != to;
+    case GPIO_INTR_LOW_LEVEL: return to == 0;
+    case GPIO_INTR_HIGH_LEVEL: return to == 1;
+    default: return false;
+  }
+}
+
+// Collects the interrupt of a BUSY pin that goes from one level to the other
+static void _busyEdge(SimPin& p, bool to_busy, std::vector<SimIsrCall>& calls) {
+  uint8_t from = to_busy ? p.ready_level : !p.ready_level;
+  uint8_t to = to_busy ? !p.ready_level : p.ready_level;
+  if (p.intr_enabled && p.isr != nullptr && _edgeFires(p.intr_type, from, to)) {
+    calls.push_back({p.isr, p.isr_arg});
+  }
+}
+
+// Same for all BUSY pins that are not linked to a chip select
+static void _busyEdges(bool to_busy, std::vector<SimIsrCall>& calls) {
+  for (int i = 0; i < GPIO_NUM_MAX; i++) {
+    SimPin& p = s_pins[i];
+    if (p.busy && p.link_cs < 0) _busyEdge(p, to_busy, calls);
+  }
+}
+
+// Earliest time a BUSY pin is released, 0 if none is busy
+static int64_t _busyNext() {
+  int64_t next = s_busy_until;
+  for (int i = 0; i < GPIO_NUM_MAX; i++) {
+    SimPin& p = s_pins[i];
+    if (p.busy && p.link_cs >= 0 && p.until != 0 && (next == 0 || p.until < next)) next = p.until;
+  }
+  return next;
+}
+
+// Releases BUSY when the time has passed. Runs like an interrupt context
+static void _busyThread() {
+  std::unique_lock<std::mutex> lock(s_lock);
+  for (;;) {
+    int64_t next = _busyNext();
+    if (next == 0) {
+      s_busy_cv.wait(lock);
+      continue;
+    }
+    int64_t now = sim::now_us();
+    if (next > now) {
+      s_busy_cv.wait_until(lock, sim::deadline_us(next - now));
+      continue;
+    }
+    std::vector<SimIsrCall> calls;
+    if (s_busy_until != 0 && s_busy_until <= now) {
+      s_busy_until = 0;
+      _busyEdges(false, calls);
+    }
+    for (int i = 0; i < GPIO_NUM_MAX; i++) {
+      SimPin& p = s_pins[i];
+      if (!p.busy || p.link_cs < 0 || p.until == 0 || p.until > now) continue;
+      p.until = 0;
+      _busyEdge(p, false, calls);
+    }
+    lock.unlock();
+    for (auto& call : calls) call.isr(call.arg);
+    lock.lock();
+  }
+}
+
+namespace sim {
+  bool dc_is_command() {
+    std::lock_guard<std::mutex> guard(s_lock);
+    for (int i = 0; i < GPIO_NUM_MAX; i++) {
+      if (s_pins[i].dc && s_pins[i].output && s_pins[i].level == 0) return true;
+    }
+    return false;
+  }
+
+  bool is_dc_pin(int pin) {
+    std::lock_guard<std::mutex> guard(s_lock);
+    return _valid(pin) && s_pins[pin].dc;
+  }
+
+  void set_cs_pin(int pin) {
+    std::lock_guard<std::mutex> guard(s_lock);
+    if (_valid(pin)) s_pins[pin].cs = true;
+  }
+
+  void busy_start(uint8_t cmd, int cs) {
+    std::vector<SimIsrCall> calls;
+    {
+      std::lock_guard<std::mutex> guard(s_lock);
+      if (s_busy_ms[cmd] == 0) return;
+      int64_t until = sim::now_us() + (int64_t)s_busy_ms[cmd] * 1000;
+      bool linked = false;
+      for (int i = 0; i < GPIO_NUM_MAX && cs >= 0; i++) {
+        SimPin& p = s_pins[i];
+        if (!p.busy || p.link_cs != cs) continue;
+        linked = true;
+        if (p.until == 0) _busyEdge(p, true, calls);
+        if (until > p.until) p.until = until;
+      }
+      if (!linked) {
+        if (s_busy_until == 0) _busyEdges(true, calls);
+        if (until > s_busy_until) s_busy_until = until;
+      }
+      if (!s_busy_thread) {
+        std::thread(_busyThread).detach();
+        s_busy_thread = true;
+      }
+    }
+    s_busy_cv.notify_all();
+    sim::count_busy();
+    for (auto& call : calls) call.isr(call.arg);
+  }
+}
+
+void epd_sim_clear_busy_pins(void) {
+  std::lock_guard<std::mutex> guard(s_lock);
+  for (int i = 0; i < GPIO_NUM_MAX; i++) {
+    s_pins[i].busy = false;
+    s_pins[i].link_cs = -1;
+    s_pins[i].until = 0;
+  }
+}
+
+void epd_sim_link_busy_pin(gpio_num_t pin, gpio_num_t cs) {
+  std::lock_guard<std::mutex> guard(s_lock);
+  if (!_valid(pin)) return;
+  s_pins[pin].link_cs = _valid(cs) ? cs : -1;
+  s_pins[pin].until = 0;
+}
+
+void epd_sim_add_busy_pin(gpio_num_t pin, uint8_t ready_level) {
+  std::lock_guard<std::mutex> guard(s_lock);
+  if (!_valid(pin)) return;
+  s_pins[pin].busy = true;
+  s_pins[pin].ready_level = ready_level ? 1 : 0;
+}
+
+void epd_sim_set_busy_time(uint8_t cmd, uint32_t ms) {
+  std::lock_guard<std::mutex> guard(s_lock);
+  s_busy_ms[cmd] = ms;
+}
+
+void epd_sim_add_dc_pin(gpio_num_t pin) {
+  std::lock_guard<std::mutex> guard(s_lock);
+  if (_valid(pin)) s_pins[pin].dc = true;
+}
+
+esp_err_t gpio_reset_pin(gpio_num_t gpio_num) {
+  return gpio_set_direction(gpio_num, GPIO_MODE_INPUT);
+}
+
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode) {
+  if (!_valid(gpio_num)) return ESP_ERR_INVALID_ARG;
+  std::lock_guard<std::mutex> guard(s_lock);
+  s_pins[gpio_num].output = (mode & GPIO_MODE_OUTPUT) != 0;
+  return ESP_OK;
+}
+
+esp_err_t gpio_set_pull_mode(gpio_num_t gpio_num, gpio_pull_mode_t pull) {
+  (void)pull;
+  return _valid(gpio_num) ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level) {
+  if (!_valid(gpio_num)) return ESP_ERR_INVALID_ARG;
+  bool traced = false;
+  {
+    std::lock_guard<std::mutex> guard(s_lock);
+    SimPin& p = s_pins[gpio_num];
+    // The controller drives BUSY
+    if (p.busy) return ESP_OK;
+    uint8_t value = level ? 1 : 0;
+    traced = p.output && !p.dc && !p.cs && p.level != value;
+    p.level = value;
+  }
+  if (traced) sim::trace("G %d %d\n", gpio_num, level ? 1 : 0);
+  return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num) {
+  if (!_valid(gpio_num)) return 0;
+  std::lock_guard<std::mutex> guard(s_lock);
+  SimPin& p = s_pins[gpio_num];
+  if (p.busy) {
+    int64_t until = (p.link_cs >= 0) ? p.until : s_busy_until;
+    bool busy = until != 0 && sim::now_us() < until;
+    return busy ? !p.ready_level : p.ready_level;
+  }
+  return p.level;
+}
+
+esp_err_t gpio_set_intr_type(gpio_num_t gpio_num, gpio_int_type_t intr_type) {
+  if (!_valid(gpio_num)) return ESP_ERR_INVALID_ARG;
+  std::lock_guard<std::mutex> guard(s_lock);
+  s_pins[gpio_num].intr_type = intr_type;
+  return ESP_OK;
+}
+
+esp_err_t gpio_intr_enable(gpio_num_t gpio_num) {
+  if (!_valid(gpio_num)) return ESP_ERR_INVALID_ARG;
+  std::lock_guard<std::mutex> guard(s_lock);
+  s_pins[gpio_num].intr_enabled = true;
+  return ESP_OK;
+}
+
+esp_err_t gpio_intr_disable(gpio_num_t gpio_num) {
+  if (!_valid(gpio_num)) return ESP_ERR_INVALID_ARG;
+  std::lock_guard<std::mutex> guard(s_lock);
+  s_pins[gpio_num].intr_enabled = false;
+  return ESP_OK;
+}
+
+esp_err_t gpio_install_isr_service(int intr_alloc_flags) {
+  (void)intr_alloc_flags;
+  static bool installed = false;
+  std::lock_guard<std::mutex> guard(s_lock);
+  if (installed) return ESP_ERR_INVALID_STATE;
+  installed = true;
+  return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler, void* args) {
+  if (!_valid(gpio_num)) return ESP_ERR_INVALID_ARG;
+  std::lock_guard<std::mutex> guard(s_lock);
+  s_pins[gpio_num].isr = isr_handler;
+  s_pins[gpio_num].isr_arg = args;
+  return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_remove(gpio_num_t gpio_num) {
+  if (!_valid(gpio_num)) return ESP_ERR_INVALID_ARG;
+  std::lock_guard<std::mutex> guard(s_lock);
+  s_pins[gpio_num].isr = nullptr;
+  s_pins[gpio_num].isr_arg = nullptr;
+  return ESP_OK;
+}
@@ -0,0 +1,35 @@
+// Host build: State shared by the simulated ESP-IDF and FreeRTOS modules
+#pragma once
+#include <stdint.h>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include "freertos/FreeRTOS.h"
+
+namespace sim {
+  // All FreeRTOS objects are protected by one mutex and woken up by one condition variable
+  extern std::mutex& rtos_lock;
+  extern std::condition_variable& rtos_cv;
+
+  // Simulated microseconds since start
+  int64_t now_us();
+  // Real time point after the given simulated ticks
+  std::chrono::steady_clock::time_point deadline(TickType_t ticks);
+  std::chrono::steady_clock::time_point deadline_us(int64_t sim_us);
+
+  // Blocks the calling task until ready() or timeout. Returns ready()
+  bool wait(std::unique_lock<std::mutex>& lock, TickType_t ticks, const std::function<bool()>& ready);
+
+  // GPIO side of the SPI bus
+  bool dc_is_command();
+  bool is_dc_pin(int pin);
+  void set_cs_pin(int pin);
+  // cs: chip select of the device that received the command, -1 if it has none
+  void busy_start(uint8_t cmd, int cs);
+
+  void trace(const char* format, ...);
+  void trace_data(const uint8_t* data, size_t len);
+  void count_transaction(bool command, size_t bytes, int clock_hz);
+  void count_busy();
+}
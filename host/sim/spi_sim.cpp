@@ -0,0 +1,129 @@
+// Host build: SPI master. Transactions complete as soon as they are sent, queued ones wait
+// in the result queue until spi_device_get_trans_result() like with the real driver
+#include <string.h>
+#include <deque>
+#include "sim.h"
+#include "driver/spi_master.h"
+#include "epd_sim.h"
+
+struct spi_device_t {
+  spi_host_device_t host;
+  spi_device_interface_config_t config;
+  std::deque<spi_transaction_t*> results;
+};
+
+static bool s_bus_initialized[3] = {false, false, false};
+static uint8_t s_miso = 0xFF;
+
+void epd_sim_set_miso(uint8_t value) {
+  s_miso = value;
+}
+
+static void _execute(spi_device_handle_t handle, spi_transaction_t* t) {
+  if (handle->config.pre_cb != nullptr) handle->config.pre_cb(t);
+
+  size_t len = (t->length + 7) / 8;
+  const uint8_t* tx = (t->flags & SPI_TRANS_USE_TXDATA) ? t->tx_data : (const uint8_t*)t->tx_buffer;
+  bool command = sim::dc_is_command();
+
+  if (tx != nullptr && len > 0) {
+    if (command) {
+      for (size_t i = 0; i < len; i++) {
+        sim::trace("C %02x\n", tx[i]);
+      }
+    } else {
+      sim::trace_data(tx, len);
+    }
+  }
+  // Nothing drives MISO: every read returns the idle level
+  size_t rx_len = ((t->rxlength ? t->rxlength : t->length) + 7) / 8;
+  if (t->flags & SPI_TRANS_USE_RXDATA) {
+    memset(t->rx_data, s_miso, sizeof(t->rx_data));
+  } else if (t->rx_buffer != nullptr) {
+    memset(t->rx_buffer, s_miso, rx_len);
+  }
+  sim::count_transaction(command, len, handle->config.clock_speed_hz);
+
+  if (handle->config.post_cb != nullptr) handle->config.post_cb(t);
+  if (command && tx != nullptr && len > 0) sim::busy_start(tx[len - 1], handle->config.spics_io_num);
+}
+
+esp_err_t spi_bus_initialize(spi_host_device_t host_id, const spi_bus_config_t* bus_config, spi_dma_chan_t dma_chan) {
+  (void)bus_config;
+  (void)dma_chan;
+  if (host_id > SPI3_HOST) return ESP_ERR_INVALID_ARG;
+  if (s_bus_initialized[host_id]) return ESP_ERR_INVALID_STATE;
+  s_bus_initialized[host_id] = true;
+  return ESP_OK;
+}
+
+esp_err_t spi_bus_free(spi_host_device_t host_id) {
+  if (host_id > SPI3_HOST) return ESP_ERR_INVALID_ARG;
+  s_bus_initialized[host_id] = false;
+  return ESP_OK;
+}
+
+esp_err_t spi_bus_add_device(spi_host_device_t host_id, const spi_device_interface_config_t* dev_config, spi_device_handle_t* handle) {
+  if (host_id > SPI3_HOST || !s_bus_initialized[host_id]) return ESP_ERR_INVALID_STATE;
+  spi_device_t* device = new spi_device_t();
+  device->host = host_id;
+  device->config = *dev_config;
+  if (device->config.queue_size <= 0) device->config.queue_size = 1;
+  sim::set_cs_pin(dev_config->spics_io_num);
+  *handle = device;
+  return ESP_OK;
+}
+
+esp_err_t spi_bus_remove_device(spi_device_handle_t handle) {
+  if (!handle->results.empty()) return ESP_ERR_INVALID_STATE;
+  delete handle;
+  return ESP_OK;
+}
+
+esp_err_t spi_device_queue_trans(spi_device_handle_t handle, spi_transaction_t* trans_desc, TickType_t ticks_to_wait) {
+  (void)ticks_to_wait;
+  // With the real driver this would block forever, since nobody takes the results
+  if ((int)handle->results.size() >= handle->config.queue_size) {
+    printf("E (spi_sim) queue_trans: %d results pending, queue_size is %d\n",
+           (int)handle->results.size(), handle->config.queue_size);
+    return ESP_ERR_TIMEOUT;
+  }
+  _execute(handle, trans_desc);
+  handle->results.push_back(trans_desc);
+  return ESP_OK;
+}
+
+esp_err_t spi_device_get_trans_result(spi_device_handle_t handle, spi_transaction_t** trans_desc, TickType_t ticks_to_wait) {
+  (void)ticks_to_wait;
+  if (handle->results.empty()) return ESP_ERR_TIMEOUT;
+  *trans_desc = handle->results.front();
+  handle->results.pop_front();
+  return ESP_OK;
+}
+
+esp_err_t spi_device_transmit(spi_device_handle_t handle, spi_transaction_t* trans_desc) {
+  esp_err_t ret = spi_device_queue_trans(handle, trans_desc, portMAX_DELAY);
+  if (ret != ESP_OK) return ret;
+  spi_transaction_t* done;
+  return spi_device_get_trans_result(handle, &done, portMAX_DELAY);
+}
+
+esp_err_t spi_device_polling_transmit(spi_device_handle_t handle, spi_transaction_t* trans_desc) {
+  // Same restriction as the real driver: no polling while queued transactions are pending
+  if (!handle->results.empty()) {
+    printf("E (spi_sim) polling_transmit: %d queued transactions pending\n", (int)handle->results.size());
+    return ESP_ERR_INVALID_STATE;
+  }
+  _execute(handle, trans_desc);
+  return ESP_OK;
+}
+
+esp_err_t spi_device_acquire_bus(spi_device_handle_t device, TickType_t wait) {
+  (void)device;
+  (void)wait;
+  return ESP_OK;
+}
+
+void spi_device_release_bus(spi_device_handle_t dev) {
+  (void)dev;
+}
@@ -0,0 +1,73 @@
+// epd_format() against snprintf() with random conversions
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include "epdformat.h"
+
+static void out(void* arg, const char* text, size_t len)
+{
+  static_cast<std::string*>(arg)->append(text, len);
+}
+
+static int failures = 0;
+
+template <typename T>
+static void check(const char* spec, T value)
+{
+  char expected[256];
+  snprintf(expected, sizeof(expected), spec, value);
+  std::string got;
+  size_t len = epd_format(out, &got, spec, value);
+  if (got != expected || len != got.size()) {
+    if (failures < 20) printf("FAIL %s: \"%s\" expected \"%s\"\n", spec, got.c_str(), expected);
+    failures++;
+  }
+}
+
+// Flags, width and precision for conversion, each one random
+static void randomSpec(char* spec, size_t size, const char* length, char conversion)
+{
+  static const char flags[] = "-+ #0";
+  size_t s = 0;
+  spec[s++] = '%';
+  for (int i = 0; i < 5; i++) {
+    if (rand() % 4 == 0) spec[s++] = flags[i];
+  }
+  int width = (rand() % 3 == 0) ? -1 : rand() % 80;
+  int precision = (rand() % 3 == 0) ? -1 : rand() % 12;
+  if (width >= 0) s += snprintf(spec + s, size - s, "%d", width);
+  if (precision >= 0) s += snprintf(spec + s, size - s, ".%d", precision);
+  snprintf(spec + s, size - s, "%s%c", length, conversion);
+}
+
+int main()
+{
+  // Widths longer than EPD_FORMAT_CONVERSION
+  check("%60d", 42);
+  check("%-50.2f|", 3.14159);
+  check("%060x", 0xBEEFu);
+  check("%#060x", 0xBEEFu);
+  check("%+060.3f", -2.5);
+  check("%060f", 1.0 / 0.0);
+  check("%060.5d", -17);
+  check("%-60c|", 'x');
+  check("%60s|", "text");
+  check("%-60.2s|", "text");
+
+  srand(1);
+  char spec[32];
+  for (int i = 0; i < 20000; i++) {
+    int v = rand() - RAND_MAX / 2;
+    switch (rand() % 6) {
+      case 0: randomSpec(spec, sizeof(spec), "", 'd'); check(spec, v); break;
+      case 1: randomSpec(spec, sizeof(spec), "", "uoxX"[rand() % 4]); check(spec, (unsigned)v); break;
+      case 2: randomSpec(spec, sizeof(spec), "ll", 'i'); check(spec, (long long)v * 1000003); break;
+      case 3: randomSpec(spec, sizeof(spec), "", "fFeEgGaA"[rand() % 8]); check(spec, v / 977.0); break;
+      case 4: randomSpec(spec, sizeof(spec), "", 's'); check(spec, "epaper"); break;
+      case 5: randomSpec(spec, sizeof(spec), "h", 'd'); check(spec, v % 30000); break;
+    }
+  }
+  printf("%d failures\n", failures);
+  return failures ? 1 : 0;
+}
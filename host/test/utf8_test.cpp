@@ -0,0 +1,136 @@
+// EpdUtf8::decode() against a plain UTF-8 decoder, text split in random pieces
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include "epdutf8.h"
+
+static int failures = 0;
+
+static void expect(const char* name, const std::string& got, const std::string& expected)
+{
+  if (got == expected) return;
+  if (failures < 20) {
+    printf("FAIL %s:", name);
+    for (unsigned char c : got) printf(" %02X", c);
+    printf(" expected");
+    for (unsigned char c : expected) printf(" %02X", c);
+    printf("\n");
+  }
+  failures++;
+}
+
+// Code points up to U+00FF as they are, invalid bytes and missing glyphs are one '?' each. An
+// invalid byte after the start of a sequence breaks it and is decoded again
+static std::string reference(const std::string& text)
+{
+  std::string out;
+  size_t i = 0;
+  while (i < text.size()) {
+    unsigned char b = text[i];
+    if (b < 0x80) {
+      out += (char)b;
+      i++;
+      continue;
+    }
+    size_t len = 0;
+    unsigned char lo = 0x80, hi = 0xBF;
+    uint32_t cp = 0;
+    if (b >= 0xC2 && b <= 0xDF) { len = 2; cp = b & 0x1F; }
+    else if (b >= 0xE0 && b <= 0xEF) { len = 3; cp = b & 0x0F; if (b == 0xE0) lo = 0xA0; if (b == 0xED) hi = 0x9F; }
+    else if (b >= 0xF0 && b <= 0xF4) { len = 4; cp = b & 0x07; if (b == 0xF0) lo = 0x90; if (b == 0xF4) hi = 0x8F; }
+    if (len == 0) {
+      out += EPD_UTF8_MISSING;
+      i++;
+      continue;
+    }
+    size_t n = 1;
+    for (; n < len && i + n < text.size(); n++) {
+      unsigned char c = text[i + n];
+      if (c < lo || c > hi) break;
+      cp = (cp << 6) | (c & 0x3F);
+      lo = 0x80;
+      hi = 0xBF;
+    }
+    // Left open at the end: the decoder waits for the next piece
+    if (i + n == text.size() && n < len) break;
+    if (n < len) {
+      out += EPD_UTF8_MISSING;
+    } else {
+      out += (cp <= 0xFF) ? (char)cp : EPD_UTF8_MISSING;
+    }
+    i += n;
+  }
+  return out;
+}
+
+static std::string decode(const GFXfont* font, const std::string& text, size_t max_piece)
+{
+  EpdUtf8 utf8;
+  std::string out;
+  uint8_t chars[EPD_UTF8_RUN + 1];
+  size_t i = 0;
+  while (i < text.size()) {
+    size_t n = 1 + rand() % max_piece;
+    if (n > text.size() - i) n = text.size() - i;
+    size_t count = utf8.decode(font, text.data() + i, n, chars);
+    out.append((const char*)chars, count);
+    i += n;
+  }
+  return out;
+}
+
+static void append(std::string& text, uint32_t cp)
+{
+  if (cp < 0x80) {
+    text += (char)cp;
+  } else if (cp < 0x800) {
+    text += (char)(0xC0 | (cp >> 6));
+    text += (char)(0x80 | (cp & 0x3F));
+  } else if (cp < 0x10000) {
+    text += (char)(0xE0 | (cp >> 12));
+    text += (char)(0x80 | ((cp >> 6) & 0x3F));
+    text += (char)(0x80 | (cp & 0x3F));
+  } else {
+    text += (char)(0xF0 | (cp >> 18));
+    text += (char)(0x80 | ((cp >> 12) & 0x3F));
+    text += (char)(0x80 | ((cp >> 6) & 0x3F));
+    text += (char)(0x80 | (cp & 0x3F));
+  }
+}
+
+int main()
+{
+  // Any font with no map, only the pointer is used
+  static const GFXfont latin1 = {};
+  static const GFXfont mapped = {};
+
+  expect("ascii", decode(&latin1, "Hello", 5), "Hello");
+  expect("latin-1", decode(&latin1, "\xC3\xA9t\xC3\xA9", 1), "\xE9t\xE9");
+  expect("overlong", decode(&latin1, "\xC0\xAF" "a", 3), "??a");
+  expect("surrogate", decode(&latin1, "\xED\xA0\x80", 3), "???");
+  expect("broken", decode(&latin1, "\xE2\x82" "a", 3), "?a");
+  expect("classic", decode(nullptr, "\xC3\xA9\xC3\x9F\xC2\xB0\xC3\x80", 8), "\x82\xE0\xF7?");
+
+  static const epd_glyph_map_t map[] = {{0x0104, 0x80}, {0x0141, 0x81}, {0x20AC, 0x82}};
+  EpdUtf8::setFontMap(&mapped, map, 3);
+  expect("map", decode(&mapped, "\xC5\x81\xE2\x82\xAC\xC4\x84\xC4\x85\xC3\xA9", 4), "\x81\x82\x80?\xE9");
+
+  srand(1);
+  for (int round = 0; round < 5000; round++) {
+    std::string text;
+    int len = rand() % 64;
+    for (int i = 0; i < len; i++) {
+      switch (rand() % 5) {
+        case 0: text += (char)(rand() % 256); break;
+        case 1: append(text, 0x80 + rand() % 0x80); break;
+        case 2: append(text, rand() % 0x800); break;
+        case 3: append(text, rand() % 0x10000); break;
+        default: append(text, rand() % 0x110000); break;
+      }
+    }
+    std::string expected = reference(text);
+    expect("random", decode(&latin1, text, 1 + rand() % EPD_UTF8_RUN), expected);
+  }
+  printf("%d failures\n", failures);
+  return failures ? 1 : 0;
+}
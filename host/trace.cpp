@@ -0,0 +1,67 @@
+// Host build: Runs a model against the simulator and writes the SPI/GPIO trace
+//   calepd_trace --list
+//   calepd_trace <model> [trace-file]
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "models.h"
+#include "epd_sim.h"
+
+// Same drawing for every model so traces can be compared between commits
+static void draw(HostDisplay* display, uint16_t white) {
+  Adafruit_GFX& gfx = display->gfx();
+  int16_t w = gfx.width();
+  int16_t h = gfx.height();
+  gfx.fillScreen(white);
+  gfx.drawRect(0, 0, w, h, 0);
+  gfx.drawLine(0, 0, w - 1, h - 1, 0);
+  gfx.drawLine(w - 1, 0, 0, h - 1, 0);
+  gfx.fillRect(w / 4, h / 4, w / 8, h / 8, 0);
+  gfx.drawCircle(w / 2, h / 2, (w < h ? w : h) / 4, 0);
+  gfx.setTextColor(0);
+  gfx.setCursor(4, 4);
+  display->print("CalEPD host trace");
+}
+
+static void print_model(const host_model_t* model, void* arg) {
+  (void)arg;
+  printf("%s\n", model->name);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    printf("Usage: %s --list | <model> [trace-file]\n", argv[0]);
+    return 1;
+  }
+  if (strcmp(argv[1], "--list") == 0) {
+    host_model_each(print_model, nullptr);
+    return 0;
+  }
+  const host_model_t* model = host_model_find(argv[1]);
+  if (model == nullptr) {
+    printf("Model %s is not in the host build. Use --list\n", argv[1]);
+    return 1;
+  }
+
+  FILE* trace = stdout;
+  if (argc > 2) {
+    trace = fopen(argv[2], "w");
+    if (trace == nullptr) {
+      perror(argv[2]);
+      return 1;
+    }
+  }
+  HostDisplay* display = host_model_create(model);
+  epd_sim_trace(trace);
+  display->init(false);
+  draw(display, model->white);
+  display->update();
+  epd_sim_trace(nullptr);
+  if (trace != stdout) fclose(trace);
+
+  epd_sim_stats_t stats;
+  epd_sim_get_stats(&stats);
+  fprintf(stderr, "%s: %" PRIu32 " transactions, %" PRIu32 " commands, %" PRIu64 " bytes, %" PRIu64 " us on the bus, %" PRIu32 " busy\n",
+          model->name, stats.transactions, stats.commands, stats.bytes, stats.wire_us, stats.busy_events);
+  return 0;
+}
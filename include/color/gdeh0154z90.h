@@ -12,6 +12,8 @@
 #include <epd.h>
 #include <Adafruit_GFX.h>
 #include <epdspi.h>
+#include <epdframebuffer.h>
+#include <epdrotation.h>
 #include <gdew_colors.h>
 #include <esp_timer.h>
 
@@ -35,14 +37,20 @@ public:
     void init(bool debug = false);
     void fillScreen(uint16_t color);
     void drawPixel(int16_t x, int16_t y, uint16_t color); // Override GFX own drawPixel method
+    void setRotation(uint8_t r) override;
 
     void update();
 
 private:
+    // drawPixel for the current rotation, selected in setRotation()
+    template <uint8_t R> void _drawPixel(int16_t x, int16_t y, uint16_t color);
+    void (Gdeh0154z90::*_drawPixelRotated)(int16_t x, int16_t y, uint16_t color) = &Gdeh0154z90::_drawPixel<0>;
     EpdSpi &IO;
 
     uint8_t _black_buffer[GDEH0154Z90_BUFFER_SIZE];
     uint8_t _red_buffer[GDEH0154Z90_BUFFER_SIZE];
+    // Value bit 0: black plane (1 is white), bit 1: red plane (1 is red)
+    Framebuffer<EpdPlanes2, GDEH0154Z90_WIDTH, GDEH0154Z90_HEIGHT> _fb{_black_buffer, _red_buffer};
 
     bool _initial = true;
 
@@ -53,15 +53,4 @@ class Gdew027c44 : public Epd
     void _sleep();
     void _waitBusy(const char* message);
     void _rotate(uint16_t& x, uint16_t& y, uint16_t& w, uint16_t& h);
-
-    // Command & data structs
-    static const epd_init_3 epd_soft_start;
-    static const epd_init_1 epd_panel_setting;
-    static const epd_init_1 epd_extra_setting;
-    // LUT init tables 
-    static const epd_init_44 lut_20_vcomDC;
-    static const epd_init_42 lut_21;
-    static const epd_init_42 lut_22_red;
-    static const epd_init_42 lut_23_white;
-    static const epd_init_42 lut_24_black;
 };
\ No newline at end of file
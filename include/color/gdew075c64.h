@@ -58,10 +58,4 @@ class Gdew075C64 : public Epd
     void _sleep();
     void _waitBusy(const char* message);
     void _rotate(uint16_t& x, uint16_t& y, uint16_t& w, uint16_t& h);
-    
-    // Command & data structs
-    
-    static const epd_power_4 epd_wakeup_power;
-    static const epd_init_4 epd_resolution;
-    static const epd_init_4 epd_boost;
 };
\ No newline at end of file
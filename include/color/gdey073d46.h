@@ -12,6 +12,10 @@
 #include <epd7color.h>
 #include <Adafruit_GFX.h>
 #include <epdspi.h>
+#include <epdframebuffer.h>
+#include <epdrotation.h>
+#include <epdtranspose.h>
+#include <epdpage.h>
 #include <color/wave7colors.h>
 #include <esp_timer.h>
 
@@ -25,23 +29,55 @@ class gdey073d46 : public Epd7Color
 {
   public:
     gdey073d46(EpdSpi& IO);
+    ~gdey073d46();
     const uint8_t colors_supported = 7;
     bool spi_optimized = false;
     const bool has_partial_update = false;
     
     void init(bool debug = false);
     void drawPixel(int16_t x, int16_t y, uint16_t color);
+    void setRotation(uint8_t r) override;
     void fillScreen(uint16_t color);
     void update();
+    // Keeps the buffer in the rotation set and rotates it 2 rows at a time while update() sends it, instead of
+    // rotating every pixel drawn. The buffer layout follows the rotation: set it before drawing the frame
+    bool setRotateOnTransmit(bool enabled);
+    // Frees the full buffer and draws the frame in bands of about bytes, see epdpage.h. update() does
+    // nothing then: the frame comes from drawPaged(). Turned on by the constructor if there is no PSRAM
+    bool setPaging(bool enabled, uint32_t bytes = EPD_PAGE_BYTES);
+    // Calls draw once per band and sends each band. Without paging draw runs once and update() follows
+    void drawPaged(epd_draw_page_t draw, void* arg = nullptr);
 
   private:
+    // drawPixel for the current rotation, selected in setRotation()
+    template <uint8_t R> void _drawPixel(int16_t x, int16_t y, uint16_t color);
+    void (gdey073d46::*_drawPixelRotated)(int16_t x, int16_t y, uint16_t color) = &gdey073d46::_drawPixel<0>;
+    // Same for rotate on transmit: the pixel goes to the buffer as it comes
+    template <uint8_t R> void _drawPixelLogical(int16_t x, int16_t y, uint16_t color);
+    // And for paged mode: only the rows of the band
+    template <uint8_t R> void _drawPixelPaged(int16_t x, int16_t y, uint16_t color);
+    void _selectWriters();
     EpdSpi& IO;
     // In case this _buffer is too large and there is no DRAM available to build, then store it in PSRAM
     //uint8_t _buffer[GDEY073D46_BUFFER_SIZE];
     uint8_t* _buffer = (uint8_t*)heap_caps_malloc(GDEY073D46_BUFFER_SIZE, MALLOC_CAP_SPIRAM);
+    Framebuffer<EpdNibble4, GDEY073D46_WIDTH, GDEY073D46_HEIGHT> _fb{_buffer};
+    // The same buffer drawn in rotation 1 or 3 with rotate on transmit
+    Framebuffer<EpdNibble4, GDEY073D46_HEIGHT, GDEY073D46_WIDTH> _fb_portrait{_buffer};
+    // 2 controller rows built by EpdRotatedRows. nullptr when rotate on transmit is off
+    uint8_t* _tx_rows = nullptr;
+    // Band drawn in paged mode, _buffer is nullptr then
+    EpdPage _page;
+    bool _update_skipped = false;
+    uint64_t _update_start_time = 0;
+    uint64_t _update_sent_time = 0;
 
     void _wakeUp();
     void _sleep();
     void _waitBusy(const char* message);
+    void _waitBusy(const char* message, uint32_t timeout_ms);
+    void _updateBegin() override;
+    void _updateFinish() override;
+    void _sendRows(EpdRotatedRows<4>& rows, uint16_t count);
     void _rotate(uint16_t& x, uint16_t& y, uint16_t& w, uint16_t& h);
 };
@@ -12,6 +12,8 @@
 #include <epd7color.h>
 #include <Adafruit_GFX.h>
 #include <epdspi.h>
+#include <epdframebuffer.h>
+#include <epdrotation.h>
 #include <color/wave7colors.h>
 #include <esp_timer.h>
 
@@ -32,6 +34,7 @@ class Wave5i7Color : public Epd7Color
     
     void init(bool debug = false);
     void drawPixel(int16_t x, int16_t y, uint16_t color);
+    void setRotation(uint8_t r) override;
     void fillScreen(uint16_t color);
     void update();
     void setRawBuf(uint32_t position, uint8_t value);
@@ -51,9 +54,13 @@ class Wave5i7Color : public Epd7Color
     }
 
   private:
+    // drawPixel for the current rotation, selected in setRotation()
+    template <uint8_t R> void _drawPixel(int16_t x, int16_t y, uint16_t color);
+    void (Wave5i7Color::*_drawPixelRotated)(int16_t x, int16_t y, uint16_t color) = &Wave5i7Color::_drawPixel<0>;
     EpdSpi& IO;
 
     uint8_t _buffer[WAVE5I7COLOR_BUFFER_SIZE];
+    Framebuffer<EpdNibble4, WAVE5I7COLOR_WIDTH, WAVE5I7COLOR_HEIGHT> _fb{_buffer};
 
     bool _initial = true;
     void _wakeUp();
@@ -161,6 +161,8 @@ const unsigned char lut_R24_DU[42] =
     void _sleep();
     void _waitBusy(const char* message);
     void _rotate(uint16_t& x, uint16_t& y, uint16_t& w, uint16_t& h);
+    void _updateDirtyRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h) override;
+    void _updateWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h, bool clean_before);
     uint16_t _setPartialRamArea(uint16_t x, uint16_t y, uint16_t xe, uint16_t ye);
     
 };
\ No newline at end of file
@@ -15,6 +15,29 @@
 #include <string>
 #include <Adafruit_GFX.h>
 #include <epdspi.h>
+#include <epdasync.h>
+#include <epddirty.h>
+#include <epdspan.h>
+#include <epdglyphcache.h>
+#include <epdutf8.h>
+#include <epdformat.h>
+#include <epdtextcache.h>
+#include <epdparagraph.h>
+
+// Above this percentage of dirty display area updateDirty() does a full update()
+#define EPD_DIRTY_FULL_UPDATE_PERCENT 40
+// Decoded text kept to measure and print it. draw_centered_text() formats longer text a second time
+#define EPD_TEXT_KEEP 128
+
+// Alignment of a label in its box, one horizontal and one vertical value
+#define EPD_ALIGN_LEFT        0x00
+#define EPD_ALIGN_CENTER      0x01
+#define EPD_ALIGN_RIGHT       0x02
+#define EPD_ALIGN_HORIZONTAL  0x0F
+#define EPD_ALIGN_TOP         0x00
+#define EPD_ALIGN_MIDDLE      0x10
+#define EPD_ALIGN_BOTTOM      0x20
+#define EPD_ALIGN_VERTICAL    0xF0
 
 // Shared struct(s) for different models
 typedef struct {
@@ -96,8 +119,25 @@ typedef struct {
 } epd_power_4;
 
 
+// Text placed in a box by Epd::layoutLabels() and printed by Epd::drawLabels()
+typedef struct {
+    const GFXfont* font;    // nullptr: classic 5x7 font
+    const char* text;       // UTF-8
+    int16_t x;              // Box
+    int16_t y;
+    uint16_t w;
+    uint16_t h;
+    uint8_t align;          // Ex. EPD_ALIGN_CENTER | EPD_ALIGN_MIDDLE
+    uint16_t color;
+    // Set by layoutLabels()
+    int16_t cursor_x;
+    int16_t cursor_y;
+    uint16_t text_w;
+    uint16_t text_h;
+} epd_label_t;
+
 // Note: GDEW0213I5F is our test display that will be the default initializing this class
-class Epd : public virtual Adafruit_GFX
+class Epd : public virtual Adafruit_GFX, public EpdAsync
 {
   public:
     const char* TAG = "Epd driver";
@@ -110,24 +150,98 @@ class Epd : public virtual Adafruit_GFX
     virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;  // Override GFX own drawPixel method
     virtual void init(bool debug = false) = 0;
     virtual void update() = 0; 
+    // Non-blocking version: updateAsync(), waitForUpdate() and isUpdating() come from EpdAsync
+    // Refreshes only the regions drawn since last update. Models that do not track them run update()
+    virtual void updateDirty(uint8_t full_update_percent = EPD_DIRTY_FULL_UPDATE_PERCENT);
+
+    // 1 bit models that set _span fill whole bytes here instead of one drawPixel per pixel
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+    void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+    void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+    void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
 
     // This are common methods every MODELX will inherit
     // hook to Adafruit_GFX::write
     size_t write(uint8_t);
+    // Text is UTF-8. Glyphs outside Latin-1 need a map, see EpdUtf8::setFontMap()
+    void print(const char* text, size_t len);
+    void print(const char* text);
     void print(const std::string& text);
+    // One character of the font as it is, like write()
     void print(const char c);
     void println(const std::string& text);
     void printerf(const char *format, ...);
+    // getTextBounds() of printf formatted text, without a buffer for it
+    void getTextBoundsf(int16_t x, int16_t y, int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h, const char* format, ...);
     void newline();
     void draw_centered_text(const GFXfont *font, int16_t x, int16_t y, uint16_t w, uint16_t h, const char* format, ...);
+    // Positions many labels in one pass (text size 1 or the one set, no wrap). Then drawLabels() prints them
+    void layoutLabels(epd_label_t* labels, size_t count);
+    void drawLabels(const epd_label_t* labels, size_t count);
+    // Prints the lines of the paragraph in its box, breaking them again only if it changed. bgcolor clears the box first
+    void drawParagraph(EpdParagraph& paragraph, uint16_t color);
+    void drawParagraph(EpdParagraph& paragraph, uint16_t color, uint16_t bgcolor);
+    // Keeps the bounds of measured text, see epdtextcache.h. entries 0 disables it
+    bool setTextBoundsCache(uint8_t entries = EPD_TEXT_CACHE_ENTRIES);
+    epd_text_cache_stats_t textBoundsCacheStats() { return _textCache.stats(); }
+    // GFXfont text in size 1 is blitted from pre-rendered glyphs on models with _span. glyphs 0 disables it
+    bool setGlyphCache(uint16_t glyphs = EPD_GLYPH_CACHE_GLYPHS, uint32_t bytes = EPD_GLYPH_CACHE_BYTES);
+    epd_glyph_cache_stats_t glyphCacheStats() { return _glyphs.stats(); }
     
   // Methods that should be accesible by inheriting this abstract class
   protected: 
+    // Models that can split update() override these two. By default updateAsync() runs a blocking update()
+    void _updateBegin() override;
+    void _updateFinish() override;
     // This should be inherited from this abstract class so we don't repeat in every model
     static inline uint16_t gx_uint16_min(uint16_t a, uint16_t b) {return (a < b ? a : b);};
     static inline uint16_t gx_uint16_max(uint16_t a, uint16_t b) {return (a > b ? a : b);};
     bool _using_partial_mode = false;
     bool debug_enabled = true;
+    // Models that support partial update call _dirty.begin() and mark every pixel drawn in controller coordinates
+    EpdDirtyRects _dirty;
+    // Partial update of a region in controller coordinates (no rotation). Needed when using _dirty
+    virtual void _updateDirtyRect(uint16_t, uint16_t, uint16_t, uint16_t) {}
+    // 1 bit buffer in controller orientation. Set it in the constructor to enable the span fills
+    // (buffer stays nullptr for models with other formats). Color mapping must match drawPixel
+    epd_span1_t _span = {};
+    // Fills a rectangle in rotated coordinates. Returns false if the model has no _span
+    bool _spanFill(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    EpdGlyphCache _glyphs;
+    // GFXfont text in size 1 with a model that has _span
+    bool _useGlyphCache();
+    // Adafruit_GFX::write() for one character using _glyphs
+    void _writeGlyph(uint8_t c);
+    // Writes characters decoded by _utf8
+    void _writeRun(const uint8_t* chars, size_t count);
+    EpdUtf8 _utf8;
+    EpdTextCache _textCache;
+    // Bounds of text that comes in chunks (formatted output): _measureBegin(), _measureOut() per chunk, _measureEnd()
+    typedef struct {
+      Epd* epd;
+      EpdUtf8 utf8;
+      int16_t x0, y0;     // Cursor at the start
+      int16_t x, y, minx, miny, maxx, maxy;
+      uint8_t* keep;      // Decoded characters, to measure them with the cache and print them without formatting again
+      size_t kept;
+      size_t capacity;
+      bool overflow;      // keep was too small, the text was measured as it came
+    } _measure_t;
+    static void _printOut(void* arg, const char* text, size_t len);
+    static void _measureOut(void* arg, const char* text, size_t len);
+    void _measureBegin(_measure_t& m, uint8_t* keep, size_t capacity, int16_t x, int16_t y);
+    void _measureChars(_measure_t& m, const uint8_t* chars, size_t count);
+    void _measureEnd(_measure_t& m, int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h);
+    void _measureResult(const _measure_t& m, int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h);
+    void _measure(const uint8_t* chars, size_t count, int16_t x, int16_t y, int16_t* x1, int16_t* y1,
+                  uint16_t* w, uint16_t* h);
+    int16_t _textReach(const uint8_t* chars, size_t count);
+    void _vmeasure(_measure_t& m, int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h, const char* format,
+                   va_list args);
+    // Draws glyph c with its box at x,y. Returns false if the box is not fully on the buffer
+    bool _blitGlyph(int16_t x, int16_t y, const GFXglyph* glyph, uint8_t c);
     // Very smart template from EPD to swap x,y:
     template <typename T> static inline void
     swap(T& a, T& b)
@@ -143,8 +257,6 @@ class Epd : public virtual Adafruit_GFX
     virtual void _sleep() = 0;
     virtual void _waitBusy(const char* message) = 0;
 
-    uint8_t _unicodePerChar(uint8_t c);
-    uint8_t _unicodeEasy(uint8_t c);
     // Command & data structs should be implemented by every MODELX display
 };
 #endif
@@ -1,6 +1,9 @@
 /* Implement IoInterface for SPI communication with 4 Chip selects */
 #include "driver/spi_master.h"
 #include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "epdspibus.h"
 
 #if defined CONFIG_IDF_TARGET_ESP32 && ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 0, 0)
   #include "soc/rtc_wdt.h"
@@ -8,10 +11,80 @@
 
 #ifndef epd4spi_h
 #define epd4spi_h
+
+// Panels for the transfers that take a mask. Several panels is a broadcast: the bytes go once to all of them
+#define EPD4SPI_M1  0x01
+#define EPD4SPI_S1  0x02
+#define EPD4SPI_M2  0x04
+#define EPD4SPI_S2  0x08
+#define EPD4SPI_ALL 0x0F
+// Longer transfers are split in transactions of this size, with the chip selects kept low
+#define EPD4SPI_MAX_TRANSFER 4092
+// Rows of 1304 pixels: 81 bytes go to the left panels (S2 top, M1 bottom) and 82 to the right ones
+#define EPD4SPI_ROW_BYTES   163
+#define EPD4SPI_LEFT_BYTES  81
+#define EPD4SPI_HALF_ROWS   492
+// Rows of a panel sent per transaction by dataRows(). A chunk is gathered while the previous one is on the wire
+#define EPD4SPI_CHUNK_ROWS    24
+#define EPD4SPI_CHUNK_BYTES   (EPD4SPI_CHUNK_ROWS * (EPD4SPI_ROW_BYTES - EPD4SPI_LEFT_BYTES))
+#define EPD4SPI_CHUNK_BUFFERS 2
+
+// Pins of the 4 controllers. The arrays follow the panel bits: M1, S1, M2, S2. -1: not connected
+// (a panel without BUSY line is always ready). Other displays can share the host: while the chip
+// selects are low Epd4Spi keeps the bus, so their transactions wait
+typedef struct {
+    spi_host_device_t host;
+    int8_t mosi;
+    int8_t clk;
+    int8_t cs[4];
+    int8_t busy[4];
+    int8_t dc[2];       // M1 & S1, M2 & S2
+    int8_t rst[2];
+    uint32_t clock_hz;  // 0: the frequency passed to init()
+} epd4spi_config_t;
+
+// Pins set in menuconfig (CONFIG_EINK_SPI_M1_CS...)
+#define EPD4SPI_CONFIG_DEFAULT() { \
+    EPD_SPI_HOST, CONFIG_EINK_SPI_MOSI, CONFIG_EINK_SPI_CLK, \
+    {CONFIG_EINK_SPI_M1_CS, CONFIG_EINK_SPI_S1_CS, CONFIG_EINK_SPI_M2_CS, CONFIG_EINK_SPI_S2_CS}, \
+    {CONFIG_EINK_SPI_M1_BUSY, CONFIG_EINK_SPI_S1_BUSY, CONFIG_EINK_SPI_M2_BUSY, CONFIG_EINK_SPI_S2_BUSY}, \
+    {CONFIG_EINK_M1S1_DC, CONFIG_EINK_M2S2_DC}, {CONFIG_EINK_M1S1_RST, CONFIG_EINK_M2S2_RST}, 0 }
+
 class Epd4Spi
 {
   public:
-    spi_device_handle_t spi;
+    spi_device_handle_t spi = nullptr;
+
+    // Pins from menuconfig
+    Epd4Spi();
+    // Pins of one of several displays, see epdspibus.h
+    Epd4Spi(const epd4spi_config_t& config);
+    ~Epd4Spi();
+    const epd4spi_config_t& config() { return _config; }
+    // The 4 chip selects are GPIOs driven by this class: the SPI peripheral has fewer hardware ones.
+    // Each call below asserts them once, for the whole command, row or buffer
+    void cmd(uint8_t panels, uint8_t cmd);
+    void data(uint8_t panels, const uint8_t *data, uint32_t len);
+    // Command and its parameters in one selection
+    void cmdData(uint8_t panels, uint8_t cmd, const uint8_t *data, uint32_t len);
+    template <typename T> void cmdData(uint8_t panels, const T& s) {
+      cmdData(panels, s.cmd, s.data, s.databytes);
+    }
+    // count bytes of value, to clear the controller RAM
+    void fill(uint8_t panels, uint8_t value, uint32_t count);
+    // Keeps the chip selects of panels low until deselect(), for a plane sent row by row with dataSelected()
+    void select(uint8_t panels);
+    void dataSelected(const uint8_t *data, uint32_t len);
+    void deselect();
+    // count full rows of the buffer starting at row y, each part to the panel that owns it (one selection
+    // per panel). invert sends the complement, for planes where the buffer uses the other polarity
+    void dataRows(const uint8_t *rows, uint16_t y, uint16_t count, bool invert = false);
+    // Blocks until the BUSY lines of all panels are HIGH (ready). The lines are waited at the same time,
+    // sleeping on their edge interrupts. Returns false on timeout
+    bool waitBusy(uint8_t panels, uint32_t timeout_ms, const char* message = "");
+    // True while the BUSY line of any of the panels is LOW
+    bool isBusy(uint8_t panels) { return _busyPending(panels) != 0; }
+
     // 4 different displays, same CLK & MOSI
     void cmdM1(const uint8_t cmd);
     void dataM1(uint8_t data);
@@ -33,9 +106,39 @@ class Epd4Spi
     void dataM2(const uint8_t *data, int len);
     void dataS2(const uint8_t *data, int len);
     void reset(uint8_t millis);
+    // Adds the display to its SPI host. Called again it adds it with the new frequency
     void init(uint8_t frequency, bool debug);
   private:
+    epd4spi_config_t _config;
+    void _cs(uint8_t panels, uint32_t level);
+    // Chip selects low with the SPI bus acquired, then high releasing it
+    void _csLow(uint8_t panels);
+    void _csHigh(uint8_t panels);
+    void _dc(uint8_t panels, uint32_t level);
+    void _transmit(const uint8_t *data, uint32_t len);
     bool debug_enabled = true;
+    uint8_t _selected = 0;
+
+    // DMA buffers of dataRows(), allocated on first use. Without them rows are sent one by one
+    uint8_t* _chunk[EPD4SPI_CHUNK_BUFFERS] = {};
+    spi_transaction_t _chunk_trans[EPD4SPI_CHUNK_BUFFERS];
+    uint8_t _chunk_head = 0;
+    uint8_t _chunk_inflight = 0;
+    bool _chunkInit();
+    uint8_t* _chunkBuffer();
+    void _chunkQueue(uint32_t len);
+    void _chunkDrain();
+
+    // One bit per panel, set by the BUSY interrupts
+    EventGroupHandle_t _busy_events = nullptr;
+    typedef struct {
+      Epd4Spi* io;
+      uint8_t bit;
+    } _busy_isr_t;
+    _busy_isr_t _busy_isr[4];
+    void _busyInit();
+    uint8_t _busyPending(uint8_t panels);
+    static void _busyIsr(void *arg);
 };
 #endif
 // Note: using override compiler will issue an error for "changing the type"
@@ -13,11 +13,13 @@
 #include "esp_log.h"
 #include <string>
 #include <Adafruit_GFX.h>
+#include <epdutf8.h>
 #include <epdspi.h>
+#include <epdasync.h>
 #include <color/wave7colors.h>
 
 // Note: This is the base to inherit for 7 color epapers
-class Epd7Color : public virtual Adafruit_GFX
+class Epd7Color : public virtual Adafruit_GFX, public EpdAsync
 {
   public:
     const char* TAG = "Epd driver 7col";
@@ -30,17 +32,25 @@ class Epd7Color : public virtual Adafruit_GFX
     virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;  // Override GFX own drawPixel method
     virtual void init(bool debug = false) = 0;
     virtual void update() = 0; 
+    // Non-blocking version: updateAsync(), waitForUpdate() and isUpdating() come from EpdAsync
 
     // This are common methods every MODELX will inherit
     // hook to Adafruit_GFX::write
     size_t write(uint8_t);
+    // Text is UTF-8. Glyphs outside Latin-1 need a map, see EpdUtf8::setFontMap()
+    void print(const char* text, size_t len);
+    void print(const char* text);
     void print(const std::string& text);
+    // One character of the font as it is, like write()
     void print(const char c);
     void println(const std::string& text);
     void newline();
 
   // Methods that should be accesible by inheriting this abstract class
   protected: 
+    // Models that can split update() override these two. By default updateAsync() runs a blocking update()
+    void _updateBegin() override;
+    void _updateFinish() override;
      bool debug_enabled = true;
     // Very smart template from EPD to swap x,y:
     template <typename T> static inline void
@@ -57,8 +67,7 @@ class Epd7Color : public virtual Adafruit_GFX
     virtual void _sleep() = 0;
     virtual void _waitBusy(const char* message) = 0;
     virtual void _rotate(uint16_t& x, uint16_t& y, uint16_t& w, uint16_t& h) = 0;
-    uint8_t _unicodePerChar(uint8_t c);
-    uint8_t _unicodeEasy(uint8_t c);
+    EpdUtf8 _utf8;
     // Command & data structs should be implemented by every MODELX display
 };
 #endif
@@ -12,6 +12,7 @@
 #include "esp_log.h"
 #include <string>
 #include <Adafruit_GFX.h>
+#include <epdutf8.h>
 
 class EpdParallel : public virtual Adafruit_GFX
 {
@@ -32,7 +33,11 @@ class EpdParallel : public virtual Adafruit_GFX
     // This are common methods every MODELX will inherit
     // hook to Adafruit_GFX::write
     size_t write(uint8_t);
+    // Text is UTF-8. Glyphs outside Latin-1 need a map, see EpdUtf8::setFontMap()
+    void print(const char* text, size_t len);
+    void print(const char* text);
     void print(const std::string& text);
+    // One character of the font as it is, like write()
     void print(const char c);
     void println(const std::string& text);
     void newline();
@@ -55,7 +60,6 @@ class EpdParallel : public virtual Adafruit_GFX
 
   private:
     // Every display model should implement this private methods
-    uint8_t _unicodePerChar(uint8_t c);
-    uint8_t _unicodeEasy(uint8_t c);
+    EpdUtf8 _utf8;
     // Command & data structs should be implemented by every MODELX display
 };
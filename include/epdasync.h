@@ -0,0 +1,64 @@
+/* Non-blocking update support shared by the Epd and Epd7Color base classes
+ *
+ * The refresh runs in the background only for the models that split update() into
+ * _updateBegin() / _updateFinish(): Gdew075T7, Gdey075T7, gdey073d46 and EpdTiled (when its
+ * tiles are such models). Every other model runs the blocking update() in _updateBegin(), so
+ * updateAsync() returns after the refresh as update() does and only the callback runs in the task.
+ */
+#ifndef epdasync_h
+#define epdasync_h
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+
+#define EPD_ASYNC_TASK_STACK    3072
+#define EPD_ASYNC_TASK_PRIORITY 5
+
+// Called from the update task when the refresh finished and the display is sleeping
+typedef void (*epd_update_cb_t)(void* arg);
+
+class EpdAsync
+{
+  public:
+    virtual ~EpdAsync();
+
+    /**
+     * @brief Sends the buffer and triggers the refresh. Returns as soon as the controller
+     *        latched the buffer so the application can draw the next frame while the panel refreshes.
+     *        If a previous update is still running it waits for it first.
+     * @param cb  Optional callback, runs in the update task once the display is back to sleep
+     * @return false if the update task could not be started (update() was run blocking instead)
+     */
+    bool updateAsync(epd_update_cb_t cb = nullptr, void* arg = nullptr);
+    // Blocks until the running update (if any) finished. Returns false on timeout
+    bool waitForUpdate(uint32_t timeout_ms = portMAX_DELAY);
+    // Blocks until the buffer of the running update was sent and the refresh started. Returns false on timeout
+    bool waitForTransfer(uint32_t timeout_ms = portMAX_DELAY);
+    bool isUpdating();
+
+  protected:
+    // Wake up, send the buffer and trigger the refresh. After this returns the buffer can be modified
+    virtual void _updateBegin() = 0;
+    // Wait for the refresh and put the display to sleep
+    virtual void _updateFinish() = 0;
+    // Models with a front/back buffer swap them here and return true. Since the application
+    // draws then in the other buffer, the transfer in _updateBegin() can run in the update task too
+    virtual bool _updateSwap() { return false; }
+    // Waits for the running update and its callback, then deletes the update task. Models that override
+    // _updateBegin() / _updateFinish() call it from their destructor: ~EpdAsync() runs when they are gone
+    void _asyncStop();
+
+  private:
+    static void _asyncTask(void* arg);
+    void _updateAsyncWork();
+    bool _asyncInit();
+
+    TaskHandle_t _async_task = nullptr;
+    EventGroupHandle_t _async_events = nullptr;
+    epd_update_cb_t _async_cb = nullptr;
+    void* _async_cb_arg = nullptr;
+    bool _async_transfer = false;
+};
+#endif
@@ -0,0 +1,96 @@
+/* Render and transfer benchmark. Runs on the target (call it from app_main) and on the host build
+ *
+ *   EpdBench bench("gdew075T7");
+ *   bench.setIoStats(EpdBench::spiStats, &io);
+ *   bench.run(display);
+ *
+ * Every test reports the operations per second, what was sent on the bus (transactions and bytes)
+ * and the peak heap allocated while it was running. Drawing tests do not refresh the display.
+ */
+#ifndef epdbench_h
+#define epdbench_h
+
+#include <stdint.h>
+#include <Adafruit_GFX.h>
+#include <epdspi.h>
+
+// Tests that run() can select
+#define EPD_BENCH_FILL        (1 << 0)
+#define EPD_BENCH_PIXEL       (1 << 1)  // drawPixel in the 4 rotations
+#define EPD_BENCH_PRIMITIVES  (1 << 2)  // Lines, rectangles and circles
+#define EPD_BENCH_TEXT        (1 << 3)  // Default font and the Adafruit-GFX bundled fonts
+#define EPD_BENCH_UPDATE      (1 << 4)  // update() and updateWindow() if set
+#define EPD_BENCH_ALL         0xFF
+
+// Number of times each drawing test is repeated
+#ifndef EPD_BENCH_LOOPS
+  #define EPD_BENCH_LOOPS 4
+#endif
+
+typedef struct {
+    const char* model;
+    const char* test;
+    uint32_t ops;           // Pixels, primitives, characters or updates
+    int64_t time_us;
+    uint32_t transactions;
+    uint32_t bytes;
+    uint32_t heap_peak;     // Max. heap allocated during the test
+} epd_bench_result_t;
+
+typedef void (*epd_bench_report_cb_t)(const epd_bench_result_t* result, void* arg);
+// Fills stats with the counters of the bus since start (only the difference between two calls is used)
+typedef void (*epd_bench_io_cb_t)(epd_spi_stats_t* stats, void* arg);
+typedef void (*epd_bench_window_cb_t)(void* display, int16_t x, int16_t y, uint16_t w, uint16_t h);
+
+class EpdBench
+{
+  public:
+    EpdBench(const char* model, uint16_t white = 0xFFFF, uint16_t black = 0x0000);
+
+    // Where the transactions and bytes come from. Without it they are reported as 0
+    void setIoStats(epd_bench_io_cb_t cb, void* arg);
+    // Reads the counters of an EpdSpi, pass the IO as arg
+    static void spiStats(epd_spi_stats_t* stats, void* io);
+    // By default every result is printed as one line
+    void setReport(epd_bench_report_cb_t cb, void* arg);
+    // Partial update used by the updateWindow test. Not every model has one so it needs to be set
+    void setUpdateWindow(epd_bench_window_cb_t cb) { _update_window = cb; }
+
+    // Works with any display class that has update() and print(std::string)
+    template <class T> void run(T& display, uint8_t tests = EPD_BENCH_ALL) {
+      _run(display, &display, tests,
+           [](void* d) { ((T*)d)->update(); },
+           [](void* d, const char* text) { ((T*)d)->print(text); });
+    }
+
+  private:
+    typedef void (*_update_cb_t)(void* display);
+    typedef void (*_print_cb_t)(void* display, const char* text);
+
+    const char* _model;
+    uint16_t _white;
+    uint16_t _black;
+    epd_bench_io_cb_t _io_stats = nullptr;
+    void* _io_arg = nullptr;
+    epd_bench_report_cb_t _report = nullptr;
+    void* _report_arg = nullptr;
+    epd_bench_window_cb_t _update_window = nullptr;
+
+    // State of the running test
+    epd_bench_result_t _result;
+    epd_spi_stats_t _io_start;
+    uint32_t _seed;
+
+    void _run(Adafruit_GFX& gfx, void* display, uint8_t tests, _update_cb_t update, _print_cb_t print);
+    void _begin(const char* test);
+    void _end(uint32_t ops);
+    void _sampleHeap();
+    uint16_t _random(uint16_t max);
+
+    void _fill(Adafruit_GFX& gfx);
+    void _pixel(Adafruit_GFX& gfx);
+    void _primitives(Adafruit_GFX& gfx);
+    void _text(Adafruit_GFX& gfx, void* display, _print_cb_t print);
+    void _update(Adafruit_GFX& gfx, void* display, _update_cb_t update);
+};
+#endif
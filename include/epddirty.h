@@ -0,0 +1,55 @@
+// Dirty rectangle tracking in controller coordinates. Used by Epd::updateDirty()
+#ifndef epddirty_h
+#define epddirty_h
+
+#include <stdint.h>
+
+// Max. number of separated regions that are kept before merging them
+#define EPD_DIRTY_MAX_RECTS 4
+// A pixel joins an existing region if that grows it by less than this area (in pixels)
+#define EPD_DIRTY_MERGE_AREA 512
+
+typedef struct {
+    uint16_t x;
+    uint16_t y;
+    uint16_t w;
+    uint16_t h;
+} epd_rect_t;
+
+class EpdDirtyRects
+{
+  public:
+    // Enables tracking for a controller of width * height pixels
+    void begin(uint16_t width, uint16_t height);
+    bool enabled() { return _width != 0; }
+
+    // Called from drawPixel after rotation. X coordinates are extended to byte boundaries
+    inline void mark(uint16_t x, uint16_t y) {
+      if (_last < _count && x >= _x0[_last] && x <= _x1[_last] && y >= _y0[_last] && y <= _y1[_last]) return;
+      _add(x, y, x, y);
+    }
+    // Same for a whole rectangle (span fills)
+    void markRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+    void markAll();
+    void clear() { _count = 0; _last = 0; }
+
+    uint8_t count() { return _count; }
+    epd_rect_t rect(uint8_t index);
+    // Sum of the dirty areas in pixels
+    uint32_t area();
+
+  private:
+    void _add(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
+    void _coalesce();
+
+    uint16_t _width = 0;
+    uint16_t _height = 0;
+    uint8_t _count = 0;
+    uint8_t _last = 0;
+    // Inclusive corners
+    uint16_t _x0[EPD_DIRTY_MAX_RECTS];
+    uint16_t _y0[EPD_DIRTY_MAX_RECTS];
+    uint16_t _x1[EPD_DIRTY_MAX_RECTS];
+    uint16_t _y1[EPD_DIRTY_MAX_RECTS];
+};
+#endif
@@ -0,0 +1,28 @@
+/* printf formatting without a buffer for the whole text
+ *
+ * epd_vformat() hands the output to a callback in chunks of at most EPD_FORMAT_CHUNK bytes, so text
+ * of any length is printed with a small fixed stack and no heap:
+ *
+ *   static void out(void* arg, const char* text, size_t len) { ((Epd*)arg)->print(text, len); }
+ *   epd_format(out, &display, "%s: %.1f C", name, temperature);
+ *
+ * Literal text and %s arguments are copied as they are. Every other conversion is formatted on its
+ * own with snprintf() and is cut at EPD_FORMAT_CONVERSION - 1 characters (a %f of a huge value), the
+ * width is padded apart and can be longer.
+ * Flags, width, precision (also *) and the length modifiers of printf are supported. %n is not.
+ */
+#ifndef epdformat_h
+#define epdformat_h
+
+#include <stdarg.h>
+#include <stddef.h>
+
+#define EPD_FORMAT_CHUNK      64
+#define EPD_FORMAT_CONVERSION 48
+
+typedef void (*epd_format_out_t)(void* arg, const char* text, size_t len);
+
+// Both return the number of bytes given to out
+size_t epd_vformat(epd_format_out_t out, void* arg, const char* format, va_list args);
+size_t epd_format(epd_format_out_t out, void* arg, const char* format, ...);
+#endif
@@ -0,0 +1,199 @@
+/* Framebuffer layouts shared by the models
+ *
+ *   Framebuffer<EpdMono1, GDEW075T7_WIDTH, GDEW075T7_HEIGHT> _fb{_buffer};
+ *   _fb.set(x, y, color ? 1 : 0);
+ *
+ * The framebuffer does not own the memory: it is a view with the layout resolved at compile time,
+ * so strides and masks are constants and set() is a few instructions. Coordinates are in controller
+ * orientation (the model resolves the rotation). set() and get() do not clip, fill() and blit() do.
+ *
+ * Values are the raw pixel value of the format, the model maps its colors to them:
+ *   EpdMono1    1 bit per pixel: 0 or 1
+ *   EpdPlanes2  Two 1 bit planes with the same layout: bit 0 of the value goes to plane 0, bit 1 to plane 1.
+ *               Used for the dual plane 4 grays and the black + red models
+ *   EpdNibble4  4 bits per pixel, 2 pixels per byte: 0 to 15
+ * BitOrder tells if the leftmost pixel of a byte is in the most (EPD_MSB_FIRST) or least significant bits.
+ * Inverted stores the complement of every value, for controllers where a bit set to 1 is black.
+ */
+#ifndef epdframebuffer_h
+#define epdframebuffer_h
+#include <stdint.h>
+#include <string.h>
+
+struct EpdMono1 {
+  static constexpr uint8_t bits = 1;
+  static constexpr uint8_t planes = 1;
+};
+
+struct EpdPlanes2 {
+  static constexpr uint8_t bits = 1;
+  static constexpr uint8_t planes = 2;
+};
+
+struct EpdNibble4 {
+  static constexpr uint8_t bits = 4;
+  static constexpr uint8_t planes = 1;
+};
+
+enum epd_bit_order_t {
+  EPD_MSB_FIRST,
+  EPD_LSB_FIRST
+};
+
+template <class Format, uint16_t Width, uint16_t Height, epd_bit_order_t BitOrder = EPD_MSB_FIRST, bool Inverted = false>
+class Framebuffer
+{
+  public:
+    static constexpr uint16_t width = Width;
+    static constexpr uint16_t height = Height;
+    static constexpr uint8_t planes = Format::planes;
+    static constexpr uint8_t pixels_per_byte = 8 / Format::bits;
+    // Bytes per row and per plane
+    static constexpr uint16_t stride = (uint32_t(Width) * Format::bits + 7) / 8;
+    static constexpr uint32_t size = uint32_t(stride) * Height;
+
+    explicit Framebuffer(uint8_t* plane0 = nullptr, uint8_t* plane1 = nullptr) {
+      setData(plane0, plane1);
+    }
+
+    // For models that swap buffers (double buffering) or allocate them in init()
+    void setData(uint8_t* plane0, uint8_t* plane1 = nullptr) {
+      _plane[0] = plane0;
+      if (planes > 1) _plane[planes - 1] = plane1;
+    }
+
+    uint8_t* data(uint8_t plane = 0) const { return _plane[plane]; }
+    uint8_t* row(uint16_t y, uint8_t plane = 0) const { return _plane[plane] + uint32_t(y) * stride; }
+
+    inline void set(uint16_t x, uint16_t y, uint8_t value) {
+      uint32_t i = uint32_t(y) * stride + x / pixels_per_byte;
+      uint8_t shift = _shift(x);
+      for (uint8_t p = 0; p < planes; p++) {
+        uint8_t* b = &_plane[p][i];
+        *b = (*b & ~(_pixel_mask << shift)) | (_planeValue(value, p) << shift);
+      }
+    }
+
+    inline uint8_t get(uint16_t x, uint16_t y) const {
+      uint32_t i = uint32_t(y) * stride + x / pixels_per_byte;
+      uint8_t shift = _shift(x);
+      uint8_t value = 0;
+      for (uint8_t p = 0; p < planes; p++) {
+        uint8_t v = (_plane[p][i] >> shift) & _pixel_mask;
+        if (Inverted) v ^= _pixel_mask;
+        value |= (Format::planes > 1) ? (v << p) : v;
+      }
+      return value;
+    }
+
+    // Pixels x0..x1 (inclusive) of row y. Coordinates must be inside the buffer
+    inline void span(uint16_t x0, uint16_t x1, uint16_t y, uint8_t value) {
+      for (uint8_t p = 0; p < planes; p++) {
+        _row(row(y, p), x0, x1, _fillByte(value, p));
+      }
+    }
+
+    // Rectangle clipped to the buffer
+    void fill(int32_t x, int32_t y, int32_t w, int32_t h, uint8_t value) {
+      int32_t x1 = x + w - 1;
+      int32_t y1 = y + h - 1;
+      if (x < 0) x = 0;
+      if (y < 0) y = 0;
+      if (x1 >= Width) x1 = Width - 1;
+      if (y1 >= Height) y1 = Height - 1;
+      if (x > x1 || y > y1) return;
+      for (uint8_t p = 0; p < planes; p++) {
+        uint8_t fill = _fillByte(value, p);
+        uint8_t* r = row(y, p);
+        // Whole rows are one memset
+        if (x == 0 && x1 == Width - 1 && Width % pixels_per_byte == 0) {
+          memset(r, fill, uint32_t(y1 - y + 1) * stride);
+          continue;
+        }
+        for (int32_t ry = y; ry <= y1; ry++, r += stride) {
+          _row(r, x, x1, fill);
+        }
+      }
+    }
+
+    void clear(uint8_t value) {
+      for (uint8_t p = 0; p < planes; p++) {
+        memset(_plane[p], _fillByte(value, p), size);
+      }
+    }
+
+    // Draws the bits set in a 1 bit bitmap (MSB first, rows padded to a byte, like Adafruit_GFX drawBitmap)
+    // with value. Clipped to the buffer
+    void blit(int32_t x, int32_t y, const uint8_t* bitmap, uint16_t w, uint16_t h, uint8_t value) {
+      uint16_t bitmap_stride = (w + 7) / 8;
+      for (uint16_t by = 0; by < h; by++) {
+        int32_t py = y + by;
+        if (py < 0) continue;
+        if (py >= Height) break;
+        const uint8_t* src = bitmap + uint32_t(by) * bitmap_stride;
+        for (uint16_t bx = 0; bx < w; bx++) {
+          uint8_t bits = src[bx >> 3];
+          // Skip empty bitmap bytes
+          if (bits == 0) {
+            bx |= 7;
+            continue;
+          }
+          if (!(bits & (0x80 >> (bx & 7)))) continue;
+          int32_t px = x + bx;
+          if (px < 0) continue;
+          if (px >= Width) break;
+          set(px, py, value);
+        }
+      }
+    }
+
+  private:
+    static constexpr uint8_t _pixel_mask = (1 << Format::bits) - 1;
+
+    uint8_t* _plane[Format::planes];
+
+    static inline uint8_t _shift(uint16_t x) {
+      return (BitOrder == EPD_MSB_FIRST)
+        ? 8 - Format::bits - (x % pixels_per_byte) * Format::bits
+        : (x % pixels_per_byte) * Format::bits;
+    }
+
+    static inline uint8_t _planeValue(uint8_t value, uint8_t plane) {
+      uint8_t v = (Format::planes > 1) ? (value >> plane) & 1 : value & _pixel_mask;
+      return Inverted ? v ^ _pixel_mask : v;
+    }
+
+    // The value repeated in every pixel of a byte
+    static inline uint8_t _fillByte(uint8_t value, uint8_t plane) {
+      return _planeValue(value, plane) * (0xFF / _pixel_mask);
+    }
+
+    // Head byte, whole bytes and tail byte of a row
+    static inline void _row(uint8_t* r, uint16_t x0, uint16_t x1, uint8_t fill) {
+      uint16_t b0 = x0 / pixels_per_byte;
+      uint16_t b1 = x1 / pixels_per_byte;
+      uint8_t head_bits = (x0 % pixels_per_byte) * Format::bits;
+      uint8_t tail_bits = 8 - (x1 % pixels_per_byte + 1) * Format::bits;
+      uint8_t head = (BitOrder == EPD_MSB_FIRST) ? 0xFF >> head_bits : uint8_t(0xFF << head_bits);
+      uint8_t tail = (BitOrder == EPD_MSB_FIRST) ? uint8_t(0xFF << tail_bits) : 0xFF >> tail_bits;
+      if (b0 == b1) {
+        uint8_t mask = head & tail;
+        r[b0] = (r[b0] & ~mask) | (fill & mask);
+        return;
+      }
+      r[b0] = (r[b0] & ~head) | (fill & head);
+      if (b1 > b0 + 1) {
+        memset(&r[b0 + 1], fill, b1 - b0 - 1);
+      }
+      r[b1] = (r[b1] & ~tail) | (fill & tail);
+    }
+};
+
+// Definitions of the constants for C++11, where using them by reference needs one
+template <class F, uint16_t W, uint16_t H, epd_bit_order_t O, bool I> constexpr uint16_t Framebuffer<F, W, H, O, I>::width;
+template <class F, uint16_t W, uint16_t H, epd_bit_order_t O, bool I> constexpr uint16_t Framebuffer<F, W, H, O, I>::height;
+template <class F, uint16_t W, uint16_t H, epd_bit_order_t O, bool I> constexpr uint8_t Framebuffer<F, W, H, O, I>::planes;
+template <class F, uint16_t W, uint16_t H, epd_bit_order_t O, bool I> constexpr uint8_t Framebuffer<F, W, H, O, I>::pixels_per_byte;
+template <class F, uint16_t W, uint16_t H, epd_bit_order_t O, bool I> constexpr uint16_t Framebuffer<F, W, H, O, I>::stride;
+template <class F, uint16_t W, uint16_t H, epd_bit_order_t O, bool I> constexpr uint32_t Framebuffer<F, W, H, O, I>::size;
+#endif
@@ -0,0 +1,66 @@
+/* Frame diff against the last buffer sent to the controller
+ *
+ * The buffer is split in bands of EPD_DIFF_BAND_ROWS rows. compare() returns how many bands changed
+ * and band() gives the changed rows and byte columns of each one. Two modes:
+ *
+ *  EPD_DIFF_SHADOW  Full copy of the last frame (in PSRAM if available). Exact row and column span per band
+ *  EPD_DIFF_HASH    Only a 32 bit hash per band. A changed band is reported with the full row width
+ */
+#ifndef epdframediff_h
+#define epdframediff_h
+
+#include <stdint.h>
+
+#define EPD_DIFF_BAND_ROWS 16
+
+typedef enum {
+    EPD_DIFF_SHADOW,
+    EPD_DIFF_HASH
+} epd_diff_mode_t;
+
+typedef struct {
+    uint16_t y;   // First row
+    uint16_t h;   // Rows
+    uint16_t xb;  // First byte in the row
+    uint16_t wb;  // Bytes
+} epd_diff_band_t;
+
+class EpdFrameDiff
+{
+  public:
+    ~EpdFrameDiff();
+
+    // row_bytes is the number of buffer bytes per controller row. Returns false if there is no memory
+    bool begin(uint16_t row_bytes, uint16_t rows, epd_diff_mode_t mode, uint16_t band_rows = EPD_DIFF_BAND_ROWS);
+    void end();
+    bool enabled() { return _row_bytes != 0; }
+
+    // Compares buffer with the last committed frame. Returns the number of changed bands
+    uint16_t compare(const uint8_t* buffer);
+    epd_diff_band_t band(uint16_t index) { return _changed[index]; }
+    // Joins the bands found by compare() that intersect the area. Returns false if nothing changed there
+    bool changedArea(uint16_t& xb, uint16_t& y, uint16_t& wb, uint16_t& h);
+
+    // Call after the buffer was sent to the controller
+    void commit(const uint8_t* buffer);
+    // Same for a partial update. In hash mode only the bands completely inside are committed
+    void commitArea(const uint8_t* buffer, uint16_t xb, uint16_t y, uint16_t wb, uint16_t h);
+    // Next compare() reports the whole frame as changed
+    void invalidate() { _valid = false; }
+
+  private:
+    uint32_t _hash(const uint8_t* data, uint32_t len);
+    bool _rowSpan(const uint8_t* a, const uint8_t* b, uint16_t& first, uint16_t& last);
+
+    epd_diff_mode_t _mode = EPD_DIFF_SHADOW;
+    uint16_t _row_bytes = 0;
+    uint16_t _rows = 0;
+    uint16_t _band_rows = EPD_DIFF_BAND_ROWS;
+    uint16_t _band_count = 0;
+    uint16_t _changed_count = 0;
+    bool _valid = false;
+    uint8_t* _shadow = nullptr;
+    uint32_t* _hashes = nullptr;
+    epd_diff_band_t* _changed = nullptr;
+};
+#endif
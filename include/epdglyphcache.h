@@ -0,0 +1,66 @@
+/* Cache of GFXfont glyphs pre-rendered in the buffer orientation
+ *
+ * Adafruit_GFX draws every set bit of a glyph with writePixel(). Once the cache is enabled with
+ * Epd::setGlyphCache(), Epd::write() takes a faster path for 1 bit models (the ones with span fills),
+ * GFXfont fonts and text size 1: the glyph is rotated and unpacked once into byte aligned rows, and
+ * each time it is printed the rows are shifted into the buffer a byte at a time.
+ *
+ * Entries are direct mapped by font, character and rotation: a collision replaces the entry. When the
+ * bitmap pool is full the cache is flushed and starts again.
+ */
+#ifndef epdglyphcache_h
+#define epdglyphcache_h
+
+#include <stdint.h>
+#include <Adafruit_GFX.h>
+
+#define EPD_GLYPH_CACHE_GLYPHS 128
+// Bitmap pool. A 12pt glyph takes about 40 bytes
+#define EPD_GLYPH_CACHE_BYTES  8192
+
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t flushes;   // Times the bitmap pool was full and the cache started again
+    uint32_t bytes;     // Bitmap bytes in use
+} epd_glyph_cache_stats_t;
+
+typedef struct {
+    const GFXfont* font;  // nullptr: free entry
+    uint8_t c;
+    uint8_t rotation;
+    uint8_t w;            // Size in buffer orientation
+    uint8_t h;
+    uint8_t stride;       // Bytes per row
+    uint8_t* bits;        // MSB first, the leftmost pixel of the row is bit 7 of the first byte
+} epd_glyph_t;
+
+class EpdGlyphCache
+{
+  public:
+    ~EpdGlyphCache();
+
+    // Returns false if there is no memory
+    bool begin(uint16_t glyphs, uint32_t bytes);
+    void end();
+    bool enabled() { return _entries != nullptr; }
+
+    // Glyph c of font rotated for the buffer, rendered on a miss. nullptr if c has no bitmap
+    // or does not fit in the pool
+    const epd_glyph_t* get(const GFXfont* font, uint8_t c, uint8_t rotation);
+
+    epd_glyph_cache_stats_t stats() { return _stats; }
+    void resetStats();
+
+  private:
+    void _flush();
+    void _render(epd_glyph_t* entry, const GFXfont* font, const GFXglyph* glyph);
+
+    epd_glyph_t* _entries = nullptr;
+    uint16_t _glyphs = 0;
+    uint8_t* _pool = nullptr;
+    uint32_t _pool_size = 0;
+    uint32_t _pool_used = 0;
+    epd_glyph_cache_stats_t _stats = {};
+};
+#endif
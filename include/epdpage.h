@@ -0,0 +1,55 @@
+/* Band of controller rows for paged rendering
+ *
+ * Models with setPaging() keep only a few rows instead of the whole frame. drawPaged() calls the
+ * application draw function once per band: drawPixel() drops the pixels outside the band and the
+ * finished band is sent to the controller before the next one is drawn in the same memory.
+ *
+ *   void draw(Adafruit_GFX& gfx, void* arg) {
+ *     gfx.fillCircle(400, 240, 100, EPD_RED);   // Same drawing every time, the model clips it
+ *   }
+ *   display.setPaging(true);
+ *   display.drawPaged(draw);
+ *
+ * The frame is drawn as many times as there are bands: more memory means less drawing.
+ */
+#ifndef epdpage_h
+#define epdpage_h
+
+#include <stdint.h>
+#include <Adafruit_GFX.h>
+
+// Band buffer size. Rows per band are this divided by the bytes of a row
+#define EPD_PAGE_BYTES 8192
+
+// Draws the whole frame. Called once per band
+typedef void (*epd_draw_page_t)(Adafruit_GFX& gfx, void* arg);
+
+class EpdPage
+{
+  public:
+    ~EpdPage();
+
+    // Band of bytes / stride rows of a controller with height rows. Returns false if there is no memory,
+    // keeping the band in use
+    bool begin(uint32_t bytes, uint16_t stride, uint16_t height);
+    void end();
+    bool enabled() { return _data != nullptr; }
+
+    // Moves to the band that starts at controller row y. Returns false past the last row
+    bool select(uint16_t y);
+    uint8_t* data() { return _data; }
+    // Rows of the band buffer
+    uint16_t rows() { return _rows; }
+    // Controller rows of the selected band, the last one can be shorter
+    uint16_t top() { return _top; }
+    uint16_t count() { return _count; }
+    bool contains(uint16_t y) { return (uint16_t)(y - _top) < _count; }
+
+  private:
+    uint8_t* _data = nullptr;
+    uint16_t _rows = 0;
+    uint16_t _height = 0;
+    uint16_t _top = 0;
+    uint16_t _count = 0;
+};
+#endif
@@ -0,0 +1,98 @@
+/* Paragraph of text laid out in a box
+ *
+ * Lines are broken once, with the glyph advances of the font, when the text, font, text size, box or
+ * line spacing change. Drawing an unchanged paragraph again only prints the lines:
+ *
+ *   static EpdParagraph forecast(&FreeSans9pt7b);
+ *   forecast.setBox(10, 40, 380, 120);
+ *   forecast.setAlign(EPD_ALIGN_LEFT | EPD_ALIGN_TOP);
+ *   forecast.setEllipsis(true);
+ *   if (forecast.setText(text)) {
+ *     display.drawParagraph(forecast, EPD_BLACK, EPD_WHITE);  // Clears the box first
+ *   }
+ *
+ * Lines break after spaces and hyphens, and inside words that do not fit in a line. '\n' starts a new
+ * line. When the text needs more lines than the box has, the last one ends with "..." (ellipsis on) or
+ * the text is cut. Text is UTF-8, decoded once per setText().
+ */
+#ifndef epdparagraph_h
+#define epdparagraph_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <Adafruit_GFX.h>
+
+typedef struct {
+    uint16_t start;     // First character
+    uint16_t len;       // Characters printed, without the spaces at the end
+    uint16_t width;     // Sum of the advances, ellipsis included
+    bool ellipsis;      // Printed with "..." after it
+} epd_paragraph_line_t;
+
+class EpdParagraph
+{
+  public:
+    // font nullptr is the classic 5x7 font
+    explicit EpdParagraph(const GFXfont* font = nullptr);
+    ~EpdParagraph();
+
+    // Returns true if the text is different from the last one or there was none
+    bool setText(const char* text);
+    void setFont(const GFXfont* font);
+    void setBox(int16_t x, int16_t y, uint16_t w, uint16_t h);
+    // EPD_ALIGN_* of epd.h, one horizontal and one vertical value
+    void setAlign(uint8_t align) { _align = align; }
+    // Percent of the font line height
+    void setLineSpacing(uint8_t percent);
+    void setEllipsis(bool ellipsis);
+
+    // Breaks the lines if something changed since the last call. Returns the number of lines that fit
+    uint16_t layout(uint8_t size_x, uint8_t size_y);
+
+    const GFXfont* font() { return _font; }
+    int16_t x() { return _x; }
+    int16_t y() { return _y; }
+    uint16_t width() { return _w; }
+    uint16_t height() { return _h; }
+    uint8_t align() { return _align; }
+    const uint8_t* chars() { return _chars; }
+    // After layout(): lines that fit, their line height and the font ascent (baseline below the line top)
+    const epd_paragraph_line_t* lines() { return _lines; }
+    uint16_t lineCount() { return _visible; }
+    int16_t lineHeight() { return _line_height; }
+    int16_t ascent() { return _ascent; }
+    // Height from the top of the first line to the bottom of the last one
+    int16_t textHeight();
+
+  private:
+    void _decode();
+    uint16_t _advance(uint8_t c);
+    bool _addLine(uint16_t start, uint16_t end, uint32_t width);
+    void _ellipsize(epd_paragraph_line_t& line);
+
+    const GFXfont* _font;
+    int16_t _x = 0;
+    int16_t _y = 0;
+    uint16_t _w = 0;
+    uint16_t _h = 0;
+    uint8_t _align = 0;
+    uint8_t _spacing = 100;
+    bool _ellipsis = false;
+
+    char* _text = nullptr;      // UTF-8 as given to setText()
+    uint16_t _text_len = 0;
+    uint8_t* _chars = nullptr;  // Decoded for the font
+    uint16_t _len = 0;
+
+    epd_paragraph_line_t* _lines = nullptr;
+    uint16_t _capacity = 0;
+    uint16_t _visible = 0;
+    uint16_t _max_lines = 0;
+    int16_t _line_height = 0;
+    int16_t _ascent = 0;
+    int16_t _descent = 0;
+    uint8_t _size_x = 0;
+    uint8_t _size_y = 0;
+    bool _dirty = true;
+};
+#endif
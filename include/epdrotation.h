@@ -0,0 +1,64 @@
+/* Rotation resolved at compile time
+ *
+ * Models keep one drawPixel writer per rotation and select it in setRotation(), so drawing has no
+ * switch (getRotation()) per pixel:
+ *
+ *   template <uint8_t R> void Model::_drawPixel(int16_t x, int16_t y, uint16_t color) {
+ *     typedef EpdRotation<R, MODEL_WIDTH, MODEL_HEIGHT> rotation;
+ *     if (!rotation::contains(x, y)) return;
+ *     rotation::map(x, y);
+ *     _fb.set(x, y, color ? 1 : 0);
+ *   }
+ *
+ * Width and Height are the controller (rotation 0) dimensions.
+ */
+#ifndef epdrotation_h
+#define epdrotation_h
+#include <stdint.h>
+
+template <uint8_t R, uint16_t Width, uint16_t Height>
+struct EpdRotationBounds {
+  // Logical size, the same as width() and height() of Adafruit_GFX in rotation R
+  static constexpr uint16_t width = (R & 1) ? Height : Width;
+  static constexpr uint16_t height = (R & 1) ? Width : Height;
+
+  // Negative coordinates are large unsigned values: one compare per axis
+  static inline bool contains(int16_t x, int16_t y) {
+    return (uint16_t)x < width && (uint16_t)y < height;
+  }
+};
+template <uint8_t R, uint16_t W, uint16_t H> constexpr uint16_t EpdRotationBounds<R, W, H>::width;
+template <uint8_t R, uint16_t W, uint16_t H> constexpr uint16_t EpdRotationBounds<R, W, H>::height;
+
+template <uint8_t R, uint16_t Width, uint16_t Height>
+struct EpdRotation : EpdRotationBounds<0, Width, Height> {
+  // Rotation 0: logical and controller coordinates are the same
+  static inline void map(int16_t&, int16_t&) {}
+};
+
+template <uint16_t Width, uint16_t Height>
+struct EpdRotation<1, Width, Height> : EpdRotationBounds<1, Width, Height> {
+  static inline void map(int16_t& x, int16_t& y) {
+    int16_t t = x;
+    x = Width - y - 1;
+    y = t;
+  }
+};
+
+template <uint16_t Width, uint16_t Height>
+struct EpdRotation<2, Width, Height> : EpdRotationBounds<2, Width, Height> {
+  static inline void map(int16_t& x, int16_t& y) {
+    x = Width - x - 1;
+    y = Height - y - 1;
+  }
+};
+
+template <uint16_t Width, uint16_t Height>
+struct EpdRotation<3, Width, Height> : EpdRotationBounds<3, Width, Height> {
+  static inline void map(int16_t& x, int16_t& y) {
+    int16_t t = x;
+    x = y;
+    y = Height - t - 1;
+  }
+};
+#endif
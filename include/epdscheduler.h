@@ -0,0 +1,116 @@
+/* Update scheduler for several displays
+ *
+ * Every update has a transfer phase (wake up, send the buffer, trigger the refresh) that needs the SPI
+ * bus and a refresh phase where the display only waits for BUSY. The scheduler runs the transfers of
+ * the queued updates one after the other in its own task and starts the next one as soon as the
+ * previous display began to refresh, so N displays take about max(refresh) + sum(transfer):
+ *
+ *   EpdScheduler scheduler;
+ *   scheduler.submit(left);
+ *   scheduler.submit(right);
+ *   scheduler.waitForTransfer(left);   // Before drawing the next frame in left
+ *   scheduler.waitAll();
+ *   printf("left: %d ms\n", (int)scheduler.stats(left).last.latency_ms);
+ *
+ * Only models that split update() overlap their refresh (the list is in epdasync.h), the other
+ * ones refresh in the transfer phase. A display that is still refreshing is skipped and its next
+ * update waits in the queue while the other displays go on.
+ */
+#ifndef epdscheduler_h
+#define epdscheduler_h
+
+#include <stdint.h>
+#include "epdasync.h"
+#include "freertos/semphr.h"
+
+#define EPD_SCHEDULER_MAX_DISPLAYS 8
+#define EPD_SCHEDULER_QUEUE        16
+#define EPD_SCHEDULER_TASK_STACK    3072
+#define EPD_SCHEDULER_TASK_PRIORITY EPD_ASYNC_TASK_PRIORITY
+
+// Timing of one update, from submit() until the display is back to sleep
+typedef struct {
+    EpdAsync* epd;
+    uint32_t wait_ms;      // In the queue: bus used by other displays or this one still refreshing
+    uint32_t transfer_ms;  // Wake up, buffer and refresh command
+    uint32_t refresh_ms;   // BUSY and sleep
+    uint32_t latency_ms;   // Sum of the three
+} epd_sched_report_t;
+
+typedef struct {
+    uint32_t updates;
+    uint32_t max_latency_ms;
+    uint32_t avg_latency_ms;
+    epd_sched_report_t last;
+} epd_sched_stats_t;
+
+// Called from the update task of the display when it is back to sleep
+typedef void (*epd_sched_cb_t)(const epd_sched_report_t* report, void* arg);
+
+class EpdScheduler
+{
+  public:
+    // debug prints the report of every update
+    EpdScheduler(bool debug = false);
+    // Waits for the queued updates
+    ~EpdScheduler();
+
+    /**
+     * @brief Queues an update of epd. Its buffer is sent later, don't draw in it until waitForTransfer(epd)
+     * @return false if the queue is full, the display could not be added (up to EPD_SCHEDULER_MAX_DISPLAYS)
+     *         or the scheduler task could not be started
+     */
+    bool submit(EpdAsync& epd, epd_sched_cb_t cb = nullptr, void* arg = nullptr);
+    // Blocks until the queued updates of epd sent their buffer. Returns false on timeout
+    bool waitForTransfer(EpdAsync& epd, uint32_t timeout_ms = portMAX_DELAY);
+    // Blocks until every queued update finished. Returns false on timeout
+    bool waitAll(uint32_t timeout_ms = portMAX_DELAY);
+    // Queued updates whose transfer did not start yet
+    uint8_t pending();
+    // Zeroed stats if epd was never submitted
+    epd_sched_stats_t stats(EpdAsync& epd);
+    void resetStats();
+
+  private:
+    typedef struct {
+        uint8_t display;
+        epd_sched_cb_t cb;
+        void* arg;
+        int64_t queued_us;
+    } _job_t;
+
+    typedef struct {
+        EpdScheduler* scheduler;
+        EpdAsync* epd;
+        bool active;          // Transfer or refresh running
+        _job_t job;           // The running one
+        int64_t start_us;
+        int64_t sent_us;
+        uint32_t updates;
+        uint32_t max_latency_ms;
+        uint64_t sum_latency_ms;
+        epd_sched_report_t last;
+    } _display_t;
+
+    _display_t _displays[EPD_SCHEDULER_MAX_DISPLAYS];
+    uint8_t _display_count = 0;
+    // Oldest first
+    _job_t _queue[EPD_SCHEDULER_QUEUE];
+    uint8_t _queued = 0;
+    bool _debug;
+
+    TaskHandle_t _task = nullptr;
+    EventGroupHandle_t _events = nullptr;
+    SemaphoreHandle_t _mutex = nullptr;
+
+    bool _init();
+    // -1 if not found and add is false or there is no room
+    int8_t _display(EpdAsync& epd, bool add);
+    bool _queuedFor(uint8_t display);
+    void _updateIdle();
+    static void _schedulerTask(void* arg);
+    void _run();
+    // epd_update_cb_t of updateAsync(), arg is the _display_t
+    static void _done(void* arg);
+};
+#endif
@@ -0,0 +1,51 @@
+/* Declarative controller command sequences executed by the IO class
+ *
+ * A sequence is a flat byte array where every entry starts with an opcode.
+ * Build it with the macros below so it stays readable and is validated at compile time:
+ *
+ *   static constexpr DRAM_ATTR uint8_t epd_wakeup[] = {
+ *     EPD_RESET(10),
+ *     EPD_CMD(0x01, 4), 0x07, 0x07, 0x3f, 0x3f,  // POWER SETTING
+ *     EPD_CMD(0x04, 0),                          // Power on
+ *     EPD_BUSY(1, 2000),                         // Wait until BUSY is HIGH (2 seconds timeout)
+ *     EPD_END
+ *   };
+ *   static_assert(epd_sequence_valid(epd_wakeup, sizeof(epd_wakeup)), "Malformed sequence");
+ *
+ *   IO.sequence(epd_wakeup);
+ */
+#ifndef epdsequence_h
+#define epdsequence_h
+#include <stdint.h>
+#include <stddef.h>
+
+#define EPD_SEQ_OP_END       0x00 // End of sequence
+#define EPD_SEQ_OP_CMD       0x01 // cmd, len, data[len]: Payload sent in one transaction
+#define EPD_SEQ_OP_CMD_BYTES 0x02 // cmd, len, data[len]: One transaction per data byte
+#define EPD_SEQ_OP_DELAY     0x03 // ms (16 bits, little endian)
+#define EPD_SEQ_OP_BUSY      0x04 // ready level, timeout ms (16 bits, little endian)
+#define EPD_SEQ_OP_RESET     0x05 // ms
+
+#define EPD_CMD(cmd, len)          EPD_SEQ_OP_CMD, (uint8_t)(cmd), (uint8_t)(len)
+// For controllers that like to receive data byte per byte
+#define EPD_CMD_BYTES(cmd, len)    EPD_SEQ_OP_CMD_BYTES, (uint8_t)(cmd), (uint8_t)(len)
+#define EPD_DELAY(ms)              EPD_SEQ_OP_DELAY, (uint8_t)((ms) & 0xFF), (uint8_t)((ms) >> 8)
+#define EPD_BUSY(level, timeout)   EPD_SEQ_OP_BUSY, (uint8_t)(level), (uint8_t)((timeout) & 0xFF), (uint8_t)((timeout) >> 8)
+#define EPD_RESET(ms)              EPD_SEQ_OP_RESET, (uint8_t)(ms)
+#define EPD_END                    EPD_SEQ_OP_END
+
+/**
+ * @brief Walks a sequence and checks that every opcode is known, that payloads
+ *        fit in the array and that EPD_END is the last byte. Use it in a static_assert.
+ */
+constexpr bool epd_sequence_valid(const uint8_t* seq, size_t size, size_t pos = 0) {
+  return (pos >= size) ? false :
+    (seq[pos] == EPD_SEQ_OP_END) ? (pos == size - 1) :
+    (seq[pos] == EPD_SEQ_OP_CMD || seq[pos] == EPD_SEQ_OP_CMD_BYTES) ?
+      ((pos + 2 < size) && epd_sequence_valid(seq, size, pos + 3 + seq[pos + 2])) :
+    (seq[pos] == EPD_SEQ_OP_DELAY) ? epd_sequence_valid(seq, size, pos + 3) :
+    (seq[pos] == EPD_SEQ_OP_BUSY) ? epd_sequence_valid(seq, size, pos + 4) :
+    (seq[pos] == EPD_SEQ_OP_RESET) ? epd_sequence_valid(seq, size, pos + 2) :
+    false;
+}
+#endif
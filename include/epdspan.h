@@ -0,0 +1,67 @@
+/* Span fills for 1 bit per pixel buffers (MSB is the leftmost pixel of every byte)
+ *
+ * Horizontal runs are written as a masked head byte, whole bytes and a masked tail byte,
+ * so filling a background costs about the same as a memset instead of one drawPixel per pixel.
+ * Coordinates are in controller orientation and already clipped.
+ */
+#ifndef epdspan_h
+#define epdspan_h
+#include <stdint.h>
+#include <string.h>
+
+// Buffer description that Epd uses for the fillRect / fast line overrides
+typedef struct {
+    uint8_t* buffer;    // nullptr: the model does not support span fills
+    uint16_t width;     // Visible pixels per row
+    uint16_t height;
+    uint16_t stride;    // Bytes per row
+    bool inverted;      // true when a bit set to 1 is black (color 0)
+    bool rotated;       // Buffer drawn in the rotation set (rotate at transmit): width() pixels per row
+} epd_span1_t;
+
+// Bits x0..x1 (inclusive) of one row to 1 (set) or 0
+static inline void epd_span1_row(uint8_t* row, uint16_t x0, uint16_t x1, bool set)
+{
+  uint16_t b0 = x0 >> 3;
+  uint16_t b1 = x1 >> 3;
+  uint8_t head = 0xFF >> (x0 & 7);
+  uint8_t tail = 0xFF << (7 - (x1 & 7));
+  if (b0 == b1) {
+    uint8_t mask = head & tail;
+    row[b0] = set ? (row[b0] | mask) : (row[b0] & ~mask);
+    return;
+  }
+  row[b0] = set ? (row[b0] | head) : (row[b0] & ~head);
+  if (b1 > b0 + 1) {
+    memset(&row[b0 + 1], set ? 0xFF : 0x00, b1 - b0 - 1);
+  }
+  row[b1] = set ? (row[b1] | tail) : (row[b1] & ~tail);
+}
+
+static inline void epd_span1_rect(uint8_t* buffer, uint16_t stride, uint16_t x0, uint16_t y0,
+                                  uint16_t x1, uint16_t y1, bool set)
+{
+  uint8_t* row = buffer + (uint32_t)y0 * stride;
+  // Rows covering whole bytes of the buffer are one memset
+  if ((x0 & 7) == 0 && (x1 & 7) == 7 && (uint16_t)((x1 - x0 + 1) >> 3) == stride) {
+    memset(row, set ? 0xFF : 0x00, (uint32_t)(y1 - y0 + 1) * stride);
+    return;
+  }
+  for (uint16_t y = y0; y <= y1; y++, row += stride) {
+    epd_span1_row(row, x0, x1, set);
+  }
+}
+
+static inline void epd_span1_column(uint8_t* buffer, uint16_t stride, uint16_t x, uint16_t y0,
+                                    uint16_t y1, bool set)
+{
+  uint8_t* p = buffer + (uint32_t)y0 * stride + (x >> 3);
+  uint8_t mask = 0x80 >> (x & 7);
+  if (set) {
+    for (uint16_t y = y0; y <= y1; y++, p += stride) *p |= mask;
+  } else {
+    mask = ~mask;
+    for (uint16_t y = y0; y <= y1; y++, p += stride) *p &= mask;
+  }
+}
+#endif
@@ -1,29 +1,110 @@
 /* Implement IoInterface for SPI communication */
 #include "driver/spi_master.h"
 #include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 #include "iointerface.h"
+#include "epdsequence.h"
+#include "epdspibus.h"
 #include <vector>
 using namespace std;
 
 #ifndef epdspi_h
 #define epdspi_h
+// Transactions that can be queued in the SPI driver at the same time (devcfg.queue_size)
+#ifndef EPD_SPI_QUEUE_SIZE
+  #define EPD_SPI_QUEUE_SIZE 8
+#endif
+// Number of DMA row buffers used by the queued data stream (Should be <= EPD_SPI_QUEUE_SIZE)
+#ifndef EPD_STREAM_BUFFERS
+  #define EPD_STREAM_BUFFERS 3
+#endif
+
+// DC level for a queued transaction. Passed in spi_transaction_t.user and applied by the pre_cb callback
+typedef struct {
+    gpio_num_t pin;
+    uint32_t level;
+} epd_spi_dc_t;
+
+// Counters of what was sent on the bus. Used by the benchmark (epdbench.h)
+typedef struct {
+    uint32_t transactions;
+    uint32_t bytes;
+} epd_spi_stats_t;
 // : IoInterface
 class EpdSpi 
 {
   public:
-    spi_device_handle_t spi;
+    spi_device_handle_t spi = nullptr;
     const char * TAG = "EpdSpi";
 
+    // Pins from menuconfig
+    EpdSpi();
+    // Pins of one of several displays, see epdspibus.h
+    EpdSpi(const epd_spi_config_t& config);
+    ~EpdSpi();
+    const epd_spi_config_t& config() { return _config; }
+    int getBusyLevel() { return gpio_get_level((gpio_num_t)_config.busy); }
+
     void cmd(const uint8_t cmd) ; // Should override if IoInterface is there
+    // Command + payload queued back to back, DC is switched in pre_cb
+    void cmdData(const uint8_t cmd, const uint8_t *data, int len);
+    // Sends any of the epd_init_N / epd_lut_N structs
+    template <typename T> void cmdData(const T& s) {
+      cmdData(s.cmd, s.data, s.databytes);
+    }
     void data(uint8_t data) ;
     void dataBuffer(uint8_t data);
     void data(const uint8_t *data, int len) ;
     // Deprecated
     void dataVector(vector<uint8_t> _buffer);
     void reset(uint8_t millis) ;
+    // Adds the display to its SPI host. Called again it adds it with the new frequency
     void init(uint8_t frequency, bool debug) ;
+    // Executes a whole epdsequence.h command sequence queuing as many transactions as possible
+    void sequence(const uint8_t *seq);
+    // Blocks on a GPIO interrupt until BUSY reaches ready_level. Returns false on timeout
+    bool waitBusy(uint8_t ready_level, uint32_t timeout_ms, const char* message = "");
+
+    // Queued DMA streaming: row N+1 is prepared while row N is on the wire
+    void dataStreamBegin(uint16_t max_len);
+    uint8_t* dataStreamBuffer();
+    void dataStreamQueue(int len);
+    void dataStream(const uint8_t *data, int len);
+    void dataStreamEnd();
+
+    // Transactions and bytes sent since init() or the last resetStats()
+    epd_spi_stats_t getStats() { return _stats; }
+    void resetStats() { _stats = {}; }
   private:
+    epd_spi_config_t _config;
     bool debug_enabled = true;
+    epd_spi_dc_t _dc_cmd;
+    epd_spi_dc_t _dc_data;
+    static void _preTransfer(spi_transaction_t *t);
+    epd_spi_stats_t _stats = {};
+    inline void _countTrans(const spi_transaction_t *t) {
+      _stats.transactions++;
+      _stats.bytes += t->length / 8;
+    }
+
+    spi_transaction_t _seq_trans[EPD_SPI_QUEUE_SIZE];
+    uint8_t _seq_head = 0;
+    uint8_t _seq_inflight = 0;
+    uint16_t _seq_count = 0;
+    void _seqQueue(const uint8_t *data, uint8_t len, epd_spi_dc_t *dc);
+    void _seqDrain();
+
+    SemaphoreHandle_t _busy_sem = nullptr;
+    void _busyInit();
+    static void _busyIsr(void *arg);
+
+    uint8_t* _stream_buffer[EPD_STREAM_BUFFERS] = {};
+    spi_transaction_t _stream_trans[EPD_STREAM_BUFFERS];
+    uint16_t _stream_buffer_size = 0;
+    uint8_t _stream_head = 0;
+    uint8_t _stream_inflight = 0;
+    void _streamCollect();
 };
 #endif
 // Note: using override compiler will issue an error for "changing the type"
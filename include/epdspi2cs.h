@@ -2,7 +2,10 @@
 #include "driver/spi_master.h"
 #include "driver/gpio.h"
 #include "iointerface.h"
+#include "epdspibus.h"
 #include <esp_timer.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 #ifndef epdspi2cs_h
 #define epdspi2cs_h
 // Instruction R/W bit set HIGH for data READ
@@ -11,7 +14,15 @@
 class EpdSpi2Cs
 {
   public:
-    spi_device_handle_t spi;
+    spi_device_handle_t spi = nullptr;
+
+    // Pins from menuconfig
+    EpdSpi2Cs();
+    // Pins of one of several displays, see epdspibus.h
+    EpdSpi2Cs(const epd_spi_config_t& config);
+    ~EpdSpi2Cs();
+    const epd_spi_config_t& config() { return _config; }
+    int getBusyLevel() { return gpio_get_level((gpio_num_t)_config.busy); }
 
     void cmd(const uint8_t cmd);
     void data(uint8_t data);
@@ -20,14 +31,21 @@ class EpdSpi2Cs
     void reset(uint8_t millis);
     void init(uint8_t frequency, bool debug);
 
+    // Removes the display from its SPI host
     void release();
     uint8_t readTemp();
     uint8_t readRegister(const uint8_t *data, int len);
     
     // Accelerometer BMA250E uses CS2. Update being done in plastic/accelerometer branch
+    // Blocks on a GPIO interrupt until BUSY is HIGH, 500 ms at most
     void waitForBusy();
   private:
+    epd_spi_config_t _config;
     bool debug_enabled = true;
+
+    SemaphoreHandle_t _busy_sem = nullptr;
+    void _busyInit();
+    static void _busyIsr(void *arg);
 };
 #endif
 // Note: using override compiler will issue an error for "changing the type"
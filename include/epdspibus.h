@@ -0,0 +1,51 @@
+/* Pins of a display and SPI hosts shared by several of them
+ *
+ * The IO classes take an epd_spi_config_t so one firmware can drive several displays. Displays on the
+ * same host share MOSI and CLK and have their own CS, DC, RST and BUSY:
+ *
+ *   epd_spi_config_t left = EPD_SPI_CONFIG_DEFAULT();
+ *   epd_spi_config_t right = left;
+ *   right.cs = 5; right.dc = 17; right.rst = 16; right.busy = 4;
+ *   EpdSpi io1(left), io2(right);
+ *
+ * The first display initializes the host, the next ones only add their device to it. A host that the
+ * application already initialized (Ex. for an SD card) is used as it is.
+ */
+#ifndef epdspibus_h
+#define epdspibus_h
+
+#include "driver/spi_master.h"
+#include "sdkconfig.h"
+
+// Host of the menuconfig pins
+#if defined CONFIG_IDF_TARGET_ESP32
+  #define EPD_SPI_HOST HSPI_HOST
+#else
+  #define EPD_SPI_HOST SPI2_HOST
+#endif
+
+// -1: not connected
+typedef struct {
+    spi_host_device_t host;
+    int8_t mosi;
+    int8_t miso;        // EpdSpi2Cs only
+    int8_t clk;
+    int8_t cs;
+    int8_t cs2;         // EpdSpi2Cs only (accelerometer)
+    int8_t dc;
+    int8_t rst;
+    int8_t busy;
+    uint32_t clock_hz;  // 0: the frequency passed to init()
+} epd_spi_config_t;
+
+// Pins set in menuconfig (CONFIG_EINK_*)
+#define EPD_SPI_CONFIG_DEFAULT() { \
+    EPD_SPI_HOST, CONFIG_EINK_SPI_MOSI, CONFIG_EINK_SPI_MISO, CONFIG_EINK_SPI_CLK, \
+    CONFIG_EINK_SPI_CS, CONFIG_EINK_SPI_CS2, CONFIG_EINK_DC, CONFIG_EINK_RST, CONFIG_EINK_BUSY, 0 }
+
+// Initializes host for the first display that uses it. Fails if it runs with other pins or with a
+// shorter max_transfer (init the display that needs the longest transfers first)
+esp_err_t epd_spi_bus_acquire(spi_host_device_t host, int mosi, int miso, int clk, int max_transfer);
+// Frees host after the last display that acquired it
+void epd_spi_bus_release(spi_host_device_t host);
+#endif
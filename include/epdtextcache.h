@@ -0,0 +1,70 @@
+/* Cache of text bounds
+ *
+ * Dashboards measure the same labels on every refresh. Once enabled with Epd::setTextBoundsCache(),
+ * the bounds measured by draw_centered_text(), getTextBoundsf() and layoutLabels() are kept relative
+ * to the cursor, keyed by font, text size and a hash of the decoded text, and the least recently used
+ * entry is replaced when the cache is full.
+ *
+ * Text with a newline is not cached. Text that would wrap at the position it is measured is measured
+ * again: reach is how far right of the cursor the wrap test of Adafruit_GFX goes.
+ */
+#ifndef epdtextcache_h
+#define epdtextcache_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <Adafruit_GFX.h>
+
+#define EPD_TEXT_CACHE_ENTRIES 16
+
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;
+} epd_text_cache_stats_t;
+
+typedef struct {
+    int16_t x1;         // Relative to the cursor, like getTextBounds() with x,y 0,0
+    int16_t y1;
+    uint16_t w;
+    uint16_t h;
+    int16_t reach;
+} epd_text_bounds_t;
+
+class EpdTextCache
+{
+  public:
+    ~EpdTextCache();
+
+    // Returns false if there is no memory
+    bool begin(uint8_t entries);
+    void end();
+    bool enabled() { return _entries != nullptr; }
+
+    bool find(const GFXfont* font, uint8_t size_x, uint8_t size_y, const uint8_t* text, size_t len,
+              epd_text_bounds_t* bounds);
+    void insert(const GFXfont* font, uint8_t size_x, uint8_t size_y, const uint8_t* text, size_t len,
+                const epd_text_bounds_t& bounds);
+
+    epd_text_cache_stats_t stats() { return _stats; }
+    void resetStats() { _stats = {}; }
+
+  private:
+    typedef struct {
+      const GFXfont* font;
+      uint32_t hash;
+      uint16_t len;
+      uint8_t size_x;
+      uint8_t size_y;
+      epd_text_bounds_t bounds;
+      uint32_t used;      // Last use, 0 is a free entry
+    } entry_t;
+
+    // FNV-1a of the decoded characters
+    static uint32_t _hash(const uint8_t* text, size_t len);
+
+    entry_t* _entries = nullptr;
+    uint8_t _size = 0;
+    uint32_t _clock = 0;
+    epd_text_cache_stats_t _stats = {};
+};
+#endif
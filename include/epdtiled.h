@@ -0,0 +1,82 @@
+/* Tiled display: one canvas over several panels
+ *
+ * Every tile is a model with its own IO, so its own chip select, DC and BUSY pins. The canvas is the
+ * bounding box of the tiles: drawing is routed to the tiles under it and update() refreshes only the
+ * tiles drawn since the last one. Those are started with updateAsync() one after the other, so while
+ * a tile refreshes the next one receives its buffer and the panels refresh at the same time.
+ * Models that split update() (the list is in epdasync.h) return as soon as the buffer is sent,
+ * other ones refresh one after the other.
+ *
+ *   Gdew075T7 left(io1), right(io2);
+ *   epd_tile_t tiles[] = {{&left, 0, 0}, {&right, 800, 0}};
+ *   EpdTiled wall(tiles, 2);
+ *   wall.init();
+ *   wall.fillCircle(800, 240, 200, EPD_BLACK);  // Drawn on both panels
+ *   wall.update();
+ *
+ * Panels mounted rotated get setRotation() on the tile model before they are added.
+ */
+#ifndef epdtiled_h
+#define epdtiled_h
+
+#include <epd.h>
+
+#define EPD_TILED_MAX_TILES 16
+
+typedef struct {
+    Epd* epd;       // Model of the panel, with its own IO
+    int16_t x;      // Top left corner in the canvas
+    int16_t y;
+} epd_tile_t;
+
+class EpdTiled : public Epd
+{
+  public:
+    // Copies the list, up to EPD_TILED_MAX_TILES
+    EpdTiled(const epd_tile_t* tiles, uint8_t count);
+    ~EpdTiled();
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+    void fillScreen(uint16_t color) override;
+    // Split between the tiles, each one fills its part with its own fast fills
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+    void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+    void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+    void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+
+    void init(bool debug = false) override;
+    // Refreshes the tiles drawn since the last update, at the same time
+    void update() override;
+    // updateDirty() of every tile drawn since the last update: partial refresh where the model supports it
+    void updateDirty(uint8_t full_update_percent = EPD_DIRTY_FULL_UPDATE_PERCENT) override;
+    // The next update refreshes all tiles
+    void markAll() { _changed = (1UL << _count) - 1; }
+    uint8_t tiles() { return _count; }
+    // Bit N is set when tile N has to be refreshed
+    uint32_t changed() { return _changed; }
+
+  protected:
+    void _updateBegin() override;
+    void _updateFinish() override;
+
+  private:
+    epd_tile_t _tiles[EPD_TILED_MAX_TILES];
+    uint8_t _count = 0;
+    uint32_t _changed = 0;
+    // Tiles started by _updateBegin()
+    uint32_t _updating = 0;
+    // Tile of the last pixel: next ones are usually on it too
+    uint8_t _last = 0;
+
+    static int16_t _canvasWidth(const epd_tile_t* tiles, uint8_t count);
+    static int16_t _canvasHeight(const epd_tile_t* tiles, uint8_t count);
+    // Rectangle in rotated coordinates to the tiles under it
+    void _fill(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    // Tiles do their own wake up, sleep and busy wait
+    void _wakeUp() override {}
+    void _sleep() override {}
+    void _waitBusy(const char*) override {}
+};
+#endif
@@ -0,0 +1,126 @@
+/* Rotate at transmit
+ *
+ * Models that support it keep the buffer in the orientation the application draws (width() pixels
+ * per row) and build the controller rows while update() streams them: 8 rows at a time with an 8x8
+ * bit transpose for 1 bit per pixel, 2 rows at a time with a nibble transpose for 4 bits per pixel.
+ * Rotation then costs one linear pass per frame instead of a transformation per pixel drawn.
+ *
+ *   EpdRotatedRows<1> rows(_buffer, WIDTH, HEIGHT, getRotation(), _tx_rows);
+ *   for (uint16_t y = 0; y < HEIGHT; y++) IO.dataStream(rows.row(y), WIDTH / 8);
+ *
+ * Buffers are MSB first (leftmost pixel in the high bits) and the controller width and height must be
+ * multiples of 8. Same mapping as EpdRotation.
+ */
+#ifndef epdtranspose_h
+#define epdtranspose_h
+#include <stdint.h>
+
+static inline uint8_t epd_reverse_bits(uint8_t b)
+{
+  b = (b >> 4) | (b << 4);
+  b = ((b & 0xCC) >> 2) | ((b & 0x33) << 2);
+  return ((b & 0xAA) >> 1) | ((b & 0x55) << 1);
+}
+
+static inline uint8_t epd_swap_nibbles(uint8_t b)
+{
+  return (b >> 4) | (b << 4);
+}
+
+// 8x8 bits: bit 7-j of in[i] goes to bit 7-i of out[j * out_stride] (Hacker's Delight transpose8)
+static inline void epd_transpose8x8(const uint8_t* in, uint8_t* out, uint16_t out_stride)
+{
+  uint32_t x = ((uint32_t)in[0] << 24) | ((uint32_t)in[1] << 16) | ((uint32_t)in[2] << 8) | in[3];
+  uint32_t y = ((uint32_t)in[4] << 24) | ((uint32_t)in[5] << 16) | ((uint32_t)in[6] << 8) | in[7];
+  uint32_t t;
+  t = (x ^ (x >> 7)) & 0x00AA00AA;  x = x ^ t ^ (t << 7);
+  t = (y ^ (y >> 7)) & 0x00AA00AA;  y = y ^ t ^ (t << 7);
+  t = (x ^ (x >> 14)) & 0x0000CCCC; x = x ^ t ^ (t << 14);
+  t = (y ^ (y >> 14)) & 0x0000CCCC; y = y ^ t ^ (t << 14);
+  t = (x & 0xF0F0F0F0) | ((y >> 4) & 0x0F0F0F0F);
+  y = ((x << 4) & 0xF0F0F0F0) | (y & 0x0F0F0F0F);
+  x = t;
+  out[0] = x >> 24; out[out_stride] = x >> 16; out[2 * out_stride] = x >> 8; out[3 * out_stride] = x;
+  out += 4 * out_stride;
+  out[0] = y >> 24; out[out_stride] = y >> 16; out[2 * out_stride] = y >> 8; out[3 * out_stride] = y;
+}
+
+// 2x2 nibbles: the same transpose for 4 bits per pixel
+static inline void epd_transpose2x2(const uint8_t* in, uint8_t* out, uint16_t out_stride)
+{
+  out[0] = (in[0] & 0xF0) | (in[1] >> 4);
+  out[out_stride] = (in[0] << 4) | (in[1] & 0x0F);
+}
+
+template <uint8_t Bits>
+class EpdRotatedRows
+{
+  public:
+    // Controller rows built at once, the pixels in a byte
+    static constexpr uint8_t band = 8 / Bits;
+
+    // buffer is drawn in rotation (width() pixels per row). width and height are the controller size.
+    // scratch holds band controller rows: width * Bits bytes
+    EpdRotatedRows(const uint8_t* buffer, uint16_t width, uint16_t height, uint8_t rotation, uint8_t* scratch):
+      _buffer(buffer), _width(width), _height(height), _rotation(rotation & 3), _scratch(scratch),
+      _stride(uint32_t(width) * Bits / 8), _logical_stride(uint32_t(height) * Bits / 8) {}
+
+    // Controller row y, valid until the next call. Rows are expected in order
+    const uint8_t* row(uint16_t y) {
+      switch (_rotation) {
+        case 0:
+          return _buffer + uint32_t(y) * _stride;
+        case 2: {
+          // Same row upside down, read backwards
+          const uint8_t* src = _buffer + uint32_t(_height - 1 - y) * _stride + _stride - 1;
+          for (uint16_t b = 0; b < _stride; b++) {
+            _scratch[b] = _reverse(*src--);
+          }
+          return _scratch;
+        }
+        default:
+          if (y / band != _band) {
+            _band = y / band;
+            _build(_band);
+          }
+          return _scratch + (y % band) * _stride;
+      }
+    }
+
+  private:
+    const uint8_t* _buffer;
+    uint16_t _width;
+    uint16_t _height;
+    uint8_t _rotation;
+    uint8_t* _scratch;
+    uint16_t _stride;
+    uint16_t _logical_stride;
+    int32_t _band = -1;
+
+    static inline uint8_t _reverse(uint8_t b) {
+      return (Bits == 1) ? epd_reverse_bits(b) : epd_swap_nibbles(b);
+    }
+
+    // Controller rows band * k .. band * k + band - 1 are one byte column of the buffer
+    void _build(uint16_t k) {
+      uint8_t in[band];
+      for (uint16_t bx = 0; bx < _stride; bx++) {
+        if (_rotation == 1) {
+          // Buffer rows from the bottom: row width - 1 is controller x 0
+          const uint8_t* src = _buffer + uint32_t(_width - 1 - band * bx) * _logical_stride + k;
+          for (uint8_t i = 0; i < band; i++, src -= _logical_stride) in[i] = *src;
+        } else {
+          // Buffer columns from the right, pixels mirrored inside the byte
+          const uint8_t* src = _buffer + uint32_t(band * bx) * _logical_stride + _logical_stride - 1 - k;
+          for (uint8_t i = 0; i < band; i++, src += _logical_stride) in[i] = _reverse(*src);
+        }
+        if (Bits == 1) {
+          epd_transpose8x8(in, _scratch + bx, _stride);
+        } else {
+          epd_transpose2x2(in, _scratch + bx, _stride);
+        }
+      }
+    }
+};
+template <uint8_t Bits> constexpr uint8_t EpdRotatedRows<Bits>::band;
+#endif
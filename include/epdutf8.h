@@ -0,0 +1,52 @@
+/* UTF-8 text to GFXfont characters
+ *
+ * GFXfont fonts index their glyphs with an 8 bit character. Fonts converted with Latin-1 (first 32,
+ * last 255) have the code points up to U+00FF in place, so those are used as they are. The classic
+ * 5x7 font (nullptr) is code page 437: Latin-1 is mapped to it, '?' where it has no glyph. Other code
+ * points are looked up in the map registered for the font:
+ *
+ *   static const epd_glyph_map_t polish[] = {{0x0104, 0x80}, {0x0141, 0x81}, {0x20AC, 0x82}};
+ *   EpdUtf8::setFontMap(&MyFont12pt, polish, 3);
+ *
+ * Bytes go through the table driven decoder of Bjoern Hoehrmann. A sequence split between two print()
+ * calls continues in the next one. Invalid sequences and code points the font does not have are
+ * printed as EPD_UTF8_MISSING.
+ */
+#ifndef epdutf8_h
+#define epdutf8_h
+
+#include <stdint.h>
+#include <stddef.h>
+#include <Adafruit_GFX.h>
+
+#define EPD_UTF8_MISSING   '?'
+// Fonts that can have a map at the same time
+#define EPD_UTF8_FONT_MAPS 8
+// Bytes print() decodes at a time
+#define EPD_UTF8_RUN       64
+
+typedef struct {
+    uint16_t codepoint;
+    uint8_t c;              // Character of the font that has the glyph
+} epd_glyph_map_t;
+
+class EpdUtf8
+{
+  public:
+    // map must be sorted by codepoint and stay valid. font nullptr is the classic 5x7 font.
+    // Returns false when all EPD_UTF8_FONT_MAPS are taken
+    static bool setFontMap(const GFXfont* font, const epd_glyph_map_t* map, uint16_t size);
+
+    // Decodes len bytes of text into out, the characters of font to write(). Returns how many.
+    // out needs len + 1 bytes: a sequence left open by the last call and broken now adds one
+    size_t decode(const GFXfont* font, const char* text, size_t len, uint8_t* out);
+    // Drops a sequence left incomplete by the last decode()
+    void reset() { _state = 0; }
+
+  private:
+    static uint8_t _lookup(const GFXfont* font, uint32_t codepoint);
+
+    uint32_t _state = 0;
+    uint32_t _codepoint = 0;
+};
+#endif
@@ -11,6 +11,8 @@
 #include <epd.h>
 #include <Adafruit_GFX.h>
 #include <epdspi.h>
+#include <epdframebuffer.h>
+#include <epdrotation.h>
 #include <gdew_colors.h>
 #include <esp_timer.h>
 
@@ -37,6 +39,7 @@ class Gdeh0213b73 : public Epd
     uint8_t colors_supported = 1;
     
     void drawPixel(int16_t x, int16_t y, uint16_t color);  // Override GFX own drawPixel method
+    void setRotation(uint8_t r) override;
     
     // EPD tests 
     void init(bool debug = false);
@@ -53,9 +56,14 @@ class Gdeh0213b73 : public Epd
     void updateToWindow(uint16_t xs, uint16_t ys, uint16_t xd, uint16_t yd, uint16_t w, uint16_t h, bool using_rotation = true);
 
   private:
+    // drawPixel for the current rotation, selected in setRotation()
+    template <uint8_t R> void _drawPixel(int16_t x, int16_t y, uint16_t color);
+    void (Gdeh0213b73::*_drawPixelRotated)(int16_t x, int16_t y, uint16_t color) = &Gdeh0213b73::_drawPixel<0>;
     EpdSpi& IO;
 
     uint8_t _buffer[GDEH0213B73_BUFFER_SIZE];
+    // A bit set to 1 is black
+    Framebuffer<EpdMono1, GDEH0213B73_WIDTH, GDEH0213B73_HEIGHT, EPD_MSB_FIRST, true> _fb{_buffer};
 
     bool debug_enabled = false;
     uint16_t _setPartialRamArea(uint16_t x, uint16_t y, uint16_t xe, uint16_t ye);
@@ -60,13 +60,4 @@ class Gdep015OC1 : public Epd
     void _waitBusy(const char* message, uint16_t busy_time);
     void _waitBusy(const char* message);
     void _rotate(uint16_t& x, uint16_t& y, uint16_t& w, uint16_t& h);
-
-    // Command & data structs
-    static const epd_init_30 LUTDefault_full;
-    static const epd_init_30 LUTDefault_part;
-    static const epd_init_3 GDOControl;
-    static const epd_init_3 epd_soft_start;
-    static const epd_init_1 VCOMVol;
-    static const epd_init_1 DummyLine;
-    static const epd_init_1 Gatetime;
 };
\ No newline at end of file
@@ -12,6 +12,8 @@
 #include <epd.h>
 #include <Adafruit_GFX.h>
 #include <epdspi.h>
+#include <epdframebuffer.h>
+#include <epdrotation.h>
 #include <gdew_colors.h>
 #include <esp_timer.h>
 // Controller: IL0398 (old version, new see Grays class) : http://www.good-display.com/download_detail/downloadsId=537.html
@@ -32,6 +34,7 @@ class Gdew042t2 : public Epd
     uint8_t colors_supported = 1;
     
     void drawPixel(int16_t x, int16_t y, uint16_t color);  // Override GFX own drawPixel method
+    void setRotation(uint8_t r) override;
     
     // EPD tests 
     void init(bool debug = false);
@@ -44,9 +47,13 @@ class Gdew042t2 : public Epd
     // This are already inherited from Epd: write(uint8_t); print(const std::string& text);println(same);
 
   private:
+    // drawPixel for the current rotation, selected in setRotation()
+    template <uint8_t R> void _drawPixel(int16_t x, int16_t y, uint16_t color);
+    void (Gdew042t2::*_drawPixelRotated)(int16_t x, int16_t y, uint16_t color) = &Gdew042t2::_drawPixel<0>;
     EpdSpi& IO;
 
     uint8_t _buffer[GDEW042T2_BUFFER_SIZE];
+    Framebuffer<EpdMono1, GDEW042T2_WIDTH, GDEW042T2_HEIGHT> _fb{_buffer};
     bool _using_partial_mode = false;
     bool _initial = true;
 
@@ -68,10 +75,4 @@ class Gdew042t2 : public Epd
     static const epd_init_42 lut_22_bw_partial;
     static const epd_init_42 lut_23_wb_partial;
     static const epd_init_42 lut_24_bb_partial;
-
-    static const epd_power_4 epd_wakeup_power;
-    static const epd_init_3 epd_soft_start;
-    static const epd_init_1 epd_panel_setting;
-    static const epd_init_1 epd_pll;
-    static const epd_init_4 epd_resolution;
 };
\ No newline at end of file
@@ -12,6 +12,8 @@
 #include <epd.h>
 #include <Adafruit_GFX.h>
 #include <epdspi.h>
+#include <epdframebuffer.h>
+#include <epdrotation.h>
 #if defined CONFIG_IDF_TARGET_ESP32 && ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 0, 0)
   #include "soc/rtc_wdt.h"
 #endif
@@ -33,6 +35,7 @@ class Gdew042t2Grays : public Epd
     uint8_t colors_supported = 1;
     
     void drawPixel(int16_t x, int16_t y, uint16_t color);  // Override GFX own drawPixel method
+    void setRotation(uint8_t r) override;
     
     // EPD tests 
     void init(bool debug = false);
@@ -46,11 +49,17 @@ class Gdew042t2Grays : public Epd
     // This are already inherited from Epd: write(uint8_t); print(const std::string& text);println(same);
 
   private:
+    // drawPixel for the current rotation, selected in setRotation()
+    template <uint8_t R> void _drawPixel(int16_t x, int16_t y, uint16_t color);
+    void (Gdew042t2Grays::*_drawPixelRotated)(int16_t x, int16_t y, uint16_t color) = &Gdew042t2Grays::_drawPixel<0>;
     EpdSpi& IO;
     bool _mono_mode = false;
     uint8_t _buffer1[GDEW042T2_MONO_BUFFER_SIZE];
     uint8_t _buffer2[GDEW042T2_MONO_BUFFER_SIZE];
     uint8_t _mono_buffer[GDEW042T2_MONO_BUFFER_SIZE];
+    Framebuffer<EpdMono1, GDEW042T2_WIDTH, GDEW042T2_HEIGHT> _mono{_mono_buffer};
+    // Plane 0 is _buffer1 and plane 1 _buffer2
+    Framebuffer<EpdPlanes2, GDEW042T2_WIDTH, GDEW042T2_HEIGHT> _grays{_buffer1, _buffer2};
     bool _initial = true;
     bool _partial_mode = false;
     //uint16_t _partials = 0;
@@ -75,10 +84,4 @@ class Gdew042t2Grays : public Epd
     static const epd_init_42 lut_22_bw_partial;
     static const epd_init_42 lut_23_wb_partial;
     static const epd_init_42 lut_24_bb_partial;
-
-    static const epd_power_4 epd_wakeup_power;
-    static const epd_init_3 epd_soft_start;
-    static const epd_init_2 epd_panel_setting;
-    static const epd_init_1 epd_pll;
-    static const epd_init_4 epd_resolution;
 };
\ No newline at end of file
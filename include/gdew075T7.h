@@ -14,6 +14,10 @@
 #include <epd.h>
 #include <Adafruit_GFX.h>
 #include <epdspi.h>
+#include <epdframediff.h>
+#include <epdframebuffer.h>
+#include <epdrotation.h>
+#include <epdtranspose.h>
 // Note in S3 rtc_wdt has errors: https://github.com/espressif/esp-idf/issues/8038
 #if defined CONFIG_IDF_TARGET_ESP32 && ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 0, 0)
   #include "soc/rtc_wdt.h"
@@ -36,9 +40,11 @@ class Gdew075T7 : public Epd
   public:
    
     Gdew075T7(EpdSpi& IO);
+    ~Gdew075T7();
     uint8_t colors_supported = 1;
     
     void drawPixel(int16_t x, int16_t y, uint16_t color);  // Override GFX own drawPixel method
+    void setRotation(uint8_t r) override;
     
     // EPD tests 
     void init(bool debug = false);
@@ -50,23 +56,60 @@ class Gdew075T7 : public Epd
     void fillRawBufferPos(uint16_t index, uint8_t value);
     void fillRawBufferImage(uint8_t image[], uint16_t size);
     void update();
+    // Optional front/back buffers: update() sends the front buffer while the application draws in the back one.
+    // The second buffer goes to PSRAM if available. After each update the back buffer holds a copy of the frame sent:
+    // update() and updateAsync() copy the whole frame (the buffer size) on the caller's thread before sending it
+    bool setDoubleBuffer(bool enabled);
+    // Keeps the last frame sent (or a hash per band) so update() skips unchanged frames and updateWindow() sends only what changed
+    bool setFrameDiff(bool enabled, epd_diff_mode_t mode = EPD_DIFF_SHADOW);
+    // Keeps the buffer in the rotation set and rotates it block-wise while update() sends it, instead of
+    // rotating every pixel drawn. The buffer layout follows the rotation: set it before drawing the frame
+    bool setRotateOnTransmit(bool enabled);
     void setRawBuf(uint32_t position, uint8_t value);
     
   private:
+    // drawPixel for the current rotation, selected in setRotation()
+    template <uint8_t R> void _drawPixel(int16_t x, int16_t y, uint16_t color);
+    void (Gdew075T7::*_drawPixelRotated)(int16_t x, int16_t y, uint16_t color) = &Gdew075T7::_drawPixel<0>;
+    // Same for rotate on transmit: the pixel goes to the buffer as it comes
+    template <uint8_t R> void _drawPixelLogical(int16_t x, int16_t y, uint16_t color);
+    void _selectWriters();
     EpdSpi& IO;
 
-    uint8_t _buffer[GDEW075T7_BUFFER_SIZE];
+    uint8_t _buffer_mem[GDEW075T7_BUFFER_SIZE];
+    // Buffer where the application draws
+    uint8_t* _buffer = _buffer_mem;
+    Framebuffer<EpdMono1, GDEW075T7_WIDTH, GDEW075T7_HEIGHT> _fb{_buffer_mem};
+    // The same buffer drawn in rotation 1 or 3 with rotate on transmit
+    Framebuffer<EpdMono1, GDEW075T7_HEIGHT, GDEW075T7_WIDTH> _fb_portrait{_buffer_mem};
+    // Buffer being sent to the display when double buffering is enabled
+    uint8_t* _front_buffer = nullptr;
+    uint8_t* _buffer_alloc = nullptr;
     // Place _buffer in external RAM
     //uint8_t* _buffer = (uint8_t*)heap_caps_malloc(GDEW075T7_BUFFER_SIZE, MALLOC_CAP_SPIRAM);
 
+    // 8 controller rows built by EpdRotatedRows. nullptr when rotate on transmit is off
+    uint8_t* _tx_rows = nullptr;
+    // Rotation of the buffer being sent
+    uint8_t _tx_rotation = 0;
+
     bool _using_partial_mode = false;
     bool _initial = true;
+    EpdFrameDiff _diff;
+    bool _update_skipped = false;
+    uint64_t _update_start_time = 0;
+    uint64_t _update_sent_time = 0;
     
     uint16_t _setPartialRamArea(uint16_t x, uint16_t y, uint16_t xe, uint16_t ye);
     void _wakeUp();
     void _sleep();
     void _waitBusy(const char* message);
+    void _waitBusy(const char* message, uint32_t timeout_ms);
+    void _updateBegin() override;
+    void _updateFinish() override;
+    bool _updateSwap() override;
     void _rotate(uint16_t& x, uint16_t& y, uint16_t& w, uint16_t& h);
+    void _updateDirtyRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h) override;
     
     // Command & data structs
     // LUT tables for this display are filled with zeroes at the end with writeLuts()
@@ -77,9 +120,7 @@ class Gdew075T7 : public Epd
     static const epd_init_42 lut_24_LUTKK_partial;
     static const epd_init_42 lut_25_LUTBD_partial;
     
-    static const epd_power_4 epd_wakeup_power;
     static const epd_init_1 epd_panel_setting_full;
     static const epd_init_1 epd_panel_setting_partial;
     static const epd_init_1 epd_pll;
-    static const epd_init_4 epd_resolution;
 };
\ No newline at end of file
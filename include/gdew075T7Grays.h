@@ -15,6 +15,8 @@
 #include <epd.h>
 #include <Adafruit_GFX.h>
 #include <epdspi.h>
+#include <epdframebuffer.h>
+#include <epdrotation.h>
 // Note in S3 rtc_wdt has errors: https://github.com/espressif/esp-idf/issues/8038
 #if defined CONFIG_IDF_TARGET_ESP32 && ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 0, 0)
   #include "soc/rtc_wdt.h"
@@ -38,6 +40,7 @@ class Gdew075T7Grays : public Epd
     uint8_t colors_supported = 1;
     
     void drawPixel(int16_t x, int16_t y, uint16_t color);  // Override GFX own drawPixel method
+    void setRotation(uint8_t r) override;
     
     // EPD tests 
     void init(bool debug = false);
@@ -52,8 +55,13 @@ class Gdew075T7Grays : public Epd
     void update();
 
   private:
+    // drawPixel for the current rotation, selected in setRotation()
+    template <uint8_t R> void _drawPixel(int16_t x, int16_t y, uint16_t color);
+    void (Gdew075T7Grays::*_drawPixelRotated)(int16_t x, int16_t y, uint16_t color) = &Gdew075T7Grays::_drawPixel<0>;
     EpdSpi& IO;
     uint8_t* _buffer = (uint8_t*)heap_caps_malloc(GDEW075T7_BUFFER_SIZE, MALLOC_CAP_SPIRAM);
+    // 16 grays, the left pixel of every byte goes in the low nibble
+    Framebuffer<EpdNibble4, GDEW075T7_WIDTH, GDEW075T7_HEIGHT, EPD_LSB_FIRST> _fb{_buffer};
 
     bool _initial = true;
     void _wakeUp();
@@ -69,9 +77,7 @@ class Gdew075T7Grays : public Epd
     static const epd_init_42 lut_wb;
     static const epd_init_42 lut_bb;
     
-    static const epd_power_4 epd_wakeup_power;
     static const epd_init_1 epd_panel_setting_full;
     static const epd_init_1 epd_pll;
-    static const epd_init_4 epd_resolution;
 
 };
\ No newline at end of file
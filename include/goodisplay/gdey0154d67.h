@@ -67,6 +67,7 @@ class Gdey0154d67 : public Epd
     void _waitBusy(const char* message, uint16_t busy_time);
     void _waitBusy(const char* message);
     void _rotate(uint16_t& x, uint16_t& y, uint16_t& w, uint16_t& h);
+    void _updateDirtyRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h) override;
 
     // Command & data structs
     static const epd_lut_159 lut_4_grays;
@@ -13,6 +13,8 @@
 #include <epd.h>
 #include <Adafruit_GFX.h>
 #include <epdspi.h>
+#include <epdframebuffer.h>
+#include <epdrotation.h>
 #include <gdew_4grays.h>
 #include <esp_timer.h>
 
@@ -40,6 +42,7 @@ class Gdey029T94 : public Epd
     uint8_t spi_optimized = true;
 
     void drawPixel(int16_t x, int16_t y, uint16_t color);  // Override GFX own drawPixel method
+    void setRotation(uint8_t r) override;
     
     // EPD tests 
     void init(bool debug = false);
@@ -52,11 +55,17 @@ class Gdey029T94 : public Epd
     void updateWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h, bool using_rotation = true);
   
   private:
+    // drawPixel for the current rotation, selected in setRotation()
+    template <uint8_t R> void _drawPixel(int16_t x, int16_t y, uint16_t color);
+    void (Gdey029T94::*_drawPixelRotated)(int16_t x, int16_t y, uint16_t color) = &Gdey029T94::_drawPixel<0>;
     EpdSpi& IO;
     bool _mono_mode = false;
     uint8_t _mono_buffer[GDEY029T94_BUFFER_SIZE];
     uint8_t _buffer1[GDEY029T94_BUFFER_SIZE];
     uint8_t _buffer2[GDEY029T94_BUFFER_SIZE];
+    Framebuffer<EpdMono1, GDEY029T94_WIDTH, GDEY029T94_HEIGHT> _mono{_mono_buffer};
+    // Plane 0 is _buffer1 and plane 1 _buffer2
+    Framebuffer<EpdPlanes2, GDEY029T94_WIDTH, GDEY029T94_HEIGHT> _grays{_buffer1, _buffer2};
 
     bool debug_enabled = false;
     
@@ -12,6 +12,8 @@
 #include <epd.h>
 #include <Adafruit_GFX.h>
 #include <epdspi.h>
+#include <epdframebuffer.h>
+#include <epdrotation.h>
 #include <gdew_colors.h>
 #include <esp_timer.h>
 #include "FT6X36.h" // Touch interface
@@ -34,6 +36,7 @@ class Gdey027T91T : public Epd
     bool spi_optimized = true;
 
     void drawPixel(int16_t x, int16_t y, uint16_t color);  // Override GFX own drawPixel method
+    void setRotation(uint8_t r) override;
     
     // EPD tests 
     void init(bool debug = false);
@@ -51,12 +54,19 @@ class Gdey027T91T : public Epd
     void(*_touchHandler)(TPoint point, TEvent e) = nullptr;
 
   private:
+    // drawPixel for the current rotation, selected in setRotation()
+    template <uint8_t R> void _drawPixel(int16_t x, int16_t y, uint16_t color);
+    void (Gdey027T91T::*_drawPixelRotated)(int16_t x, int16_t y, uint16_t color) = &Gdey027T91T::_drawPixel<0>;
     EpdSpi& IO;
     FT6X36& Touch;
 
     uint8_t _mono_buffer[GDEY027T91T_BUFFER_SIZE];
     uint8_t _buffer1[GDEY027T91T_BUFFER_SIZE];
     uint8_t _buffer2[GDEY027T91T_BUFFER_SIZE];
+    // A bit set to 1 is black
+    Framebuffer<EpdMono1, GDEY027T91T_WIDTH, GDEY027T91T_HEIGHT, EPD_MSB_FIRST, true> _mono{_mono_buffer};
+    // Plane 0 is _buffer1 and plane 1 _buffer2
+    Framebuffer<EpdPlanes2, GDEY027T91T_WIDTH, GDEY027T91T_HEIGHT> _grays{_buffer1, _buffer2};
 
     bool color = false;
     bool _initial = true;
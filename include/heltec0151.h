@@ -60,9 +60,4 @@ class Hel0151 : public Epd
     void _waitBusy(const char* message, uint16_t busy_time);
     void _waitBusy(const char* message);
     void _rotate(uint16_t& x, uint16_t& y, uint16_t& w, uint16_t& h);
-
-    // Command & data structs
-    static const epd_init_30 LUTDefault_full;
-    static const epd_init_30 LUTDefault_part;
-    static const epd_init_3 GDOControl;
 };
\ No newline at end of file
@@ -10,6 +10,7 @@
 #include "esp_log.h"
 #include <string>
 #include <Adafruit_GFX.h>
+#include <epdutf8.h>
 #include <epdspi2cs.h>
 
 #ifndef plasticlogic_h
@@ -74,6 +75,9 @@ class PlasticLogic : public virtual Adafruit_GFX
 
     // This are common methods every MODELX will inherit
     size_t write(uint8_t);  // hook to Adafruit_GFX::write
+    // Text is UTF-8. Glyphs outside Latin-1 need a map, see EpdUtf8::setFontMap()
+    void print(const char* text, size_t len);
+    void print(const char* text);
     void print(const std::string& text);
     void println(const std::string& text);
     void newline();
@@ -108,6 +112,6 @@ class PlasticLogic : public virtual Adafruit_GFX
     // Only detail IO is being instanced two times and may be not convenient:
     EpdSpi2Cs& IO;
     
-    uint8_t _unicodeEasy(uint8_t c);
+    EpdUtf8 _utf8;
 };
 #endif
\ No newline at end of file
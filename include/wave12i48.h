@@ -12,6 +12,7 @@
 #include <epd.h>
 #include <Adafruit_GFX.h>
 #include <epd4spi.h>
+#include <epdpage.h>
 // Note in S3 rtc_wdt has errors: https://github.com/espressif/esp-idf/issues/8038
 #if defined CONFIG_IDF_TARGET_ESP32 && ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 0, 0)
   #include "soc/rtc_wdt.h"       // Watchdog control
@@ -47,23 +48,28 @@ class Wave12I48 : public Epd
     void updateWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h, bool using_rotation);
     void fillScreen(uint16_t color);
     void update();
+    // Frees the full buffer and draws the frame in bands of about bytes, see epdpage.h. update() does
+    // nothing then: the frame comes from drawPaged(). Turned on by the constructor if there is no PSRAM
+    bool setPaging(bool enabled, uint32_t bytes = EPD_PAGE_BYTES);
+    // Calls draw once per band and sends each band. Without paging draw runs once and update() follows
+    void drawPaged(epd_draw_page_t draw, void* arg = nullptr);
 
   private:
     Epd4Spi& IO;
 
     //uint8_t _buffer[WAVE12I48_BUFFER_SIZE];
     uint8_t* _buffer = (uint8_t*)heap_caps_malloc(WAVE12I48_BUFFER_SIZE, MALLOC_CAP_SPIRAM);
+    // Band drawn in paged mode. _buffer points to it and drawPixel() draws only its rows
+    EpdPage _page;
 
     bool _initial = true;
     
     void _wakeUp();
     void _powerOn();
+    // count buffer rows starting at controller row y to the controllers that own them
+    void _sendRows(const uint8_t* rows, uint16_t y, uint16_t count);
     void _sleep();
     void _waitBusy(const char* message);
-    void _waitBusyM1(const char* message);
-    void _waitBusyM2(const char* message);
-    void _waitBusyS1(const char* message);
-    void _waitBusyS2(const char* message);
     void _rotate(uint16_t& x, uint16_t& y, uint16_t& w, uint16_t& h);
     
     // Command & data structs
@@ -12,6 +12,8 @@
 #include <epd.h>
 #include <Adafruit_GFX.h>
 #include <epd4spi.h>
+#include <epdframebuffer.h>
+#include <epdrotation.h>
 // Note in S3 rtc_wdt has errors: https://github.com/espressif/esp-idf/issues/8038
 #if defined CONFIG_IDF_TARGET_ESP32 && ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 0, 0)
   #include "soc/rtc_wdt.h"       // Watchdog control
@@ -43,6 +45,7 @@ class Wave12I48RB : public Epd
     bool colors_supported = 3;
     
     void drawPixel(int16_t x, int16_t y, uint16_t color);  // Override GFX own drawPixel method
+    void setRotation(uint8_t r) override;
     
     uint16_t _setPartialRamArea(uint16_t x, uint16_t y, uint16_t xe, uint16_t ye);
     // EPD tests 
@@ -55,10 +58,15 @@ class Wave12I48RB : public Epd
     void update();
 
   private:
+    // drawPixel for the current rotation, selected in setRotation()
+    template <uint8_t R> void _drawPixel(int16_t x, int16_t y, uint16_t color);
+    void (Wave12I48RB::*_drawPixelRotated)(int16_t x, int16_t y, uint16_t color) = &Wave12I48RB::_drawPixel<0>;
     Epd4Spi& IO;
 
     uint8_t* _buffer_black = (uint8_t*)heap_caps_malloc(WAVE12I48_BUFFER_SIZE, MALLOC_CAP_SPIRAM);
     uint8_t* _buffer_red = (uint8_t*)heap_caps_malloc(WAVE12I48_BUFFER_SIZE, MALLOC_CAP_SPIRAM);
+    // Value 0 is white, 1 black and 2 red
+    Framebuffer<EpdPlanes2, WAVE12I48_WIDTH, WAVE12I48_HEIGHT> _fb{_buffer_black, _buffer_red};
 
     bool _initial = true;
     
@@ -67,10 +75,6 @@ class Wave12I48RB : public Epd
     void _sleep();
     void _setLut();
     void _waitBusy(const char* message);
-    void _waitBusyM1(const char* message);
-    void _waitBusyM2(const char* message);
-    void _waitBusyS1(const char* message);
-    void _waitBusyS2(const char* message);
     void _rotate(uint16_t& x, uint16_t& y, uint16_t& w, uint16_t& h);
     
     // Command & data structs
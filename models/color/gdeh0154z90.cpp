@@ -31,23 +31,16 @@ void Gdeh0154z90::init(bool debug)
 
 void Gdeh0154z90::fillScreen(uint16_t color)
 {
-    uint8_t black = GDEH0154Z90_8PIX_WHITE;
-    uint8_t red = GDEH0154Z90_8PIX_RED_WHITE;
-
+    uint8_t value = 1; // White
     if (color == EPD_BLACK)
     {
-        black = GDEH0154Z90_8PIX_BLACK;
+        value = 0;
     }
     else if (color == EPD_RED)
     {
-        red = GDEH0154Z90_8PIX_RED;
-    }
-
-    for (uint16_t x = 0; x < sizeof(_black_buffer); x++)
-    {
-        _black_buffer[x] = black;
-        _red_buffer[x] = red;
+        value = 3;
     }
+    _fb.clear(value);
 
     if (debug_enabled)
     {
@@ -55,44 +48,34 @@ void Gdeh0154z90::fillScreen(uint16_t color)
     }
 }
 
-void Gdeh0154z90::drawPixel(int16_t x, int16_t y, uint16_t color)
+void Gdeh0154z90::setRotation(uint8_t r)
 {
-    if ((x < 0) || (x >= width()) || (y < 0) || (y >= height()))
-    {
-        return;
-    }
+    Adafruit_GFX::setRotation(r);
+    static const decltype(_drawPixelRotated) writers[] = {
+        &Gdeh0154z90::_drawPixel<0>, &Gdeh0154z90::_drawPixel<1>, &Gdeh0154z90::_drawPixel<2>, &Gdeh0154z90::_drawPixel<3>};
+    _drawPixelRotated = writers[getRotation()];
+}
 
-    // check rotation, move pixel around if necessary
-    switch (getRotation())
-    {
-    case 1:
-        swap(x, y);
-        x = GDEH0154Z90_WIDTH - x - 1;
-        break;
-    case 2:
-        x = GDEH0154Z90_WIDTH - x - 1;
-        y = GDEH0154Z90_HEIGHT - y - 1;
-        break;
-    case 3:
-        swap(x, y);
-        y = GDEH0154Z90_HEIGHT - y - 1;
-        break;
-    }
-    uint16_t i = x / 8 + y * GDEH0154Z90_WIDTH / 8;
+void Gdeh0154z90::drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+    (this->*_drawPixelRotated)(x, y, color);
+}
 
+template <uint8_t R> void Gdeh0154z90::_drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+    typedef EpdRotation<R, GDEH0154Z90_WIDTH, GDEH0154Z90_HEIGHT> rotation;
+    if (!rotation::contains(x, y)) return;
+    rotation::map(x, y);
     switch (color)
     {
     case EPD_BLACK:
-        _red_buffer[i] = (_red_buffer[i] & (GDEH0154Z90_8PIX_RED_WHITE ^ (1 << (7 - x % 8)))); // white
-        _black_buffer[i] = (_black_buffer[i] & (GDEH0154Z90_8PIX_WHITE ^ (1 << (7 - x % 8)))); // white
+        _fb.set(x, y, 0);
         break;
     case EPD_WHITE:
-        _black_buffer[i] = (_black_buffer[i] | (1 << (7 - x % 8)));
-        _red_buffer[i] = (_red_buffer[i] & (GDEH0154Z90_8PIX_RED_WHITE ^ (1 << (7 - x % 8)))); // white
+        _fb.set(x, y, 1);
         break;
     case EPD_RED:
-        _red_buffer[i] = (_red_buffer[i] | (1 << (7 - x % 8)));
-        _black_buffer[i] = (_black_buffer[i] & (GDEH0154Z90_8PIX_WHITE ^ (1 << (7 - x % 8)))); // white
+        _fb.set(x, y, 2);
         break;
     }
 }
@@ -184,26 +167,11 @@ void Gdeh0154z90::_sleep()
 
 void Gdeh0154z90::_waitBusy(const char *message)
 {
-    if (debug_enabled)
-    {
+    if (debug_enabled) {
         ESP_LOGI(TAG, "_waitBusy for %s", message);
     }
-    int64_t time_since_boot = esp_timer_get_time();
-
-    while (1)
-    {
-        // On low is not busy anymore
-        if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 0)
-            break;
-        vTaskDelay(1);
-        if (esp_timer_get_time() - time_since_boot > 7000000)
-        {
-            if (debug_enabled)
-            {
-                ESP_LOGI(TAG, "Busy Timeout");
-            }
-            break;
-        }
+    if (!IO.waitBusy(0, 7000, message) && debug_enabled) {
+        ESP_LOGI(TAG, "Busy Timeout");
     }
 }
 
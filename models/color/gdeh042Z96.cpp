@@ -169,16 +169,8 @@ void Gdeh042Z96::_waitBusy(const char* message){
   if (debug_enabled) {
     ESP_LOGI(TAG, "_waitBusy for %s", message);
   }
-  int64_t time_since_boot = esp_timer_get_time();
-
-  while (1){
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 0) break;
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>2000000)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
-    }
+  if (!IO.waitBusy(0, 2000, message) && debug_enabled) {
+    ESP_LOGI(TAG, "Busy Timeout");
   }
 }
 
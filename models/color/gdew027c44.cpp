@@ -8,74 +8,62 @@
 #include <inttypes.h>
 
 // This class is refactored to cope with Good display Arduino example
-DRAM_ATTR const epd_init_3 Gdew027c44::epd_soft_start={
-0x06,{0x07,0x07,0x17},3
-};
-
-DRAM_ATTR const epd_init_1 Gdew027c44::epd_extra_setting={
-0x16,{0xaf},1
-};
-// LUT from OTP 128x296
-DRAM_ATTR const epd_init_1 Gdew027c44::epd_panel_setting={
-0x00,{0xaf},1
+DRAM_ATTR static constexpr uint8_t gdew027c44_wakeup[] = {
+  EPD_RESET(10),
+  // IMPORTANT: Some EPD controllers like to receive data byte per byte
+  EPD_CMD_BYTES(0x01, 5), 0x03, 0x00, 0x2b, 0x2b, 0x09, // POWER SETTING
+  EPD_CMD_BYTES(0x06, 3), 0x07, 0x07, 0x17,        // boost. KW-BF   KWR-AF  BWROTP 0f
+  EPD_CMD(0x16, 1), 0xaf,                          // Extra setting
+  EPD_CMD(0x04, 0),                                // Power on
+  EPD_BUSY(1, 7000),
+  // Original boost codes from Good display example - Makes partial update slow
+  EPD_CMD(0x00, 1), 0xaf,                          // Panel setting
+  EPD_CMD(0x30, 1), 0x3a,                          // PLL
+  EPD_DELAY(2),
+  EPD_CMD(0x20, 44),                               // LUT vcomDC
+    0x00  , 0x00,
+    0x00  , 0x1A  , 0x1A  , 0x00  , 0x00  , 0x01,
+    0x00  , 0x0A  , 0x0A  , 0x00  , 0x00  , 0x08,
+    0x00  , 0x0E  , 0x01  , 0x0E  , 0x01  , 0x10,
+    0x00  , 0x0A  , 0x0A  , 0x00  , 0x00  , 0x08,
+    0x00  , 0x04  , 0x10  , 0x00  , 0x00  , 0x05,
+    0x00  , 0x03  , 0x0E  , 0x00  , 0x00  , 0x0A,
+    0x00  , 0x23  , 0x00  , 0x00  , 0x00  , 0x01,
+  EPD_CMD(0x21, 42),                               // LUT 21
+    0x90  , 0x1A  , 0x1A  , 0x00  , 0x00  , 0x01,
+    0x40  , 0x0A  , 0x0A  , 0x00  , 0x00  , 0x08,
+    0x84  , 0x0E  , 0x01  , 0x0E  , 0x01  , 0x10,
+    0x80  , 0x0A  , 0x0A  , 0x00  , 0x00  , 0x08,
+    0x00  , 0x04  , 0x10  , 0x00  , 0x00  , 0x05,
+    0x00  , 0x03  , 0x0E  , 0x00  , 0x00  , 0x0A,
+    0x00  , 0x23  , 0x00  , 0x00  , 0x00  , 0x01,
+  EPD_CMD(0x22, 42),                               // LUT red
+    0xA0  , 0x1A  , 0x1A  , 0x00  , 0x00  , 0x01,
+    0x00  , 0x0A  , 0x0A  , 0x00  , 0x00  , 0x08,
+    0x84  , 0x0E  , 0x01  , 0x0E  , 0x01  , 0x10,
+    0x90  , 0x0A  , 0x0A  , 0x00  , 0x00  , 0x08,
+    0xB0  , 0x04  , 0x10  , 0x00  , 0x00  , 0x05,
+    0xB0  , 0x03  , 0x0E  , 0x00  , 0x00  , 0x0A,
+    0xC0  , 0x23  , 0x00  , 0x00  , 0x00  , 0x01,
+  EPD_CMD(0x23, 42),                               // LUT white
+    0x90  , 0x1A  , 0x1A  , 0x00  , 0x00  , 0x01,
+    0x40  , 0x0A  , 0x0A  , 0x00  , 0x00  , 0x08,
+    0x84  , 0x0E  , 0x01  , 0x0E  , 0x01  , 0x10,
+    0x80  , 0x0A  , 0x0A  , 0x00  , 0x00  , 0x08,
+    0x00  , 0x04  , 0x10  , 0x00  , 0x00  , 0x05,
+    0x00  , 0x03  , 0x0E  , 0x00  , 0x00  , 0x0A,
+    0x00  , 0x23  , 0x00  , 0x00  , 0x00  , 0x01,
+  EPD_CMD(0x24, 42),                               // LUT black
+    0x90  , 0x1A  , 0x1A  , 0x00  , 0x00  , 0x01,
+    0x20  , 0x0A  , 0x0A  , 0x00  , 0x00  , 0x08,
+    0x84  , 0x0E  , 0x01  , 0x0E  , 0x01  , 0x10,
+    0x10  , 0x0A  , 0x0A  , 0x00  , 0x00  , 0x08,
+    0x00  , 0x04  , 0x10  , 0x00  , 0x00  , 0x05,
+    0x00  , 0x03  , 0x0E  , 0x00  , 0x00  , 0x0A,
+    0x00  , 0x23  , 0x00  , 0x00  , 0x00  , 0x01,
+  EPD_END
 };
-
-//partial screen update LUT
-DRAM_ATTR const epd_init_44 Gdew027c44::lut_20_vcomDC={
-0x20, {
-  0x00  , 0x00,
-  0x00  , 0x1A  , 0x1A  , 0x00  , 0x00  , 0x01,
-  0x00  , 0x0A  , 0x0A  , 0x00  , 0x00  , 0x08,
-  0x00  , 0x0E  , 0x01  , 0x0E  , 0x01  , 0x10,
-  0x00  , 0x0A  , 0x0A  , 0x00  , 0x00  , 0x08,
-  0x00  , 0x04  , 0x10  , 0x00  , 0x00  , 0x05,
-  0x00  , 0x03  , 0x0E  , 0x00  , 0x00  , 0x0A,
-  0x00  , 0x23  , 0x00  , 0x00  , 0x00  , 0x01
-},44};
-
-DRAM_ATTR const epd_init_42 Gdew027c44::lut_21={
-0x21, {
-  0x90  , 0x1A  , 0x1A  , 0x00  , 0x00  , 0x01,
-  0x40  , 0x0A  , 0x0A  , 0x00  , 0x00  , 0x08,
-  0x84  , 0x0E  , 0x01  , 0x0E  , 0x01  , 0x10,
-  0x80  , 0x0A  , 0x0A  , 0x00  , 0x00  , 0x08,
-  0x00  , 0x04  , 0x10  , 0x00  , 0x00  , 0x05,
-  0x00  , 0x03  , 0x0E  , 0x00  , 0x00  , 0x0A,
-  0x00  , 0x23  , 0x00  , 0x00  , 0x00  , 0x01
-},42};
-
-DRAM_ATTR const epd_init_42 Gdew027c44::lut_22_red={
-0x22, {
-  0xA0  , 0x1A  , 0x1A  , 0x00  , 0x00  , 0x01,
-  0x00  , 0x0A  , 0x0A  , 0x00  , 0x00  , 0x08,
-  0x84  , 0x0E  , 0x01  , 0x0E  , 0x01  , 0x10,
-  0x90  , 0x0A  , 0x0A  , 0x00  , 0x00  , 0x08,
-  0xB0  , 0x04  , 0x10  , 0x00  , 0x00  , 0x05,
-  0xB0  , 0x03  , 0x0E  , 0x00  , 0x00  , 0x0A,
-  0xC0  , 0x23  , 0x00  , 0x00  , 0x00  , 0x01
-},42};
-
-DRAM_ATTR const epd_init_42 Gdew027c44::lut_23_white={
-0x23, {
-  0x90  , 0x1A  , 0x1A  , 0x00  , 0x00  , 0x01,
-  0x40  , 0x0A  , 0x0A  , 0x00  , 0x00  , 0x08,
-  0x84  , 0x0E  , 0x01  , 0x0E  , 0x01  , 0x10,
-  0x80  , 0x0A  , 0x0A  , 0x00  , 0x00  , 0x08,
-  0x00  , 0x04  , 0x10  , 0x00  , 0x00  , 0x05,
-  0x00  , 0x03  , 0x0E  , 0x00  , 0x00  , 0x0A,
-  0x00  , 0x23  , 0x00  , 0x00  , 0x00  , 0x01
-},42};
-
-DRAM_ATTR const epd_init_42 Gdew027c44::lut_24_black={
-0x24, {
-  0x90  , 0x1A  , 0x1A  , 0x00  , 0x00  , 0x01,
-  0x20  , 0x0A  , 0x0A  , 0x00  , 0x00  , 0x08,
-  0x84  , 0x0E  , 0x01  , 0x0E  , 0x01  , 0x10,
-  0x10  , 0x0A  , 0x0A  , 0x00  , 0x00  , 0x08,
-  0x00  , 0x04  , 0x10  , 0x00  , 0x00  , 0x05,
-  0x00  , 0x03  , 0x0E  , 0x00  , 0x00  , 0x0A,
-  0x00  , 0x23  , 0x00  , 0x00  , 0x00  , 0x01
-},42};
+static_assert(epd_sequence_valid(gdew027c44_wakeup, sizeof(gdew027c44_wakeup)), "gdew027c44_wakeup is malformed");
 
 // Constructor
 Gdew027c44::Gdew027c44(EpdSpi& dio): 
@@ -115,53 +103,7 @@ void Gdew027c44::fillScreen(uint16_t color)
 
 void Gdew027c44::_wakeUp(){
   printf("wakeup() start commands\n");
-  IO.reset(10);
-
-  IO.cmd(0x01); //POWER SETTING
-  IO.data(0x03);
-  IO.data(0x00);
-  IO.data(0x2b);
-  IO.data(0x2b);
-  IO.data(0x09);
-  //KW-BF   KWR-AF  BWROTP 0f
-  IO.cmd(epd_soft_start.cmd);     // boost
-  for (int i=0;i<epd_soft_start.databytes;++i) {
-      IO.data(epd_soft_start.data[i]);
-  }
-  IO.cmd(epd_extra_setting.cmd);  // CMD: 0x16 DATA: 0x00
-  IO.data(epd_extra_setting.data[0]);
-
-
-  IO.cmd(0x04);
-  _waitBusy("epd_wakeup_power:ON");
-  
-  // Original boost codes from Good display example - Makes partial update slow
-  IO.cmd(epd_panel_setting.cmd);  // CMD: 0x00 DATA: 0xbf
-  IO.data(0xaf);
-
-  IO.cmd(0x30);
-  IO.data(0x3a);
-  vTaskDelay(2/portTICK_PERIOD_MS); // delay(2)
-  IO.cmd(lut_20_vcomDC.cmd);
-  for (int i=0;i<lut_20_vcomDC.databytes;++i) {
-      IO.data(lut_20_vcomDC.data[i]);
-  }
-  IO.cmd(lut_21.cmd);
-  for (int i=0;i<lut_21.databytes;++i) {
-      IO.data(lut_21.data[i]);
-  }
-  IO.cmd(lut_22_red.cmd);
-  for (int i=0;i<lut_22_red.databytes;++i) {
-      IO.data(lut_22_red.data[i]);
-  }
-  IO.cmd(lut_23_white.cmd);
-  for (int i=0;i<lut_23_white.databytes;++i) {
-      IO.data(lut_23_white.data[i]);
-  }
-  IO.cmd(lut_24_black.cmd);
-  for (int i=0;i<lut_24_black.databytes;++i) {
-      IO.data(lut_24_black.data[i]);
-  }
+  IO.sequence(gdew027c44_wakeup);
 }
 
 void Gdew027c44::update()
@@ -252,16 +194,8 @@ void Gdew027c44::_waitBusy(const char* message){
   if (debug_enabled) {
     ESP_LOGI(TAG, "_waitBusy for %s", message);
   }
-  int64_t time_since_boot = esp_timer_get_time();
-
-  while (1){
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 1) break;
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>7000000)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
-    }
+  if (!IO.waitBusy(1, 7000, message) && debug_enabled) {
+    ESP_LOGI(TAG, "Busy Timeout");
   }
 }
 
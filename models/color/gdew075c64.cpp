@@ -9,29 +9,27 @@
 // Controller: GD7965 (EK79655)
 // Specification: https://www.scribd.com/document/448888338/GDEW075C64-V1-0-Specification
 
-// 0x07 (2nd) VGH=20V,VGL=-20V
-// 0x3f (1st) VDH= 15V
-// 0x3f (2nd) VDH=-15V
-DRAM_ATTR const epd_power_4 Gdew075C64::epd_wakeup_power = {
-    0x01, {0x07, 0x07, 0x3f, 0x3f}, 4};
-
-DRAM_ATTR const epd_init_4 Gdew075C64::epd_resolution = {
-    0x61, {0x03, //source 800
-           0x20,
-           0x01, //gate 480
-           0xE0},
-    4};
-
-// Note: Played with this settings. If is too high (In specs says 0x17) then
-//       yellow will get out from right side. Too low and won't be yellow enough (But is sill not 100% right)
-//       For me it looks more yellow on the top and more dark yellow on the bottom
-DRAM_ATTR const epd_init_4 Gdew075C64::epd_boost={
-0x06,{
-  0x17,
-  0x17,
-  0x25, /* Top part of the display get's more color on 0x16. On 0x18 get's too yellow and desbords on left side. On 0x17 is shit */
-  0x17},4
+DRAM_ATTR static constexpr uint8_t gdew075c64_wakeup[] = {
+  EPD_RESET(10),
+  // IMPORTANT: Some EPD controllers like to receive data byte per byte
+  EPD_CMD_BYTES(0x01, 4), 0x07, 0x07, 0x3f, 0x3f, // POWER SETTING VGH=20V,VGL=-20V VDH=15V VDL=-15V
+  EPD_CMD(0x04, 0),                                // Power on
+  EPD_BUSY(1, 2000),
+  EPD_CMD(0x00, 1), 0x0f,                          // Panel setting KW: 3f, KWR: 2F, BWROTP: 0f, BWOTP: 1f
+  EPD_CMD(0x30, 1), 0x06,                          // PLL
+  EPD_CMD_BYTES(0x61, 4), 0x03, 0x20, 0x01, 0xE0,  // Resolution setting: source 800, gate 480
+  // Boost: Handles the intensity of the colors displayed. Played with this settings. If is too high
+  // (In specs says 0x17) then yellow will get out from right side. Too low and won't be yellow enough
+  // (But is sill not 100% right). For me it looks more yellow on the top and more dark yellow on the bottom
+  // 3rd: Top part of the display get's more color on 0x16. On 0x18 get's too yellow and desbords on left side. On 0x17 is shit
+  EPD_CMD_BYTES(0x06, 4), 0x17, 0x17, 0x25, 0x17,
+  // Not sure if 0x15 is really needed, seems to work the same without it too
+  EPD_CMD(0x15, 1), 0x00,                          // Dual SPI: MM_EN, DUSPI_EN
+  EPD_CMD_BYTES(0x50, 2), 0x11, 0x07,              // VCOM AND DATA INTERVAL SETTING: LUTKW, N2OCP: copy new to old
+  EPD_CMD(0x60, 1), 0x22,                          // TCON SETTING
+  EPD_END
 };
+static_assert(epd_sequence_valid(gdew075c64_wakeup, sizeof(gdew075c64_wakeup)), "gdew075c64_wakeup is malformed");
 
 // Constructor
 Gdew075C64::Gdew075C64(EpdSpi &dio) : Adafruit_GFX(GDEW075C64_WIDTH, GDEW075C64_HEIGHT),
@@ -70,51 +68,7 @@ void Gdew075C64::fillScreen(uint16_t color)
 
 void Gdew075C64::_wakeUp()
 {
-  IO.reset(10);
-  //IMPORTANT: Some EPD controllers like to receive data byte per byte
-  //So this won't work:
-  //IO.data(epd_wakeup_power.data,epd_wakeup_power.databytes);
-
-  IO.cmd(epd_wakeup_power.cmd);
-  for (int i = 0; i < epd_wakeup_power.databytes; ++i)
-  {
-    IO.data(epd_wakeup_power.data[i]);
-  }
-
-  IO.cmd(0x04);
-  _waitBusy("_wakeUp power on");
-
-  // Panel setting
-  IO.cmd(0x00);
-  IO.data(0x0f); //KW: 3f, KWR: 2F, BWROTP: 0f, BWOTP: 1f
-
-  // PLL 
-  IO.cmd(0x30);
-  IO.data(0x06);
-
-  // Resolution setting
-  IO.cmd(epd_resolution.cmd);
-  for (int i = 0; i < epd_resolution.databytes; ++i)
-  {
-    IO.data(epd_resolution.data[i]);
-  }
-
-  printf("Boost\n"); // Handles the intensity of the colors displayed
-  IO.cmd(epd_boost.cmd);
-  for (int i=0;i<sizeof(epd_boost.data);++i) {
-    IO.data(epd_boost.data[i]);
-  }
-
-  // Not sure if 0x15 is really needed, seems to work the same without it too
-  IO.cmd(0x15);  // Dual SPI
-  IO.data(0x00); // MM_EN, DUSPI_EN
-
-  IO.cmd(0x50);  // VCOM AND DATA INTERVAL SETTING
-  IO.data(0x11); // LUTKW, N2OCP: copy new to old
-  IO.data(0x07);
-
-  IO.cmd(0x60);  // TCON SETTING
-  IO.data(0x22);
+  IO.sequence(gdew075c64_wakeup);
 }
 
 void Gdew075C64::update()
@@ -180,23 +134,11 @@ void Gdew075C64::updateWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h, bo
 
 void Gdew075C64::_waitBusy(const char *message)
 {
-  if (debug_enabled)
-  {
+  if (debug_enabled) {
     ESP_LOGI(TAG, "_waitBusy for %s", message);
   }
-  int64_t time_since_boot = esp_timer_get_time();
-
-  while (1)
-  {
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 1)
-      break;
-    vTaskDelay(1);
-    if (esp_timer_get_time() - time_since_boot > 2000000)
-    {
-      if (debug_enabled)
-        ESP_LOGI(TAG, "Busy Timeout");
-      break;
-    }
+  if (!IO.waitBusy(1, 2000, message) && debug_enabled) {
+    ESP_LOGI(TAG, "Busy Timeout");
   }
 }
 
@@ -7,6 +7,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <inttypes.h>
+// A full 7 color refresh takes many seconds, much more than the default busy timeout
+#define GDEY073D46_REFRESH_TIMEOUT 30000
 // Constructor
 gdey073d46::gdey073d46(EpdSpi& dio): 
   Adafruit_GFX(GDEY073D46_WIDTH, GDEY073D46_HEIGHT),
@@ -14,6 +16,17 @@ gdey073d46::gdey073d46(EpdSpi& dio):
 {
   printf("gdey073d46() constructor injects IO and extends Adafruit_GFX(%d,%d)\n",
   GDEY073D46_WIDTH, GDEY073D46_HEIGHT);  
+  if (_buffer == nullptr) {
+    ESP_LOGW(TAG, "No memory for a %d bytes buffer, drawing in bands: use drawPaged()", (int)GDEY073D46_BUFFER_SIZE);
+    setPaging(true);
+  }
+}
+
+gdey073d46::~gdey073d46()
+{
+  // _updateFinish() of an update in flight needs this object
+  _asyncStop();
+  free(_tx_rows);
 }
 
 //Initialize the display
@@ -31,160 +44,177 @@ void gdey073d46::init(bool debug)
 
 void gdey073d46::fillScreen(uint16_t color)
 {
-  uint8_t pv = _color7(color);
-  uint8_t pv2 = pv | pv << 4;
-  for (uint32_t x = 0; x < GDEY073D46_BUFFER_SIZE; x++)
-  {
-    _buffer[x] = pv2;
+  if (_page.enabled()) {
+    _fb.fill(0, 0, GDEY073D46_WIDTH, _page.count(), _color7(color));
+    return;
   }
+  _fb.clear(_color7(color));
 
   if (debug_enabled) printf("fillScreen(%x) _buffer len:%d\n", color, sizeof(_buffer));
 }
 
-void gdey073d46::_wakeUp(){
-  IO.reset(10);
-  vTaskDelay(200 / portTICK_PERIOD_MS);
-  // Wait for the electronic paper IC to release the idle signal
-  //_waitBusy("epd_wakeup reset");
-
-  // <Essential settings> in GOODISPLAY example 
-  IO.cmd(0xAA);   // CMDH
-  IO.data(0x49);
-  IO.data(0x55);
-  IO.data(0x20);
-  IO.data(0x08);
-  IO.data(0x09);
-  IO.data(0x18);
-
-  IO.cmd(0x01);   // PWRR
-  IO.data(0x3F);
-  IO.data(0x00);
-  IO.data(0x32);
-  IO.data(0x2A);
-  IO.data(0x0E);
-  IO.data(0x2A);
-  
-  IO.cmd(0x00);   // PSR
-  IO.data(0x5F);
-  IO.data(0x69);
-  
-  IO.cmd(0x03);   // POFS
-  IO.data(0x00);
-  IO.data(0x54);
-  IO.data(0x00);
-  IO.data(0x44); 
-
-  IO.cmd(0x05);   // BTST1
-  IO.data(0x40);
-  IO.data(0x1F);
-  IO.data(0x1F);
-  IO.data(0x2C);
-  
-  IO.cmd(0x06);   // BTST2
-  IO.data(0x6F);
-  IO.data(0x1F);
-  IO.data(0x16);
-  IO.data(0x25);
-
-  IO.cmd(0x08);   // BTST3
-  IO.data(0x6F);
-  IO.data(0x1F);
-  IO.data(0x1F);
-  IO.data(0x22);
- 
-  IO.cmd(0x13);    // IPC
-  IO.data(0x00);
-  IO.data(0x04);
-  
-  IO.cmd(0x30);    // PLL
-  IO.data(0x02);
-  
-  IO.cmd(0x41);    // TSE
-  IO.data(0x00);
-  
-  IO.cmd(0x50);    // CDI
-  IO.data(0x3F);
-  
-  IO.cmd(0x60);    // TCON
-  IO.data(0x02);
-  IO.data(0x00);
-  
-  IO.cmd(0x61);    // TRES
-  IO.data(0x03);
-  IO.data(0x20);
-  IO.data(0x01); 
-  IO.data(0xE0);
-  
-  IO.cmd(0x82);    // VDCS
-  IO.data(0x1E); 
-
-  IO.cmd(0x84);    // T_VDCS
-  IO.data(0x00);
+// <Essential settings> in GOODISPLAY example
+DRAM_ATTR static constexpr uint8_t gdey073d46_wakeup[] = {
+  EPD_RESET(10),
+  EPD_DELAY(200),
+  EPD_CMD(0xAA, 6), 0x49, 0x55, 0x20, 0x08, 0x09, 0x18, // CMDH
+  EPD_CMD(0x01, 6), 0x3F, 0x00, 0x32, 0x2A, 0x0E, 0x2A, // PWRR
+  EPD_CMD(0x00, 2), 0x5F, 0x69,                         // PSR
+  EPD_CMD(0x03, 4), 0x00, 0x54, 0x00, 0x44,             // POFS
+  EPD_CMD(0x05, 4), 0x40, 0x1F, 0x1F, 0x2C,             // BTST1
+  EPD_CMD(0x06, 4), 0x6F, 0x1F, 0x16, 0x25,             // BTST2
+  EPD_CMD(0x08, 4), 0x6F, 0x1F, 0x1F, 0x22,             // BTST3
+  EPD_CMD(0x13, 2), 0x00, 0x04,                         // IPC
+  EPD_CMD(0x30, 1), 0x02,                               // PLL
+  EPD_CMD(0x41, 1), 0x00,                               // TSE
+  EPD_CMD(0x50, 1), 0x3F,                               // CDI
+  EPD_CMD(0x60, 2), 0x02, 0x00,                         // TCON
+  EPD_CMD(0x61, 4), GDEY073D46_WIDTH / 256, GDEY073D46_WIDTH % 256,
+                    GDEY073D46_HEIGHT / 256, GDEY073D46_HEIGHT % 256, // TRES 800x480
+  EPD_CMD(0x82, 1), 0x1E,                               // VDCS
+  EPD_CMD(0x84, 1), 0x00,                               // T_VDCS
+  EPD_CMD(0x86, 1), 0x00,                               // AGID
+  EPD_CMD(0xE3, 1), 0x2F,                               // PWS
+  EPD_CMD(0xE0, 1), 0x00,                               // CCSET
+  EPD_CMD(0xE6, 1), 0x00,                               // TSSET
+  EPD_CMD(0x04, 0),                                     // PWR on
+  EPD_BUSY(1, 2000),
+  EPD_END
+};
+static_assert(epd_sequence_valid(gdey073d46_wakeup, sizeof(gdey073d46_wakeup)), "gdey073d46_wakeup is malformed");
 
-  IO.cmd(0x86);    // AGID
-  IO.data(0x00);
-  
-  IO.cmd(0xE3);    // PWS
-  IO.data(0x2F);
- 
-  IO.cmd(0xE0);    // CCSET
-  IO.data(0x00); 
-  
-  IO.cmd(0xE6);   // TSSET
-  IO.data(0x00);	
-
-	IO.cmd(0x04);		//PWR on
-  _waitBusy("power on");
+void gdey073d46::_wakeUp(){
+  IO.sequence(gdey073d46_wakeup);
 }
 
 void gdey073d46::update()
+{
+  waitForUpdate();
+  _updateBegin();
+  _updateFinish();
+}
+
+void gdey073d46::_updateBegin()
 {
   printf("display.update() called\n");
+  _update_skipped = _page.enabled();
+  if (_update_skipped) {
+    ESP_LOGE(TAG, "Paged mode has no frame buffer to send: draw the frame with drawPaged()");
+    return;
+  }
 
-  uint64_t startTime = esp_timer_get_time();
+  _update_start_time = esp_timer_get_time();
   _wakeUp();
 
   IO.cmd(0x10);
 
+  // With rotate on transmit every 2 rows are built from the buffer right before they are sent
+  EpdRotatedRows<4> rows(_buffer, GDEY073D46_WIDTH, GDEY073D46_HEIGHT, (_tx_rows != nullptr) ? getRotation() : 0, _tx_rows);
+  _sendRows(rows, GDEY073D46_HEIGHT);
+
+  _update_sent_time = esp_timer_get_time();
+
+  IO.cmd(0x12);
+  IO.data(0x00);
+}
+
+void gdey073d46::_sendRows(EpdRotatedRows<4>& rows, uint16_t count)
+{
+  uint16_t xLineBytes = GDEY073D46_WIDTH/2;
   // v2 SPI optimizing. Check: https://github.com/martinberlin/cale-idf/wiki/About-SPI-optimization
   if (spi_optimized) {
+    // Rows are queued using DMA. Since _buffer lives in PSRAM each row is copied to a DMA capable buffer
     uint32_t i = 0;
-    uint16_t xLineBytes = GDEY073D46_WIDTH/2;
-    uint8_t x1buf[xLineBytes];
-    for (uint16_t y = 1; y <= GDEY073D46_HEIGHT; y++)
+    IO.dataStreamBegin(xLineBytes);
+    for (uint16_t y = 0; y < count; y++)
     {
-      for (uint16_t x = 1; x <= xLineBytes; x++)
-      {
-        uint8_t data = i < GDEY073D46_BUFFER_SIZE ? _buffer[i] : 0x33;
-        x1buf[x - 1] = data;
-        if (x == xLineBytes)
-        { // Flush the X line buffer to SPI
-          IO.data(x1buf, sizeof(x1buf));
-        }
-        ++i;
-      }
+      IO.dataStream(rows.row(y), xLineBytes);
+      i += xLineBytes;
     }
+    IO.dataStreamEnd();
     if (debug_enabled) {
-      printf("\nSPI optimization is on. Sending full xLineBytes: %d per SPI (4 bits per pixel)\n\nBuffer size: %d  expected size: %d\n", 
-      (int)xLineBytes, (int)i, (int)GDEY073D46_BUFFER_SIZE);
+      printf("\nSPI optimization is on. Sending full xLineBytes: %d per SPI (4 bits per pixel)\n\nSent: %d bytes\n", 
+      (int)xLineBytes, (int)i);
     }
 
   } else {
-    for (uint32_t i = 0; i < GDEY073D46_BUFFER_SIZE; i++) {
-      IO.data(_buffer[i]);
+    for (uint16_t y = 0; y < count; y++) {
+      const uint8_t* row = rows.row(y);
+      for (uint16_t x = 0; x < xLineBytes; x++) {
+        IO.data(row[x]);
+      }
+    }
+  }
+}
+
+bool gdey073d46::setPaging(bool enabled, uint32_t bytes)
+{
+  waitForUpdate();
+  if (enabled) {
+    // The band is in controller layout
+    setRotateOnTransmit(false);
+    if (!_page.begin(bytes, GDEY073D46_WIDTH / 2, GDEY073D46_HEIGHT)) return false;
+    free(_buffer);
+    _buffer = nullptr;
+    _fb.setData(_page.data());
+    _fb_portrait.setData(_page.data());
+  } else {
+    if (!_page.enabled()) return true;
+    uint8_t* buffer = (uint8_t*)heap_caps_malloc(GDEY073D46_BUFFER_SIZE, MALLOC_CAP_SPIRAM);
+    if (buffer == nullptr) {
+      buffer = (uint8_t*)heap_caps_malloc(GDEY073D46_BUFFER_SIZE, MALLOC_CAP_8BIT);
+    }
+    if (buffer == nullptr) {
+      ESP_LOGE(TAG, "Not enough memory for a %d bytes buffer", (int)GDEY073D46_BUFFER_SIZE);
+      return false;
     }
+    _page.end();
+    _buffer = buffer;
+    _fb.setData(_buffer);
+    _fb_portrait.setData(_buffer);
+    fillScreen(EPD_WHITE);
   }
+  _selectWriters();
+  return true;
+}
 
-  uint64_t endTime = esp_timer_get_time();
+void gdey073d46::drawPaged(epd_draw_page_t draw, void* arg)
+{
+  if (!_page.enabled()) {
+    draw(*this, arg);
+    update();
+    return;
+  }
+  waitForUpdate();
+  printf("display.drawPaged() called, bands of %d rows\n", (int)_page.rows());
+
+  _update_start_time = esp_timer_get_time();
+  _wakeUp();
+
+  IO.cmd(0x10);
+  for (uint16_t y = 0; _page.select(y); y += _page.rows()) {
+    _fb.fill(0, 0, GDEY073D46_WIDTH, _page.count(), _color7(EPD_WHITE));
+    draw(*this, arg);
+    EpdRotatedRows<4> rows(_page.data(), GDEY073D46_WIDTH, _page.count(), 0, nullptr);
+    _sendRows(rows, _page.count());
+  }
+  _update_sent_time = esp_timer_get_time();
 
   IO.cmd(0x12);
   IO.data(0x00);
+  _update_skipped = false;
+  _updateFinish();
+}
+
+void gdey073d46::_updateFinish()
+{
+  if (_update_skipped) return;
   vTaskDelay(2);
-  _waitBusy("0x12 display refresh");
+  _waitBusy("0x12 display refresh", GDEY073D46_REFRESH_TIMEOUT);
 
   uint64_t powerOnTime = esp_timer_get_time();
   printf("\n\nSTATS (ms)\n%llu _wakeUp settings+send Buffer\n%llu _powerOn\n%llu total time in millis\n",
-  (endTime-startTime)/1000, (powerOnTime-endTime)/1000, (powerOnTime-startTime)/1000);
+  (_update_sent_time-_update_start_time)/1000, (powerOnTime-_update_sent_time)/1000, (powerOnTime-_update_start_time)/1000);
 
   // DEBUG Disable sleep until Buffer is completely written and tested
   //vTaskDelay(1000 / portTICK_PERIOD_MS);
@@ -192,22 +222,19 @@ void gdey073d46::update()
 }
 
 void gdey073d46::_waitBusy(const char* message){
+  _waitBusy(message, 2000);
+}
+
+void gdey073d46::_waitBusy(const char* message, uint32_t timeout_ms){
   if (debug_enabled) {
     ESP_LOGI(TAG, "_waitBusy for %s", message);
   }
   int64_t time_since_boot = esp_timer_get_time();
 
-  while (1){
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 1) {
-      ESP_LOGI(TAG, "Busy release for %s in %llu ms", message, (esp_timer_get_time()-time_since_boot)/1000 );
-      break;
-    }
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>2000000)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout: %s", message);
-      break;
-    }
+  if (IO.waitBusy(1, timeout_ms, message)) {
+    ESP_LOGI(TAG, "Busy release for %s in %llu ms", message, (esp_timer_get_time()-time_since_boot)/1000 );
+  } else if (debug_enabled) {
+    ESP_LOGI(TAG, "Busy Timeout: %s", message);
   }
 }
 
@@ -239,31 +266,81 @@ void gdey073d46::_rotate(uint16_t& x, uint16_t& y, uint16_t& w, uint16_t& h)
   }
 }
 
+void gdey073d46::setRotation(uint8_t r)
+{
+  Adafruit_GFX::setRotation(r);
+  _selectWriters();
+}
+
+bool gdey073d46::setRotateOnTransmit(bool enabled)
+{
+  waitForUpdate();
+  if (enabled && _page.enabled()) {
+    ESP_LOGE(TAG, "Rotate on transmit needs the full buffer, it does not work in paged mode");
+    return false;
+  }
+  if (enabled && _tx_rows == nullptr) {
+    _tx_rows = (uint8_t*)heap_caps_malloc(EpdRotatedRows<4>::band * GDEY073D46_WIDTH / 2, MALLOC_CAP_8BIT);
+    if (_tx_rows == nullptr) {
+      ESP_LOGE(TAG, "Not enough memory for rotate on transmit");
+      return false;
+    }
+  } else if (!enabled && _tx_rows != nullptr) {
+    free(_tx_rows);
+    _tx_rows = nullptr;
+  }
+  _selectWriters();
+  return true;
+}
+
+void gdey073d46::_selectWriters()
+{
+  static const decltype(_drawPixelRotated) writers[] = {
+    &gdey073d46::_drawPixel<0>, &gdey073d46::_drawPixel<1>, &gdey073d46::_drawPixel<2>, &gdey073d46::_drawPixel<3>};
+  static const decltype(_drawPixelRotated) logical_writers[] = {
+    &gdey073d46::_drawPixelLogical<0>, &gdey073d46::_drawPixelLogical<1>,
+    &gdey073d46::_drawPixelLogical<2>, &gdey073d46::_drawPixelLogical<3>};
+  static const decltype(_drawPixelRotated) paged_writers[] = {
+    &gdey073d46::_drawPixelPaged<0>, &gdey073d46::_drawPixelPaged<1>,
+    &gdey073d46::_drawPixelPaged<2>, &gdey073d46::_drawPixelPaged<3>};
+  if (_page.enabled()) {
+    _drawPixelRotated = paged_writers[getRotation()];
+  } else {
+    _drawPixelRotated = (_tx_rows != nullptr) ? logical_writers[getRotation()] : writers[getRotation()];
+  }
+}
+
 /**
  * From GxEPD2 (Jean-Marc)
  */
-void gdey073d46::drawPixel(int16_t x, int16_t y, uint16_t color) {
-  if ((x < 0) || (x >= width()) || (y < 0) || (y >= height())) return;
+void gdey073d46::drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+  (this->*_drawPixelRotated)(x, y, color);
+}
 
-  // Check rotation, move pixel around if necessary
-  switch (getRotation())
-  {
-    case 1:
-      swap(x, y);
-      x = GDEY073D46_WIDTH - x - 1;
-      break;
-    case 2:
-      x = GDEY073D46_WIDTH - x - 1;
-      y = GDEY073D46_HEIGHT - y - 1;
-      break;
-    case 3:
-      swap(x, y);
-      y = GDEY073D46_HEIGHT - y - 1;
-      break;
+template <uint8_t R> void gdey073d46::_drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+  typedef EpdRotation<R, GDEY073D46_WIDTH, GDEY073D46_HEIGHT> rotation;
+  if (!rotation::contains(x, y)) return;
+  rotation::map(x, y);
+  _fb.set(x, y, _color7(color));
+}
+
+template <uint8_t R> void gdey073d46::_drawPixelLogical(int16_t x, int16_t y, uint16_t color)
+{
+  if (!EpdRotation<R, GDEY073D46_WIDTH, GDEY073D46_HEIGHT>::contains(x, y)) return;
+  if (R & 1) {
+    _fb_portrait.set(x, y, _color7(color));
+  } else {
+    _fb.set(x, y, _color7(color));
   }
-  uint32_t i = x / 2 + uint32_t(y) * (GDEY073D46_WIDTH / 2);
-  uint8_t pv = _color7(color);
-      
-  if (x & 1) _buffer[i] = (_buffer[i] & 0xF0) | pv;
-    else _buffer[i] = (_buffer[i] & 0x0F) | (pv << 4);
+}
+
+template <uint8_t R> void gdey073d46::_drawPixelPaged(int16_t x, int16_t y, uint16_t color)
+{
+  typedef EpdRotation<R, GDEY073D46_WIDTH, GDEY073D46_HEIGHT> rotation;
+  if (!rotation::contains(x, y)) return;
+  rotation::map(x, y);
+  if (!_page.contains(y)) return;
+  _fb.set(x, y - _page.top(), _color7(color));
 }
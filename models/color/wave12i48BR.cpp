@@ -127,131 +127,60 @@ void Wave12I48RB::fillScreen(uint16_t color)
 
 void Wave12I48RB::_powerOn(){
     // Power on
-  IO.cmdM1(0x04);
-  IO.cmdM2(0x04);
-  vTaskDelay(pdMS_TO_TICKS(300));
+  IO.cmd(EPD4SPI_M1 | EPD4SPI_M2, 0x04);
+  IO.waitBusy(EPD4SPI_M1 | EPD4SPI_M2, WAVE_BUSY_TIMEOUT / 1000, "power on");
+  // The 4 panels refresh at the same time: wait for the last one to be ready
   IO.cmdM1S1M2S2(0x12);
-  _waitBusyM1("display refresh");
-  _waitBusyM2("display refresh");
+  bool ready = IO.waitBusy(EPD4SPI_ALL, WAVE_BUSY_TIMEOUT / 1000, "display refresh");
+  if (!ready && debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
 }
 
 void Wave12I48RB::_setLut(){
   printf("\nSending LUT init tables\n");
-  uint8_t count = 0;
-  IO.cmdM1S1M2S2(0x20);							//vcom
-  for(count=0; count<60; count++) {
-      IO.dataM1S1M2S2(lut_vcom1[count]);
-  }
-
-  IO.cmdM1S1M2S2(0x21);							//red not use
-  for(count=0; count<60; count++) {
-      IO.dataM1S1M2S2(lut_ww1[count]);
-  }
-
-  IO.cmdM1S1M2S2(0x22);							//bw r
-  for(count=0; count<60; count++) {
-      IO.dataM1S1M2S2(lut_bw1[count]);   // bw=r
-  }
-
-  IO.cmdM1S1M2S2(0x23);							//wb w
-  for(count=0; count<60; count++) {
-      IO.dataM1S1M2S2(lut_wb1[count]);   // wb=w
-  }
-
-  IO.cmdM1S1M2S2(0x24);							//bb b
-  for(count=0; count<60; count++) {
-      IO.dataM1S1M2S2(lut_bb1[count]);   // bb=b
-  }
-
-  IO.cmdM1S1M2S2(0x25);							//bb b
-  for(count=0; count<60; count++) {
-      IO.dataM1S1M2S2(lut_ww1[count]);   // bb=b
-  }
+  // Each table is broadcast to the 4 panels in one transfer
+  IO.cmdData(EPD4SPI_ALL, 0x20, lut_vcom1, 60); //vcom
+  IO.cmdData(EPD4SPI_ALL, 0x21, lut_ww1, 60);   //red not use
+  IO.cmdData(EPD4SPI_ALL, 0x22, lut_bw1, 60);   //bw r
+  IO.cmdData(EPD4SPI_ALL, 0x23, lut_wb1, 60);   //wb w
+  IO.cmdData(EPD4SPI_ALL, 0x24, lut_bb1, 60);   //bb b
+  IO.cmdData(EPD4SPI_ALL, 0x25, lut_ww1, 60);   //bb b
 }
 
 void Wave12I48RB::_wakeUp(){
   IO.reset(200);
   // Panel setting
   printf("_wakeUp() initial epaper bootstrap: Panel setting\n");
-  IO.cmdM1(epd_panel_setting_full.cmd);
-  IO.dataM1(epd_panel_setting_full.data[0]);
-  IO.cmdS1(epd_panel_setting_full.cmd);
-  IO.dataS1(epd_panel_setting_full.data[0]);
-  IO.cmdM2(epd_panel_setting_full.cmd);
-  IO.dataM2(0x23);
-  IO.cmdS2(epd_panel_setting_full.cmd);
-  IO.dataS2(0x23);
+  static const uint8_t panel_setting_m2s2[] = {0x23};
+  IO.cmdData(EPD4SPI_M1 | EPD4SPI_S1, epd_panel_setting_full);
+  IO.cmdData(EPD4SPI_M2 | EPD4SPI_S2, epd_panel_setting_full.cmd, panel_setting_m2s2, sizeof(panel_setting_m2s2));
 
   printf("Power setting\n");
-  // POWER SETTING
-  IO.cmdM1(0x01);
-  IO.dataM1(0x07);
-  IO.dataM1(0x17);	//VGH=20V,VGL=-20V
-  IO.dataM1(0x3F);	//VDH=15V
-  IO.dataM1(0x3F);  //VDL=-15V
-  IO.dataM1(0x0d);
-  IO.cmdM2(0x01);
-  IO.dataM2(0x07);
-  IO.dataM2(0x17);	//VGH=20V,VGL=-20V
-  IO.dataM2(0x3F);	//VDH=15V
-  IO.dataM2(0x3F);  //VDL=-15V
-  IO.dataM2(0x0d);
+  // POWER SETTING: VGH=20V,VGL=-20V VDH=15V VDL=-15V
+  static const uint8_t power_setting[] = {0x07, 0x17, 0x3F, 0x3F, 0x0d};
+  IO.cmdData(EPD4SPI_M1 | EPD4SPI_M2, 0x01, power_setting, sizeof(power_setting));
 
   // booster soft start
-  IO.cmdM1(0x06);
-  IO.dataM1(0x17);	//A
-  IO.dataM1(0x17);	//B
-  IO.dataM1(0x39);	//C
-  IO.dataM1(0x17);
-  IO.cmdM2(0x06);
-  IO.dataM2(0x17);
-  IO.dataM2(0x17);
-  IO.dataM2(0x39);
-  IO.dataM2(0x17);
+  static const uint8_t booster[] = {0x17, 0x17, 0x39, 0x17}; // A, B, C
+  IO.cmdData(EPD4SPI_M1 | EPD4SPI_M2, 0x06, booster, sizeof(booster));
 
   printf("Resolution setting\n");
-  IO.cmdM1(epd_resolution_m1s2.cmd);
-  for (int i=0;i<epd_resolution_m1s2.databytes;++i) {
-    IO.dataM1(epd_resolution_m1s2.data[i]);
-  }
-  IO.cmdS1(epd_resolution_m2s1.cmd);
-  for (int i=0;i<epd_resolution_m2s1.databytes;++i) {
-    IO.dataS1(epd_resolution_m2s1.data[i]);
-  }
-  IO.cmdM2(epd_resolution_m2s1.cmd);
-  for (int i=0;i<epd_resolution_m2s1.databytes;++i) {
-    IO.dataM2(epd_resolution_m2s1.data[i]);
-  }
-  IO.cmdS2(epd_resolution_m1s2.cmd);
-  for (int i=0;i<epd_resolution_m1s2.databytes;++i) {
-    IO.dataS2(epd_resolution_m1s2.data[i]);
-  }
-  
-  IO.cmdM1S1M2S2(0x15);  // DUSPI
-  IO.dataM1S1M2S2(0x20);
-
-  IO.cmdM1S1M2S2(0x30);  // PLL
-  IO.dataM1S1M2S2(0x08);
-
-  IO.cmdM1S1M2S2(0x50);  //Vcom and data interval setting
-  IO.dataM1S1M2S2(0x31); //Border KW
-  IO.dataM1S1M2S2(0x07);
-
-  IO.cmdM1S1M2S2(0x60);  //TCON
-  IO.dataM1S1M2S2(0x22);
-  
-  IO.cmdM1(0xE0);        // Power setting
-  IO.dataM1(0x01);
-  IO.cmdM2(0xE0);
-  IO.dataM2(0x01);
-
-  IO.cmdM1S1M2S2(0xE3);
-  IO.dataM1S1M2S2(0x00);
-
-  IO.cmdM1(0x82);
-  IO.dataM1(0x1c);
-  IO.cmdM2(0x82);
-  IO.dataM2(0x1c);
+  IO.cmdData(EPD4SPI_M1 | EPD4SPI_S2, epd_resolution_m1s2);
+  IO.cmdData(EPD4SPI_S1 | EPD4SPI_M2, epd_resolution_m2s1);
+
+  static const uint8_t duspi[] = {0x20};
+  static const uint8_t pll[] = {0x08};
+  static const uint8_t vcom[] = {0x31, 0x07};   // Border KW
+  static const uint8_t tcon[] = {0x22};
+  static const uint8_t power[] = {0x01};
+  static const uint8_t e3[] = {0x00};
+  static const uint8_t vdcs[] = {0x1c};
+  IO.cmdData(EPD4SPI_ALL, 0x15, duspi, sizeof(duspi));            // DUSPI
+  IO.cmdData(EPD4SPI_ALL, 0x30, pll, sizeof(pll));                // PLL
+  IO.cmdData(EPD4SPI_ALL, 0x50, vcom, sizeof(vcom));              // Vcom and data interval setting
+  IO.cmdData(EPD4SPI_ALL, 0x60, tcon, sizeof(tcon));              // TCON
+  IO.cmdData(EPD4SPI_M1 | EPD4SPI_M2, 0xE0, power, sizeof(power)); // Power setting
+  IO.cmdData(EPD4SPI_ALL, 0xE3, e3, sizeof(e3));
+  IO.cmdData(EPD4SPI_M1 | EPD4SPI_M2, 0x82, vdcs, sizeof(vdcs));
   
   // Acording to Waveshare/GoodDisplay code this needs LUT Tables
   // Comment next line if it does not work. 
@@ -263,9 +192,7 @@ void Wave12I48RB::update()
   uint64_t startTime = esp_timer_get_time();
   _wakeUp();
   
-  printf("\nSending BLACK buffer[%d] via SPI\n", (int)WAVE12I48_BUFFER_SIZE);
-  uint32_t i = 0;
-    /*
+  /*
    DISPLAYS:
   __________
   | S2 | M2 |
@@ -276,87 +203,15 @@ void Wave12I48RB::update()
     0x10 -> BLACK
     0x13 -> RED
   */
-  uint8_t x1buf[81];
-  uint8_t x2buf[82];
-
+  printf("\nSending BLACK buffer[%d] via SPI\n", (int)WAVE12I48_BUFFER_SIZE);
   IO.cmdM1S1M2S2(0x10); // Black buffer
-  // Optimized to send in 81/82 byte chuncks (v2 after our conversation with Samuel)
-  for(uint16_t y =  1; y <= WAVE12I48_HEIGHT; y++) {
-        for(uint16_t x = 1; x <= WAVE12I48_WIDTH/8; x++) {
-          // bitwise invert: ~ data
-          uint8_t data = i < WAVE12I48_BUFFER_SIZE ? ~_buffer_black[i] : WAVE12I48_8PIX_BLACK_CLEAR;
-
-          if(y<=1) {  // DEBUG remove after testing
-                  printf("%x ",data);
-                }
-
-        if (y <= 492) {  // S2 & M2 area
-          if (x <= 81) { // 648/8 -> S2
-            x1buf[x-1] = data;
-          } else {       // M2
-            x2buf[x-82] = data;
-          }
-
-          if (x==WAVE12I48_WIDTH/8) {  // Send the complete X line for S2 & M2
-                IO.dataS2(x1buf,sizeof(x1buf));
-                IO.dataM2(x2buf,sizeof(x2buf));
-          }
-
-        } else {         // M1 & S1
-          if (x <= 81) { // 648/8 -> M1
-            x1buf[x-1] = data;
-          } else {       // S1
-            x2buf[x-82] = data;
-          }
-
-          if (x==WAVE12I48_WIDTH/8) { // Send the complete X line for M1 & S1
-              IO.dataM1(x1buf,sizeof(x1buf));
-              IO.dataS1(x2buf,sizeof(x2buf));
-          }
-        }
-          ++i;
-        }
-  }
+  // bitwise invert: ~ data
+  IO.dataRows(_buffer_black, 0, WAVE12I48_HEIGHT, true);
 
-  i = 0;
   printf("\nSending RED buffer[%d] via SPI\n", (int)WAVE12I48_BUFFER_SIZE);
   IO.cmdM1S1M2S2(0x13); // Red buffer
+  IO.dataRows(_buffer_red, 0, WAVE12I48_HEIGHT);
 
-  for(uint16_t y =  1; y <= WAVE12I48_HEIGHT; y++) {
-        for(uint16_t x = 1; x <= WAVE12I48_WIDTH/8; x++) {
-
-          uint8_t data = i < WAVE12I48_BUFFER_SIZE ? _buffer_red[i] : WAVE12I48_8PIX_RED_CLEAR;
-
-        if(y<=1) {  // DEBUG remove after testing
-                  printf("%x ",data);
-                }
-        if (y <= 492) {  // S2 & M2 area
-          if (x <= 81) { // 648/8 -> S2
-            x1buf[x-1] = data;
-          } else {       // M2
-            x2buf[x-82] = data;
-          }
-
-          if (x==WAVE12I48_WIDTH/8) {  // Send the complete X line for S2 & M2
-                IO.dataS2(x1buf,sizeof(x1buf));
-                IO.dataM2(x2buf,sizeof(x2buf));
-          }
-
-        } else {         // M1 & S1
-          if (x <= 81) { // 648/8 -> M1
-            x1buf[x-1] = data;
-          } else {       // S1
-            x2buf[x-82] = data;
-          }
-
-          if (x==WAVE12I48_WIDTH/8) { // Send the complete X line for M1 & S1
-              IO.dataM1(x1buf,sizeof(x1buf));
-              IO.dataS1(x2buf,sizeof(x2buf));
-          }
-        }
-          ++i;
-        }
-  }
   uint64_t endTime = esp_timer_get_time();
   
   _powerOn();
@@ -371,90 +226,16 @@ uint16_t Wave12I48RB::_setPartialRamArea(uint16_t, uint16_t, uint16_t, uint16_t)
 }
 
 void Wave12I48RB::_waitBusy(const char* message){
-  _waitBusyM1(message);
-}
-
-void Wave12I48RB::_waitBusyM1(const char* message){
-  if (debug_enabled) {
-    ESP_LOGI(TAG, "_waitBusyM1 for %s", message);
-  }
-  int64_t time_since_boot = esp_timer_get_time();
-
-  while (1){
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_SPI_M1_BUSY) == 1) break;
-    IO.cmdM1(0x71);
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>WAVE_BUSY_TIMEOUT)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
-    }
-  }
-  vTaskDelay(pdMS_TO_TICKS(200));
-}
-
-void Wave12I48RB::_waitBusyM2(const char* message){
-  if (debug_enabled) {
-    ESP_LOGI(TAG, "_waitBusyM2 for %s", message);
-  }
-  int64_t time_since_boot = esp_timer_get_time();
-
-  while (1){
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_SPI_M2_BUSY) == 1) break;
-    IO.cmdM1(0x71);
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>WAVE_BUSY_TIMEOUT)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
-    }
-  }
-  vTaskDelay(pdMS_TO_TICKS(200));
-}
-
-void Wave12I48RB::_waitBusyS1(const char* message){
-  if (debug_enabled) {
-    ESP_LOGI(TAG, "_waitBusyS1 for %s", message);
-  }
-  int64_t time_since_boot = esp_timer_get_time();
-
-  while (1){
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_SPI_S1_BUSY) == 1) break;
-    IO.cmdM1(0x71);
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>WAVE_BUSY_TIMEOUT)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
-    }
-  }
-  vTaskDelay(pdMS_TO_TICKS(200));
-}
-
-void Wave12I48RB::_waitBusyS2(const char* message){
-  if (debug_enabled) {
-    ESP_LOGI(TAG, "_waitBusyS2 for %s", message);
-  }
-  int64_t time_since_boot = esp_timer_get_time();
-
-  while (1){
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_SPI_S2_BUSY) == 1) break;
-    IO.cmdM1(0x71);
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>WAVE_BUSY_TIMEOUT)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
-    }
-  }
-  vTaskDelay(pdMS_TO_TICKS(200));
+  // Interrupt driven: returns as soon as the 4 panels are ready
+  bool ready = IO.waitBusy(EPD4SPI_ALL, WAVE_BUSY_TIMEOUT / 1000, message);
+  if (!ready && debug_enabled) ESP_LOGI(TAG, "Busy Timeout for %s", message);
 }
 
 void Wave12I48RB::_sleep(){
   IO.cmdM1S1M2S2(0x02); // power off
   vTaskDelay(pdMS_TO_TICKS(300));
-  IO.cmdM1S1M2S2(0x07); // Deep sleep
-  IO.dataM1S1M2S2(0xA5);
+  static const uint8_t deep_sleep[] = {0xA5};
+  IO.cmdData(EPD4SPI_ALL, 0x07, deep_sleep, sizeof(deep_sleep)); // Deep sleep
   vTaskDelay(pdMS_TO_TICKS(300));
 }
 
@@ -479,88 +260,44 @@ void Wave12I48RB::_rotate(uint16_t& x, uint16_t& y, uint16_t& w, uint16_t& h)
   }
 }
 
-void Wave12I48RB::drawPixel(int16_t x, int16_t y, uint16_t color) {
-  if ((x < 0) || (x >= width()) || (y < 0) || (y >= height())) return;
-  switch (getRotation())
-  {
-    case 1:
-      swap(x, y);
-      x = WAVE12I48_WIDTH - x - 1;
-      break;
-    case 2:
-      x = WAVE12I48_WIDTH - x - 1;
-      y = WAVE12I48_HEIGHT - y - 1;
-      break;
-    case 3:
-      swap(x, y);
-      y = WAVE12I48_HEIGHT - y - 1;
-      break;
-  }
-  uint32_t i = x / 8 + y * WAVE12I48_WIDTH / 8;
+void Wave12I48RB::setRotation(uint8_t r)
+{
+  Adafruit_GFX::setRotation(r);
+  static const decltype(_drawPixelRotated) writers[] = {
+    &Wave12I48RB::_drawPixel<0>, &Wave12I48RB::_drawPixel<1>, &Wave12I48RB::_drawPixel<2>, &Wave12I48RB::_drawPixel<3>};
+  _drawPixelRotated = writers[getRotation()];
+}
 
-  _buffer_black[i] = (_buffer_black[i] & (0xFF ^ (1 << (7 - x % 8)))); // white
-  _buffer_red[i] = (_buffer_red[i] & (0xFF ^ (1 << (7 - x % 8)))); // white
-  if (color == EPD_WHITE) return;
+void Wave12I48RB::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  (this->*_drawPixelRotated)(x, y, color);
+}
 
-  else if (color == EPD_BLACK) _buffer_black[i] = (_buffer_black[i] | (1 << (7 - x % 8)));
-  else if (color == EPD_RED) _buffer_red[i] = (_buffer_red[i] | (1 << (7 - x % 8)));
+template <uint8_t R> void Wave12I48RB::_drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+  typedef EpdRotation<R, WAVE12I48_WIDTH, WAVE12I48_HEIGHT> rotation;
+  if (!rotation::contains(x, y)) return;
+  rotation::map(x, y);
+
+  uint8_t value = 0;
+  if (color == EPD_WHITE) value = 0;
+  else if (color == EPD_BLACK) value = 1;
+  else if (color == EPD_RED) value = 2;
   else
   {
-    if ((color & 0xF100) > (0xF100 / 2)) _buffer_red[i] = (_buffer_red[i] | (1 << (7 - x % 8)));
-    else if ((((color & 0xF100) >> 11) + ((color & 0x07E0) >> 5) + (color & 0x001F)) < 3 * 255 / 2)
-    {
-      _buffer_black[i] = (_buffer_black[i] | (1 << (7 - x % 8)));
-    }
+    if ((color & 0xF100) > (0xF100 / 2)) value = 2;
+    else if ((((color & 0xF100) >> 11) + ((color & 0x07E0) >> 5) + (color & 0x001F)) < 3 * 255 / 2) value = 1;
   }
+  _fb.set(x, y, value);
 }
 
 void Wave12I48RB::clear(){
   printf("EPD_12in48_Clear start ...\n");
-    //M1 part 648*492
-    IO.cmdM1(0x10);
-    for(uint16_t y =  492; y < 984; y++)
-        for(uint16_t x = 0; x < 81; x++) {
-            IO.dataM1(0xff);
-        }
-    IO.cmdM1(0x13);
-    for(uint16_t y = 492; y < 984; y++)
-        for(uint16_t x = 0; x < 81; x++) {
-            IO.dataM1(0x00);
-        }
-
-    //S1 part 656*492
-    IO.cmdS1(0x10);
-    for(uint16_t y = 492; y < 984; y++)
-        for(uint16_t x = 81; x < 163; x++) {
-            IO.dataS1(0xff);
-        }
-    IO.cmdS1(0x13);
-    for(uint16_t y = 492; y < 984; y++)
-        for(uint16_t x = 81; x < 163; x++) {
-            IO.dataS1(0x00);
-        }
-
-    //M2 part 656*492
-    IO.cmdM2(0x10);
-    for(uint16_t y = 0; y < 492; y++)
-        for(uint16_t x = 81; x < 163; x++) {
-            IO.dataM2(0xff);
-        }
-    IO.cmdM2(0x13);
-    for(uint16_t y = 0; y < 492; y++)
-        for(uint16_t x = 81; x < 163; x++) {
-            IO.dataM2(0x00);
-        }
-
-    //S2 part 648*492
-    IO.cmdS2(0x10);
-    for(uint16_t y = 0; y < 492; y++)
-        for(uint16_t x = 0; x < 81; x++) {
-            IO.dataS2(0xff);
-        }
-    IO.cmdS2(0x13);
-    for(uint16_t y = 0; y < 492; y++)
-        for(uint16_t x = 0; x < 81; x++) {
-            IO.dataS2(0x00);
-        }
+  // Black (0x10) and red (0x13) planes to white. M1 & S2 are 648*492, S1 & M2 656*492
+  static const uint8_t commands[] = {0x10, 0x13};
+  static const uint8_t values[] = {0xff, 0x00};
+  for (uint8_t i = 0; i < 2; i++) {
+    IO.cmdM1S1M2S2(commands[i]);
+    IO.fill(EPD4SPI_M1 | EPD4SPI_S2, values[i], EPD4SPI_LEFT_BYTES * EPD4SPI_HALF_ROWS);
+    IO.fill(EPD4SPI_S1 | EPD4SPI_M2, values[i], (EPD4SPI_ROW_BYTES - EPD4SPI_LEFT_BYTES) * EPD4SPI_HALF_ROWS);
+  }
 }
@@ -32,12 +32,7 @@ void Wave5i7Color::init(bool debug)
 
 void Wave5i7Color::fillScreen(uint16_t color)
 {
-  uint8_t pv = _color7(color);
-  uint8_t pv2 = pv | pv << 4;
-  for (uint32_t x = 0; x < sizeof(_buffer); x++)
-  {
-    _buffer[x] = pv2;
-  }
+  _fb.clear(_color7(color));
 
   if (debug_enabled) printf("fillScreen(%x) black/red _buffer len:%d\n", color, sizeof(_buffer));
 }
@@ -157,16 +152,8 @@ void Wave5i7Color::_waitBusy(const char* message){
   if (debug_enabled) {
     ESP_LOGI(TAG, "_waitBusy for %s", message);
   }
-  int64_t time_since_boot = esp_timer_get_time();
-
-  while (1){
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 1) break;
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>2000000)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
-    }
+  if (!IO.waitBusy(1, 2000, message) && debug_enabled) {
+    ESP_LOGI(TAG, "Busy Timeout");
   }
 }
 
@@ -199,33 +186,28 @@ void Wave5i7Color::_rotate(uint16_t& x, uint16_t& y, uint16_t& w, uint16_t& h)
   }
 }
 
+void Wave5i7Color::setRotation(uint8_t r)
+{
+  Adafruit_GFX::setRotation(r);
+  static const decltype(_drawPixelRotated) writers[] = {
+    &Wave5i7Color::_drawPixel<0>, &Wave5i7Color::_drawPixel<1>, &Wave5i7Color::_drawPixel<2>, &Wave5i7Color::_drawPixel<3>};
+  _drawPixelRotated = writers[getRotation()];
+}
+
 /**
  * From GxEPD2 (Jean-Marc)
  */
-void Wave5i7Color::drawPixel(int16_t x, int16_t y, uint16_t color) {
-  if ((x < 0) || (x >= width()) || (y < 0) || (y >= height())) return;
+void Wave5i7Color::drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+  (this->*_drawPixelRotated)(x, y, color);
+}
 
-  // Check rotation, move pixel around if necessary
-  switch (getRotation())
-  {
-    case 1:
-      swap(x, y);
-      x = WAVE5I7COLOR_WIDTH - x - 1;
-      break;
-    case 2:
-      x = WAVE5I7COLOR_WIDTH - x - 1;
-      y = WAVE5I7COLOR_HEIGHT - y - 1;
-      break;
-    case 3:
-      swap(x, y);
-      y = WAVE5I7COLOR_HEIGHT - y - 1;
-      break;
-  }
-  uint32_t i = x / 2 + uint32_t(y) * (WAVE5I7COLOR_WIDTH / 2);
-  uint8_t pv = _color7(color);
-      
-  if (x & 1) _buffer[i] = (_buffer[i] & 0xF0) | pv;
-    else _buffer[i] = (_buffer[i] & 0x0F) | (pv << 4);
+template <uint8_t R> void Wave5i7Color::_drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+  typedef EpdRotation<R, WAVE5I7COLOR_WIDTH, WAVE5I7COLOR_HEIGHT> rotation;
+  if (!rotation::contains(x, y)) return;
+  rotation::map(x, y);
+  _fb.set(x, y, _color7(color));
 }
 
 void Wave5i7Color::setRawBuf(uint32_t position, uint8_t value) {
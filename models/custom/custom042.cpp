@@ -15,6 +15,7 @@ Custom042::Custom042(EpdSpi& dio):
 {
   printf("Custom042() constructor injects IO and extends Adafruit_GFX(%d,%d)\n",
   CUSTOM042_WIDTH, CUSTOM042_HEIGHT);  
+  _dirty.begin(CUSTOM042_WIDTH, CUSTOM042_HEIGHT);
 }
 
 //Initialize the display
@@ -107,16 +108,8 @@ void Custom042::_waitBusy(const char* message){
   if (debug_enabled) {
     ESP_LOGI(TAG, "_waitBusy for %s", message);
   }
-  int64_t time_since_boot = esp_timer_get_time();
-
-  while (1){
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 1) break;
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>2000000)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
-    }
+  if (!IO.waitBusy(1, 2000, message) && debug_enabled) {
+    ESP_LOGI(TAG, "Busy Timeout");
   }
 }
 
@@ -153,6 +146,7 @@ void Custom042::_rotate(uint16_t& x, uint16_t& y, uint16_t& w, uint16_t& h)
 
 void Custom042::update()
 {
+  _dirty.clear();
   uint64_t startTime = esp_timer_get_time();
   _using_partial_mode = false;
   _wakeUp();
@@ -222,6 +216,7 @@ void Custom042::drawPixel(int16_t x, int16_t y, uint16_t color) {
       break;
   }
   uint16_t i = x / 8 + y * CUSTOM042_WIDTH / 8;
+  _dirty.mark(x, y);
   
   // This formulas are from gxEPD that apparently got the color right:
  
@@ -235,6 +230,7 @@ void Custom042::drawPixel(int16_t x, int16_t y, uint16_t color) {
 
 void Custom042::fillScreen(uint16_t color)
 {
+  _dirty.markAll();
   // Fill screen will be inverted with the way is done NOW
   uint8_t black = CUSTOM042_8PIX_WHITE;
   
@@ -276,6 +272,17 @@ uint16_t Custom042::_setPartialRamArea(uint16_t x, uint16_t y, uint16_t xe, uint
 void Custom042::updateWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h, bool clean_before)
 { 
   _rotate(x, y, w, h);
+  _updateWindow(x, y, w, h, clean_before);
+}
+
+void Custom042::_updateDirtyRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+  _updateWindow(x, y, w, h, false);
+}
+
+// Coordinates are already rotated
+void Custom042::_updateWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h, bool clean_before)
+{
   if (x >= CUSTOM042_WIDTH) return;
   if (y >= CUSTOM042_HEIGHT) return;
   uint16_t xe = gx_uint16_min(CUSTOM042_WIDTH, x + w) - 1;
@@ -15,6 +15,9 @@ Depg1020bn::Depg1020bn(EpdSpi& dio):
 {
   printf("Depg1020bn() %d*%d\n",
   DEPG1020BN_WIDTH, DEPG1020BN_HEIGHT);  
+  _dirty.begin(DEPG1020BN_WIDTH, DEPG1020BN_HEIGHT);
+  // A bit set to 1 is black
+  _span = {_mono_buffer, DEPG1020BN_WIDTH, DEPG1020BN_HEIGHT, DEPG1020BN_WIDTH / 8, true, false};
 }
 
 void Depg1020bn::initFullUpdate(){
@@ -38,6 +41,7 @@ void Depg1020bn::init(bool debug)
 
 void Depg1020bn::fillScreen(uint16_t color)
 {
+  _dirty.markAll();
   // 0xFF = 8 pixels black, 0x00 = 8 pix. white
   uint8_t data = (color == EPD_BLACK) ? DEPG1020BN_8PIX_BLACK : DEPG1020BN_8PIX_WHITE;
   for (uint32_t x = 0; x < sizeof(_mono_buffer); x++)
@@ -100,6 +104,7 @@ void Depg1020bn::_wakeUp(uint8_t em) {
 
 void Depg1020bn::update()
 {
+  _dirty.clear();
   uint64_t startTime = esp_timer_get_time();
   uint8_t xLineBytes = DEPG1020BN_WIDTH / 8;
   uint8_t x1buf[xLineBytes];
@@ -255,24 +260,22 @@ void Depg1020bn::updateWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h, bo
   _waitBusy("updateWindow");
 }
 
+void Depg1020bn::_updateDirtyRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+  updateWindow(x, y, w, h, false);
+}
+
 void Depg1020bn::_waitBusy(const char* message, uint16_t busy_time){
   if (debug_enabled) {
     ESP_LOGI(TAG, "_waitBusy for %s", message);
   }
-  int64_t time_since_boot = esp_timer_get_time();
-  // On high is busy
-  if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 1) {
-  while (1){
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 0) break;
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>7000000)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
+  // On high is busy. If it is not busy yet give the controller busy_time
+  if (IO.getBusyLevel() == 1) {
+    if (!IO.waitBusy(0, 7000, message) && debug_enabled) {
+      ESP_LOGI(TAG, "Busy Timeout");
     }
-  }
   } else {
-    vTaskDelay(busy_time/portTICK_PERIOD_MS); 
+    vTaskDelay(busy_time/portTICK_PERIOD_MS);
   }
 }
 
@@ -280,17 +283,8 @@ void Depg1020bn::_waitBusy(const char* message){
   if (debug_enabled) {
     ESP_LOGI(TAG, "_waitBusy for %s", message);
   }
-  int64_t time_since_boot = esp_timer_get_time();
-
-  while (1){
-    // On low is not busy anymore
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 0) break;
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>7000000)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
-    }
+  if (!IO.waitBusy(0, 7000, message) && debug_enabled) {
+    ESP_LOGI(TAG, "Busy Timeout");
   }
 }
 
@@ -342,6 +336,7 @@ void Depg1020bn::drawPixel(int16_t x, int16_t y, uint16_t color) {
       break;
   }
   uint32_t i = x / 8 + y * DEPG1020BN_WIDTH / 8;
+  _dirty.mark(x, y);
 
   // This is the trick to draw colors right. Genious Jean-Marc
   if (color) {
@@ -84,7 +84,7 @@ void Depg750bn::init(bool debug)
     debug_enabled = debug;
     if (debug_enabled) printf("Depg750bn::init(debug:%d)\n", debug);
     //Initialize SPI at 4MHz frequency. true for debug
-    gpio_set_level((gpio_num_t)CONFIG_EINK_RST, 1);
+    gpio_set_level((gpio_num_t)IO.config().rst, 1);
 
     IO.init(4, debug);
     fillScreen(EPD_WHITE);
@@ -260,16 +260,8 @@ void Depg750bn::_waitBusy(const char* message){
   if (debug_enabled) {
     ESP_LOGI(TAG, "_waitBusy for %s", message);
   }
-  int64_t time_since_boot = esp_timer_get_time();
-  // In this controller BUSY == 0
-  while (true){
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 1) break;
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>2000000)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
-    }
+  if (!IO.waitBusy(1, 2000, message) && debug_enabled) {
+    ESP_LOGI(TAG, "Busy Timeout");
   }
 }
 
@@ -261,18 +261,11 @@ void Gdeh0154d67::_waitBusy(const char* message, uint16_t busy_time){
   if (debug_enabled) {
     ESP_LOGI(TAG, "_waitBusy for %s", message);
   }
-  int64_t time_since_boot = esp_timer_get_time();
-  // On high is busy
-  if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 1) {
-  while (1){
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 0) break;
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>7000000)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
+  // On high is busy. If it is not busy yet give the controller busy_time
+  if (IO.getBusyLevel() == 1) {
+    if (!IO.waitBusy(0, 7000, message) && debug_enabled) {
+      ESP_LOGI(TAG, "Busy Timeout");
     }
-  }
   } else {
     vTaskDelay(busy_time/portTICK_PERIOD_MS);
   }
@@ -282,17 +275,8 @@ void Gdeh0154d67::_waitBusy(const char* message){
   if (debug_enabled) {
     ESP_LOGI(TAG, "_waitBusy for %s", message);
   }
-  int64_t time_since_boot = esp_timer_get_time();
-
-  while (1){
-    // On low is not busy anymore
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 0) break;
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>7000000)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
-    }
+  if (!IO.waitBusy(0, 7000, message) && debug_enabled) {
+    ESP_LOGI(TAG, "Busy Timeout");
   }
 }
 
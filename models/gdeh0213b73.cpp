@@ -59,6 +59,8 @@ Gdeh0213b73::Gdeh0213b73(EpdSpi& dio):
 {
   printf("Gdeh0213b73() constructor injects IO and extends Adafruit_GFX(%d,%d)\n",
   GDEH0213B73_WIDTH, GDEH0213B73_HEIGHT);  
+  // A bit set to 1 is black
+  _span = {_buffer, GDEH0213B73_VISIBLE_WIDTH, GDEH0213B73_HEIGHT, GDEH0213B73_WIDTH / 8, true, false};
 }
 
 void Gdeh0213b73::initFullUpdate(){
@@ -211,23 +213,15 @@ void Gdeh0213b73::_waitBusy(const char* message){
   if (debug_enabled) {
     ESP_LOGI(TAG, "_waitBusy for %s", message);
   }
-  int64_t time_since_boot = esp_timer_get_time();
-
-  while (1){
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 0) break;
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>1000000)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
-    }
+  if (!IO.waitBusy(0, 1000, message) && debug_enabled) {
+    ESP_LOGI(TAG, "Busy Timeout");
   }
 }
 
 void Gdeh0213b73::cmd(uint8_t command){
   char buffer[3];
   sprintf(buffer,"%x",command);
-  if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 1) {
+  if (IO.getBusyLevel() == 1) {
     _waitBusy(buffer);
   }
   IO.cmd(command);
@@ -262,31 +256,25 @@ void Gdeh0213b73::_rotate(uint16_t& x, uint16_t& y, uint16_t& w, uint16_t& h)
 }
 
 
+void Gdeh0213b73::setRotation(uint8_t r)
+{
+  Adafruit_GFX::setRotation(r);
+  static const decltype(_drawPixelRotated) writers[] = {
+    &Gdeh0213b73::_drawPixel<0>, &Gdeh0213b73::_drawPixel<1>, &Gdeh0213b73::_drawPixel<2>, &Gdeh0213b73::_drawPixel<3>};
+  _drawPixelRotated = writers[getRotation()];
+}
+
 void Gdeh0213b73::drawPixel(int16_t x, int16_t y, uint16_t color) {
-    if ((x < 0) || (x >= width()) || (y < 0) || (y >= height())) return;
+  (this->*_drawPixelRotated)(x, y, color);
+}
 
-  // check rotation, move pixel around if necessary
-  switch (getRotation())
-  {
-    case 1:
-      swap(x, y);
-      x = GDEH0213B73_VISIBLE_WIDTH - x - 1;
-      break;
-    case 2:
-      x = GDEH0213B73_VISIBLE_WIDTH - x - 1;
-      y = GDEH0213B73_HEIGHT - y - 1;
-      break;
-    case 3:
-      swap(x, y);
-      y = GDEH0213B73_HEIGHT - y - 1;
-      break;
-  }
-  uint16_t i = x / 8 + y * GDEH0213B73_WIDTH / 8;
-  if (!color) {
-    _buffer[i] = (_buffer[i] | (1 << (7 - x % 8)));
-    } else {
-    _buffer[i] = (_buffer[i] & (0xFF ^ (1 << (7 - x % 8))));
-    }
+template <uint8_t R> void Gdeh0213b73::_drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+  if (!EpdRotationBounds<R, GDEH0213B73_WIDTH, GDEH0213B73_HEIGHT>::contains(x, y)) return;
+  // Rotations 1 and 2 mirror the visible columns: the 6 columns past them fall out of the buffer
+  EpdRotation<R, GDEH0213B73_VISIBLE_WIDTH, GDEH0213B73_HEIGHT>::map(x, y);
+  if (x < 0) return;
+  _fb.set(x, y, color ? 1 : 0);
 }
 
 // _InitDisplay generalizing names here
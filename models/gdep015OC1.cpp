@@ -9,37 +9,33 @@
 
 //Place data into DRAM. Constant data gets placed into DROM by default, which is not accessible by DMA.
 //full screen update LUT
-const epd_init_30 Gdep015OC1::LUTDefault_full={
-0x32, {
-  0x50, 0xAA, 0x55, 0xAA, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-},30};
-
-const epd_init_30 Gdep015OC1::LUTDefault_part={
-0x32, {
-  0x10, 0x18, 0x18, 0x08, 0x18, 0x18, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x13, 0x14, 0x44, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-},30};
-
-DRAM_ATTR const epd_init_3 Gdep015OC1::GDOControl={
-0x01,{(GDEP015OC1_HEIGHT - 1) % 256, (GDEP015OC1_HEIGHT - 1) / 256, 0x00},3
+DRAM_ATTR static constexpr uint8_t gdep015OC1_lut_full[] = {
+  EPD_CMD(0x32, 30),
+    0x50, 0xAA, 0x55, 0xAA, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  EPD_END
 };
+static_assert(epd_sequence_valid(gdep015OC1_lut_full, sizeof(gdep015OC1_lut_full)), "gdep015OC1_lut_full is malformed");
 
-DRAM_ATTR const epd_init_3 Gdep015OC1::epd_soft_start={
-0x0c,{0xd7, 0xd6, 0x9d},3
+DRAM_ATTR static constexpr uint8_t gdep015OC1_lut_part[] = {
+  EPD_CMD(0x32, 30),
+    0x10, 0x18, 0x18, 0x08, 0x18, 0x18, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x13, 0x14, 0x44, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  EPD_END
 };
-
-DRAM_ATTR const epd_init_1 Gdep015OC1::VCOMVol={
-0x2c,{0x9b},1
-}; // VCOM 7c
-
-DRAM_ATTR const epd_init_1 Gdep015OC1::DummyLine={
-0x3a,{0x1a},1
-};
-
-DRAM_ATTR const epd_init_1 Gdep015OC1::Gatetime={
-0x3b,{0x08},1
+static_assert(epd_sequence_valid(gdep015OC1_lut_part, sizeof(gdep015OC1_lut_part)), "gdep015OC1_lut_part is malformed");
+
+DRAM_ATTR static constexpr uint8_t gdep015OC1_wakeup[] = {
+  // Byte per byte, as the controller always got them
+  EPD_CMD_BYTES(0x01, 3), (GDEP015OC1_HEIGHT - 1) % 256, (GDEP015OC1_HEIGHT - 1) / 256, 0x00, // Driver output control
+  EPD_CMD_BYTES(0x0c, 3), 0xd7, 0xd6, 0x9d,        // boost
+  EPD_CMD(0x2c, 1), 0x9b,                          // VCOM 7c
+  EPD_BUSY(0, 7000),                               // Needed?
+  EPD_CMD(0x3a, 1), 0x1a,                          // Dummy line
+  EPD_CMD(0x3b, 1), 0x08,                          // Gate time
+  EPD_END
 };
+static_assert(epd_sequence_valid(gdep015OC1_wakeup, sizeof(gdep015OC1_wakeup)), "gdep015OC1_wakeup is malformed");
 
 // Partial Update Delay
 #define GDEP015OC1_PU_DELAY 100
@@ -57,10 +53,7 @@ Gdep015OC1::Gdep015OC1(EpdSpi& dio):
 void Gdep015OC1::initFullUpdate(){
     _wakeUp(0x03);
     
-    IO.cmd(LUTDefault_full.cmd);     // boost
-    for (int i=0;i<LUTDefault_full.databytes;++i) {
-        IO.data(LUTDefault_full.data[i]);
-    } 
+    IO.sequence(gdep015OC1_lut_full);
     _PowerOn();
     if (debug_enabled) printf("initFullUpdate() LUT\n");
 }
@@ -68,10 +61,7 @@ void Gdep015OC1::initFullUpdate(){
 void Gdep015OC1::initPartialUpdate(){
     _wakeUp(0x03);
 
-    IO.cmd(LUTDefault_part.cmd);     // boost
-    for (int i=0;i<LUTDefault_part.databytes;++i) {
-        IO.data(LUTDefault_part.data[i]);
-    }
+    IO.sequence(gdep015OC1_lut_part);
     _PowerOn();
 
     if (debug_enabled) printf("initPartialUpdate() LUT\n");
@@ -112,7 +102,7 @@ void Gdep015OC1::_wakeUp(){
  * @deprecated It seems there is no need to do this for now
  */
 void Gdep015OC1::_writeCommandData(const uint8_t cmd, const uint8_t* pCommandData, uint8_t datalen) {
-  if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY)){
+  if (IO.getBusyLevel()){
     _waitBusy("_waitBusy",100);
   }
   IO.cmd(cmd);
@@ -124,27 +114,7 @@ void Gdep015OC1::_writeCommandData(const uint8_t cmd, const uint8_t* pCommandDat
 void Gdep015OC1::_wakeUp(uint8_t em){
   printf("wakeup() start commands\n");
 
-  IO.cmd(GDOControl.cmd);
-  for (int i=0;i<GDOControl.databytes;++i) {
-      IO.data(GDOControl.data[i]);
-  }
-
-  IO.cmd(epd_soft_start.cmd);     // boost
-  for (int i=0;i<epd_soft_start.databytes;++i) {
-      IO.data(epd_soft_start.data[i]);
-  }
-
-  IO.cmd(VCOMVol.cmd);
-  IO.data(VCOMVol.data[0]);
-
-  _waitBusy("epd_wakeup_power:ON"); // Needed?
-
-  IO.cmd(DummyLine.cmd);
-  IO.data(DummyLine.data[0]);
-  
-  IO.cmd(Gatetime.cmd);            // CMD: 0x30 DATA: 0xbf
-  IO.data(Gatetime.data[0]);
-
+  IO.sequence(gdep015OC1_wakeup);
   _setRamDataEntryMode(em);
 }
 
@@ -289,18 +259,11 @@ void Gdep015OC1::_waitBusy(const char* message, uint16_t busy_time){
   if (debug_enabled) {
     ESP_LOGI(TAG, "_waitBusy for %s", message);
   }
-  int64_t time_since_boot = esp_timer_get_time();
-  // On high is busy
-  if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 1) {
-  while (1){
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 0) break;
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>7000000)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
+  // On high is busy. If it is not busy yet give the controller busy_time
+  if (IO.getBusyLevel() == 1) {
+    if (!IO.waitBusy(0, 7000, message) && debug_enabled) {
+      ESP_LOGI(TAG, "Busy Timeout");
     }
-  }
   } else {
     vTaskDelay(busy_time/portTICK_PERIOD_MS);
   }
@@ -310,17 +273,8 @@ void Gdep015OC1::_waitBusy(const char* message){
   if (debug_enabled) {
     ESP_LOGI(TAG, "_waitBusy for %s", message);
   }
-  int64_t time_since_boot = esp_timer_get_time();
-
-  while (1){
-    // On low is not busy anymore
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 0) break;
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>7000000)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
-    }
+  if (!IO.waitBusy(0, 7000, message) && debug_enabled) {
+    ESP_LOGI(TAG, "Busy Timeout");
   }
 }
 
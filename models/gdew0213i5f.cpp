@@ -172,20 +172,15 @@ void Gdew0213i5f::initFullUpdate(){
     IO.data(0x97); //WBmode:VBDF 17|D7 VBDW 97 VBDB 57
 
     // Every next cmd/data seems to be essential for initialization
-    IO.cmd(lut_20_vcomDC.cmd);
-    IO.data(lut_20_vcomDC.data,lut_20_vcomDC.databytes);
+    IO.cmdData(lut_20_vcomDC);
    
-    IO.cmd(lut_21_ww.cmd);
-    IO.data(lut_21_ww.data,lut_21_ww.databytes);
+    IO.cmdData(lut_21_ww);
 
-    IO.cmd(lut_22_bw.cmd);
-    IO.data(lut_22_bw.data,lut_22_bw.databytes);
+    IO.cmdData(lut_22_bw);
 
-    IO.cmd(lut_23_wb.cmd);
-    IO.data(lut_23_wb.data,lut_23_wb.databytes);
+    IO.cmdData(lut_23_wb);
 
-    IO.cmd(lut_24_bb.cmd);
-    IO.data(lut_24_bb.data,lut_24_bb.databytes);
+    IO.cmdData(lut_24_bb);
     if (debug_enabled) printf("initFullUpdate() LUT\n");
 }
 
@@ -196,20 +191,15 @@ void Gdew0213i5f::initPartialUpdate(){
     IO.cmd(0X50);  //VCOM AND DATA INTERVAL SETTING
     IO.data(0x17);
 
-    IO.cmd(lut_20_vcomDC_partial.cmd);
-    IO.data(lut_20_vcomDC_partial.data,lut_20_vcomDC_partial.databytes);
+    IO.cmdData(lut_20_vcomDC_partial);
    
-    IO.cmd(lut_21_ww_partial.cmd);
-    IO.data(lut_21_ww_partial.data,lut_21_ww_partial.databytes);
+    IO.cmdData(lut_21_ww_partial);
 
-    IO.cmd(lut_22_bw_partial.cmd);
-    IO.data(lut_22_bw_partial.data,lut_22_bw_partial.databytes);
+    IO.cmdData(lut_22_bw_partial);
 
-    IO.cmd(lut_23_wb_partial.cmd);
-    IO.data(lut_23_wb_partial.data,lut_23_wb_partial.databytes);
+    IO.cmdData(lut_23_wb_partial);
 
-    IO.cmd(lut_24_bb_partial.cmd);
-    IO.data(lut_24_bb_partial.data,lut_24_bb_partial.databytes);
+    IO.cmdData(lut_24_bb_partial);
     if (debug_enabled) printf("initPartialUpdate() LUT\n");
 }
 
@@ -417,16 +407,8 @@ void Gdew0213i5f::_waitBusy(const char* message){
   if (debug_enabled) {
     ESP_LOGI(TAG, "_waitBusy for %s", message);
   }
-  int64_t time_since_boot = esp_timer_get_time();
-
-  while (1){
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 1) break;
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>1800000)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
-    }
+  if (!IO.waitBusy(1, 1800, message) && debug_enabled) {
+    ESP_LOGI(TAG, "Busy Timeout");
   }
 }
 
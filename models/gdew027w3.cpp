@@ -17,78 +17,74 @@ uses the "LUT from OTP" instead of this and seems to work better
 NOW UPDATED
 */
 // This class is refactored to cope with Good display Arduino example
-DRAM_ATTR const epd_init_3 Gdew027w3::epd_soft_start={
-0x06,{0x07,0x07,0x17},3
-};
-
-DRAM_ATTR const epd_init_1 Gdew027w3::epd_extra_setting={
-0x16,{0x00},1
-};
-// LUT from OTP 128x296
-DRAM_ATTR const epd_init_1 Gdew027w3::epd_panel_setting={
-0x00,{0x1f},1
-};
-
-DRAM_ATTR const epd_init_1 Gdew027w3::epd_vcom2={
-0x50,{0x97},1
+DRAM_ATTR static constexpr uint8_t gdew027w3_wakeup[] = {
+  EPD_RESET(10),
+  // IMPORTANT: Some EPD controllers like to receive data byte per byte
+  EPD_CMD_BYTES(0x01, 4), 0x03, 0x00, 0x2b, 0x2b,  // POWER SETTING
+  EPD_CMD_BYTES(0x06, 3), 0x07, 0x07, 0x17,        // boost. KW-BF   KWR-AF  BWROTP 0f
+  EPD_CMD(0x16, 1), 0x00,                          // Extra setting
+  EPD_CMD(0x04, 0),                                // Power on
+  EPD_BUSY(1, 7000),
+  // Original boost codes from Good display example - Makes partial update slow
+  EPD_CMD(0x00, 1), 0x1f,                          // Panel setting: LUT from OTP 128x296
+  // This two panel setting and PLL are the ones that make partial refresh work super fast
+  EPD_CMD(0x30, 1), 0x3a,                          // PLL setting: 90 50HZ  3A 100HZ   29 150Hz 39 200HZ 31 171HZ
+  EPD_CMD(0x82, 1), 0x08,                          // vcom_DC setting: 0x28:-2.0V,0x12:-0.9V
+  EPD_DELAY(2),
+  EPD_CMD(0x50, 1), 0x97,                          // vcom and data interval: WBmode:VBDF 17|D7 VBDW 97 VBDB 57   WBRmode:VBDF F7 VBDW 77 VBDB 37  VBDR B7
+  EPD_END
 };
+static_assert(epd_sequence_valid(gdew027w3_wakeup, sizeof(gdew027w3_wakeup)), "gdew027w3_wakeup is malformed");
 
 //partial screen update LUT
-DRAM_ATTR const epd_init_44 Gdew027w3::lut_20_vcomDC_partial={
-0x20, {
-  0x00, 0x00,
-  0x00, 0x19, 0x01, 0x00, 0x00, 0x01,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-},44};
-
-DRAM_ATTR const epd_init_42 Gdew027w3::lut_21_ww_partial={
-0x21, {
-  0x00, 0x19, 0x01, 0x00, 0x00, 0x01,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-},42};
-
-DRAM_ATTR const epd_init_42 Gdew027w3::lut_22_bw_partial={
-0x22, {
-  0x80, 0x19, 0x01, 0x00, 0x00, 0x01,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-},42};
-
-DRAM_ATTR const epd_init_42 Gdew027w3::lut_23_wb_partial={
-0x23, {
-  0x40, 0x19, 0x01, 0x00, 0x00, 0x01,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-},42};
-
-DRAM_ATTR const epd_init_42 Gdew027w3::lut_24_bb_partial={
-0x24, {
-  0x00, 0x19, 0x01, 0x00, 0x00, 0x01,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-},42};
+DRAM_ATTR static constexpr uint8_t gdew027w3_partial[] = {
+  EPD_CMD(0x00, 1), 0xbf,                          // Panel setting for fast partial
+  EPD_CMD(0x82, 1), 0x08,                          // vcom_DC setting
+  EPD_CMD(0x50, 1), 0x17,                          // VCOM AND DATA INTERVAL SETTING: WBmode:VBDF 17|D7 VBDW 97 VBDB 57   WBRmode:VBDF F7 VBDW 77 VBDB 37  VBDR B7
+  EPD_CMD(0x20, 44),                               // LUT vcomDC
+    0x00, 0x00,
+    0x00, 0x19, 0x01, 0x00, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  EPD_CMD(0x21, 42),                               // LUT ww
+    0x00, 0x19, 0x01, 0x00, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  EPD_CMD(0x22, 42),                               // LUT bw
+    0x80, 0x19, 0x01, 0x00, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  EPD_CMD(0x23, 42),                               // LUT wb
+    0x40, 0x19, 0x01, 0x00, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  EPD_CMD(0x24, 42),                               // LUT bb
+    0x00, 0x19, 0x01, 0x00, 0x00, 0x01,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  EPD_END
+};
+static_assert(epd_sequence_valid(gdew027w3_partial, sizeof(gdew027w3_partial)), "gdew027w3_partial is malformed");
 
 // Constructor
 Gdew027w3::Gdew027w3(EpdSpi& dio): 
@@ -113,41 +109,7 @@ void Gdew027w3::init(bool debug)
 
 
 void Gdew027w3::initPartialUpdate(){
-    IO.cmd(0x00);  //Panel setting for fast partial
-    IO.data(0xbf);
-
-    IO.cmd(0x82);  //vcom_DC setting
-    IO.data(0x08);
-
-    IO.cmd(0X50);  //VCOM AND DATA INTERVAL SETTING
-    IO.data(0x17); //WBmode:VBDF 17|D7 VBDW 97 VBDB 57   WBRmode:VBDF F7 VBDW 77 VBDB 37  VBDR B7
-
-    uint8_t index = 0;
-    IO.cmd(lut_20_vcomDC_partial.cmd);
-    for (index = 0; index < lut_20_vcomDC_partial.databytes; index++) {
-      IO.data(lut_20_vcomDC_partial.data[index]);
-    }
-   
-    IO.cmd(lut_21_ww_partial.cmd);
-    for (index = 0; index < lut_21_ww_partial.databytes; index++) {
-      IO.data(lut_21_ww_partial.data[index]);
-    }
-
-    IO.cmd(lut_22_bw_partial.cmd);
-    for (index = 0; index < lut_22_bw_partial.databytes; index++) {
-      IO.data(lut_22_bw_partial.data[index]);
-    }
-
-    IO.cmd(lut_23_wb_partial.cmd);
-    for (index = 0; index < lut_23_wb_partial.databytes; index++) {
-      IO.data(lut_23_wb_partial.data[index]);
-    }
-
-    IO.cmd(lut_24_bb_partial.cmd);
-    for (index = 0; index < lut_24_bb_partial.databytes; index++) {
-      IO.data(lut_24_bb_partial.data[index]);
-    }
-    
+    IO.sequence(gdew027w3_partial);
     if (debug_enabled) printf("initPartialUpdate() LUT\n");
 }
 
@@ -165,40 +127,7 @@ void Gdew027w3::fillScreen(uint16_t color)
 
 void Gdew027w3::_wakeUp(){
   printf("wakeup() start commands\n");
-  IO.reset(10);
-
-  IO.cmd(0x01); //POWER SETTING
-  IO.data(0x03);
-  IO.data(0x00);
-  IO.data(0x2b);
-  IO.data(0x2b);
-
-  //KW-BF   KWR-AF  BWROTP 0f
-  IO.cmd(epd_soft_start.cmd);     // boost
-  for (int i=0;i<epd_soft_start.databytes;++i) {
-      IO.data(epd_soft_start.data[i]);
-  }
-  IO.cmd(epd_extra_setting.cmd);  // CMD: 0x16 DATA: 0x00
-  IO.data(epd_extra_setting.data[0]);
-
-  IO.cmd(0x04);
-  _waitBusy("epd_wakeup_power:ON");
-  
-  // Original boost codes from Good display example - Makes partial update slow
-  IO.cmd(epd_panel_setting.cmd);  // CMD: 0x00 DATA: 0xbf
-  IO.data(epd_panel_setting.data[0]);
-  // This two panel setting and PLL are the ones that make partial refresh work super fast
-  IO.cmd(0x30); //PLL setting
-  IO.data(0x3a);   //90 50HZ  3A 100HZ   29 150Hz 39 200HZ 31 171HZ
-
-  IO.cmd(0x82); //vcom_DC setting
-  IO.data(0x08);   //0x28:-2.0V,0x12:-0.9V
-
-  vTaskDelay(2/portTICK_PERIOD_MS); // delay(2)
-
-  //WBmode:VBDF 17|D7 VBDW 97 VBDB 57   WBRmode:VBDF F7 VBDW 77 VBDB 37  VBDR B7
-  IO.cmd(epd_vcom2.cmd);          // vcom and data interval
-  IO.data(epd_vcom2.data[0]);     // CMD: 0x50 DATA: 0x97 
+  IO.sequence(gdew027w3_wakeup);
 }
 
 void Gdew027w3::update()
@@ -312,16 +241,8 @@ void Gdew027w3::_waitBusy(const char* message){
   if (debug_enabled) {
     ESP_LOGI(TAG, "_waitBusy for %s", message);
   }
-  int64_t time_since_boot = esp_timer_get_time();
-
-  while (1){
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 1) break;
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>7000000)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
-    }
+  if (!IO.waitBusy(1, 7000, message) && debug_enabled) {
+    ESP_LOGI(TAG, "Busy Timeout");
   }
 }
 
@@ -114,31 +114,15 @@ void Gdew027w3T::initPartialUpdate(){
     IO.cmd(0X50);  //VCOM AND DATA INTERVAL SETTING
     IO.data(0x17); //WBmode:VBDF 17|D7 VBDW 97 VBDB 57   WBRmode:VBDF F7 VBDW 77 VBDB 37  VBDR B7
 
-    uint8_t index = 0;
-    IO.cmd(lut_20_vcomDC_partial.cmd);
-    for (index = 0; index < lut_20_vcomDC_partial.databytes; index++) {
-      IO.data(lut_20_vcomDC_partial.data[index]);
-    }
+    IO.cmdData(lut_20_vcomDC_partial);
    
-    IO.cmd(lut_21_ww_partial.cmd);
-    for (index = 0; index < lut_21_ww_partial.databytes; index++) {
-      IO.data(lut_21_ww_partial.data[index]);
-    }
+    IO.cmdData(lut_21_ww_partial);
 
-    IO.cmd(lut_22_bw_partial.cmd);
-    for (index = 0; index < lut_22_bw_partial.databytes; index++) {
-      IO.data(lut_22_bw_partial.data[index]);
-    }
+    IO.cmdData(lut_22_bw_partial);
 
-    IO.cmd(lut_23_wb_partial.cmd);
-    for (index = 0; index < lut_23_wb_partial.databytes; index++) {
-      IO.data(lut_23_wb_partial.data[index]);
-    }
+    IO.cmdData(lut_23_wb_partial);
 
-    IO.cmd(lut_24_bb_partial.cmd);
-    for (index = 0; index < lut_24_bb_partial.databytes; index++) {
-      IO.data(lut_24_bb_partial.data[index]);
-    }
+    IO.cmdData(lut_24_bb_partial);
     
     if (debug_enabled) printf("initPartialUpdate() LUT\n");
 }
@@ -166,10 +150,7 @@ void Gdew027w3T::_wakeUp(){
   IO.data(0x2b);
 
   //KW-BF   KWR-AF  BWROTP 0f
-  IO.cmd(epd_soft_start.cmd);     // boost
-  for (int i=0;i<epd_soft_start.databytes;++i) {
-      IO.data(epd_soft_start.data[i]);
-  }
+  IO.cmdData(epd_soft_start);     // boost
   IO.cmd(epd_extra_setting.cmd);  // CMD: 0x16 DATA: 0x00
   IO.data(epd_extra_setting.data[0]);
 
@@ -325,16 +306,8 @@ void Gdew027w3T::_waitBusy(const char* message){
   if (debug_enabled) {
     ESP_LOGI(TAG, "_waitBusy for %s", message);
   }
-  int64_t time_since_boot = esp_timer_get_time();
-
-  while (1){
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 1) break;
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>7000000)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
-    }
+  if (!IO.waitBusy(1, 7000, message) && debug_enabled) {
+    ESP_LOGI(TAG, "Busy Timeout");
   }
 }
 
@@ -119,29 +119,6 @@ DRAM_ATTR const epd_init_42 Gdew042t2::lut_24_bb_partial={
   0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00
 },42};
 
-DRAM_ATTR const epd_power_4 Gdew042t2::epd_wakeup_power={
-0x01,{0x03,0x00,0x2b,0x2b},4
-};
-
-DRAM_ATTR const epd_init_3 Gdew042t2::epd_soft_start={
-0x06,{0x17,0x17,0x17},3
-};
-
-DRAM_ATTR const epd_init_1 Gdew042t2::epd_panel_setting={
-0x00,{0x3f},1
-};
-
-DRAM_ATTR const epd_init_1 Gdew042t2::epd_pll={
-0x30,{0x3a},1
-};
-
-DRAM_ATTR const epd_init_4 Gdew042t2::epd_resolution={
-0x61,{GDEW042T2_WIDTH/256,
-GDEW042T2_WIDTH%256,
-GDEW042T2_HEIGHT/256,
-GDEW042T2_HEIGHT%256
-},4};
-
 // Constructor
 Gdew042t2::Gdew042t2(EpdSpi& dio): 
   Adafruit_GFX(GDEW042T2_WIDTH, GDEW042T2_HEIGHT),
@@ -149,6 +126,7 @@ Gdew042t2::Gdew042t2(EpdSpi& dio):
 {
   printf("Gdew042t2() constructor injects IO and extends Adafruit_GFX(%d,%d)\n",
   GDEW042T2_WIDTH, GDEW042T2_HEIGHT);  
+  _span = {_buffer, GDEW042T2_WIDTH, GDEW042T2_HEIGHT, GDEW042T2_WIDTH / 8, false, false};
 }
 
 void Gdew042t2::initFullUpdate(){
@@ -156,20 +134,15 @@ void Gdew042t2::initFullUpdate(){
     IO.data(0x3F);
 
 
-    IO.cmd(lut_vcom0_full.cmd);
-    IO.data(lut_vcom0_full.data,lut_vcom0_full.databytes);
+    IO.cmdData(lut_vcom0_full);
    
-    IO.cmd(lut_ww_full.cmd);
-    IO.data(lut_ww_full.data,lut_ww_full.databytes);
+    IO.cmdData(lut_ww_full);
 
-    IO.cmd(lut_bw_full.cmd);
-    IO.data(lut_bw_full.data,lut_bw_full.databytes);
+    IO.cmdData(lut_bw_full);
 
-    IO.cmd(lut_wb_full.cmd);
-    IO.data(lut_wb_full.data,lut_wb_full.databytes);
+    IO.cmdData(lut_wb_full);
 
-    IO.cmd(lut_bb_full.cmd);
-    IO.data(lut_bb_full.data,lut_bb_full.databytes);
+    IO.cmdData(lut_bb_full);
     if (debug_enabled) printf("initFullUpdate() LUT\n");
 }
 
@@ -178,21 +151,16 @@ void Gdew042t2::initPartialUpdate(){
   IO.data(0x3F); //300x400 B/W mode, LUT set by register
 
   // LUT Tables for partial update. Send them directly in 42 bytes chunks. In total 210 bytes
-  IO.cmd(lut_20_vcom0_partial.cmd);
-  IO.data(lut_20_vcom0_partial.data,lut_20_vcom0_partial.databytes);
+  IO.cmdData(lut_20_vcom0_partial);
 
 
-  IO.cmd(lut_21_ww_partial.cmd);
-  IO.data(lut_21_ww_partial.data,lut_21_ww_partial.databytes);
+  IO.cmdData(lut_21_ww_partial);
 
-  IO.cmd(lut_22_bw_partial.cmd);
-  IO.data(lut_22_bw_partial.data,lut_22_bw_partial.databytes);
+  IO.cmdData(lut_22_bw_partial);
 
-  IO.cmd(lut_23_wb_partial.cmd);
-  IO.data(lut_23_wb_partial.data,lut_23_wb_partial.databytes);
+  IO.cmdData(lut_23_wb_partial);
 
-  IO.cmd(lut_24_bb_partial.cmd);
-  IO.data(lut_24_bb_partial.data,lut_24_bb_partial.databytes);
+  IO.cmdData(lut_24_bb_partial);
  }
 
 //Initialize the display
@@ -219,45 +187,25 @@ void Gdew042t2::fillScreen(uint16_t color)
   if (debug_enabled) printf("fillScreen(%d) _buffer len:%d\n",data,sizeof(_buffer));
 }
 
-void Gdew042t2::_wakeUp(){
-  IO.reset(10);
-//IMPORTANT: Some EPD controllers like to receive data byte per byte
-//So this won't work:
-//IO.data(epd_wakeup_power.data,epd_wakeup_power.databytes);
-  
-
-  IO.cmd(epd_wakeup_power.cmd);
-  for (int i=0;i<epd_wakeup_power.databytes;++i) {
-    IO.data(epd_wakeup_power.data[i]);
-  }
- 
-  IO.cmd(epd_soft_start.cmd);
-  for (int i=0;i<epd_soft_start.databytes;++i) {
-    IO.data(epd_soft_start.data[i]);
-  }
-  
-  IO.cmd(epd_panel_setting.cmd);
-  for (int i=0;i<epd_panel_setting.databytes;++i) {
-    IO.data(epd_panel_setting.data[i]);
-  }
-  
-  IO.cmd(epd_pll.cmd);
-  for (int i=0;i<epd_pll.databytes;++i) {
-    IO.data(epd_pll.data[i]);
-  }
-  //resolution setting
-  IO.cmd(epd_resolution.cmd);
-  for (int i=0;i<epd_resolution.databytes;++i) {
-    IO.data(epd_resolution.data[i]);
-  }
-
-  IO.cmd(0x82); // vcom_DC setting
-  IO.data(0x12);   // -0.1 + 18 * -0.05 = -1.0V from OTP, slightly better
-  IO.cmd(0x50); // VCOM AND DATA INTERVAL SETTING
-  IO.data(0xd7);    // border floating to avoid flashing
-  IO.cmd(0x04);
+DRAM_ATTR static constexpr uint8_t gdew042t2_wakeup[] = {
+  EPD_RESET(10),
+  // IMPORTANT: Some EPD controllers like to receive data byte per byte
+  EPD_CMD_BYTES(0x01, 4), 0x03, 0x00, 0x2b, 0x2b,  // POWER SETTING
+  EPD_CMD_BYTES(0x06, 3), 0x17, 0x17, 0x17,        // Booster soft start
+  EPD_CMD_BYTES(0x00, 1), 0x3f,                    // Panel setting
+  EPD_CMD_BYTES(0x30, 1), 0x3a,                    // PLL
+  EPD_CMD_BYTES(0x61, 4), GDEW042T2_WIDTH / 256, GDEW042T2_WIDTH % 256,  // Resolution setting
+                          GDEW042T2_HEIGHT / 256, GDEW042T2_HEIGHT % 256,
+  EPD_CMD(0x82, 1), 0x12,                          // vcom_DC setting: -0.1 + 18 * -0.05 = -1.0V from OTP, slightly better
+  EPD_CMD(0x50, 1), 0xd7,                          // VCOM AND DATA INTERVAL SETTING: border floating to avoid flashing
+  EPD_CMD(0x04, 0),                                // Power on
+  EPD_BUSY(1, 2000),
+  EPD_END
+};
+static_assert(epd_sequence_valid(gdew042t2_wakeup, sizeof(gdew042t2_wakeup)), "gdew042t2_wakeup is malformed");
 
-  _waitBusy("epd_wakeup_power");
+void Gdew042t2::_wakeUp(){
+  IO.sequence(gdew042t2_wakeup);
   initFullUpdate();
 }
 
@@ -371,16 +319,8 @@ void Gdew042t2::_waitBusy(const char* message){
   if (debug_enabled) {
     ESP_LOGI(TAG, "_waitBusy for %s", message);
   }
-  int64_t time_since_boot = esp_timer_get_time();
-
-  while (1){
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 1) break;
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>2000000)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
-    }
+  if (!IO.waitBusy(1, 2000, message) && debug_enabled) {
+    ESP_LOGI(TAG, "Busy Timeout");
   }
 }
 
@@ -415,30 +355,22 @@ void Gdew042t2::_rotate(uint16_t& x, uint16_t& y, uint16_t& w, uint16_t& h)
 }
 
 
-void Gdew042t2::drawPixel(int16_t x, int16_t y, uint16_t color) {
-  if ((x < 0) || (x >= width()) || (y < 0) || (y >= height())) return;
+void Gdew042t2::setRotation(uint8_t r)
+{
+  Adafruit_GFX::setRotation(r);
+  static const decltype(_drawPixelRotated) writers[] = {
+    &Gdew042t2::_drawPixel<0>, &Gdew042t2::_drawPixel<1>, &Gdew042t2::_drawPixel<2>, &Gdew042t2::_drawPixel<3>};
+  _drawPixelRotated = writers[getRotation()];
+}
 
-  // check rotation, move pixel around if necessary
-  switch (getRotation())
-  {
-    case 1:
-      swap(x, y);
-      x = GDEW042T2_WIDTH - x - 1;
-      break;
-    case 2:
-      x = GDEW042T2_WIDTH - x - 1;
-      y = GDEW042T2_HEIGHT - y - 1;
-      break;
-    case 3:
-      swap(x, y);
-      y = GDEW042T2_HEIGHT - y - 1;
-      break;
-  }
-  uint16_t i = x / 8 + y * GDEW042T2_WIDTH / 8;
+void Gdew042t2::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  (this->*_drawPixelRotated)(x, y, color);
+}
 
-  if (color) {
-    _buffer[i] = (_buffer[i] | (1 << (7 - x % 8)));
-    } else {
-    _buffer[i] = (_buffer[i] & (0xFF ^ (1 << (7 - x % 8))));
-    }
+template <uint8_t R> void Gdew042t2::_drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+  typedef EpdRotation<R, GDEW042T2_WIDTH, GDEW042T2_HEIGHT> rotation;
+  if (!rotation::contains(x, y)) return;
+  rotation::map(x, y);
+  _fb.set(x, y, color ? 1 : 0);
 }
@@ -129,28 +129,52 @@ DRAM_ATTR const epd_init_42 Gdew042t2Grays::lut_bb_full={
   0x00	,0x00	,0x00	,0x00	,0x00	,0x00,
 },42};
 
-DRAM_ATTR const epd_power_4 Gdew042t2Grays::epd_wakeup_power={
-0x01,{0x03,0x00,0x2b,0x2b},4
+// IMPORTANT: Some EPD controllers like to receive data byte per byte
+DRAM_ATTR static constexpr uint8_t gdew042t2Grays_partial[] = {
+  EPD_RESET(10),
+  EPD_CMD(0x04, 0),                                // Power on
+  EPD_BUSY(1, 2000),
+  EPD_CMD_BYTES(0x01, 4), 0x03, 0x00, 0x2b, 0x2b,  // POWER SETTING
+  EPD_CMD_BYTES(0x06, 3), 0x17, 0x17, 0x17,        // Booster soft start
+  EPD_CMD(0x00, 1), 0x3f,                          // panel setting: 300x400 B/W mode, LUT set by register
+  EPD_CMD(0x30, 1), 0x3a,                          // PLL setting: 3a 100HZ   29 150Hz 39 200HZ 31 171HZ
+  EPD_CMD(0x82, 1), 0x1A,                          // vcom_DC setting
+  EPD_CMD(0x50, 1), 0xD7,                          // VCOM AND DATA INTERVAL SETTING: Border avoid flashing
+  EPD_END
 };
-
-DRAM_ATTR const epd_init_3 Gdew042t2Grays::epd_soft_start={
-0x06,{0x17,0x17,0x17},3
-};
-
-// 0xbf, 0x0d seems appropiate for 4 grays mode
-DRAM_ATTR const epd_init_2 Gdew042t2Grays::epd_panel_setting={
-0x00,{0xbf, 0x0d}, 2
+static_assert(epd_sequence_valid(gdew042t2Grays_partial, sizeof(gdew042t2Grays_partial)), "gdew042t2Grays_partial is malformed");
+
+DRAM_ATTR static constexpr uint8_t gdew042t2Grays_wakeup_mono[] = {
+  EPD_RESET(10),
+  EPD_CMD_BYTES(0x06, 3), 0x17, 0x17, 0x17,        // Booster soft start
+  EPD_CMD_BYTES(0x61, 4), GDEW042T2_WIDTH / 256, GDEW042T2_WIDTH % 256,  // Resolution setting
+                          GDEW042T2_HEIGHT / 256, GDEW042T2_HEIGHT % 256,
+  EPD_CMD(0x04, 0),                                // Power on
+  EPD_BUSY(1, 2000),
+  EPD_CMD(0x00, 1), 0x1f,                          // panel setting: LUT from OTP, KW-BF KWR-AF BWROTP 0f BWOTP 1f
+  EPD_CMD_BYTES(0x61, 4), GDEW042T2_WIDTH / 256, GDEW042T2_WIDTH % 256,  // resolution setting
+                          GDEW042T2_HEIGHT / 256, GDEW042T2_HEIGHT % 256,
+  EPD_CMD(0x50, 1), 0x97,                          // VCOM AND DATA INTERVAL SETTING: WBmode:VBDF 17|D7 VBDW 97 VBDB 57
+  EPD_END
 };
-
-DRAM_ATTR const epd_init_1 Gdew042t2Grays::epd_pll={
-0x30,{0x3c},1
+static_assert(epd_sequence_valid(gdew042t2Grays_wakeup_mono, sizeof(gdew042t2Grays_wakeup_mono)), "gdew042t2Grays_wakeup_mono is malformed");
+
+DRAM_ATTR static constexpr uint8_t gdew042t2Grays_wakeup[] = {
+  EPD_RESET(10),
+  EPD_CMD_BYTES(0x06, 3), 0x17, 0x17, 0x17,        // Booster soft start
+  EPD_CMD_BYTES(0x61, 4), GDEW042T2_WIDTH / 256, GDEW042T2_WIDTH % 256,  // Resolution setting
+                          GDEW042T2_HEIGHT / 256, GDEW042T2_HEIGHT % 256,
+  EPD_CMD_BYTES(0x01, 4), 0x03, 0x00, 0x2b, 0x2b,  // POWER SETTING
+  EPD_CMD_BYTES(0x00, 2), 0xbf, 0x0d,              // panel setting: 0xbf, 0x0d seems appropiate for 4 grays mode
+  EPD_CMD(0x30, 1), 0x3c,                          // PLL setting
+  EPD_CMD(0x82, 1), 0x12,                          // vcom_DC setting: -0.1 + 18 * -0.05 = -1.0V from OTP, slightly better
+  // GxEPD: WBmode:VBDF 17|D7 VBDW 97 VBDB 57   WBRmode:VBDF F7 VBDW 77 VBDB 37  VBDR B7
+  EPD_CMD(0x50, 1), 0xd7,                          // VCOM AND DATA INTERVAL SETTING: border floating to avoid flashing
+  EPD_CMD(0x04, 0),                                // Power on
+  EPD_BUSY(1, 2000),
+  EPD_END
 };
-
-DRAM_ATTR const epd_init_4 Gdew042t2Grays::epd_resolution={
-0x61,{
-  0x01, 0x90,
-  0x01, 0x2c
-},4};
+static_assert(epd_sequence_valid(gdew042t2Grays_wakeup, sizeof(gdew042t2Grays_wakeup)), "gdew042t2Grays_wakeup is malformed");
 
 // Constructor
 Gdew042t2Grays::Gdew042t2Grays(EpdSpi& dio): 
@@ -163,16 +187,11 @@ Gdew042t2Grays::Gdew042t2Grays(EpdSpi& dio):
 
 void Gdew042t2Grays::initFullUpdate(){
   if (_mono_mode == false) {
-    IO.cmd(lut_vcom11.cmd);
-    IO.data(lut_vcom11.data,lut_vcom11.databytes);
-    IO.cmd(lut_ww_full.cmd);
-    IO.data(lut_ww_full.data,lut_ww_full.databytes);
-    IO.cmd(lut_bw_full.cmd);
-    IO.data(lut_bw_full.data,lut_bw_full.databytes);
-    IO.cmd(lut_wb_full.cmd);
-    IO.data(lut_wb_full.data,lut_wb_full.databytes);
-    IO.cmd(lut_bb_full.cmd);
-    IO.data(lut_bb_full.data,lut_bb_full.databytes);
+    IO.cmdData(lut_vcom11);
+    IO.cmdData(lut_ww_full);
+    IO.cmdData(lut_bw_full);
+    IO.cmdData(lut_wb_full);
+    IO.cmdData(lut_bb_full);
   }
    
   if (debug_enabled) printf("initFullUpdate() LUT in mode %d\n", (uint8_t)_mono_mode);
@@ -184,44 +203,18 @@ void Gdew042t2Grays::initFullUpdate(){
  */
 void Gdew042t2Grays::initPartialUpdate(){
     printf("INIT PARTIAL MODE\n");
-    IO.reset(10);
-
-    IO.cmd(0x04); // Power on
-		_waitBusy("0x04");
+    IO.sequence(gdew042t2Grays_partial);
 
-    IO.cmd(epd_wakeup_power.cmd);
-    for (int i=0;i<epd_wakeup_power.databytes;++i) {
-      IO.data(epd_wakeup_power.data[i]);
-    }
-    IO.cmd(epd_soft_start.cmd);
-    for (int i=0;i<epd_soft_start.databytes;++i) {
-      IO.data(epd_soft_start.data[i]);
-    }
-    IO.cmd(0x00);     // panel setting
-    IO.data(0x3f);    // 300x400 B/W mode, LUT set by register
-    IO.cmd(0x30);     // PLL setting
-    IO.data(0x3a);    // 3a 100HZ   29 150Hz 39 200HZ 31 171HZ
-
-    IO.cmd(0x82); // vcom_DC setting
-    IO.data(0x1A);
-    IO.cmd(0X50);			// VCOM AND DATA INTERVAL SETTING
-		IO.data(0xD7);		// Border avoid flashing
-    
     // LUT Tables for partial update. Send them directly in 42 bytes chunks. In total 210 bytes
-    IO.cmd(lut_20_vcom0_partial.cmd);
-    IO.data(lut_20_vcom0_partial.data,lut_20_vcom0_partial.databytes);
+    IO.cmdData(lut_20_vcom0_partial);
 
-    IO.cmd(lut_21_ww_partial.cmd);
-    IO.data(lut_21_ww_partial.data,lut_21_ww_partial.databytes);
+    IO.cmdData(lut_21_ww_partial);
 
-    IO.cmd(lut_22_bw_partial.cmd);
-    IO.data(lut_22_bw_partial.data,lut_22_bw_partial.databytes);
+    IO.cmdData(lut_22_bw_partial);
 
-    IO.cmd(lut_23_wb_partial.cmd);
-    IO.data(lut_23_wb_partial.data,lut_23_wb_partial.databytes);
+    IO.cmdData(lut_23_wb_partial);
 
-    IO.cmd(lut_24_bb_partial.cmd);
-    IO.data(lut_24_bb_partial.data,lut_24_bb_partial.databytes);
+    IO.cmdData(lut_24_bb_partial);
 
 }
 
@@ -244,99 +237,34 @@ void Gdew042t2Grays::init(bool debug)
 void Gdew042t2Grays::fillScreen(uint16_t color)
 {
   if (_mono_mode) {
-      uint8_t data = (color == EPD_BLACK) ? 0x00 : 0xFF;
-      for (uint16_t x = 0; x < sizeof(_mono_buffer); x++)
-      {
-        _mono_buffer[x] = data;
-      }
+    _mono.clear((color == EPD_BLACK) ? 0 : 1);
 
   } else {
-    uint8_t b1 = 0x00;
-    uint8_t b2 = 0x00;
+    // Plane bits (_buffer2 _buffer1) filled per color
+    uint8_t bits = 0;
     switch (color)
     {
       case EPD_BLACK:
-          b1 = 0xFF;
-          b2 = 0xFF;
+          bits = 3;
       break;
       case EPD_LIGHTGREY:
-          b1 = 0xFF;
-          b2 = 0x00;
+          bits = 1;
       break;
       case EPD_DARKGREY:
-          b1 = 0x00;
-          b2 = 0xFF;
-      break;
-      case EPD_WHITE:
-          b1 = 0x00;
-          b2 = 0x00;
+          bits = 2;
       break;
     }
-
-      for(uint32_t i=0; i<GDEW042T2_MONO_BUFFER_SIZE; i++)
-      {
-        _buffer1[i] = b1;
-        _buffer2[i] = b2;
-      }
+    _grays.clear(bits);
     return;
   }
   if (debug_enabled) printf("fillScreen(%d)\n", color);
 }
 
 void Gdew042t2Grays::_wakeUp(){
-  
-  IO.reset(10);
-
-  IO.cmd(epd_soft_start.cmd);
-  for (int i=0;i<epd_soft_start.databytes;++i) {
-    IO.data(epd_soft_start.data[i]);
-  }
-  // Resolution setting
-  IO.cmd(epd_resolution.cmd);
-  for (int i=0;i<epd_resolution.databytes;++i) {
-    IO.data(epd_resolution.data[i]);
-  }
-
-  if (_mono_mode) {    
-    IO.cmd(0x04);  
-    _waitBusy("0x04");//waiting for the electronic paper IC to release the idle signal
-
-    IO.cmd(0x00);     //panel setting
-    IO.data(0x1f);    //LUT from OTP£¬KW-BF   KWR-AF  BWROTP 0f BWOTP 1f
-
-    IO.cmd(0x61);     //resolution setting
-    IO.data(0x01); 
-    IO.data(0x90);    //400   
-    IO.data(0x01);   //300
-    IO.data(0x2c); 
-    
-    IO.cmd(0X50);     //VCOM AND DATA INTERVAL SETTING      
-    IO.data(0x97);    //WBmode:VBDF 17|D7 VBDW 97 VBDB 57
+  if (_mono_mode) {
+    IO.sequence(gdew042t2Grays_wakeup_mono);
   } else {
-
-    IO.cmd(epd_wakeup_power.cmd);
-    for (int i=0;i<epd_wakeup_power.databytes;++i) {
-      IO.data(epd_wakeup_power.data[i]);
-    }
-    
-    IO.cmd(epd_panel_setting.cmd);
-    for (int i=0;i<epd_panel_setting.databytes;++i) {
-      IO.data(epd_panel_setting.data[i]);
-    }
-
-    IO.cmd(epd_pll.cmd);
-    IO.data(epd_pll.data[0]);
-
-    IO.cmd(0x82);    // vcom_DC setting
-    IO.data(0x12);   // -0.1 + 18 * -0.05 = -1.0V from OTP, slightly better
-
-    IO.cmd(0x50);    // VCOM AND DATA INTERVAL SETTING
-    //IO.data(0x97);  // GxEPD: WBmode:VBDF 17|D7 VBDW 97 VBDB 57   WBRmode:VBDF F7 VBDW 77 VBDB 37  VBDR B7
-    IO.data(0xd7); // border floating to avoid flashing
-
-    IO.cmd(0x04);
-
-    _waitBusy("epd_wakeup_power");
+    IO.sequence(gdew042t2Grays_wakeup);
     initFullUpdate();
   }
 }
@@ -481,16 +409,8 @@ void Gdew042t2Grays::_waitBusy(const char* message){
   if (debug_enabled) {
     ESP_LOGI(TAG, "_waitBusy for %s", message);
   }
-  int64_t time_since_boot = esp_timer_get_time();
-
-  while (1){
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 1) break;
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>2000000)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
-    }
+  if (!IO.waitBusy(1, 2000, message) && debug_enabled) {
+    ESP_LOGI(TAG, "Busy Timeout");
   }
 }
 
@@ -522,67 +442,37 @@ void Gdew042t2Grays::_rotate(uint16_t& x, uint16_t& y, uint16_t& w, uint16_t& h)
   }
 }
 
+void Gdew042t2Grays::setRotation(uint8_t r)
+{
+  Adafruit_GFX::setRotation(r);
+  static const decltype(_drawPixelRotated) writers[] = {
+    &Gdew042t2Grays::_drawPixel<0>, &Gdew042t2Grays::_drawPixel<1>, &Gdew042t2Grays::_drawPixel<2>, &Gdew042t2Grays::_drawPixel<3>};
+  _drawPixelRotated = writers[getRotation()];
+}
+
 /**
  * @param x 
  * @param y 
  * @param color 
  */
-void Gdew042t2Grays::drawPixel(int16_t x, int16_t y, uint16_t color) {
-  if ((x < 0) || (x >= width()) || (y < 0) || (y >= height())) return;
-
-  // Check rotation, move pixel around if necessary
-  switch (getRotation())
-  {
-    case 1:
-      swap(x, y);
-      x = GDEW042T2_WIDTH - x - 1;
-      break;
-    case 2:
-      x = GDEW042T2_WIDTH - x - 1;
-      y = GDEW042T2_HEIGHT - y - 1;
-      break;
-    case 3:
-      swap(x, y);
-      y = GDEW042T2_HEIGHT - y - 1;
-      break;
-  }
-  
-  uint16_t i = x / 8 + y * GDEW042T2_WIDTH / 8;
-  uint8_t mask = 0x80 >> (x & 7);
+void Gdew042t2Grays::drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+  (this->*_drawPixelRotated)(x, y, color);
+}
 
+template <uint8_t R> void Gdew042t2Grays::_drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+  typedef EpdRotation<R, GDEW042T2_WIDTH, GDEW042T2_HEIGHT> rotation;
+  if (!rotation::contains(x, y)) return;
+  rotation::map(x, y);
   if (_mono_mode) {
-     if (color) {
-      _mono_buffer[i] = _mono_buffer[i] | mask;
-      } else {
-      _mono_buffer[i] = _mono_buffer[i] & (0xFF ^ mask);
-      }
+    _mono.set(x, y, color ? 1 : 0);
   } else {
-      // 4 gray mode
-      color >>= 6; // Color is from 0 (black) to 255 (white)
-      
-      switch (color)
-      {
-      case 1:
-        // Dark gray: Correct
-        _buffer1[i] = _buffer1[i] & (0xFF ^ mask);
-        _buffer2[i] = _buffer2[i] | mask;
-        break;
-      case 2:
-        // Light gray: Correct
-        _buffer1[i] = _buffer1[i] | mask;
-        _buffer2[i] = _buffer2[i] & (0xFF ^ mask);
-        break;
-      case 3:
-        // WHITE
-        _buffer1[i] = _buffer1[i] | mask;
-        _buffer2[i] = _buffer2[i] | mask;
-        break;
-      default:
-        // Black
-        _buffer1[i] = _buffer1[i] & (0xFF ^ mask);
-        _buffer2[i] = _buffer2[i] & (0xFF ^ mask);
-        break;
-      }
+    // 4 gray mode. Color is from 0 (black) to 255 (white)
+    // Plane bits per gray: black, dark gray, light gray and white
+    static const uint8_t grays[] = {0, 2, 1, 3};
+    color >>= 6;
+    _grays.set(x, y, (color < 4) ? grays[color] : 0);
   }
 }
 
@@ -17,6 +17,8 @@
 
 // Partial Update Delay, may have an influence on degradation
 #define GDEW075T7_PU_DELAY 100
+// In low temperatures a full update takes longer than the default busy timeout
+#define GDEW075T7_FULL_UPDATE_TIMEOUT 10000
 
 // Partial display Waveform
 DRAM_ATTR const epd_init_42 Gdew075T7::lut_20_LUTC_partial = {
@@ -49,25 +51,12 @@ DRAM_ATTR const epd_init_42 Gdew075T7::lut_25_LUTBD_partial = {
            0x00, T1, T2, T3, T4, 1, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
     42};
 
-// 0x07 (2nd) VGH=20V,VGL=-20V
-// 0x3f (1st) VDH= 15V
-// 0x3f (2nd) VDH=-15V
-DRAM_ATTR const epd_power_4 Gdew075T7::epd_wakeup_power = {
-    0x01, {0x07, 0x07, 0x3f, 0x3f}, 4};
-
 DRAM_ATTR const epd_init_1 Gdew075T7::epd_panel_setting_full = {
     0x00, {0x1f}, 1};
 
 DRAM_ATTR const epd_init_1 Gdew075T7::epd_panel_setting_partial = {
     0x00, {0x3f}, 1};
 
-DRAM_ATTR const epd_init_4 Gdew075T7::epd_resolution = {
-    0x61, {GDEW075T7_WIDTH / 256, //source 800
-           GDEW075T7_WIDTH % 256,
-           GDEW075T7_HEIGHT / 256, //gate 480
-           GDEW075T7_HEIGHT % 256},
-    4};
-
 // Constructor
 Gdew075T7::Gdew075T7(EpdSpi &dio) : Adafruit_GFX(GDEW075T7_WIDTH, GDEW075T7_HEIGHT),
                                     Epd(GDEW075T7_WIDTH, GDEW075T7_HEIGHT), IO(dio)
@@ -75,6 +64,16 @@ Gdew075T7::Gdew075T7(EpdSpi &dio) : Adafruit_GFX(GDEW075T7_WIDTH, GDEW075T7_HEIG
   printf("Gdew075T7() constructor injects IO and extends Adafruit_GFX(%d,%d) Pix Buffer[%d]\n",
          GDEW075T7_WIDTH, GDEW075T7_HEIGHT, (int)GDEW075T7_BUFFER_SIZE);
   printf("\nAvailable heap after Epd bootstrap:%d\n", (int) xPortGetFreeHeapSize());
+  _dirty.begin(GDEW075T7_WIDTH, GDEW075T7_HEIGHT);
+  _span = {_buffer, GDEW075T7_WIDTH, GDEW075T7_HEIGHT, GDEW075T7_WIDTH / 8, false, false};
+}
+
+Gdew075T7::~Gdew075T7()
+{
+  // _updateFinish() of an update in flight needs this object
+  _asyncStop();
+  free(_buffer_alloc);
+  free(_tx_rows);
 }
 
 void Gdew075T7::initFullUpdate()
@@ -97,23 +96,17 @@ void Gdew075T7::initPartialUpdate()
   IO.data(0x07);
 
   // LUT Tables for partial update. Send them directly in 42 bytes chunks. In total 210 bytes
-  IO.cmd(lut_20_LUTC_partial.cmd);
-  IO.data(lut_20_LUTC_partial.data, lut_20_LUTC_partial.databytes);
+  IO.cmdData(lut_20_LUTC_partial);
 
-  IO.cmd(lut_21_LUTWW_partial.cmd);
-  IO.data(lut_21_LUTWW_partial.data, lut_21_LUTWW_partial.databytes);
+  IO.cmdData(lut_21_LUTWW_partial);
 
-  IO.cmd(lut_22_LUTKW_partial.cmd);
-  IO.data(lut_22_LUTKW_partial.data, lut_22_LUTKW_partial.databytes);
+  IO.cmdData(lut_22_LUTKW_partial);
 
-  IO.cmd(lut_23_LUTWK_partial.cmd);
-  IO.data(lut_23_LUTWK_partial.data, lut_23_LUTWK_partial.databytes);
+  IO.cmdData(lut_23_LUTWK_partial);
 
-  IO.cmd(lut_24_LUTKK_partial.cmd);
-  IO.data(lut_24_LUTKK_partial.data, lut_24_LUTKK_partial.databytes);
+  IO.cmdData(lut_24_LUTKK_partial);
 
-  IO.cmd(lut_25_LUTBD_partial.cmd);
-  IO.data(lut_25_LUTBD_partial.data, lut_25_LUTBD_partial.databytes);
+  IO.cmdData(lut_25_LUTBD_partial);
 }
 
 //Initialize the display
@@ -130,90 +123,161 @@ void Gdew075T7::init(bool debug)
 
 void Gdew075T7::fillScreen(uint16_t color)
 {
-  uint8_t data = (color == EPD_BLACK) ? GDEW075T7_8PIX_BLACK : GDEW075T7_8PIX_WHITE;
-  for (uint16_t x = 0; x < sizeof(_buffer); x++)
-  {
-    _buffer[x] = data;
-  }
+  _dirty.markAll();
+  _fb.clear((color == EPD_BLACK) ? 0 : 1);
 }
 
+DRAM_ATTR static constexpr uint8_t gdew075T7_wakeup[] = {
+  EPD_RESET(10),
+  // IMPORTANT: Some EPD controllers like to receive data byte per byte
+  EPD_CMD_BYTES(0x01, 4), 0x07, 0x07, 0x3f, 0x3f, // POWER SETTING VGH=20V,VGL=-20V VDH=15V VDL=-15V
+  EPD_CMD(0x04, 0),                                // Power on
+  EPD_BUSY(1, 2000),
+  EPD_CMD(0x61, 4), GDEW075T7_WIDTH / 256, GDEW075T7_WIDTH % 256,  // Resolution setting: source 800
+                    GDEW075T7_HEIGHT / 256, GDEW075T7_HEIGHT % 256, // gate 480
+  // Not sure if 0x15 is really needed, seems to work the same without it too
+  EPD_CMD(0x15, 1), 0x00,                          // Dual SPI: MM_EN, DUSPI_EN
+  EPD_CMD(0x50, 2), 0x29, 0x17,                    // VCOM AND DATA INTERVAL SETTING: LUTKW, N2OCP: copy new to old
+  EPD_CMD(0x60, 1), 0x22,                          // TCON SETTING
+  EPD_CMD(0x00, 1), 0x1f,                          // panel setting: full update LUT from OTP
+  EPD_END
+};
+static_assert(epd_sequence_valid(gdew075T7_wakeup, sizeof(gdew075T7_wakeup)), "gdew075T7_wakeup is malformed");
+
 void Gdew075T7::_wakeUp()
 {
-  IO.reset(10);
-  //IMPORTANT: Some EPD controllers like to receive data byte per byte
-  //So this won't work:
-  //IO.data(epd_wakeup_power.data,epd_wakeup_power.databytes);
+  IO.sequence(gdew075T7_wakeup);
+}
 
-  IO.cmd(epd_wakeup_power.cmd);
-  for (int i = 0; i < epd_wakeup_power.databytes; ++i)
-  {
-    IO.data(epd_wakeup_power.data[i]);
+bool Gdew075T7::setDoubleBuffer(bool enabled)
+{
+  waitForUpdate();
+  if (enabled) {
+    if (_buffer_alloc != nullptr) return true;
+    _buffer_alloc = (uint8_t*)heap_caps_malloc(GDEW075T7_BUFFER_SIZE, MALLOC_CAP_SPIRAM);
+    if (_buffer_alloc == nullptr) {
+      _buffer_alloc = (uint8_t*)heap_caps_malloc(GDEW075T7_BUFFER_SIZE, MALLOC_CAP_8BIT);
+    }
+    if (_buffer_alloc == nullptr) {
+      ESP_LOGE(TAG, "Not enough memory for a second buffer of %d bytes", (int)GDEW075T7_BUFFER_SIZE);
+      return false;
+    }
+    memcpy(_buffer_alloc, _buffer, GDEW075T7_BUFFER_SIZE);
+    _front_buffer = _buffer_alloc;
+    return true;
   }
 
-  IO.cmd(0x01); // POWER SETTING
-  IO.data(0x07);
-  IO.data(0x07); // VGH=20V,VGL=-20V
-  IO.data(0x3f); // VDH=15V
-  IO.data(0x3f); // VDL=-15V
-  IO.cmd(0x04);
-  _waitBusy("_wakeUp power on");
-
-  // Resolution setting
-  IO.cmd(epd_resolution.cmd);
-  for (int i = 0; i < epd_resolution.databytes; ++i)
-  {
-    IO.data(epd_resolution.data[i]);
+  if (_buffer_alloc == nullptr) return true;
+  // Keep what the application was drawing
+  if (_buffer != _buffer_mem) {
+    memcpy(_buffer_mem, _buffer, GDEW075T7_BUFFER_SIZE);
+    _buffer = _buffer_mem;
+    _span.buffer = _buffer;
+    _fb.setData(_buffer);
+    _fb_portrait.setData(_buffer);
   }
-  // Not sure if 0x15 is really needed, seems to work the same without it too
-  IO.cmd(0x15);  // Dual SPI
-  IO.data(0x00); // MM_EN, DUSPI_EN
+  free(_buffer_alloc);
+  _buffer_alloc = nullptr;
+  _front_buffer = nullptr;
+  return true;
+}
 
-  IO.cmd(0x50);  // VCOM AND DATA INTERVAL SETTING
-  IO.data(0x29); // LUTKW, N2OCP: copy new to old
-  IO.data(0x17);
-  IO.cmd(0x60);  // TCON SETTING
-  IO.data(0x22);
+bool Gdew075T7::_updateSwap()
+{
+  // Every update path starts here: what was drawn until now is being sent
+  _dirty.clear();
+  // The frame being sent keeps the rotation it was drawn with
+  _tx_rotation = (_tx_rows != nullptr) ? getRotation() : 0;
+  if (_front_buffer == nullptr) return false;
+  uint8_t* drawn = _buffer;
+  _buffer = _front_buffer;
+  _front_buffer = drawn;
+  // The back buffer continues from the frame being sent: updateWindow() and updateDirty() send parts of it
+  memcpy(_buffer, _front_buffer, GDEW075T7_BUFFER_SIZE);
+  _span.buffer = _buffer;
+  _fb.setData(_buffer);
+  _fb_portrait.setData(_buffer);
+  return true;
+}
 
-  IO.cmd(epd_panel_setting_full.cmd);      // panel setting
-  IO.data(epd_panel_setting_full.data[0]); // full update LUT from OTP
+bool Gdew075T7::setFrameDiff(bool enabled, epd_diff_mode_t mode)
+{
+  waitForUpdate();
+  if (!enabled) {
+    _diff.end();
+    return true;
+  }
+  return _diff.begin(GDEW075T7_WIDTH / 8, GDEW075T7_HEIGHT, mode);
+}
+
+bool Gdew075T7::setRotateOnTransmit(bool enabled)
+{
+  waitForUpdate();
+  if (enabled && _tx_rows == nullptr) {
+    _tx_rows = (uint8_t*)heap_caps_malloc(EpdRotatedRows<1>::band * GDEW075T7_WIDTH / 8, MALLOC_CAP_8BIT);
+    if (_tx_rows == nullptr) {
+      ESP_LOGE(TAG, "Not enough memory for rotate on transmit");
+      return false;
+    }
+  } else if (!enabled && _tx_rows != nullptr) {
+    free(_tx_rows);
+    _tx_rows = nullptr;
+  }
+  // The last frame sent was in the other layout
+  _diff.invalidate();
+  _selectWriters();
+  return true;
 }
 
 void Gdew075T7::update()
 {
-  uint64_t startTime = esp_timer_get_time();
+  waitForUpdate();
+  _updateSwap();
+  _updateBegin();
+  _updateFinish();
+}
+
+void Gdew075T7::_updateBegin()
+{
+  const uint8_t* tx_buffer = (_front_buffer != nullptr) ? _front_buffer : _buffer;
+  _update_skipped = _diff.enabled() && _diff.compare(tx_buffer) == 0;
+  if (_update_skipped) {
+    if (debug_enabled) printf("update: Frame did not change, skipping refresh\n");
+    return;
+  }
+  _update_start_time = esp_timer_get_time();
   _using_partial_mode = false;
   _wakeUp();
 
   IO.cmd(0x13);
-  printf("Sending a %d bytes buffer via SPI\n", sizeof(_buffer));
+  printf("Sending a %d bytes buffer via SPI\n", (int)GDEW075T7_BUFFER_SIZE);
 
-  // v2 SPI optimizing. Check: https://github.com/martinberlin/cale-idf/wiki/About-SPI-optimization
-  uint16_t i = 0;
+  // v3 SPI optimizing: rows are queued using DMA so the next X line is copied while the previous one is sent
+  // Check: https://github.com/martinberlin/cale-idf/wiki/About-SPI-optimization
+  // With rotate on transmit each band of 8 rows is transposed right before it is queued
   uint8_t xLineBytes = GDEW075T7_WIDTH / 8;
-  uint8_t x1buf[xLineBytes];
-  for (uint16_t y = 1; y <= GDEW075T7_HEIGHT; y++)
+  EpdRotatedRows<1> rows(tx_buffer, GDEW075T7_WIDTH, GDEW075T7_HEIGHT, _tx_rotation, _tx_rows);
+  IO.dataStreamBegin(xLineBytes);
+  for (uint16_t y = 0; y < GDEW075T7_HEIGHT; y++)
   {
-    for (uint16_t x = 1; x <= xLineBytes; x++)
-    {
-      uint8_t data = i < sizeof(_buffer) ? _buffer[i] : 0x00;
-      x1buf[x - 1] = data;
-      if (x == xLineBytes)
-      { // Flush the X line buffer to SPI
-        IO.data(x1buf, sizeof(x1buf));
-      }
-      ++i;
-    }
+    uint8_t* x1buf = IO.dataStreamBuffer();
+    memcpy(x1buf, rows.row(y), xLineBytes);
+    IO.dataStreamQueue(xLineBytes);
   }
+  IO.dataStreamEnd();
+  _diff.commit(tx_buffer);
 
-  uint64_t endTime = esp_timer_get_time();
+  _update_sent_time = esp_timer_get_time();
   IO.cmd(0x12);
-  _waitBusy("update");
+}
+
+void Gdew075T7::_updateFinish()
+{
+  if (_update_skipped) return;
+  _waitBusy("update", GDEW075T7_FULL_UPDATE_TIMEOUT);
   uint64_t updateTime = esp_timer_get_time();
   printf("\n\nSTATS (ms)\n%llu _wakeUp settings+send Buffer\n%llu update \n%llu total time in millis\n",
-         (endTime - startTime) / 1000, (updateTime - endTime) / 1000, (updateTime - startTime) / 1000);
-  
-  // Additional 2 seconds wait before sleeping since in low temperatures full update takes longer
-  vTaskDelay(2000 / portTICK_PERIOD_MS);
+         (_update_sent_time - _update_start_time) / 1000, (updateTime - _update_sent_time) / 1000, (updateTime - _update_start_time) / 1000);
 
   _sleep();
 }
@@ -238,12 +302,27 @@ uint16_t Gdew075T7::_setPartialRamArea(uint16_t x, uint16_t y, uint16_t xe, uint
 void Gdew075T7::updateWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h, bool using_rotation)
 {
   printf("updateWindow: Still in test mode\n");
+  waitForUpdate();
   if (using_rotation)
     _rotate(x, y, w, h);
   if (x >= GDEW075T7_WIDTH)
     return;
   if (y >= GDEW075T7_HEIGHT)
     return;
+  // With rotate on transmit the buffer is not in controller layout: the diff only works for whole frames
+  bool rotated = _tx_rows != nullptr;
+  if (_diff.enabled() && !rotated) {
+    // Clip the window to the bytes that changed since they were last sent
+    uint16_t xb = x / 8;
+    uint16_t wb = (gx_uint16_min(GDEW075T7_WIDTH, x + w) + 7) / 8 - xb;
+    _diff.compare(_buffer);
+    if (!_diff.changedArea(xb, y, wb, h)) {
+      if (debug_enabled) printf("updateWindow: Area did not change, skipping refresh\n");
+      return;
+    }
+    x = xb * 8;
+    w = wb * 8;
+  }
   uint16_t xe = gx_uint16_min(GDEW075T7_WIDTH, x + w) - 1;
   uint16_t ye = gx_uint16_min(GDEW075T7_HEIGHT, y + h) - 1;
 
@@ -262,13 +341,15 @@ void Gdew075T7::updateWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h, boo
     _setPartialRamArea(x, y, xe, ye);
     IO.cmd(0x13);
 
+    EpdRotatedRows<1> rows(_buffer, GDEW075T7_WIDTH, GDEW075T7_HEIGHT, rotated ? getRotation() : 0, _tx_rows);
     for (int16_t y1 = y; y1 <= ye; y1++)
     {
+      const uint8_t* row = rows.row(y1);
       for (int16_t x1 = xs_bx; x1 < xe_bx; x1++)
       {
         uint16_t idx = y1 * (GDEW075T7_WIDTH / 8) + x1;
         // white is 0x00 in buffer
-        uint8_t data = (idx < sizeof(_buffer)) ? _buffer[idx] : 0x00;
+        uint8_t data = (idx < GDEW075T7_BUFFER_SIZE) ? row[x1] : 0x00;
         // white is 0xFF on device
         IO.data(data);
 
@@ -284,30 +365,33 @@ void Gdew075T7::updateWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h, boo
     IO.cmd(0x12); // display refresh
     _waitBusy("updateWindow");
     IO.cmd(0x92); // partial out
+    if (rotated) {
+      _diff.invalidate();
+    } else {
+      _diff.commitArea(_buffer, xs_bx, y, xe_bx - xs_bx, ye - y + 1);
+    }
   }
 
   vTaskDelay(GDEW075T7_PU_DELAY / portTICK_PERIOD_MS);
 }
 
+void Gdew075T7::_updateDirtyRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+  updateWindow(x, y, w, h, false);
+}
+
 void Gdew075T7::_waitBusy(const char *message)
 {
-  if (debug_enabled)
-  {
+  _waitBusy(message, 2000);
+}
+
+void Gdew075T7::_waitBusy(const char *message, uint32_t timeout_ms)
+{
+  if (debug_enabled) {
     ESP_LOGI(TAG, "_waitBusy for %s", message);
   }
-  int64_t time_since_boot = esp_timer_get_time();
-
-  while (1)
-  {
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 1)
-      break;
-    vTaskDelay(1);
-    if (esp_timer_get_time() - time_since_boot > 2000000)
-    {
-      if (debug_enabled)
-        ESP_LOGI(TAG, "Busy Timeout");
-      break;
-    }
+  if (!IO.waitBusy(1, timeout_ms, message) && debug_enabled) {
+    ESP_LOGI(TAG, "Busy Timeout");
   }
 }
 
@@ -340,35 +424,50 @@ void Gdew075T7::_rotate(uint16_t &x, uint16_t &y, uint16_t &w, uint16_t &h)
   }
 }
 
+void Gdew075T7::setRotation(uint8_t r)
+{
+  Adafruit_GFX::setRotation(r);
+  _selectWriters();
+}
+
+void Gdew075T7::_selectWriters()
+{
+  static const decltype(_drawPixelRotated) writers[] = {
+    &Gdew075T7::_drawPixel<0>, &Gdew075T7::_drawPixel<1>, &Gdew075T7::_drawPixel<2>, &Gdew075T7::_drawPixel<3>};
+  static const decltype(_drawPixelRotated) logical_writers[] = {
+    &Gdew075T7::_drawPixelLogical<0>, &Gdew075T7::_drawPixelLogical<1>,
+    &Gdew075T7::_drawPixelLogical<2>, &Gdew075T7::_drawPixelLogical<3>};
+  bool rotated = _tx_rows != nullptr;
+  _drawPixelRotated = rotated ? logical_writers[getRotation()] : writers[getRotation()];
+  _span.rotated = rotated;
+}
+
 void Gdew075T7::drawPixel(int16_t x, int16_t y, uint16_t color)
 {
-  if ((x < 0) || (x >= width()) || (y < 0) || (y >= height()))
-    return;
-  switch (getRotation())
-  {
-  case 1:
-    swap(x, y);
-    x = GDEW075T7_WIDTH - x - 1;
-    break;
-  case 2:
-    x = GDEW075T7_WIDTH - x - 1;
-    y = GDEW075T7_HEIGHT - y - 1;
-    break;
-  case 3:
-    swap(x, y);
-    y = GDEW075T7_HEIGHT - y - 1;
-    break;
-  }
-  uint16_t i = x / 8 + y * GDEW075T7_WIDTH / 8;
+  (this->*_drawPixelRotated)(x, y, color);
+}
 
-  if (color)
-  {
-    _buffer[i] = (_buffer[i] | (1 << (7 - x % 8)));
-  }
-  else
-  {
-    _buffer[i] = (_buffer[i] & (0xFF ^ (1 << (7 - x % 8))));
+template <uint8_t R> void Gdew075T7::_drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+  typedef EpdRotation<R, GDEW075T7_WIDTH, GDEW075T7_HEIGHT> rotation;
+  if (!rotation::contains(x, y)) return;
+  rotation::map(x, y);
+  _dirty.mark(x, y);
+  _fb.set(x, y, color ? 1 : 0);
+}
+
+template <uint8_t R> void Gdew075T7::_drawPixelLogical(int16_t x, int16_t y, uint16_t color)
+{
+  typedef EpdRotation<R, GDEW075T7_WIDTH, GDEW075T7_HEIGHT> rotation;
+  if (!rotation::contains(x, y)) return;
+  if (R & 1) {
+    _fb_portrait.set(x, y, color ? 1 : 0);
+  } else {
+    _fb.set(x, y, color ? 1 : 0);
   }
+  // Dirty regions are in controller coordinates
+  rotation::map(x, y);
+  _dirty.mark(x, y);
 }
 
 void Gdew075T7::setRawBuf(uint32_t position, uint8_t value) {
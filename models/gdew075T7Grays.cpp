@@ -68,18 +68,23 @@ DRAM_ATTR const epd_init_42 Gdew075T7Grays::lut_bb = {
 0x00	,0x00	,0x00	,0x00	,0x00	,0x00},
     42};
 
-// 0x07 (2nd) VGH=20V,VGL=-20V
-// 0x3f (1st) VDH= 15V
-// 0x3f (2nd) VDH=-15V
-DRAM_ATTR const epd_power_4 Gdew075T7Grays::epd_wakeup_power = {
-    0x01, {0x07, 0x17, 0x3f, 0x3f}, 4};
-
-DRAM_ATTR const epd_init_4 Gdew075T7Grays::epd_resolution = {
-    0x61, {GDEW075T7_WIDTH / 256, //source 800
-           GDEW075T7_WIDTH % 256,
-           GDEW075T7_HEIGHT / 256, //gate 480
-           GDEW075T7_HEIGHT % 256},
-    4};
+DRAM_ATTR static constexpr uint8_t gdew075T7Grays_wakeup[] = {
+  EPD_RESET(10),
+  // IMPORTANT: Some EPD controllers like to receive data byte per byte
+  EPD_CMD_BYTES(0x01, 4), 0x07, 0x17, 0x3f, 0x3f, // POWER SETTING VGH=20V,VGL=-20V VDH=15V VDL=-15V
+  EPD_CMD(0x04, 0),                                // Power on
+  EPD_BUSY(1, 2000),
+  EPD_CMD(0x00, 1), 0xBF,                          // PANNEL SETTING
+  EPD_CMD(0x30, 1), 0x06,                          // PLL
+  EPD_CMD_BYTES(0x61, 4), GDEW075T7_WIDTH / 256, GDEW075T7_WIDTH % 256,  // Resolution setting: source 800
+                          GDEW075T7_HEIGHT / 256, GDEW075T7_HEIGHT % 256, // gate 480
+  EPD_CMD(0x15, 1), 0x00,                          // SPI Setting
+  EPD_CMD(0x60, 1), 0x22,                          // TCON SETTING
+  EPD_CMD(0x82, 1), 0x12,                          // vcom_DC setting
+  EPD_CMD_BYTES(0x50, 2), 0x10, 0x07,              // VCOM AND DATA INTERVAL SETTING 10:KW(0--1)  21:KW(1--0)
+  EPD_END
+};
+static_assert(epd_sequence_valid(gdew075T7Grays_wakeup, sizeof(gdew075T7Grays_wakeup)), "gdew075T7Grays_wakeup is malformed");
 
 // Constructor
 Gdew075T7Grays::Gdew075T7Grays(EpdSpi &dio) : Adafruit_GFX(GDEW075T7_WIDTH, GDEW075T7_HEIGHT),
@@ -128,44 +133,7 @@ void Gdew075T7Grays::fillScreen(uint16_t color)
 
 void Gdew075T7Grays::_wakeUp()
 {
-  IO.reset(10);
-  //IMPORTANT: Some EPD controllers like to receive data byte per byte
-  //So this won't work:
-  //IO.data(epd_wakeup_power.data,epd_wakeup_power.databytes);
-
-  IO.cmd(epd_wakeup_power.cmd);
-  for (int i = 0; i < epd_wakeup_power.databytes; ++i)
-  {
-    IO.data(epd_wakeup_power.data[i]);
-  }
-
-  IO.cmd(0x04);
-  _waitBusy("_wakeUp power on");
-
-  IO.cmd(0x00);	//PANNEL SETTING
-  IO.data(0xBF);
-
-  IO.cmd(0x30);  // PLL
-  IO.data(0x06);
-
-  // Resolution setting
-  IO.cmd(epd_resolution.cmd);
-  for (int i = 0; i < epd_resolution.databytes; ++i)
-  {
-    IO.data(epd_resolution.data[i]);
-  }
-  IO.cmd(0x15);  // SPI Setting
-  IO.data(0x00);
-
-  IO.cmd(0x60);  // TCON SETTING
-  IO.data(0x22);
-
-  IO.cmd(0x82);  //vcom_DC setting
-  IO.data(0x12);
-
-  IO.cmd(0x50);  //VCOM AND DATA INTERVAL SETTING
-  IO.data(0x10); //10:KW(0--1)  21:KW(1--0)
-  IO.data(0x07);
+  IO.sequence(gdew075T7Grays_wakeup);
 }
 
 void Gdew075T7Grays::update()
@@ -276,23 +244,11 @@ void Gdew075T7Grays::updateWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h
 
 void Gdew075T7Grays::_waitBusy(const char *message)
 {
-  if (debug_enabled)
-  {
+  if (debug_enabled) {
     ESP_LOGI(TAG, "_waitBusy for %s", message);
   }
-  int64_t time_since_boot = esp_timer_get_time();
-
-  while (1)
-  {
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 1)
-      break;
-    vTaskDelay(1);
-    if (esp_timer_get_time() - time_since_boot > 2000000)
-    {
-      if (debug_enabled)
-        ESP_LOGI(TAG, "Busy Timeout");
-      break;
-    }
+  if (!IO.waitBusy(1, 2000, message) && debug_enabled) {
+    ESP_LOGI(TAG, "Busy Timeout");
   }
 }
 
@@ -325,32 +281,25 @@ void Gdew075T7Grays::_rotate(uint16_t &x, uint16_t &y, uint16_t &w, uint16_t &h)
   }
 }
 
+void Gdew075T7Grays::setRotation(uint8_t r)
+{
+  Adafruit_GFX::setRotation(r);
+  static const decltype(_drawPixelRotated) writers[] = {
+    &Gdew075T7Grays::_drawPixel<0>, &Gdew075T7Grays::_drawPixel<1>, &Gdew075T7Grays::_drawPixel<2>, &Gdew075T7Grays::_drawPixel<3>};
+  _drawPixelRotated = writers[getRotation()];
+}
+
 void Gdew075T7Grays::drawPixel(int16_t x, int16_t y, uint16_t color)
 {
-  if ((x < 0) || (x >= width()) || (y < 0) || (y >= height()))
-    return;
-  switch (getRotation())
-  {
-  case 1:
-    swap(x, y);
-    x = GDEW075T7_WIDTH - x - 1;
-    break;
-  case 2:
-    x = GDEW075T7_WIDTH - x - 1;
-    y = GDEW075T7_HEIGHT - y - 1;
-    break;
-  case 3:
-    swap(x, y);
-    y = GDEW075T7_HEIGHT - y - 1;
-    break;
-  }
+  (this->*_drawPixelRotated)(x, y, color);
+}
 
-  uint8_t *buf_ptr = &_buffer[y * GDEW075T7_WIDTH / 2 + x / 2];
-  if (x % 2) {
-    *buf_ptr = (*buf_ptr & 0x0F) | (color & 0xF0);
-  } else {
-    *buf_ptr = (*buf_ptr & 0xF0) | (color >> 4);
-  }
+template <uint8_t R> void Gdew075T7Grays::_drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+  typedef EpdRotation<R, GDEW075T7_WIDTH, GDEW075T7_HEIGHT> rotation;
+  if (!rotation::contains(x, y)) return;
+  rotation::map(x, y);
+  _fb.set(x, y, color >> 4);
 }
 
 void Gdew075T7Grays::fillRawBufferPos(uint32_t index, uint8_t value) {
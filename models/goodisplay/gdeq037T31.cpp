@@ -69,7 +69,7 @@ void Gdeq037T31::init(bool debug)
 
     printf("Free heap:%d\n", (int)xPortGetFreeHeapSize());
     fillScreen(EPD_WHITE);
-    _mono_mode = 1;
+    setMonoMode(true);
     fillScreen(EPD_WHITE);
 }
 
@@ -348,17 +348,8 @@ void Gdeq037T31::_waitBusy(const char* message){
   if (debug_enabled) {
     ESP_LOGI(TAG, "_waitBusy for %s", message);
   }
-  int64_t time_since_boot = esp_timer_get_time();
-
-  while (1){
-    // On low is not busy anymore
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 0) break;
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>7000000)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
-    }
+  if (!IO.waitBusy(0, 7000, message) && debug_enabled) {
+    ESP_LOGI(TAG, "Busy Timeout");
   }
 }
 
@@ -460,4 +451,6 @@ void Gdeq037T31::setMonoMode(bool mode) {
     _mono_mode = true;
   }
   _mono_mode = mode;
+  // Span fills only know the 1 bit buffer (a bit set to 1 is black)
+  _span = {mode ? _mono_buffer : nullptr, GDEQ037T31_WIDTH, GDEQ037T31_HEIGHT, GDEQ037T31_WIDTH / 8, true, false};
 }
@@ -43,6 +43,7 @@ Gdey0154d67::Gdey0154d67(EpdSpi& dio):
 {
   printf("Gdey0154d67() %d*%d\n",
   GDEY0154D67_WIDTH, GDEY0154D67_HEIGHT);  
+  _dirty.begin(GDEY0154D67_WIDTH, GDEY0154D67_HEIGHT);
 }
 
 void Gdey0154d67::initFullUpdate(){
@@ -60,12 +61,13 @@ void Gdey0154d67::init(bool debug)
 
     printf("Free heap:%d\n", (int)xPortGetFreeHeapSize());
     fillScreen(EPD_WHITE);
-    _mono_mode = 1;
+    setMonoMode(true);
     fillScreen(EPD_WHITE);
 }
 
 void Gdey0154d67::fillScreen(uint16_t color)
 {
+  _dirty.markAll();
   if (_mono_mode) {
     // 0xFF = 8 pixels black, 0x00 = 8 pix. white
     uint8_t data = (color == EPD_BLACK) ? GDEY0154D67_8PIX_BLACK : GDEY0154D67_8PIX_WHITE;
@@ -148,10 +150,7 @@ void Gdey0154d67::_wakeUp(){
 	IO.data(lut_4_grays.data[157]); //VSL
 
   // LUT init table for 4 gray. Check if it's needed!
-  IO.cmd(lut_4_grays.cmd);     // boost
-  for (int i=0; i<lut_4_grays.databytes; ++i) {
-      IO.data(lut_4_grays.data[i]);
-  }
+  IO.cmdData(lut_4_grays);     // boost
 }
 
 void Gdey0154d67::_wakeUp(uint8_t em) {
@@ -160,10 +159,7 @@ void Gdey0154d67::_wakeUp(uint8_t em) {
   // Theoretically this display could be driven without RST pin connected
   _waitBusy("SWRESET");
 
-  /* IO.cmd(GDOControl.cmd);
-  for (int i=0;i<GDOControl.databytes;++i) {
-      IO.data(GDOControl.data[i]);
-  } */
+  /* IO.cmdData(GDOControl); */
   IO.cmd(0x01);   // Driver output control      
   IO.data(0xC7);
   IO.data(0x00);
@@ -199,6 +195,7 @@ void Gdey0154d67::_wakeUp(uint8_t em) {
 
 void Gdey0154d67::update()
 {
+  _dirty.clear();
   uint64_t startTime = esp_timer_get_time();
   uint8_t xLineBytes = GDEY0154D67_WIDTH / 8;
   uint8_t x1buf[xLineBytes];
@@ -382,24 +379,22 @@ void Gdey0154d67::updateWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h, b
   _waitBusy("updateWindow");
 }
 
+void Gdey0154d67::_updateDirtyRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+  updateWindow(x, y, w, h, false);
+}
+
 void Gdey0154d67::_waitBusy(const char* message, uint16_t busy_time){
   if (debug_enabled) {
     ESP_LOGI(TAG, "_waitBusy for %s", message);
   }
-  int64_t time_since_boot = esp_timer_get_time();
-  // On high is busy
-  if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 1) {
-  while (1){
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 0) break;
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>7000000)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
+  // On high is busy. If it is not busy yet give the controller busy_time
+  if (IO.getBusyLevel() == 1) {
+    if (!IO.waitBusy(0, 7000, message) && debug_enabled) {
+      ESP_LOGI(TAG, "Busy Timeout");
     }
-  }
   } else {
-    vTaskDelay(busy_time/portTICK_PERIOD_MS); 
+    vTaskDelay(busy_time/portTICK_PERIOD_MS);
   }
 }
 
@@ -407,17 +402,8 @@ void Gdey0154d67::_waitBusy(const char* message){
   if (debug_enabled) {
     ESP_LOGI(TAG, "_waitBusy for %s", message);
   }
-  int64_t time_since_boot = esp_timer_get_time();
-
-  while (1){
-    // On low is not busy anymore
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 0) break;
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>7000000)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
-    }
+  if (!IO.waitBusy(0, 7000, message) && debug_enabled) {
+    ESP_LOGI(TAG, "Busy Timeout");
   }
 }
 
@@ -470,6 +456,7 @@ void Gdey0154d67::drawPixel(int16_t x, int16_t y, uint16_t color) {
       break;
   }
   uint16_t i = x / 8 + y * GDEY0154D67_WIDTH / 8;
+  _dirty.mark(x, y);
 
  if (_mono_mode) {
     // This is the trick to draw colors right. Genious Jean-Marc
@@ -512,4 +499,12 @@ void Gdey0154d67::drawPixel(int16_t x, int16_t y, uint16_t color) {
 
 void Gdey0154d67::setMonoMode(bool mode) {
   _mono_mode = mode;
+  // Span fills only know the 1 bit buffer (a bit set to 1 is black)
+  _span = {mode ? _mono_buffer : nullptr, GDEY0154D67_WIDTH, GDEY0154D67_HEIGHT, GDEY0154D67_WIDTH / 8, true, false};
+  // Partial update works only in mono mode. In 4 grays updateDirty() does a full update
+  if (mode) {
+    _dirty.begin(GDEY0154D67_WIDTH, GDEY0154D67_HEIGHT);
+  } else {
+    _dirty.begin(0, 0);
+  }
 }
\ No newline at end of file
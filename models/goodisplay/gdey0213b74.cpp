@@ -55,7 +55,7 @@ void Gdey0213b74::init(bool debug)
     //Reset the display
     IO.reset(20);
     fillScreen(EPD_WHITE);
-    _mono_mode = 1;
+    setMonoMode(true);
     fillScreen(EPD_WHITE);
 }
 
@@ -233,16 +233,8 @@ void Gdey0213b74::_waitBusy(const char* message){
   if (debug_enabled) {
     ESP_LOGI(TAG, "_waitBusy for %s", message);
   }
-  int64_t time_since_boot = esp_timer_get_time();
-
-  while (1){
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 0) break;
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>1000000)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
-    }
+  if (!IO.waitBusy(0, 1000, message) && debug_enabled) {
+    ESP_LOGI(TAG, "Busy Timeout");
   }
 }
 
@@ -421,10 +413,7 @@ void Gdey0213b74::_wakeUpGrayMode(){
 	IO.data(lut_4_grays.data[157]); //VSL
 
   // LUT init table for 4 gray. Check if it's needed!
-  IO.cmd(lut_4_grays.cmd);     // boost
-  for (int i=0; i<lut_4_grays.databytes; ++i) {
-      IO.data(lut_4_grays.data[i]);
-  }
+  IO.cmdData(lut_4_grays);     // boost
 }
 
 void Gdey0213b74::_SetRamArea(uint8_t Xstart, uint8_t Xend, uint8_t Ystart, uint8_t Ystart1, uint8_t Yend, uint8_t Yend1)
@@ -492,4 +481,6 @@ void Gdey0213b74::_setRamDataEntryMode(uint8_t em)
  */
 void Gdey0213b74::setMonoMode(bool mode) {
   _mono_mode = mode;
+  // Span fills only know the 1 bit buffer
+  _span = {mode ? _mono_buffer : nullptr, GDEH0213B73_VISIBLE_WIDTH, GDEH0213B73_HEIGHT, GDEH0213B73_WIDTH / 8, false, false};
 }
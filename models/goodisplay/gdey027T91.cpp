@@ -59,7 +59,7 @@ void Gdey027T91::init(bool debug)
 
     printf("Free heap:%d\n", (int)xPortGetFreeHeapSize());
     fillScreen(EPD_WHITE);
-    _mono_mode = 1;
+    setMonoMode(true);
     fillScreen(EPD_WHITE);
 }
 
@@ -137,8 +137,7 @@ void Gdey027T91::_wakeUp4Gray(){
 	IO.data(lut_4_grays.data[157]); //VSL
 
   // LUT init table for 4 gray. Check if it's needed!
-  IO.cmd(lut_4_grays.cmd);     // boost
-  IO.data(lut_4_grays.data, lut_4_grays.databytes);
+  IO.cmdData(lut_4_grays);
 
   IO.cmd(0x4E);   // set RAM x address count to 0;
 	IO.data(0x00);
@@ -364,20 +363,13 @@ void Gdey027T91::_waitBusy(const char* message, uint16_t busy_time){
   if (debug_enabled) {
     ESP_LOGI(TAG, "_waitBusy for %s", message);
   }
-  int64_t time_since_boot = esp_timer_get_time();
-  // On high is busy
-  if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 1) {
-  while (1){
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 0) break;
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>7000000)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
+  // On high is busy. If it is not busy yet give the controller busy_time
+  if (IO.getBusyLevel() == 1) {
+    if (!IO.waitBusy(0, 7000, message) && debug_enabled) {
+      ESP_LOGI(TAG, "Busy Timeout");
     }
-  }
   } else {
-    vTaskDelay(busy_time/portTICK_PERIOD_MS); 
+    vTaskDelay(busy_time/portTICK_PERIOD_MS);
   }
 }
 
@@ -385,17 +377,8 @@ void Gdey027T91::_waitBusy(const char* message){
   if (debug_enabled) {
     ESP_LOGI(TAG, "_waitBusy for %s", message);
   }
-  int64_t time_since_boot = esp_timer_get_time();
-
-  while (1){
-    // On low is not busy anymore
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 0) break;
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>7000000)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
-    }
+  if (!IO.waitBusy(0, 7000, message) && debug_enabled) {
+    ESP_LOGI(TAG, "Busy Timeout");
   }
 }
 
@@ -490,4 +473,6 @@ void Gdey027T91::drawPixel(int16_t x, int16_t y, uint16_t color) {
 
 void Gdey027T91::setMonoMode(bool mode) {
   _mono_mode = mode;
+  // Span fills only know the 1 bit buffer (a bit set to 1 is black)
+  _span = {mode ? _mono_buffer : nullptr, GDEY027T91_WIDTH, GDEY027T91_HEIGHT, GDEY027T91_WIDTH / 8, true, false};
 }
@@ -55,7 +55,7 @@ void Gdey029T94::init(bool debug)
     //Reset the display
     IO.reset(20);
     fillScreen(EPD_WHITE);
-    _mono_mode = 1;
+    setMonoMode(true);
     fillScreen(EPD_WHITE);
 }
 
@@ -233,16 +233,8 @@ void Gdey029T94::_waitBusy(const char* message){
   if (debug_enabled) {
     ESP_LOGI(TAG, "_waitBusy for %s", message);
   }
-  int64_t time_since_boot = esp_timer_get_time();
-
-  while (1){
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 0) break;
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>1000000)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
-    }
+  if (!IO.waitBusy(0, 1000, message) && debug_enabled) {
+    ESP_LOGI(TAG, "Busy Timeout");
   }
 }
 
@@ -272,62 +264,31 @@ void Gdey029T94::_rotate(uint16_t& x, uint16_t& y, uint16_t& w, uint16_t& h)
   }
 }
 
-void Gdey029T94::drawPixel(int16_t x, int16_t y, uint16_t color) {
-    if ((x < 0) || (x >= width()) || (y < 0) || (y >= height())) return;
+void Gdey029T94::setRotation(uint8_t r)
+{
+  Adafruit_GFX::setRotation(r);
+  static const decltype(_drawPixelRotated) writers[] = {
+    &Gdey029T94::_drawPixel<0>, &Gdey029T94::_drawPixel<1>, &Gdey029T94::_drawPixel<2>, &Gdey029T94::_drawPixel<3>};
+  _drawPixelRotated = writers[getRotation()];
+}
 
-  // check rotation, move pixel around if necessary
-  switch (getRotation())
-  {
-    case 1:
-      swap(x, y);
-      x = GDEY029T94_VISIBLE_WIDTH - x -1;
-      break;
-    case 2:
-      x = GDEY029T94_VISIBLE_WIDTH - x -1;
-      y = GDEY029T94_HEIGHT - y - 1;
-      break;
-    case 3:
-      swap(x, y);
-      y = GDEY029T94_HEIGHT - y - 1;
-      break;
-  }
-  uint16_t i = x / 8 + y * GDEY029T94_WIDTH / 8;
-  uint8_t mask = 1 << (7 - x % 8);
+void Gdey029T94::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  (this->*_drawPixelRotated)(x, y, color);
+}
 
+template <uint8_t R> void Gdey029T94::_drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+  typedef EpdRotation<R, GDEY029T94_WIDTH, GDEY029T94_HEIGHT> rotation;
+  if (!rotation::contains(x, y)) return;
+  rotation::map(x, y);
   if (_mono_mode) {
-    if (color) {
-        _mono_buffer[i] = _mono_buffer[i] | mask;
-      } else {
-        _mono_buffer[i] = _mono_buffer[i] & (0xFF ^ mask);
-      }
+    _mono.set(x, y, color ? 1 : 0);
   } else {
-    // 4 gray mode
-    mask = 0x80 >> (x & 7);
-    color >>= 6; // Color is from 0 (black) to 255 (white)
-    
-    switch (color)
-    {
-      case 1:
-        // Dark gray
-        _buffer1[i] = _buffer1[i] & (0xFF ^ mask);
-        _buffer2[i] = _buffer2[i] | mask;
-        break;
-      case 2:
-        // Light gray
-        _buffer1[i] = _buffer1[i] | mask;
-        _buffer2[i] = _buffer2[i] & (0xFF ^ mask);
-        break;
-      case 3:
-        // White
-        _buffer1[i] = _buffer1[i] & (0xFF ^ mask);
-        _buffer2[i] = _buffer2[i] & (0xFF ^ mask);
-        break;
-      default:
-        // Black
-        _buffer1[i] = _buffer1[i] | mask;
-        _buffer2[i] = _buffer2[i] | mask;
-        break;
-      }
+    // 4 gray mode. Color is from 0 (black) to 255 (white)
+    // Plane bits per gray: black, dark gray, light gray and white
+    static const uint8_t grays[] = {3, 2, 1, 0};
+    color >>= 6;
+    _grays.set(x, y, (color < 4) ? grays[color] : 3);
   }
 }
 
@@ -402,10 +363,7 @@ void Gdey029T94::_wakeUpGrayMode(){
 	IO.data(lut_4_grays.data[157]); //VSL
 
   // LUT init table for 4 gray. Check if it's needed!
-  IO.cmd(lut_4_grays.cmd);     // boost
-  for (int i=0; i<lut_4_grays.databytes; ++i) {
-      IO.data(lut_4_grays.data[i]);
-  }
+  IO.cmdData(lut_4_grays);     // boost
 }
 
 void Gdey029T94::_SetRamArea(uint8_t Xstart, uint8_t Xend, uint8_t Ystart, uint8_t Ystart1, uint8_t Yend, uint8_t Yend1)
@@ -473,4 +431,6 @@ void Gdey029T94::_setRamDataEntryMode(uint8_t em)
  */
 void Gdey029T94::setMonoMode(bool mode) {
   _mono_mode = mode;
+  // Span fills only know the 1 bit buffer
+  _span = {mode ? _mono_buffer : nullptr, GDEY029T94_VISIBLE_WIDTH, GDEY029T94_HEIGHT, GDEY029T94_WIDTH / 8, false, false};
 }
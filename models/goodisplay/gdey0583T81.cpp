@@ -59,6 +59,7 @@ Gdey0583T81::Gdey0583T81(EpdSpi &dio) : Adafruit_GFX(GDEY0583T81_WIDTH, GDEY0583
   printf("Gdey0583T81() constructor injects IO and extends Adafruit_GFX(%d,%d) Pix Buffer[%d]\n",
          GDEY0583T81_WIDTH, GDEY0583T81_HEIGHT, (int)GDEY0583T81_BUFFER_SIZE);
   printf("\nAvailable heap after Epd bootstrap:%d\n", (int) xPortGetFreeHeapSize());
+  _span = {_buffer, GDEY0583T81_WIDTH, GDEY0583T81_HEIGHT, GDEY0583T81_WIDTH / 8, false, false};
 }
 
 void Gdey0583T81::initPartialUpdate()
@@ -75,23 +76,17 @@ void Gdey0583T81::initPartialUpdate()
   IO.data(0x07);
 
   // LUT Tables for partial update. Send them directly in 42 bytes chunks. In total 210 bytes
-  IO.cmd(lut_20_LUTC_partial.cmd);
-  IO.data(lut_20_LUTC_partial.data, lut_20_LUTC_partial.databytes);
+  IO.cmdData(lut_20_LUTC_partial);
 
-  IO.cmd(lut_21_LUTWW_partial.cmd);
-  IO.data(lut_21_LUTWW_partial.data, lut_21_LUTWW_partial.databytes);
+  IO.cmdData(lut_21_LUTWW_partial);
 
-  IO.cmd(lut_22_LUTKW_partial.cmd);
-  IO.data(lut_22_LUTKW_partial.data, lut_22_LUTKW_partial.databytes);
+  IO.cmdData(lut_22_LUTKW_partial);
 
-  IO.cmd(lut_23_LUTWK_partial.cmd);
-  IO.data(lut_23_LUTWK_partial.data, lut_23_LUTWK_partial.databytes);
+  IO.cmdData(lut_23_LUTWK_partial);
 
-  IO.cmd(lut_24_LUTKK_partial.cmd);
-  IO.data(lut_24_LUTKK_partial.data, lut_24_LUTKK_partial.databytes);
+  IO.cmdData(lut_24_LUTKK_partial);
 
-  IO.cmd(lut_25_LUTBD_partial.cmd);
-  IO.data(lut_25_LUTBD_partial.data, lut_25_LUTBD_partial.databytes);
+  IO.cmdData(lut_25_LUTBD_partial);
 }
 
 //Initialize the display
@@ -248,23 +243,11 @@ void Gdey0583T81::updateWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h, b
 
 void Gdey0583T81::_waitBusy(const char *message)
 {
-  if (debug_enabled)
-  {
+  if (debug_enabled) {
     ESP_LOGI(TAG, "_waitBusy for %s", message);
   }
-  int64_t time_since_boot = esp_timer_get_time();
-
-  while (1)
-  {
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 1)
-      break;
-    vTaskDelay(1);
-    if (esp_timer_get_time() - time_since_boot > 2000000)
-    {
-      if (debug_enabled)
-        ESP_LOGI(TAG, "Busy Timeout");
-      break;
-    }
+  if (!IO.waitBusy(1, 2000, message) && debug_enabled) {
+    ESP_LOGI(TAG, "Busy Timeout");
   }
 }
 
@@ -17,6 +17,8 @@
 
 // Partial Update Delay, may have an influence on degradation
 #define GDEY075T7_PU_DELAY 100
+// In low temperatures a full update takes longer than the default busy timeout
+#define GDEY075T7_FULL_UPDATE_TIMEOUT 10000
 
 // Partial display Waveform
 DRAM_ATTR const epd_init_42 Gdey075T7::lut_20_LUTC_partial = {
@@ -75,6 +77,15 @@ Gdey075T7::Gdey075T7(EpdSpi &dio) : Adafruit_GFX(GDEY075T7_WIDTH, GDEY075T7_HEIG
   printf("Gdey075T7() constructor injects IO and extends Adafruit_GFX(%d,%d) Pix Buffer[%d]\n",
          GDEY075T7_WIDTH, GDEY075T7_HEIGHT, (int)GDEY075T7_BUFFER_SIZE);
   printf("\nAvailable heap after Epd bootstrap:%d\n", (int) xPortGetFreeHeapSize());
+  _dirty.begin(GDEY075T7_WIDTH, GDEY075T7_HEIGHT);
+  _span = {_buffer, GDEY075T7_WIDTH, GDEY075T7_HEIGHT, GDEY075T7_WIDTH / 8, false, false};
+}
+
+Gdey075T7::~Gdey075T7()
+{
+  // _updateFinish() of an update in flight needs this object
+  _asyncStop();
+  free(_buffer_alloc);
 }
 
 void Gdey075T7::initPartialUpdate()
@@ -91,23 +102,17 @@ void Gdey075T7::initPartialUpdate()
   IO.data(0x07);
 
   // LUT Tables for partial update. Send them directly in 42 bytes chunks. In total 210 bytes
-  IO.cmd(lut_20_LUTC_partial.cmd);
-  IO.data(lut_20_LUTC_partial.data, lut_20_LUTC_partial.databytes);
+  IO.cmdData(lut_20_LUTC_partial);
 
-  IO.cmd(lut_21_LUTWW_partial.cmd);
-  IO.data(lut_21_LUTWW_partial.data, lut_21_LUTWW_partial.databytes);
+  IO.cmdData(lut_21_LUTWW_partial);
 
-  IO.cmd(lut_22_LUTKW_partial.cmd);
-  IO.data(lut_22_LUTKW_partial.data, lut_22_LUTKW_partial.databytes);
+  IO.cmdData(lut_22_LUTKW_partial);
 
-  IO.cmd(lut_23_LUTWK_partial.cmd);
-  IO.data(lut_23_LUTWK_partial.data, lut_23_LUTWK_partial.databytes);
+  IO.cmdData(lut_23_LUTWK_partial);
 
-  IO.cmd(lut_24_LUTKK_partial.cmd);
-  IO.data(lut_24_LUTKK_partial.data, lut_24_LUTKK_partial.databytes);
+  IO.cmdData(lut_24_LUTKK_partial);
 
-  IO.cmd(lut_25_LUTBD_partial.cmd);
-  IO.data(lut_25_LUTBD_partial.data, lut_25_LUTBD_partial.databytes);
+  IO.cmdData(lut_25_LUTBD_partial);
 }
 
 //Initialize the display
@@ -124,91 +129,142 @@ void Gdey075T7::init(bool debug)
 
 void Gdey075T7::fillScreen(uint16_t color)
 {
-  uint8_t data = (color == EPD_BLACK) ? GDEY075T7_8PIX_BLACK : GDEY075T7_8PIX_WHITE;
-  for (uint16_t x = 0; x < sizeof(_buffer); x++)
-  {
-    _buffer[x] = data;
-  }
+  _dirty.markAll();
+  _fb.clear((color == EPD_BLACK) ? 0 : 1);
 }
 
+DRAM_ATTR static constexpr uint8_t gdey075T7_wakeup[] = {
+  EPD_RESET(10),
+  // IMPORTANT: Some EPD controllers like to receive data byte per byte
+  EPD_CMD_BYTES(0x01, 4), 0x07, 0x07, 0x3f, 0x3f, // POWER SETTING VGH=20V,VGL=-20V VDH=15V VDL=-15V
+  // Enhanced display drive(Add 0x06 command)
+  EPD_CMD(0x06, 4), 0x17, 0x17, 0x28, 0x17,       // Booster Soft Start
+  EPD_CMD(0x04, 0),                                // POWER ON
+  // waiting for the electronic paper IC to release the idle signal
+  EPD_BUSY(1, 2000),
+  EPD_CMD(0x00, 1), 0x1F,                          // PANNEL SETTING KW-3f KWR-2F BWROTP 0f BWOTP 1f
+  EPD_CMD(0x61, 4), 0x03, 0x20, 0x01, 0xE0,        // tres source 800 gate 480
+  EPD_CMD(0x15, 1), 0x00,
+  EPD_CMD(0x50, 2), 0x10, 0x07,                    // VCOM AND DATA INTERVAL SETTING
+  EPD_CMD(0x60, 1), 0x22,                          // TCON SETTING
+  EPD_END
+};
+static_assert(epd_sequence_valid(gdey075T7_wakeup, sizeof(gdey075T7_wakeup)), "gdey075T7_wakeup is malformed");
+
 void Gdey075T7::_wakeUp()
 {
-  IO.reset(10);
-  //IMPORTANT: Some EPD controllers like to receive data byte per byte
-  //So this won't work:
-  //IO.data(epd_wakeup_power.data,epd_wakeup_power.databytes);
-  IO.cmd(0x01);     //POWER SETTING
-  IO.data(0x07);
-  IO.data(0x07);   //VGH=20V,VGL=-20V
-  IO.data(0x3f);   //VDH=15V
-  IO.data(0x3f);   //VDL=-15V
-  //Enhanced display drive(Add 0x06 command)
-  IO.cmd(0x06);     //Booster Soft Start 
-  IO.data(0x17);
-  IO.data(0x17);   
-  IO.data(0x28);   
-  IO.data(0x17); 
-
-  IO.cmd(0x04); //POWER ON
-  //waiting for the electronic paper IC to release the idle signal
-  _waitBusy("power_on");  
-
-  IO.cmd(0X00);     //PANNEL SETTING
-  IO.data(0x1F);   //KW-3f   KWR-2F BWROTP 0f BWOTP 1f
-
-  IO.cmd(0x61);         //tres      
-  IO.data(0x03);   //source 800
-  IO.data(0x20);
-  IO.data(0x01);   //gate 480
-  IO.data(0xE0);
-
-  IO.cmd(0X15);   
-  IO.data(0x00);    
-
-  IO.cmd(0X50);     //VCOM AND DATA INTERVAL SETTING
-  IO.data(0x10);
-  IO.data(0x07);
+  IO.sequence(gdey075T7_wakeup);
+}
 
-  IO.cmd(0X60);     //TCON SETTING
-  IO.data(0x22);
+bool Gdey075T7::setDoubleBuffer(bool enabled)
+{
+  waitForUpdate();
+  if (enabled) {
+    if (_buffer_alloc != nullptr) return true;
+    _buffer_alloc = (uint8_t*)heap_caps_malloc(GDEY075T7_BUFFER_SIZE, MALLOC_CAP_SPIRAM);
+    if (_buffer_alloc == nullptr) {
+      _buffer_alloc = (uint8_t*)heap_caps_malloc(GDEY075T7_BUFFER_SIZE, MALLOC_CAP_8BIT);
+    }
+    if (_buffer_alloc == nullptr) {
+      ESP_LOGE(TAG, "Not enough memory for a second buffer of %d bytes", (int)GDEY075T7_BUFFER_SIZE);
+      return false;
+    }
+    memcpy(_buffer_alloc, _buffer, GDEY075T7_BUFFER_SIZE);
+    _front_buffer = _buffer_alloc;
+    return true;
+  }
+
+  if (_buffer_alloc == nullptr) return true;
+  // Keep what the application was drawing
+  if (_buffer != _buffer_mem) {
+    memcpy(_buffer_mem, _buffer, GDEY075T7_BUFFER_SIZE);
+    _buffer = _buffer_mem;
+    _span.buffer = _buffer;
+    _fb.setData(_buffer);
+  }
+  free(_buffer_alloc);
+  _buffer_alloc = nullptr;
+  _front_buffer = nullptr;
+  return true;
+}
+
+bool Gdey075T7::_updateSwap()
+{
+  // Every update path starts here: what was drawn until now is being sent
+  _dirty.clear();
+  if (_front_buffer == nullptr) return false;
+  uint8_t* drawn = _buffer;
+  _buffer = _front_buffer;
+  _front_buffer = drawn;
+  // The back buffer continues from the frame being sent: updateWindow() and updateDirty() send parts of it
+  memcpy(_buffer, _front_buffer, GDEY075T7_BUFFER_SIZE);
+  _span.buffer = _buffer;
+  _fb.setData(_buffer);
+  return true;
+}
+
+bool Gdey075T7::setFrameDiff(bool enabled, epd_diff_mode_t mode)
+{
+  waitForUpdate();
+  if (!enabled) {
+    _diff.end();
+    return true;
+  }
+  return _diff.begin(GDEY075T7_WIDTH / 8, GDEY075T7_HEIGHT, mode);
 }
 
 void Gdey075T7::update()
 {
-  uint64_t startTime = esp_timer_get_time();
+  waitForUpdate();
+  _updateSwap();
+  _updateBegin();
+  _updateFinish();
+}
+
+void Gdey075T7::_updateBegin()
+{
+  const uint8_t* tx_buffer = (_front_buffer != nullptr) ? _front_buffer : _buffer;
+  _update_skipped = _diff.enabled() && _diff.compare(tx_buffer) == 0;
+  if (_update_skipped) {
+    if (debug_enabled) printf("update: Frame did not change, skipping refresh\n");
+    return;
+  }
+  _update_start_time = esp_timer_get_time();
   _using_partial_mode = false;
   _wakeUp();
 
   IO.cmd(0x13);
-  printf("Sending a %d bytes buffer via SPI\n", sizeof(_buffer));
+  printf("Sending a %d bytes buffer via SPI\n", (int)GDEY075T7_BUFFER_SIZE);
 
-  // v2 SPI optimizing. Check: https://github.com/martinberlin/cale-idf/wiki/About-SPI-optimization
-  uint16_t i = 0;
+  // v3 SPI optimizing: rows are queued using DMA so the next X line is prepared while the previous one is sent
+  // Check: https://github.com/martinberlin/cale-idf/wiki/About-SPI-optimization
+  uint32_t i = 0;
   uint8_t xLineBytes = GDEY075T7_WIDTH / 8;
-  uint8_t x1buf[xLineBytes];
-  for (uint16_t y = 1; y <= GDEY075T7_HEIGHT; y++)
+  IO.dataStreamBegin(xLineBytes);
+  for (uint16_t y = 0; y < GDEY075T7_HEIGHT; y++)
   {
-    for (uint16_t x = 1; x <= xLineBytes; x++)
+    uint8_t* x1buf = IO.dataStreamBuffer();
+    for (uint16_t x = 0; x < xLineBytes; x++)
     {
-      uint8_t data = i < sizeof(_buffer) ? ~_buffer[i] : 0x00;
-      x1buf[x - 1] = data;
-      if (x == xLineBytes)
-      { // Flush the X line buffer to SPI
-        IO.data(x1buf, sizeof(x1buf));
-      }
+      x1buf[x] = ~tx_buffer[i];
       ++i;
     }
+    IO.dataStreamQueue(xLineBytes);
   }
+  IO.dataStreamEnd();
+  _diff.commit(tx_buffer);
 
-  uint64_t endTime = esp_timer_get_time();
+  _update_sent_time = esp_timer_get_time();
   IO.cmd(0x12);
-  _waitBusy("update");
+}
+
+void Gdey075T7::_updateFinish()
+{
+  if (_update_skipped) return;
+  _waitBusy("update", GDEY075T7_FULL_UPDATE_TIMEOUT);
   uint64_t updateTime = esp_timer_get_time();
   printf("\n\nSTATS (ms)\n%llu _wakeUp settings+send Buffer\n%llu update \n%llu total time in millis\n",
-         (endTime - startTime) / 1000, (updateTime - endTime) / 1000, (updateTime - startTime) / 1000);
-  
-  // Additional 2 seconds wait before sleeping since in low temperatures full update takes longer
-  vTaskDelay(2000 / portTICK_PERIOD_MS);
+         (_update_sent_time - _update_start_time) / 1000, (updateTime - _update_sent_time) / 1000, (updateTime - _update_start_time) / 1000);
 
   _sleep();
 }
@@ -233,12 +289,25 @@ uint16_t Gdey075T7::_setPartialRamArea(uint16_t x, uint16_t y, uint16_t xe, uint
 void Gdey075T7::updateWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h, bool using_rotation)
 {
   printf("updateWindow: Still in test mode\n");
+  waitForUpdate();
   if (using_rotation)
     _rotate(x, y, w, h);
   if (x >= GDEY075T7_WIDTH)
     return;
   if (y >= GDEY075T7_HEIGHT)
     return;
+  if (_diff.enabled()) {
+    // Clip the window to the bytes that changed since they were last sent
+    uint16_t xb = x / 8;
+    uint16_t wb = (gx_uint16_min(GDEY075T7_WIDTH, x + w) + 7) / 8 - xb;
+    _diff.compare(_buffer);
+    if (!_diff.changedArea(xb, y, wb, h)) {
+      if (debug_enabled) printf("updateWindow: Area did not change, skipping refresh\n");
+      return;
+    }
+    x = xb * 8;
+    w = wb * 8;
+  }
   uint16_t xe = gx_uint16_min(GDEY075T7_WIDTH, x + w) - 1;
   uint16_t ye = gx_uint16_min(GDEY075T7_HEIGHT, y + h) - 1;
 
@@ -263,7 +332,7 @@ void Gdey075T7::updateWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h, boo
       {
         uint16_t idx = y1 * (GDEY075T7_WIDTH / 8) + x1;
         // white is 0x00 in buffer
-        uint8_t data = (idx < sizeof(_buffer)) ? _buffer[idx] : 0x00;
+        uint8_t data = (idx < GDEY075T7_BUFFER_SIZE) ? _buffer[idx] : 0x00;
         // white is 0xFF on device
         IO.data(data);
 
@@ -279,30 +348,29 @@ void Gdey075T7::updateWindow(uint16_t x, uint16_t y, uint16_t w, uint16_t h, boo
     IO.cmd(0x12); // display refresh
     _waitBusy("updateWindow");
     IO.cmd(0x92); // partial out
+    _diff.commitArea(_buffer, xs_bx, y, xe_bx - xs_bx, ye - y + 1);
   }
 
   vTaskDelay(GDEY075T7_PU_DELAY / portTICK_PERIOD_MS);
 }
 
+void Gdey075T7::_updateDirtyRect(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+  updateWindow(x, y, w, h, false);
+}
+
 void Gdey075T7::_waitBusy(const char *message)
 {
-  if (debug_enabled)
-  {
+  _waitBusy(message, 2000);
+}
+
+void Gdey075T7::_waitBusy(const char *message, uint32_t timeout_ms)
+{
+  if (debug_enabled) {
     ESP_LOGI(TAG, "_waitBusy for %s", message);
   }
-  int64_t time_since_boot = esp_timer_get_time();
-
-  while (1)
-  {
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 1)
-      break;
-    vTaskDelay(1);
-    if (esp_timer_get_time() - time_since_boot > 2000000)
-    {
-      if (debug_enabled)
-        ESP_LOGI(TAG, "Busy Timeout");
-      break;
-    }
+  if (!IO.waitBusy(1, timeout_ms, message) && debug_enabled) {
+    ESP_LOGI(TAG, "Busy Timeout");
   }
 }
 
@@ -335,35 +403,26 @@ void Gdey075T7::_rotate(uint16_t &x, uint16_t &y, uint16_t &w, uint16_t &h)
   }
 }
 
+void Gdey075T7::setRotation(uint8_t r)
+{
+  Adafruit_GFX::setRotation(r);
+  static const decltype(_drawPixelRotated) writers[] = {
+    &Gdey075T7::_drawPixel<0>, &Gdey075T7::_drawPixel<1>, &Gdey075T7::_drawPixel<2>, &Gdey075T7::_drawPixel<3>};
+  _drawPixelRotated = writers[getRotation()];
+}
+
 void Gdey075T7::drawPixel(int16_t x, int16_t y, uint16_t color)
 {
-  if ((x < 0) || (x >= width()) || (y < 0) || (y >= height()))
-    return;
-  switch (getRotation())
-  {
-  case 1:
-    swap(x, y);
-    x = GDEY075T7_WIDTH - x - 1;
-    break;
-  case 2:
-    x = GDEY075T7_WIDTH - x - 1;
-    y = GDEY075T7_HEIGHT - y - 1;
-    break;
-  case 3:
-    swap(x, y);
-    y = GDEY075T7_HEIGHT - y - 1;
-    break;
-  }
-  uint16_t i = x / 8 + y * GDEY075T7_WIDTH / 8;
+  (this->*_drawPixelRotated)(x, y, color);
+}
 
-  if (color)
-  {
-    _buffer[i] = (_buffer[i] | (1 << (7 - x % 8)));
-  }
-  else
-  {
-    _buffer[i] = (_buffer[i] & (0xFF ^ (1 << (7 - x % 8))));
-  }
+template <uint8_t R> void Gdey075T7::_drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+  typedef EpdRotation<R, GDEY075T7_WIDTH, GDEY075T7_HEIGHT> rotation;
+  if (!rotation::contains(x, y)) return;
+  rotation::map(x, y);
+  _dirty.mark(x, y);
+  _fb.set(x, y, color ? 1 : 0);
 }
 
 void Gdey075T7::setRawBuf(uint32_t position, uint8_t value) {
@@ -145,10 +145,7 @@ void Gdey027T91T::_wakeUp(){
 	IO.data(lut_4_grays.data[157]); //VSL
 
   // LUT init table for 4 gray. Check if it's needed!
-  IO.cmd(lut_4_grays.cmd);     // boost
-  for (int i=0; i<lut_4_grays.databytes; ++i) {
-      IO.data(lut_4_grays.data[i]);
-  }
+  IO.cmdData(lut_4_grays);     // boost
 }
 
 void Gdey027T91T::_wakeUp(uint8_t em) {
@@ -362,20 +359,13 @@ void Gdey027T91T::_waitBusy(const char* message, uint16_t busy_time){
   if (debug_enabled) {
     ESP_LOGI(TAG, "_waitBusy for %s", message);
   }
-  int64_t time_since_boot = esp_timer_get_time();
-  // On high is busy
-  if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 1) {
-  while (1){
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 0) break;
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>7000000)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
+  // On high is busy. If it is not busy yet give the controller busy_time
+  if (IO.getBusyLevel() == 1) {
+    if (!IO.waitBusy(0, 7000, message) && debug_enabled) {
+      ESP_LOGI(TAG, "Busy Timeout");
     }
-  }
   } else {
-    vTaskDelay(busy_time/portTICK_PERIOD_MS); 
+    vTaskDelay(busy_time/portTICK_PERIOD_MS);
   }
 }
 
@@ -383,17 +373,8 @@ void Gdey027T91T::_waitBusy(const char* message){
   if (debug_enabled) {
     ESP_LOGI(TAG, "_waitBusy for %s", message);
   }
-  int64_t time_since_boot = esp_timer_get_time();
-
-  while (1){
-    // On low is not busy anymore
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 0) break;
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>7000000)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
-    }
+  if (!IO.waitBusy(0, 7000, message) && debug_enabled) {
+    ESP_LOGI(TAG, "Busy Timeout");
   }
 }
 
@@ -426,64 +407,31 @@ void Gdey027T91T::_rotate(uint16_t& x, uint16_t& y, uint16_t& w, uint16_t& h)
 }
 
 
-void Gdey027T91T::drawPixel(int16_t x, int16_t y, uint16_t color) {
-  if ((x < 0) || (x >= width()) || (y < 0) || (y >= height())) return;
+void Gdey027T91T::setRotation(uint8_t r)
+{
+  Adafruit_GFX::setRotation(r);
+  static const decltype(_drawPixelRotated) writers[] = {
+    &Gdey027T91T::_drawPixel<0>, &Gdey027T91T::_drawPixel<1>, &Gdey027T91T::_drawPixel<2>, &Gdey027T91T::_drawPixel<3>};
+  _drawPixelRotated = writers[getRotation()];
+}
 
-  // check rotation, move pixel around if necessary
-  switch (getRotation())
-  {
-    case 1:
-      swap(x, y);
-      x = GDEY027T91T_WIDTH - x - 1;
-      break;
-    case 2:
-      x = GDEY027T91T_WIDTH - x - 1;
-      y = GDEY027T91T_HEIGHT - y - 1;
-      break;
-    case 3:
-      swap(x, y);
-      y = GDEY027T91T_HEIGHT - y - 1;
-      break;
-  }
-  uint16_t i = x / 8 + y * GDEY027T91T_WIDTH / 8;
+void Gdey027T91T::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  (this->*_drawPixelRotated)(x, y, color);
+}
 
- if (_mono_mode) {
+template <uint8_t R> void Gdey027T91T::_drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+  typedef EpdRotation<R, GDEY027T91T_WIDTH, GDEY027T91T_HEIGHT> rotation;
+  if (!rotation::contains(x, y)) return;
+  rotation::map(x, y);
+  if (_mono_mode) {
     // This is the trick to draw colors right. Genious Jean-Marc
-    if (color) {
-      _mono_buffer[i] = (_mono_buffer[i] & (0xFF ^ (1 << (7 - x % 8))));
-      } else {
-      _mono_buffer[i] = (_mono_buffer[i] | (1 << (7 - x % 8)));
-      }
- } else {
-  // 4 gray mode
-  uint8_t mask = 0x80 >> (x & 7);
-
-  color >>= 6; // Color is from 0 (black) to 255 (white)
-      
-      switch (color)
-      {
-      case 1:
-        // Dark gray: Correct
-        _buffer1[i] = _buffer1[i] | mask;
-        _buffer2[i] = _buffer2[i] & (0xFF ^ mask);
-        break;
-      case 2:
-        // Light gray: Correct
-        _buffer1[i] = _buffer1[i] & (0xFF ^ mask);
-        _buffer2[i] = _buffer2[i] | mask;
-        break;
-      case 3:
-        // WHITE
-        _buffer1[i] = _buffer1[i] | mask;
-        _buffer2[i] = _buffer2[i] | mask;
-        break;
-      default:
-        // Black
-        _buffer1[i] = _buffer1[i] & (0xFF ^ mask);
-        _buffer2[i] = _buffer2[i] & (0xFF ^ mask);
-        break;
-      }
- }
+    _mono.set(x, y, color ? 1 : 0);
+  } else {
+    // 4 gray mode. Color is from 0 (black) to 255 (white)
+    color >>= 6;
+    _grays.set(x, y, (color <= 3) ? color : 0);
+  }
 }
 
 void Gdey027T91T::setMonoMode(bool mode) {
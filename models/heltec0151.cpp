@@ -8,21 +8,39 @@
 #include <inttypes.h>
 //Place data into DRAM. Constant data gets placed into DROM by default, which is not accessible by DMA.
 //full screen update LUT
-const epd_init_30 Hel0151::LUTDefault_full={
-0x32, {
-  0x50, 0xAA, 0x55, 0xAA, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-},30};
-
-const epd_init_30 Hel0151::LUTDefault_part={
-0x32, {
-  0x10, 0x18, 0x18, 0x08, 0x18, 0x18, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-  0x00, 0x00, 0x00, 0x00, 0x00, 0x13, 0x14, 0x44, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-},30};
-
-DRAM_ATTR const epd_init_3 Hel0151::GDOControl={
-0x01,{(HEL0151_HEIGHT - 1) % 256, (HEL0151_HEIGHT - 1) / 256, 0x00},3
+DRAM_ATTR static constexpr uint8_t hel0151_lut_full[] = {
+  EPD_CMD(0x32, 30),
+    0x50, 0xAA, 0x55, 0xAA, 0x11, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF, 0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  EPD_END
 };
+static_assert(epd_sequence_valid(hel0151_lut_full, sizeof(hel0151_lut_full)), "hel0151_lut_full is malformed");
+
+DRAM_ATTR static constexpr uint8_t hel0151_lut_part[] = {
+  EPD_CMD(0x32, 30),
+    0x10, 0x18, 0x18, 0x08, 0x18, 0x18, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x13, 0x14, 0x44, 0x12, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  EPD_END
+};
+static_assert(epd_sequence_valid(hel0151_lut_part, sizeof(hel0151_lut_part)), "hel0151_lut_part is malformed");
+
+DRAM_ATTR static constexpr uint8_t hel0151_wakeup[] = {
+  // Byte per byte, as the controller always got them
+  EPD_CMD_BYTES(0x01, 3), (HEL0151_HEIGHT - 1) % 256, (HEL0151_HEIGHT - 1) / 256, 0x00, // Driver output control
+  // data entry mode - Used according to Heltec
+  // _setRamDataEntryMode(em); - Interesting effect: Mirrored!
+  EPD_CMD(0x11, 1), 0x01,                          // data entry mode
+  EPD_CMD_BYTES(0x44, 2), 0x00, 0x18,              // set Ram-X address start/end position 0x0C-->(18+1)*8=200
+  EPD_CMD_BYTES(0x45, 4), 0xC7, 0x00, 0x00, 0x00,  // set Ram-Y address start/end position 0xC7-->(199+1)=200
+  EPD_CMD(0x3c, 1), 0x01,                          // BorderWavefrom
+  EPD_CMD(0x18, 1), 0x80,
+  EPD_CMD(0x22, 1), 0xB1,                          // Load Temperature and waveform setting.
+  EPD_CMD(0x20, 0),
+  EPD_CMD(0x4e, 1), 0x00,                          // set RAM x address count to 0;
+  EPD_CMD_BYTES(0x4f, 2), 0xC7, 0x00,              // set RAM y address count to 0X199;
+  EPD_END
+};
+static_assert(epd_sequence_valid(hel0151_wakeup, sizeof(hel0151_wakeup)), "hel0151_wakeup is malformed");
 
 // Partial Update Delay
 #define HEL0151_PU_DELAY 100
@@ -40,10 +58,7 @@ Hel0151::Hel0151(EpdSpi& dio):
 void Hel0151::initFullUpdate(){
     _wakeUp(0x01);
     
-    IO.cmd(LUTDefault_full.cmd);     // boost
-    for (int i=0;i<LUTDefault_full.databytes;++i) {
-        IO.data(LUTDefault_full.data[i]);
-    } 
+    IO.sequence(hel0151_lut_full);
     _PowerOn();
     if (debug_enabled) printf("initFullUpdate() LUT\n");
 }
@@ -51,10 +66,7 @@ void Hel0151::initFullUpdate(){
 void Hel0151::initPartialUpdate(){
     _wakeUp(0x03);
 
-    IO.cmd(LUTDefault_part.cmd);     // boost
-    for (int i=0;i<LUTDefault_part.databytes;++i) {
-        IO.data(LUTDefault_part.data[i]);
-    }
+    IO.sequence(hel0151_lut_part);
     _PowerOn();
 
     if (debug_enabled) printf("initPartialUpdate() LUT\n");
@@ -95,7 +107,7 @@ void Hel0151::_wakeUp(){
  * @deprecated It seems there is no need to do this for now
  */
 void Hel0151::_writeCommandData(const uint8_t cmd, const uint8_t* pCommandData, uint8_t datalen) {
-  if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY)){
+  if (IO.getBusyLevel()){
     _waitBusy("_waitBusy",100);
   }
   IO.cmd(cmd);
@@ -107,35 +119,7 @@ void Hel0151::_writeCommandData(const uint8_t cmd, const uint8_t* pCommandData,
 void Hel0151::_wakeUp(uint8_t em){
   printf("wakeup() start commands\n");
 
-  IO.cmd(GDOControl.cmd);
-  for (int i=0;i<GDOControl.databytes;++i) {
-      IO.data(GDOControl.data[i]);
-  }
-  //data entry mode - Used according to Heltec
-  //_setRamDataEntryMode(em); - Interesting effect: Mirrored!
-
-  IO.cmd(0x11); //data entry mode       
-  IO.data(0x01);
-  IO.cmd(0x44); //set Ram-X address start/end position   
-  IO.data(0x00);
-  IO.data(0x18);    //0x0C-->(18+1)*8=200
-  IO.cmd(0x45); //set Ram-Y address start/end position          
-  IO.data(0xC7);   //0xC7-->(199+1)=200
-  IO.data(0x00);
-  IO.data(0x00);
-  IO.data(0x00); 
-  IO.cmd(0x3c); //BorderWavefrom
-  IO.data(0x01);	  
-  IO.cmd(0x18); 
-  IO.data(0x80);	
-  IO.cmd(0x22); // //Load Temperature and waveform setting.
-  IO.data(0XB1);	
-  IO.cmd(0x20); 
-  IO.cmd(0x4e);   // set RAM x address count to 0;
-  IO.data(0x00);
-  IO.cmd(0x4f);   // set RAM y address count to 0X199;    
-  IO.data(0xC7);
-  IO.data(0x00);
+  IO.sequence(hel0151_wakeup);
 }
 
 void Hel0151::update()
@@ -273,20 +257,13 @@ void Hel0151::_waitBusy(const char* message, uint16_t busy_time){
   if (debug_enabled) {
     ESP_LOGI(TAG, "_waitBusy for %s", message);
   }
-  int64_t time_since_boot = esp_timer_get_time();
-  // On high is busy
-  if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 1) {
-  while (1){
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 0) break;
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>7000000)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
+  // On high is busy. If it is not busy yet give the controller busy_time
+  if (IO.getBusyLevel() == 1) {
+    if (!IO.waitBusy(0, 7000, message) && debug_enabled) {
+      ESP_LOGI(TAG, "Busy Timeout");
     }
-  }
   } else {
-    vTaskDelay(busy_time/portTICK_PERIOD_MS); 
+    vTaskDelay(busy_time/portTICK_PERIOD_MS);
   }
 }
 
@@ -294,17 +271,8 @@ void Hel0151::_waitBusy(const char* message){
   if (debug_enabled) {
     ESP_LOGI(TAG, "_waitBusy for %s", message);
   }
-  int64_t time_since_boot = esp_timer_get_time();
-
-  while (1){
-    // On low is not busy anymore
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 0) break;
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>7000000)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
-    }
+  if (!IO.waitBusy(0, 7000, message) && debug_enabled) {
+    ESP_LOGI(TAG, "Busy Timeout");
   }
 }
 
@@ -4,76 +4,67 @@
 #include "freertos/task.h"
 #include "esp_log.h"
 
-#ifdef CONFIG_IDF_TARGET_ESP32
-    #define EPD_HOST    HSPI_HOST
-    #define DMA_CHAN    2
-#elif defined CONFIG_IDF_TARGET_ESP32S2
-    #define EPD_HOST    SPI2_HOST
-    #define DMA_CHAN    EPD_HOST
-#elif defined CONFIG_IDF_TARGET_ESP32S3
-    #define EPD_HOST    SPI2_HOST
-    #define DMA_CHAN    SPI_DMA_CH_AUTO
-#elif defined CONFIG_IDF_TARGET_ESP32C3
-    // chip only support spi dma channel auto-alloc
-    #define EPD_HOST    SPI2_HOST
-    #define DMA_CHAN    SPI_DMA_CH_AUTO
-#endif
+EpdSpi2Cs::EpdSpi2Cs(): _config(EPD_SPI_CONFIG_DEFAULT())
+{
+}
+
+EpdSpi2Cs::EpdSpi2Cs(const epd_spi_config_t& config): _config(config)
+{
+}
 
+EpdSpi2Cs::~EpdSpi2Cs()
+{
+    if (_busy_sem != nullptr) {
+        gpio_isr_handler_remove((gpio_num_t)_config.busy);
+        vSemaphoreDelete(_busy_sem);
+    }
+}
 
 void EpdSpi2Cs::init(uint8_t frequency=4,bool debug=false){
     debug_enabled = debug;
+    if (spi != nullptr) release();
         // debug_enabled
         // debug: 50000  0.5 Mhz so we can sniff the SPI commands with a Slave
-    uint16_t multiplier = 1000;
+    uint32_t clock_hz = (_config.clock_hz) ? _config.clock_hz : uint32_t(frequency)*1000000;
     if (true) {
       printf("EpdSpi::init() Debug enabled. SPI master at frequency:%d  MOSI:%d MISO: %d CLK:%d CS:%d RST:%d BUSY:%d\n",
-      frequency*multiplier*1000, CONFIG_EINK_SPI_MOSI, CONFIG_EINK_SPI_MISO, CONFIG_EINK_SPI_CLK, CONFIG_EINK_SPI_CS,
-      CONFIG_EINK_RST,CONFIG_EINK_BUSY);
+      (int)clock_hz, _config.mosi, _config.miso, _config.clk, _config.cs,
+      _config.rst, _config.busy);
         }
     //Initialize GPIOs direction & initial states. MOSI/MISO are setup by SPI interface
-    gpio_set_direction((gpio_num_t)CONFIG_EINK_SPI_CS, GPIO_MODE_OUTPUT);
-    gpio_set_direction((gpio_num_t)CONFIG_EINK_SPI_CS2, GPIO_MODE_OUTPUT);
-    gpio_set_direction((gpio_num_t)CONFIG_EINK_RST, GPIO_MODE_OUTPUT);
-    gpio_set_direction((gpio_num_t)CONFIG_EINK_BUSY, GPIO_MODE_INPUT);
-    gpio_set_pull_mode((gpio_num_t)CONFIG_EINK_BUSY, GPIO_PULLUP_ONLY);
-
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_CS, 1);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_SPI_CS2, 1);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_RST, 1);
+    gpio_set_direction((gpio_num_t)_config.cs, GPIO_MODE_OUTPUT);
+    gpio_set_direction((gpio_num_t)_config.cs2, GPIO_MODE_OUTPUT);
+    gpio_set_direction((gpio_num_t)_config.rst, GPIO_MODE_OUTPUT);
+    gpio_set_direction((gpio_num_t)_config.busy, GPIO_MODE_INPUT);
+    gpio_set_pull_mode((gpio_num_t)_config.busy, GPIO_PULLUP_ONLY);
+
+    gpio_set_level((gpio_num_t)_config.cs, 1);
+    gpio_set_level((gpio_num_t)_config.cs2, 1);
+    gpio_set_level((gpio_num_t)_config.rst, 1);
+    _busyInit();
     
     esp_err_t ret;
-    // Here MISO is used, to receive temp & accelerometer data
-    // BUFFER max transfer is 21" buffer *2
-    spi_bus_config_t buscfg={
-        .mosi_io_num=CONFIG_EINK_SPI_MOSI,
-        .miso_io_num=CONFIG_EINK_SPI_MISO,
-        .sclk_io_num=CONFIG_EINK_SPI_CLK,
-        .quadwp_io_num=-1,
-        .quadhd_io_num=-1,
-        .max_transfer_sz=32768
-    };
-    // max_transfer_sz   4Kb is the defaut SPI transfer size if 0
     
     if (debug_enabled) {
-        frequency = 50;
-        multiplier = 1;
+        clock_hz = 50000;
     }
     //Config Frequency and SS GPIO. Full duplex SPI:
     spi_device_interface_config_t devcfg={
         .mode=0,  //SPI mode 0
-        .clock_speed_hz=frequency*multiplier*1000,  // DEBUG: 50000 - No debug usually 4 Mhz
-        .spics_io_num=CONFIG_EINK_SPI_CS,
+        .clock_speed_hz=(int)clock_hz,  // DEBUG: 50000 - No debug usually 4 Mhz
+        .spics_io_num=_config.cs,
         .queue_size=5
     };
     // DISABLED Callbacks pre_cb/post_cb. SPI does not seem to behave the same
     // CS / DC GPIO states the usual way
 
-    //Initialize the SPI bus
-    ret=spi_bus_initialize(EPD_HOST, &buscfg, DMA_CHAN);
+    // Initialize the SPI bus, or share it. Here MISO is used, to receive temp & accelerometer data
+    // BUFFER max transfer is 21" buffer *2
+    ret=epd_spi_bus_acquire(_config.host, _config.mosi, _config.miso, _config.clk, 32768);
     ESP_ERROR_CHECK(ret);
 
     //Attach the EPD to the SPI bus
-    ret=spi_bus_add_device(EPD_HOST, &devcfg, &spi);
+    ret=spi_bus_add_device(_config.host, &devcfg, &spi);
     ESP_ERROR_CHECK(ret);
 
     }
@@ -84,6 +75,8 @@ void EpdSpi2Cs::release() {
     esp_err_t ret;
     ret = spi_bus_remove_device(spi);
     ESP_ERROR_CHECK(ret);
+    spi = nullptr;
+    epd_spi_bus_release(_config.host);
     printf("Free heap: %d after releasing SPI\n", (int)xPortGetFreeHeapSize());
 }
 
@@ -148,16 +141,54 @@ uint8_t EpdSpi2Cs::readRegister(const uint8_t *data, int len)
     return readByte;
 }
 
-void EpdSpi2Cs::waitForBusy()
+// BUSY edges wake up the task blocked in waitForBusy()
+void EpdSpi2Cs::_busyInit()
 {
-    int64_t time_since_boot = esp_timer_get_time();
+    if (_busy_sem != nullptr || _config.busy < 0) return;
+    _busy_sem = xSemaphoreCreateBinary();
+    // The ISR service is shared: ESP_ERR_INVALID_STATE means it was already installed
+    esp_err_t ret = gpio_install_isr_service(0);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+        ESP_LOGE("EpdSpi2Cs", "gpio_install_isr_service failed: %d. waitForBusy will poll", ret);
+        vSemaphoreDelete(_busy_sem);
+        _busy_sem = nullptr;
+        return;
+    }
+    gpio_set_intr_type((gpio_num_t)_config.busy, GPIO_INTR_DISABLE);
+    ESP_ERROR_CHECK(gpio_isr_handler_add((gpio_num_t)_config.busy, EpdSpi2Cs::_busyIsr, this));
+}
 
-    while (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 0){
-        vTaskDelay(10/portTICK_PERIOD_MS); 
+void IRAM_ATTR EpdSpi2Cs::_busyIsr(void *arg)
+{
+    EpdSpi2Cs* io = (EpdSpi2Cs*) arg;
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(io->_busy_sem, &woken);
+    if (woken == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
+}
 
-        if (esp_timer_get_time()-time_since_boot>500000)
-        {
-        break;
+// Same as EpdSpi::waitBusy(1, 500): the Plasticlogic controller is ready when BUSY is HIGH
+void EpdSpi2Cs::waitForBusy()
+{
+    gpio_num_t busy = (gpio_num_t)_config.busy;
+    if (gpio_get_level(busy) == 1) return;
+
+    int64_t time_since_boot = esp_timer_get_time();
+    if (_busy_sem != nullptr) {
+        xSemaphoreTake(_busy_sem, 0); // Discard an edge from a previous wait
+        gpio_set_intr_type(busy, GPIO_INTR_POSEDGE);
+        gpio_intr_enable(busy);
+        // BUSY might have been released before the interrupt was armed
+        if (gpio_get_level(busy) == 0) {
+            xSemaphoreTake(_busy_sem, pdMS_TO_TICKS(500));
+        }
+        gpio_intr_disable(busy);
+        gpio_set_intr_type(busy, GPIO_INTR_DISABLE);
+    } else {
+        while (gpio_get_level(busy) == 0) {
+            vTaskDelay(1);
+            if (esp_timer_get_time()-time_since_boot>500000) break;
         }
     }
 }
@@ -206,8 +237,8 @@ void EpdSpi2Cs::data(const uint8_t *data, int len)
 }
 
 void EpdSpi2Cs::reset(uint8_t millis=5) {
-    gpio_set_level((gpio_num_t)CONFIG_EINK_RST, 0);
+    gpio_set_level((gpio_num_t)_config.rst, 0);
     vTaskDelay(millis / portTICK_PERIOD_MS);
-    gpio_set_level((gpio_num_t)CONFIG_EINK_RST, 1);
+    gpio_set_level((gpio_num_t)_config.rst, 1);
     vTaskDelay(millis / portTICK_PERIOD_MS);
 }
@@ -8,7 +8,7 @@
 void PlasticLogic::initIO(bool debug) {
   IO.init(4, debug); // 4MHz frequency
   
-  if (CONFIG_EINK_RST > -1) {
+  if (IO.config().rst > -1) {
     IO.reset(5);
   } else {
     IO.cmd(EPD_SOFTWARERESET);
@@ -215,9 +215,9 @@ void PlasticLogic::_waitBusy(const char* message, uint16_t busy_time){
   }
   int64_t time_since_boot = esp_timer_get_time();
   // On high is busy
-  if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 1) {
+  if (IO.getBusyLevel() == 1) {
   while (1){
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 1) break;
+    if (IO.getBusyLevel() == 1) break;
     vTaskDelay(1);
     if (esp_timer_get_time()-time_since_boot>7000000)
     {
@@ -236,7 +236,7 @@ void PlasticLogic::_waitBusy(const char* message){
   }
   int64_t time_since_boot = esp_timer_get_time();
 
-  while (gpio_get_level((gpio_num_t)CONFIG_EINK_BUSY) == 0){
+  while (IO.getBusyLevel() == 0){
     vTaskDelay(1/portTICK_PERIOD_MS); 
 
     if (esp_timer_get_time()-time_since_boot>100000)
@@ -274,30 +274,29 @@ size_t PlasticLogic::write(uint8_t v){
   Adafruit_GFX::write(v);
   return 1;
 }
-uint8_t PlasticLogic::_unicodeEasy(uint8_t c) {
-  if (c<191 && c>131 && c!=176) { // 176 is °W 
-    c+=64;
+void PlasticLogic::print(const char* text, size_t len){
+  // Decoded in runs so the buffer stays on the stack
+  uint8_t chars[EPD_UTF8_RUN + 1];
+  while (len > 0) {
+    size_t n = (len < EPD_UTF8_RUN) ? len : EPD_UTF8_RUN;
+    size_t count = _utf8.decode(gfxFont, text, n, chars);
+    for (size_t i = 0; i < count; i++) write(chars[i]);
+    text += n;
+    len -= n;
   }
-  return c;
+}
+
+void PlasticLogic::print(const char* text){
+  print(text, strlen(text));
 }
 
 void PlasticLogic::print(const std::string& text){
-   for(auto c : text) {
-     if (c==195 || c==194) continue; // Skip to next letter
-     c = _unicodeEasy(c);
-     write(uint8_t(c));
-   }
+  print(text.data(), text.size());
 }
 
 void PlasticLogic::println(const std::string& text){
-   for(auto c : text) {
-     if (c==195 || c==194) continue; // Skip to next letter
-
-     // _unicodeEasy will just sum 64 and get the right character when using umlauts and other characters:
-     c = _unicodeEasy(c);
-     write(uint8_t(c));
-   }
-   write(10); // newline
+  print(text.data(), text.size());
+  write(10); // newline
 }
 
 void PlasticLogic::newline() {
@@ -27,6 +27,10 @@ Wave12I48::Wave12I48(Epd4Spi& dio):
 {
   printf("Wave12I48() constructor injects IO and extends Adafruit_GFX(%d,%d) Pix Buffer[%d]\nNOTE: Requires external RAM\n",
   WAVE12I48_WIDTH, WAVE12I48_HEIGHT, (int) WAVE12I48_BUFFER_SIZE);
+  if (_buffer == nullptr) {
+    ESP_LOGW(TAG, "No memory for a %d bytes buffer, drawing in bands: use drawPaged()", (int)WAVE12I48_BUFFER_SIZE);
+    setPaging(true);
+  }
 }
 
 // Initialize the display
@@ -45,7 +49,9 @@ void Wave12I48::fillScreen(uint16_t color)
 {
   if (debug_enabled) printf("fillScreen(%x) Buffer size:%d\n", color, (int)WAVE12I48_BUFFER_SIZE);
   uint8_t data = (color == EPD_BLACK) ? WAVE12I48_8PIX_BLACK : WAVE12I48_8PIX_WHITE;
-  for (uint32_t x = 0; x < WAVE12I48_BUFFER_SIZE; x++)
+  // In paged mode only the band being drawn
+  uint32_t size = _page.enabled() ? uint32_t(_page.count()) * (WAVE12I48_WIDTH / 8) : WAVE12I48_BUFFER_SIZE;
+  for (uint32_t x = 0; x < size; x++)
   {
     _buffer[x] = data;
   }
@@ -53,86 +59,66 @@ void Wave12I48::fillScreen(uint16_t color)
 
 void Wave12I48::_powerOn(){
     // Power on
-  IO.cmdM1(0x04);
-  IO.cmdM2(0x04);
-  vTaskDelay(pdMS_TO_TICKS(300));
+  IO.cmd(EPD4SPI_M1 | EPD4SPI_M2, 0x04);
+  IO.waitBusy(EPD4SPI_M1 | EPD4SPI_M2, WAVE_BUSY_TIMEOUT / 1000, "power on");
+  // The 4 panels refresh at the same time: wait for the last one to be ready
   IO.cmdM1S1M2S2(0x12);
-  _waitBusyM1("display refresh");
-  _waitBusyM2("display refresh");
+  bool ready = IO.waitBusy(EPD4SPI_ALL, WAVE_BUSY_TIMEOUT / 1000, "display refresh");
+  if (!ready && debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
 }
 
 void Wave12I48::_wakeUp(){
   IO.reset(200);
+  // Settings that are the same for several panels are broadcast
   // Panel setting
-  IO.cmdM1(epd_panel_setting_full.cmd);
-  IO.dataM1(epd_panel_setting_full.data[0]);
-  IO.cmdS1(epd_panel_setting_full.cmd);
-  IO.dataS1(epd_panel_setting_full.data[0]);
-  IO.cmdM2(epd_panel_setting_full.cmd);
-  IO.dataM2(0x13);
-  IO.cmdS2(epd_panel_setting_full.cmd);
-  IO.dataS2(0x13);
+  static const uint8_t panel_setting_m2s2[] = {0x13};
+  IO.cmdData(EPD4SPI_M1 | EPD4SPI_S1, epd_panel_setting_full);
+  IO.cmdData(EPD4SPI_M2 | EPD4SPI_S2, epd_panel_setting_full.cmd, panel_setting_m2s2, sizeof(panel_setting_m2s2));
 
   // booster soft start
-  IO.cmdM1(0x06);
-  IO.dataM1(0x17);	//A
-  IO.dataM1(0x17);	//B
-  IO.dataM1(0x39);	//C
-  IO.dataM1(0x17);
-  IO.cmdM2(0x06);
-  IO.dataM2(0x17);
-  IO.dataM2(0x17);
-  IO.dataM2(0x39);
-  IO.dataM2(0x17);
+  static const uint8_t booster[] = {0x17, 0x17, 0x39, 0x17}; // A, B, C
+  IO.cmdData(EPD4SPI_M1 | EPD4SPI_M2, 0x06, booster, sizeof(booster));
 
   printf("Resolution setting\n");
-  IO.cmdM1(epd_resolution_m1s2.cmd);
-  for (int i=0;i<epd_resolution_m1s2.databytes;++i) {
-    IO.dataM1(epd_resolution_m1s2.data[i]);
-  }
-  IO.cmdS1(epd_resolution_m2s1.cmd);
-  for (int i=0;i<epd_resolution_m2s1.databytes;++i) {
-    IO.dataS1(epd_resolution_m2s1.data[i]);
-  }
-  IO.cmdM2(epd_resolution_m2s1.cmd);
-  for (int i=0;i<epd_resolution_m2s1.databytes;++i) {
-    IO.dataM2(epd_resolution_m2s1.data[i]);
-  }
-  IO.cmdS2(epd_resolution_m1s2.cmd);
-  for (int i=0;i<epd_resolution_m1s2.databytes;++i) {
-    IO.dataS2(epd_resolution_m1s2.data[i]);
-  }
-  
-  IO.cmdM1S1M2S2(0x15);  // DUSPI
-  IO.dataM1S1M2S2(0x20);
-
-  IO.cmdM1S1M2S2(0x50);  //Vcom and data interval setting
-  IO.dataM1S1M2S2(0x21); //Border KW
-  IO.dataM1S1M2S2(0x07);
-
-  IO.cmdM1S1M2S2(0x60);  //TCON
-  IO.dataM1S1M2S2(0x22);
-
-  IO.cmdM1S1M2S2(0xE3);
-  IO.dataM1S1M2S2(0x00);
-
-  IO.cmdM1S1M2S2(0xe0);  //Cascade setting
-  IO.dataM1S1M2S2(0x03);
-    
-  IO.cmdM1S1M2S2(0xe5);//Force temperature
-  IO.dataM1S1M2S2(0x00);
-
+  IO.cmdData(EPD4SPI_M1 | EPD4SPI_S2, epd_resolution_m1s2);
+  IO.cmdData(EPD4SPI_S1 | EPD4SPI_M2, epd_resolution_m2s1);
+
+  static const uint8_t duspi[] = {0x20};
+  static const uint8_t vcom[] = {0x21, 0x07};   // Border KW
+  static const uint8_t tcon[] = {0x22};
+  static const uint8_t e3[] = {0x00};
+  static const uint8_t cascade[] = {0x03};
+  static const uint8_t temperature[] = {0x00};
+  IO.cmdData(EPD4SPI_ALL, 0x15, duspi, sizeof(duspi));      // DUSPI
+  IO.cmdData(EPD4SPI_ALL, 0x50, vcom, sizeof(vcom));        // Vcom and data interval setting
+  IO.cmdData(EPD4SPI_ALL, 0x60, tcon, sizeof(tcon));        // TCON
+  IO.cmdData(EPD4SPI_ALL, 0xE3, e3, sizeof(e3));
+  IO.cmdData(EPD4SPI_ALL, 0xe0, cascade, sizeof(cascade));  // Cascade setting
+  IO.cmdData(EPD4SPI_ALL, 0xe5, temperature, sizeof(temperature)); // Force temperature
 }
 
 void Wave12I48::update()
 {
+  if (_page.enabled()) {
+    ESP_LOGE(TAG, "Paged mode has no frame buffer to send: draw the frame with drawPaged()");
+    return;
+  }
   uint64_t startTime = esp_timer_get_time();
   _wakeUp();
   
   printf("Sending a buffer[%d] via SPI\n", (int)WAVE12I48_BUFFER_SIZE);
-  uint32_t i = 0;
   IO.cmdM1S1M2S2(0x13);
+  _sendRows(_buffer, 0, WAVE12I48_HEIGHT);
+
+  uint64_t endTime = esp_timer_get_time();
+  _powerOn();
+  uint64_t powerOnTime = esp_timer_get_time();
+  printf("\nAvailable heap after Epd update: %d bytes\nSTATS (ms)\n%llu _wakeUp settings+send Buffer\n%llu _powerOn\n%llu total time in millis\n",
+  (int)xPortGetFreeHeapSize(), (endTime-startTime)/1000, (powerOnTime-endTime)/1000, (powerOnTime-startTime)/1000);
+}
 
+void Wave12I48::_sendRows(const uint8_t* rows, uint16_t y, uint16_t count)
+{
   /*
    DISPLAYS:
   __________
@@ -141,45 +127,56 @@ void Wave12I48::update()
   | M1 | S1 |
   -----------
   */
-  uint8_t x1buf[81];
-  uint8_t x2buf[82];
-
-  // Optimized to send in 81/82 byte chuncks (v2 after our conversation with Samuel)
-  for(uint16_t y =  1; y <= WAVE12I48_HEIGHT; y++) {
-        for(uint16_t x = 1; x <= WAVE12I48_WIDTH/8; x++) {
-          uint8_t data = i < WAVE12I48_BUFFER_SIZE ? _buffer[i] : 0x00;
-
-        if (y <= 492) {  // S2 & M2 area
-          if (x <= 81) { // 648/8 -> S2
-            x1buf[x-1] = data;
-          } else {       // M2
-            x2buf[x-82] = data;
-          }
+  IO.dataRows(rows, y, count);
+}
 
-          if (x==WAVE12I48_WIDTH/8) {  // Send the complete X line for S2 & M2
-                IO.dataS2(x1buf,sizeof(x1buf));
-                IO.dataM2(x2buf,sizeof(x2buf));
-          }
+bool Wave12I48::setPaging(bool enabled, uint32_t bytes)
+{
+  if (enabled) {
+    bool paged = _page.enabled();
+    if (!_page.begin(bytes, WAVE12I48_WIDTH / 8, WAVE12I48_HEIGHT)) return false;
+    // The full buffer is not needed anymore
+    if (!paged) free(_buffer);
+    _buffer = _page.data();
+    return true;
+  }
+  if (!_page.enabled()) return true;
+  uint8_t* buffer = (uint8_t*)heap_caps_malloc(WAVE12I48_BUFFER_SIZE, MALLOC_CAP_SPIRAM);
+  if (buffer == nullptr) {
+    buffer = (uint8_t*)heap_caps_malloc(WAVE12I48_BUFFER_SIZE, MALLOC_CAP_8BIT);
+  }
+  if (buffer == nullptr) {
+    ESP_LOGE(TAG, "Not enough memory for a %d bytes buffer", (int)WAVE12I48_BUFFER_SIZE);
+    return false;
+  }
+  _page.end();
+  _buffer = buffer;
+  fillScreen(EPD_WHITE);
+  return true;
+}
 
-        } else {         // M1 & S1
-          if (x <= 81) { // 648/8 -> M1
-            x1buf[x-1] = data;
-          } else {       // S1
-            x2buf[x-82] = data;
-          }
+void Wave12I48::drawPaged(epd_draw_page_t draw, void* arg)
+{
+  if (!_page.enabled()) {
+    draw(*this, arg);
+    update();
+    return;
+  }
+  uint64_t startTime = esp_timer_get_time();
+  _wakeUp();
 
-          if (x==WAVE12I48_WIDTH/8) { // Send the complete X line for M1 & S1
-              IO.dataM1(x1buf,sizeof(x1buf));
-              IO.dataS1(x2buf,sizeof(x2buf));
-          }
-        }
-          ++i;
-        }
+  printf("Sending the frame via SPI in bands of %d rows\n", (int)_page.rows());
+  IO.cmdM1S1M2S2(0x13);
+  for (uint16_t y = 0; _page.select(y); y += _page.rows()) {
+    fillScreen(EPD_WHITE);
+    draw(*this, arg);
+    _sendRows(_buffer, y, _page.count());
   }
+
   uint64_t endTime = esp_timer_get_time();
   _powerOn();
   uint64_t powerOnTime = esp_timer_get_time();
-  printf("\nAvailable heap after Epd update: %d bytes\nSTATS (ms)\n%llu _wakeUp settings+send Buffer\n%llu _powerOn\n%llu total time in millis\n",
+  printf("\nAvailable heap after Epd update: %d bytes\nSTATS (ms)\n%llu _wakeUp settings+draw and send bands\n%llu _powerOn\n%llu total time in millis\n",
   (int)xPortGetFreeHeapSize(), (endTime-startTime)/1000, (powerOnTime-endTime)/1000, (powerOnTime-startTime)/1000);
 }
 
@@ -189,90 +186,16 @@ uint16_t Wave12I48::_setPartialRamArea(uint16_t, uint16_t, uint16_t, uint16_t){
 }
 
 void Wave12I48::_waitBusy(const char* message){
-  _waitBusyM1(message);
-}
-
-void Wave12I48::_waitBusyM1(const char* message){
-  if (debug_enabled) {
-    ESP_LOGI(TAG, "_waitBusyM1 for %s", message);
-  }
-  int64_t time_since_boot = esp_timer_get_time();
-
-  while (1){
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_SPI_M1_BUSY) == 1) break;
-    IO.cmdM1(0x71);
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>WAVE_BUSY_TIMEOUT)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
-    }
-  }
-  vTaskDelay(pdMS_TO_TICKS(200));
-}
-
-void Wave12I48::_waitBusyM2(const char* message){
-  if (debug_enabled) {
-    ESP_LOGI(TAG, "_waitBusyM2 for %s", message);
-  }
-  int64_t time_since_boot = esp_timer_get_time();
-
-  while (1){
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_SPI_M2_BUSY) == 1) break;
-    IO.cmdM1(0x71);
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>WAVE_BUSY_TIMEOUT)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
-    }
-  }
-  vTaskDelay(pdMS_TO_TICKS(200));
-}
-
-void Wave12I48::_waitBusyS1(const char* message){
-  if (debug_enabled) {
-    ESP_LOGI(TAG, "_waitBusyS1 for %s", message);
-  }
-  int64_t time_since_boot = esp_timer_get_time();
-
-  while (1){
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_SPI_S1_BUSY) == 1) break;
-    IO.cmdM1(0x71);
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>WAVE_BUSY_TIMEOUT)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
-    }
-  }
-  vTaskDelay(pdMS_TO_TICKS(200));
-}
-
-void Wave12I48::_waitBusyS2(const char* message){
-  if (debug_enabled) {
-    ESP_LOGI(TAG, "_waitBusyS2 for %s", message);
-  }
-  int64_t time_since_boot = esp_timer_get_time();
-
-  while (1){
-    if (gpio_get_level((gpio_num_t)CONFIG_EINK_SPI_S2_BUSY) == 1) break;
-    IO.cmdM1(0x71);
-    vTaskDelay(1);
-    if (esp_timer_get_time()-time_since_boot>WAVE_BUSY_TIMEOUT)
-    {
-      if (debug_enabled) ESP_LOGI(TAG, "Busy Timeout");
-      break;
-    }
-  }
-  vTaskDelay(pdMS_TO_TICKS(200));
+  // Interrupt driven: returns as soon as the 4 panels are ready
+  bool ready = IO.waitBusy(EPD4SPI_ALL, WAVE_BUSY_TIMEOUT / 1000, message);
+  if (!ready && debug_enabled) ESP_LOGI(TAG, "Busy Timeout for %s", message);
 }
 
 void Wave12I48::_sleep(){
   IO.cmdM1S1M2S2(0x02); // power off
   vTaskDelay(pdMS_TO_TICKS(300));
-  IO.cmdM1S1M2S2(0x07); // Deep sleep
-  IO.dataM1S1M2S2(0xA5);
+  static const uint8_t deep_sleep[] = {0xA5};
+  IO.cmdData(EPD4SPI_ALL, 0x07, deep_sleep, sizeof(deep_sleep)); // Deep sleep
   vTaskDelay(pdMS_TO_TICKS(300));
 }
 
@@ -314,6 +237,11 @@ void Wave12I48::drawPixel(int16_t x, int16_t y, uint16_t color) {
       y = WAVE12I48_HEIGHT - y - 1;
       break;
   }
+  if (_page.enabled()) {
+    // Paged mode: only the rows of the band
+    if (!_page.contains(y)) return;
+    y -= _page.top();
+  }
   uint32_t i = x / 8 + y * WAVE12I48_WIDTH / 8;
 
   if (color) {
@@ -325,51 +253,11 @@ void Wave12I48::drawPixel(int16_t x, int16_t y, uint16_t color) {
 
 void Wave12I48::clear(){
   printf("EPD_12in48_Clear start ...\n");
-    //M1 part 648*492
-    IO.cmdM1(0x10);
-    for(uint16_t y =  492; y < 984; y++)
-        for(uint16_t x = 0; x < 81; x++) {
-            IO.dataM1(0xff);
-        }
-    IO.cmdM1(0x13);
-    for(uint16_t y = 492; y < 984; y++)
-        for(uint16_t x = 0; x < 81; x++) {
-            IO.dataM1(0xff);
-        }
-
-    //S1 part 656*492
-    IO.cmdS1(0x10);
-    for(uint16_t y = 492; y < 984; y++)
-        for(uint16_t x = 81; x < 163; x++) {
-            IO.dataS1(0xff);
-        }
-    IO.cmdS1(0x13);
-    for(uint16_t y = 492; y < 984; y++)
-        for(uint16_t x = 81; x < 163; x++) {
-            IO.dataS1(0xff);
-        }
-
-    //M2 part 656*492
-    IO.cmdM2(0x10);
-    for(uint16_t y = 0; y < 492; y++)
-        for(uint16_t x = 81; x < 163; x++) {
-            IO.dataM2(0xff);
-        }
-    IO.cmdM2(0x13);
-    for(uint16_t y = 0; y < 492; y++)
-        for(uint16_t x = 81; x < 163; x++) {
-            IO.dataM2(0xff);
-        }
-
-    //S2 part 648*492
-    IO.cmdS2(0x10);
-    for(uint16_t y = 0; y < 492; y++)
-        for(uint16_t x = 0; x < 81; x++) {
-            IO.dataS2(0xff);
-        }
-    IO.cmdS2(0x13);
-    for(uint16_t y = 0; y < 492; y++)
-        for(uint16_t x = 0; x < 81; x++) {
-            IO.dataS2(0xff);
-        }
-}
\ No newline at end of file
+  // Old (0x10) and new (0x13) data to white. M1 & S2 are 648*492, S1 & M2 656*492
+  static const uint8_t commands[] = {0x10, 0x13};
+  for (uint8_t cmd : commands) {
+    IO.cmdM1S1M2S2(cmd);
+    IO.fill(EPD4SPI_M1 | EPD4SPI_S2, 0xff, EPD4SPI_LEFT_BYTES * EPD4SPI_HALF_ROWS);
+    IO.fill(EPD4SPI_S1 | EPD4SPI_M2, 0xff, (EPD4SPI_ROW_BYTES - EPD4SPI_LEFT_BYTES) * EPD4SPI_HALF_ROWS);
+  }
+}